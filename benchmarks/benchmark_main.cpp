@@ -1,47 +1,321 @@
 #include "market_data/order_book.h"
+#include "market_data/tick_order_book.h"
+#include "market_data/l3_order_book.h"
+#include "market_data/itch_decoder.h"
+#include "market_data/feed_arbitrator.h"
+#include "market_data/feed_journal.h"
+#include "market_data/feed_replay.h"
+#include "market_data/market_data_handler.h"
+#include "market_data/shm_book.h"
+#include "network/socket_transport.h"
+#include "network/xdp_transport.h"
+#include "network/tcp_sender.h"
+#include "network/ouch_encoder.h"
+#include "trading/risk_engine.h"
+#include "trading/fair_value.h"
+#include "trading/strategy_router.h"
+#include "trading/pipeline.h"
+#include "trading/sharded_feed.h"
 #include "common/timestamp.h"
+#include "common/logger.h"
+#include "common/hashmap.h"
+#include "common/circular_buffer.h"
+#include "common/latency_histogram.h"
+#include "common/memory_pool.h"
+#include "common/symbol_table.h"
+#include "common/tick_to_trade.h"
+#include "common/rcu.h"
+#include "common/perf_counters.h"
+#include "common/realtime.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <random>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
 
 namespace hft {
 
-// Latency histogram for performance tracking
-class LatencyHistogram {
-public:
-    void record(uint64_t latency_ns) {
-        samples_.push_back(latency_ns);
+// Command line (see usage())
+struct BenchmarkOptions {
+    std::vector<std::string> filters;   // Benchmarks whose name contains one of these
+    std::string json_path;              // Results as JSON lines
+    std::string baseline_path;          // Earlier --json output to compare against
+    double tolerance = 0.10;            // Allowed regression against the baseline
+    int producer_cpu = -1;              // Cross-core benchmarks (-1: not pinned)
+    int consumer_cpu = -1;
+};
+
+// One recorded result: a latency distribution or a throughput, with the
+// hardware counters of the loop that produced it
+struct BenchmarkResult {
+    std::string name;                   // <benchmark>.<case>, stable across runs
+    std::string unit;                   // Latency: "ns", or "tsc" (counter ticks)
+    uint64_t samples = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    double mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    double throughput = 0;              // Operations per second, 0 = latency result
+    uint64_t operations = 0;            // What the counters are divided by
+    PerfCounters::Values counters;      // Whole loop (invalid: not measured)
+};
+
+BenchmarkOptions options;
+std::vector<BenchmarkResult> results;
+
+// Main thread counters: measure() opens an interval, the next recorded
+// result closes it. Results of other threads' loops pass their own.
+PerfCounters counters;
+PerfCounters::Values interval_start;
+bool measuring = false;
+
+void measure() {
+    interval_start = counters.read();
+    measuring = true;
+}
+
+PerfCounters::Values measured() {
+    PerfCounters::Values interval;
+    if (measuring) {
+        interval = counters.read().since(interval_start);
+        measuring = false;
+    }
+    return interval;
+}
+
+// Counters per operation, one line
+void print_counters(const BenchmarkResult& result) {
+    const PerfCounters::Values& c = result.counters;
+    if (!c.valid || result.operations == 0) {
+        return;
+    }
+    double ops = static_cast<double>(result.operations);
+    std::cout << "Per op:  " << c.value[PerfCounters::CYCLES] / ops << " cycles";
+    if (c.counted[PerfCounters::INSTRUCTIONS]) {
+        std::cout << ", " << c.value[PerfCounters::INSTRUCTIONS] / ops << " instructions (IPC "
+                  << c.value[PerfCounters::INSTRUCTIONS] / std::max(c.value[PerfCounters::CYCLES], 1.0) << ")";
+    }
+    if (c.counted[PerfCounters::CACHE_MISSES]) {
+        std::cout << ", " << c.value[PerfCounters::CACHE_MISSES] / ops << " cache misses";
+    }
+    if (c.counted[PerfCounters::BRANCH_MISSES]) {
+        std::cout << ", " << c.value[PerfCounters::BRANCH_MISSES] / ops << " branch misses";
+    }
+    std::cout << "\n";
+}
+
+// Latency statistics of a benchmark (common/latency_histogram.h buckets:
+// percentiles within 3%, min/max/mean exact), recorded as name. A batched
+// loop records one sample per ops_per_sample operations.
+void print_stats(const LatencyHistogram& latency, const std::string& name, const char* unit = "ns",
+                 uint64_t ops_per_sample = 1, const PerfCounters::Values* thread_counters = nullptr) {
+    PerfCounters::Values interval = measured();
+    if (latency.count() == 0) {
+        std::cout << "No samples recorded\n";
+        return;
     }
     
-    void print_stats() const {
-        if (samples_.empty()) {
-            std::cout << "No samples recorded\n";
-            return;
+    BenchmarkResult result;
+    result.name = name;
+    result.unit = unit;
+    result.samples = latency.count();
+    result.min = latency.min();
+    result.max = latency.max();
+    result.mean = latency.mean();
+    result.p50 = latency.value_at_percentile(50);
+    result.p95 = latency.value_at_percentile(95);
+    result.p99 = latency.value_at_percentile(99);
+    result.p999 = latency.value_at_percentile(99.9);
+    result.operations = latency.count() * ops_per_sample;
+    result.counters = thread_counters ? *thread_counters : interval;
+    
+    const char* suffix = result.unit == "tsc" ? " cycles\n" : " ns\n";
+    std::cout << "\n=== Latency Statistics ===\n";
+    std::cout << "Samples: " << result.samples << "\n";
+    std::cout << "Min:     " << result.min << suffix;
+    std::cout << "Max:     " << result.max << suffix;
+    std::cout << "Mean:    " << result.mean << suffix;
+    std::cout << "Median:  " << result.p50 << suffix;
+    std::cout << "P95:     " << result.p95 << suffix;
+    std::cout << "P99:     " << result.p99 << suffix;
+    std::cout << "P99.9:   " << result.p999 << suffix;
+    print_counters(result);
+    std::cout << "========================\n\n";
+    results.push_back(result);
+}
+
+// Throughput result: operations over seconds
+void print_throughput(const std::string& name, uint64_t operations, double seconds,
+                      const PerfCounters::Values* thread_counters = nullptr) {
+    PerfCounters::Values interval = measured();
+    BenchmarkResult result;
+    result.name = name;
+    result.operations = operations;
+    result.throughput = seconds > 0 ? operations / seconds : 0.0;
+    result.counters = thread_counters ? *thread_counters : interval;
+    
+    std::cout << "Throughput: " << result.throughput / 1e6 << " M/s (" << operations << " in "
+              << seconds * 1e3 << " ms)\n";
+    print_counters(result);
+    results.push_back(result);
+}
+
+// Strings in the JSON output (names, host, CPU model)
+std::string json_string(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+std::string cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            return colon == std::string::npos ? line : line.substr(line.find_first_not_of(' ', colon + 1));
         }
-        
-        auto sorted = samples_;
-        std::sort(sorted.begin(), sorted.end());
-        
-        size_t n = sorted.size();
-        double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / n;
-        
-        std::cout << "\n=== Latency Statistics ===\n";
-        std::cout << "Samples: " << n << "\n";
-        std::cout << "Min:     " << sorted[0] << " ns\n";
-        std::cout << "Max:     " << sorted[n-1] << " ns\n";
-        std::cout << "Mean:    " << mean << " ns\n";
-        std::cout << "Median:  " << sorted[n/2] << " ns\n";
-        std::cout << "P95:     " << sorted[size_t(n * 0.95)] << " ns\n";
-        std::cout << "P99:     " << sorted[size_t(n * 0.99)] << " ns\n";
-        std::cout << "P99.9:   " << sorted[size_t(n * 0.999)] << " ns\n";
-        std::cout << "========================\n\n";
     }
+    return "unknown";
+}
+
+// JSON lines: one object for the run, then one per result. Counters are
+// per operation; "counters" is null where they were not measured.
+bool write_json(const std::string& path, double tsc_freq) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+    char host[256] = {};
+    gethostname(host, sizeof(host) - 1);
+    out.precision(10);
+    out << "{\"run\": {\"host\": " << json_string(host)
+        << ", \"cpu\": " << json_string(cpu_model())
+        << ", \"cpus\": " << std::thread::hardware_concurrency()
+        << ", \"tsc_ghz\": " << tsc_freq / 1e9
+        << ", \"timestamp_ns\": " << Timestamp::wall_clock_ns()
+        << ", \"perf_counters\": " << (counters.available() ? "true" : "false") << "}}\n";
     
-private:
-    std::vector<uint64_t> samples_;
-};
+    for (const BenchmarkResult& r : results) {
+        out << "{\"name\": " << json_string(r.name);
+        if (r.samples) {
+            out << ", \"unit\": " << json_string(r.unit) << ", \"samples\": " << r.samples
+                << ", \"min\": " << r.min << ", \"mean\": " << r.mean << ", \"p50\": " << r.p50
+                << ", \"p95\": " << r.p95 << ", \"p99\": " << r.p99 << ", \"p999\": " << r.p999
+                << ", \"max\": " << r.max;
+        } else {
+            out << ", \"throughput\": " << r.throughput;
+        }
+        out << ", \"operations\": " << r.operations << ", \"counters\": ";
+        if (r.counters.valid && r.operations) {
+            const char* separator = "{";
+            for (int e = 0; e < PerfCounters::EVENTS; ++e) {
+                if (r.counters.counted[e]) {
+                    out << separator << "\"" << PerfCounters::event_name(static_cast<PerfCounters::Event>(e))
+                        << "\": " << r.counters.value[e] / r.operations;
+                    separator = ", ";
+                }
+            }
+            out << "}";
+        } else {
+            out << "null";
+        }
+        out << "}\n";
+    }
+    return static_cast<bool>(out);
+}
+
+// Number after "key": in one JSON line (0 when absent)
+double json_number(const std::string& line, const char* key) {
+    std::string field = std::string("\"") + key + "\": ";
+    size_t at = line.find(field);
+    return at == std::string::npos ? 0.0 : std::strtod(line.c_str() + at + field.size(), nullptr);
+}
+
+// This run against an earlier --json file: a result regresses when its
+// p50 or p99 grew, or its throughput fell, by more than the tolerance.
+// Latency changes within 2 units are ignored (histogram resolution at the
+// low end). Returns the number of regressions, -1 if unreadable.
+int compare_baseline(const std::string& path, double tolerance) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot read baseline " << path << "\n";
+        return -1;
+    }
+    int regressions = 0;
+    size_t compared = 0;
+    std::string line;
+    std::cout << "\n=== Baseline " << path << " (tolerance " << tolerance * 100 << " %) ===\n";
+    while (std::getline(in, line)) {
+        size_t at = line.find("{\"name\": \"");
+        if (at != 0) {
+            continue;
+        }
+        std::string name = line.substr(10, line.find('"', 10) - 10);
+        auto current = std::find_if(results.begin(), results.end(),
+                                    [&name](const BenchmarkResult& r) { return r.name == name; });
+        if (current == results.end()) {
+            continue;
+        }
+        ++compared;
+        auto check = [&](const char* what, double before, double now, bool higher_is_better) {
+            bool worse = higher_is_better ? now < before * (1.0 - tolerance)
+                                          : now > before * (1.0 + tolerance) && now - before > 2.0;
+            if (worse) {
+                ++regressions;
+                std::cout << "REGRESSION " << name << " " << what << ": " << before << " -> " << now << "\n";
+            }
+        };
+        if (current->samples) {
+            check("p50", json_number(line, "p50"), static_cast<double>(current->p50), false);
+            check("p99", json_number(line, "p99"), static_cast<double>(current->p99), false);
+        } else {
+            check("throughput", json_number(line, "throughput"), current->throughput, true);
+        }
+    }
+    std::cout << compared << " results compared, " << regressions << " regressions\n";
+    std::cout << "========================\n\n";
+    return regressions;
+}
+
+// Waiting on another thread: spin, or give the CPU away when the threads
+// share one (a spinning waiter would burn the time slice its peer needs)
+inline void backoff(unsigned& spins) {
+    static const unsigned SPIN_LIMIT = std::thread::hardware_concurrency() > 1 ? 1u << 20 : 16;
+    if (++spins < SPIN_LIMIT) {
+        cpu_relax();
+    } else {
+        std::this_thread::yield();
+    }
+}
 
 } // namespace hft
 
@@ -59,6 +333,7 @@ void benchmark_order_book() {
     
     // Benchmark updates
     std::cout << "Running " << ITERATIONS << " order book updates...\n";
+    measure();
     for (int i = 0; i < ITERATIONS; ++i) {
         auto start = Timestamp::now();
         
@@ -70,10 +345,11 @@ void benchmark_order_book() {
     }
     
     std::cout << "Order Book Update Latency:\n";
-    update_latency.print_stats();
+    print_stats(update_latency, "order_book.update");
     
     // Benchmark snapshots
     std::cout << "Running " << ITERATIONS << " order book snapshots...\n";
+    measure();
     for (int i = 0; i < ITERATIONS; ++i) {
         auto start = Timestamp::now();
         
@@ -88,98 +364,2393 @@ void benchmark_order_book() {
     }
     
     std::cout << "Order Book Snapshot Latency:\n";
-    snapshot_latency.print_stats();
+    print_stats(snapshot_latency, "order_book.snapshot");
 }
 
-// Benchmark timestamp/RDTSC
-void benchmark_timestamp() {
+// Benchmark seqlock snapshots under contention
+// One writer thread applies 10-level batched updates as fast as it can
+// while N reader threads take snapshots
+void benchmark_snapshot_contention() {
     using namespace hft;
     
-    std::cout << "Benchmarking Timestamp Operations...\n\n";
+    std::cout << "Benchmarking Snapshot Contention (1 writer, N readers)...\n\n";
     
-    constexpr int ITERATIONS = 1000000;
-    LatencyHistogram rdtsc_latency;
+    constexpr int SNAPSHOTS_PER_READER = 100000;
     
-    std::cout << "Running " << ITERATIONS << " RDTSC calls...\n";
+    for (int readers : {1, 2, 4}) {
+        OrderBook book("AAPL");
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> total_retries{0};
+        std::atomic<uint64_t> total_stale{0};
+        std::vector<LatencyHistogram> latencies(readers);
+        std::vector<PerfCounters::Values> reader_counters(readers);
+        
+        std::thread writer([&book, &stop]() {
+            uint64_t i = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                double base = 150.00 + (i++ % 100) * 0.01;
+                book.begin_update();
+                for (size_t lvl = 0; lvl < OrderBook::MAX_DEPTH; ++lvl) {
+                    book.update_bid(lvl, base - lvl * 0.01, 100.0 + lvl);
+                    book.update_ask(lvl, base + 0.01 + lvl * 0.01, 100.0 + lvl);
+                }
+                book.end_update();
+            }
+        });
+        
+        std::vector<std::thread> reader_threads;
+        for (int r = 0; r < readers; ++r) {
+            reader_threads.emplace_back([&, r]() {
+                uint64_t retries = 0;
+                uint64_t stale = 0;
+                OrderBook::Snapshot snap;
+                PerfCounters thread_counters;
+                thread_counters.open();
+                PerfCounters::Values start_counters = thread_counters.read();
+                
+                for (int i = 0; i < SNAPSHOTS_PER_READER; ++i) {
+                    // Blocking read: measures retry cost
+                    auto start = Timestamp::now();
+                    auto blocking = book.get_snapshot();
+                    auto end = Timestamp::now();
+                    latencies[r].record(Timestamp::to_nanoseconds(end - start));
+                    retries += blocking.retries;
+                    
+                    // Bounded read: counts how often we'd act on a stale book
+                    if (!book.try_get_snapshot(snap, 8)) {
+                        ++stale;
+                    }
+                    
+                    volatile double mid = blocking.mid_price();
+                    (void)mid;
+                }
+                
+                reader_counters[r] = thread_counters.read().since(start_counters);
+                total_retries.fetch_add(retries, std::memory_order_relaxed);
+                total_stale.fetch_add(stale, std::memory_order_relaxed);
+            });
+        }
+        
+        for (auto& t : reader_threads) {
+            t.join();
+        }
+        stop.store(true, std::memory_order_relaxed);
+        writer.join();
+        
+        LatencyHistogram merged;
+        for (const auto& h : latencies) {
+            merged.merge(h);
+        }
+        PerfCounters::Values reader_total = PerfCounters::Values::sum(reader_counters.data(), reader_counters.size());
+        
+        double snapshots = static_cast<double>(readers) * SNAPSHOTS_PER_READER;
+        std::cout << "Readers: " << readers << "\n";
+        std::cout << "Retries per snapshot:  " << total_retries.load() / snapshots << "\n";
+        std::cout << "Stale rate (8 spins):  " << total_stale.load() / snapshots * 100.0 << " %\n";
+        std::cout << "Snapshot Latency Under Contention (counters: blocking + bounded read):\n";
+        print_stats(merged, "snapshot_contention.readers_" + std::to_string(readers), "ns", 1, &reader_total);
+    }
+}
+
+// Depth features on a 10-level snapshot: the SIMD kernels over the
+// column layout against scalar loops over the previous one (a 64-byte
+// aligned struct per level)
+void benchmark_depth_analytics() {
+    using namespace hft;
     
-    for (int i = 0; i < ITERATIONS; ++i) {
+    std::cout << "Benchmarking depth analytics (10 levels: imbalance, microprice, VWAP to size)...\n\n";
+    
+    struct alignas(64) StridedLevel {
+        double price;
+        double quantity;
+        uint32_t order_count;
+    };
+    
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 20000;
+    constexpr size_t BOOKS = 64;
+    
+    // A rotation of books, each in both layouts
+    std::vector<OrderBook::Snapshot> snaps(BOOKS);
+    std::vector<std::array<StridedLevel, OrderBook::MAX_DEPTH>> bids(BOOKS);
+    std::vector<std::array<StridedLevel, OrderBook::MAX_DEPTH>> asks(BOOKS);
+    for (size_t b = 0; b < BOOKS; ++b) {
+        OrderBook book("AAPL");
+        for (size_t i = 0; i < OrderBook::MAX_DEPTH; ++i) {
+            book.update_bid(i, 150.00 - i * 0.01, 100.0 + 10 * i + b);
+            book.update_ask(i, 150.01 + i * 0.01, 120.0 + 5 * i + b);
+        }
+        snaps[b] = book.get_snapshot();
+        for (size_t i = 0; i < OrderBook::MAX_DEPTH; ++i) {
+            bids[b][i] = {snaps[b].bids.price[i], snaps[b].bids.quantity[i], 0};
+            asks[b][i] = {snaps[b].asks.price[i], snaps[b].asks.quantity[i], 0};
+        }
+    }
+    
+    double sink = 0;
+    LatencyHistogram strided;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
         uint64_t start = Timestamp::now();
-        uint64_t end = Timestamp::now();
+        for (int k = 0; k < BATCH; ++k) {
+            const auto& bid = bids[k % BOOKS];
+            const auto& ask = asks[k % BOOKS];
+            double size = 500.0 + k;
+            double bid_qty = 0, ask_qty = 0, bid_notional = 0, ask_notional = 0;
+            for (size_t i = 0; i < OrderBook::MAX_DEPTH; ++i) {
+                bid_qty += bid[i].quantity;
+                bid_notional += bid[i].price * bid[i].quantity;
+                ask_qty += ask[i].quantity;
+                ask_notional += ask[i].price * ask[i].quantity;
+            }
+            double imbalance = (bid_qty - ask_qty) / (bid_qty + ask_qty);
+            double micro = (bid_notional / bid_qty * ask_qty + ask_notional / ask_qty * bid_qty) / (bid_qty + ask_qty);
+            double taken = 0, notional = 0;
+            for (size_t i = 0; i < OrderBook::MAX_DEPTH && taken < size; ++i) {
+                double take = std::min(ask[i].quantity, size - taken);
+                taken += take;
+                notional += take * ask[i].price;
+            }
+            sink += imbalance + micro + notional / taken;
+        }
+        strided.record((Timestamp::now() - start) / BATCH);
+    }
+    std::cout << "Scalar, 64-byte levels (CPU cycles for all three):\n";
+    print_stats(strided, "depth_analytics.strided", "tsc", BATCH);
+    
+    LatencyHistogram columns;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        uint64_t start = Timestamp::now();
+        for (int k = 0; k < BATCH; ++k) {
+            const OrderBook::Snapshot& snap = snaps[k % BOOKS];
+            double size = 500.0 + k;
+            OrderBook::Snapshot::DepthFeatures features = snap.depth_features();
+            sink += features.imbalance + features.microprice + snap.vwap_to_size(OrderBook::Side::ASK, size);
+        }
+        columns.record((Timestamp::now() - start) / BATCH);
+    }
+    std::cout << "depth_features() + vwap_to_size(), column layout (CPU cycles for all three):\n";
+    print_stats(columns, "depth_analytics.columns", "tsc", BATCH);
+    std::cout << "(sizeof Snapshot " << sizeof(OrderBook::Snapshot) << " bytes, checksum " << sink << ")\n\n";
+}
+
+void benchmark_shm_books() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking shared memory book publication...\n\n";
+    
+    constexpr uint32_t SYMBOLS = 64;
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 20000;
+    
+    std::string name = "/hft_bench_books_" + std::to_string(getpid());
+    ShmBookPublisher publisher;
+    if (!publisher.open(name, SYMBOLS, 1 << 12)) {
+        std::cout << "(shared memory unavailable, skipped)\n\n";
+        return;
+    }
+    std::vector<std::unique_ptr<OrderBook>> books;
+    for (uint32_t i = 0; i < SYMBOLS; ++i) {
+        books.push_back(std::make_unique<OrderBook>("SYM" + std::to_string(i)));
+        books.back()->set_symbol_id(i);
+        publisher.add_symbol(i, books.back()->symbol().c_str());
+        for (size_t level = 0; level < OrderBook::MAX_DEPTH; ++level) {
+            books.back()->update_bid(level, 100.0 - level * 0.01, 100.0 + level);
+            books.back()->update_ask(level, 100.01 + level * 0.01, 100.0 + level);
+        }
+    }
+    ShmBookReader reader;
+    reader.open(name);
+    uint32_t id;
+    
+    // Writer: one level update, then with its copy into the region
+    LatencyHistogram update_only;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        uint64_t start = Timestamp::now();
+        for (int k = 0; k < BATCH; ++k) {
+            books[k % SYMBOLS]->update_bid(0, 100.0, 100.0 + (b & 7));
+        }
+        update_only.record((Timestamp::now() - start) / BATCH);
+    }
+    std::cout << "update_bid() (CPU cycles):\n";
+    print_stats(update_only, "shm_books.update", "tsc", BATCH);
+    
+    LatencyHistogram update_publish;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        uint64_t start = Timestamp::now();
+        for (int k = 0; k < BATCH; ++k) {
+            OrderBook& book = *books[k % SYMBOLS];
+            book.update_bid(0, 100.0, 100.0 + (b & 7));
+            publisher.publish(book);
+        }
+        update_publish.record((Timestamp::now() - start) / BATCH);
         
-        rdtsc_latency.record(end - start);
+        // Keep the reader's ring cursor current
+        while (reader.poll(id)) {}
     }
+    std::cout << "update_bid() + publish() (CPU cycles):\n";
+    print_stats(update_publish, "shm_books.update_publish", "tsc", BATCH);
     
-    std::cout << "RDTSC Overhead (CPU cycles):\n";
-    rdtsc_latency.print_stats();
+    // Reader: region copies against the in-process seqlock reads
+    double sink = 0;
+    OrderBook::Top top{};
+    OrderBook::Snapshot snap{};
+    auto reads = [&](const char* heading, const char* result, auto&& read_one) {
+        LatencyHistogram latency;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            uint64_t start = Timestamp::now();
+            for (int k = 0; k < BATCH; ++k) {
+                read_one(static_cast<uint32_t>(k % SYMBOLS));
+            }
+            latency.record((Timestamp::now() - start) / BATCH);
+        }
+        std::cout << heading;
+        print_stats(latency, result, "tsc", BATCH);
+    };
+    reads("OrderBook::get_top(), in process (CPU cycles):\n", "shm_books.local_top",
+          [&](uint32_t s) { sink += books[s]->get_top().bid_quantity; });
+    reads("ShmBookReader::read_top() (CPU cycles):\n", "shm_books.shm_top",
+          [&](uint32_t s) { reader.read_top(s, top); sink += top.bid_quantity; });
+    reads("OrderBook::get_snapshot(), in process (CPU cycles):\n", "shm_books.local_snapshot",
+          [&](uint32_t s) { sink += books[s]->get_snapshot().bids.quantity[0]; });
+    reads("ShmBookReader::read() (CPU cycles):\n", "shm_books.shm_snapshot",
+          [&](uint32_t s) { reader.read(s, snap); sink += snap.bids.quantity[0]; });
+    
+    // Event-driven: one notice and the top it points at
+    LatencyHistogram polled;
+    PerfCounters::Values poll_counters;
+    for (int b = 0; b < BATCHES; ++b) {
+        for (int k = 0; k < BATCH; ++k) {
+            publisher.publish(*books[k % SYMBOLS]);
+        }
+        PerfCounters::Values before = counters.read();
+        uint64_t start = Timestamp::now();
+        while (reader.poll(id)) {
+            reader.read_top(id, top);
+            sink += top.ask_price;
+        }
+        polled.record((Timestamp::now() - start) / BATCH);
+        // Publishing in between is not the reader's cost
+        PerfCounters::Values batch = counters.read().since(before);
+        PerfCounters::Values both[2] = {poll_counters, batch};
+        poll_counters = b == 0 ? batch : PerfCounters::Values::sum(both, 2);
+    }
+    std::cout << "poll() + read_top() per notice (CPU cycles):\n";
+    print_stats(polled, "shm_books.poll", "tsc", BATCH, &poll_counters);
+    std::cout << "(slot " << sizeof(shm::BookSlot) << " bytes, checksum " << sink << ")\n\n";
 }
 
-// Benchmark cache effects
-void benchmark_cache_effects() {
-    std::cout << "\nBenchmarking Cache Effects...\n\n";
+// Compare the level-indexed OrderBook with the tick-keyed full-depth book
+// Each iteration updates one bid and one ask level, cycling through depth
+void benchmark_book_depth() {
+    using namespace hft;
     
-    // This demonstrates why cache line alignment matters
-    struct UnalignedData {
-        double value1;
-        double value2;
+    std::cout << "Benchmarking Book Engines by Depth...\n\n";
+    
+    constexpr int ITERATIONS = 100000;
+    
+    for (size_t depth : {10, 50, 500}) {
+        OrderBook level_book("AAPL");
+        TickOrderBook tick_book("AAPL", 0.01, depth);
+        LatencyHistogram level_latency;
+        LatencyHistogram tick_latency;
+        
+        measure();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            size_t level = i % depth;
+            double qty = 100.0 + (i & 7);
+            
+            auto start = Timestamp::now();
+            level_book.update_bid(level, 150.00 - level * 0.01, qty);
+            level_book.update_ask(level, 150.01 + level * 0.01, qty);
+            auto end = Timestamp::now();
+            level_latency.record(Timestamp::to_nanoseconds(end - start));
+        }
+        
+        std::cout << "Depth " << depth << " - OrderBook update_bid/update_ask";
+        if (depth > OrderBook::MAX_DEPTH) {
+            std::cout << " (truncated to " << OrderBook::MAX_DEPTH << " levels)";
+        }
+        std::cout << ":\n";
+        print_stats(level_latency, "book_depth.order_book.depth_" + std::to_string(depth));
+        
+        measure();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            size_t level = i % depth;
+            double qty = 100.0 + (i & 7);
+            
+            auto start = Timestamp::now();
+            tick_book.update(TickOrderBook::Side::BID, 15000 - level, qty);
+            tick_book.update(TickOrderBook::Side::ASK, 15001 + level, qty);
+            auto end = Timestamp::now();
+            tick_latency.record(Timestamp::to_nanoseconds(end - start));
+        }
+        
+        volatile double touch = level_book.best_bid() + tick_book.best_bid();
+        (void)touch;
+        
+        std::cout << "Depth " << depth << " - TickOrderBook update ("
+                  << tick_book.level_count(TickOrderBook::Side::BID) << " bid levels):\n";
+        print_stats(tick_latency, "book_depth.tick_book.depth_" + std::to_string(depth));
+    }
+}
+
+// Benchmark the L3 book on an ITCH-like message mix
+// The mix follows the proportions of a regular-session ITCH day
+// (adds/deletes dominate, replaces next, then executions and cancels)
+// and is generated up front with a fixed seed so runs are comparable.
+void benchmark_l3_book() {
+    using namespace hft;
+    using Side = L3OrderBook::Side;
+    
+    std::cout << "Benchmarking L3 Order Book (ITCH message mix)...\n\n";
+    
+    constexpr size_t LIVE_ORDERS = 1000000;
+    constexpr size_t MESSAGES = 1000000;
+    
+    enum class Op : uint8_t { ADD, DELETE, CANCEL, EXECUTE, REPLACE };
+    struct Msg {
+        Op op;
+        Side side;
+        uint32_t quantity;
+        uint64_t order_id;
+        uint64_t new_order_id;
+        uint64_t price_ticks;
     };
     
-    struct alignas(64) AlignedData {
-        double value1;
-        char padding[64 - sizeof(double)];
-        double value2;
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> live;
+    std::vector<Side> live_side;
+    live.reserve(LIVE_ORDERS * 2);
+    live_side.reserve(LIVE_ORDERS * 2);
+    uint64_t next_id = 1;
+    
+    auto random_price = [&rng](Side side) {
+        uint64_t offset = rng() % 400;
+        return side == Side::BID ? 1000000 - offset : 1000001 + offset;
     };
     
-    constexpr int ITERATIONS = 10000000;
+    L3OrderBook book("AAPL", 0.0001, LIVE_ORDERS * 2);
+    std::cout << "Order pool: " << book.order_capacity() << " nodes, "
+              << (book.uses_huge_pages() ? "MAP_HUGETLB" : "4K pages + THP hint") << "\n";
     
-    // Unaligned access
-    UnalignedData unaligned[2] = {{1.0, 2.0}, {3.0, 4.0}};
-    auto start = hft::Timestamp::now();
-    for (int i = 0; i < ITERATIONS; ++i) {
-        unaligned[0].value1 += 1.0;
-        unaligned[1].value2 += 1.0;
+    // Pre-load the book so the run happens at millions of live orders
+    for (size_t i = 0; i < LIVE_ORDERS; ++i) {
+        Side side = (rng() & 1) ? Side::BID : Side::ASK;
+        book.add_order(next_id, side, random_price(side), 100);
+        live.push_back(next_id++);
+        live_side.push_back(side);
     }
-    auto end = hft::Timestamp::now();
-    uint64_t unaligned_time = hft::Timestamp::to_nanoseconds(end - start);
     
-    // Aligned access
-    AlignedData aligned[2] = {};
-    aligned[0].value1 = 1.0;
-    aligned[1].value2 = 3.0;
-    start = hft::Timestamp::now();
-    for (int i = 0; i < ITERATIONS; ++i) {
-        aligned[0].value1 += 1.0;
-        aligned[1].value2 += 1.0;
+    std::vector<Msg> msgs;
+    msgs.reserve(MESSAGES);
+    for (size_t i = 0; i < MESSAGES; ++i) {
+        uint32_t roll = rng() % 100;
+        size_t pick = rng() % live.size();
+        Msg m{};
+        
+        if (roll < 45) {
+            m.op = Op::ADD;
+            m.side = (rng() & 1) ? Side::BID : Side::ASK;
+            m.order_id = next_id++;
+            m.price_ticks = random_price(m.side);
+            m.quantity = 100 + rng() % 400;
+            live.push_back(m.order_id);
+            live_side.push_back(m.side);
+        } else if (roll < 80) {
+            m.op = Op::DELETE;
+            m.order_id = live[pick];
+            live[pick] = live.back();
+            live_side[pick] = live_side.back();
+            live.pop_back();
+            live_side.pop_back();
+        } else if (roll < 85) {
+            m.op = Op::CANCEL;
+            m.order_id = live[pick];
+            m.quantity = 10;
+        } else if (roll < 90) {
+            m.op = Op::EXECUTE;
+            m.order_id = live[pick];
+            m.quantity = 10;
+        } else {
+            m.op = Op::REPLACE;
+            m.order_id = live[pick];
+            m.new_order_id = next_id++;
+            m.side = live_side[pick];
+            m.price_ticks = random_price(m.side);
+            m.quantity = 100;
+            live[pick] = m.new_order_id;
+        }
+        msgs.push_back(m);
     }
-    end = hft::Timestamp::now();
-    uint64_t aligned_time = hft::Timestamp::to_nanoseconds(end - start);
     
-    std::cout << "Unaligned (false sharing): " << unaligned_time << " ns\n";
-    std::cout << "Aligned (no false sharing): " << aligned_time << " ns\n";
-    std::cout << "Speedup: " << (double)unaligned_time / aligned_time << "x\n\n";
+    LatencyHistogram latency;
+    size_t rejected = 0;
+    
+    measure();
+    for (const auto& m : msgs) {
+        auto start = Timestamp::now();
+        bool ok = false;
+        switch (m.op) {
+            case Op::ADD: ok = book.add_order(m.order_id, m.side, m.price_ticks, m.quantity); break;
+            case Op::DELETE: ok = book.delete_order(m.order_id); break;
+            case Op::CANCEL: ok = book.cancel_order(m.order_id, m.quantity); break;
+            case Op::EXECUTE: ok = book.execute_order(m.order_id, m.quantity); break;
+            case Op::REPLACE: ok = book.replace_order(m.order_id, m.new_order_id, m.price_ticks, m.quantity); break;
+        }
+        auto end = Timestamp::now();
+        latency.record(Timestamp::to_nanoseconds(end - start));
+        rejected += !ok;
+    }
+    
+    std::cout << "Live orders: " << book.order_count() << ", levels: " << book.level_count()
+              << ", rejected: " << rejected << "\n";
+    std::cout << "L3 Message Latency:\n";
+    print_stats(latency, "l3_book.itch_mix");
+}
+
+// Benchmark ITCH 5.0 decode cost (framing + jump table dispatch, no book)
+namespace {
+
+struct CountingHandler : hft::itch::NullHandler {
+    uint64_t shares = 0;
+    void on_add_order(const hft::itch::AddOrder& m) { shares += m.shares; }
+    void on_order_executed(const hft::itch::OrderExecuted& m) { shares += m.executed_shares; }
+    void on_order_delete(const hft::itch::OrderDelete& m) { shares += m.order_ref & 1; }
+};
+
+void put_be(std::vector<char>& buf, uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        buf.push_back(static_cast<char>((v >> (i * 8)) & 0xFF));
+    }
+}
+
+// Pre-built MoldUDP64 packets with an add/execute/delete ITCH mix
+std::vector<std::vector<char>> build_itch_packets(size_t count, size_t messages_per_packet) {
+    std::vector<std::vector<char>> packets(count);
+    uint64_t seq = 1;
+    for (auto& pkt : packets) {
+        pkt.insert(pkt.end(), 10, 'S');
+        put_be(pkt, seq, 8);
+        put_be(pkt, messages_per_packet, 2);
+        for (size_t i = 0; i < messages_per_packet; ++i, ++seq) {
+            switch (seq % 3) {
+                case 0:
+                    put_be(pkt, 36, 2);
+                    pkt.push_back('A');
+                    put_be(pkt, 1, 2); put_be(pkt, 0, 2); put_be(pkt, seq, 6);
+                    put_be(pkt, seq, 8);
+                    pkt.push_back('B');
+                    put_be(pkt, 100, 4);
+                    pkt.insert(pkt.end(), {'A', 'A', 'P', 'L', ' ', ' ', ' ', ' '});
+                    put_be(pkt, 1500000, 4);
+                    break;
+                case 1:
+                    put_be(pkt, 31, 2);
+                    pkt.push_back('E');
+                    put_be(pkt, 1, 2); put_be(pkt, 0, 2); put_be(pkt, seq, 6);
+                    put_be(pkt, seq - 1, 8);
+                    put_be(pkt, 50, 4);
+                    put_be(pkt, seq, 8);
+                    break;
+                default:
+                    put_be(pkt, 19, 2);
+                    pkt.push_back('D');
+                    put_be(pkt, 1, 2); put_be(pkt, 0, 2); put_be(pkt, seq, 6);
+                    put_be(pkt, seq - 2, 8);
+                    break;
+            }
+        }
+    }
+    
+    return packets;
+}
+
+// Item handed across a ring: when it was pushed and by whom
+struct RingItem {
+    uint64_t timestamp;
+    uint32_t producer;
+    uint32_t sequence;
+};
+
+// Producers on producer_cpu, producer_cpu + 1, ...; the main thread
+// consumes on consumer_cpu (its counters are the consumer's)
+template<typename Ring>
+void ring_handoff(const std::string& name, unsigned producers) {
+    using namespace hft;
+    
+    constexpr uint32_t ITEMS = 2000000;       // Throughput, all producers together
+    constexpr uint32_t ROUNDS = 50000;        // Latency, per producer
+    struct alignas(64) Consumed {
+        std::atomic<uint32_t> count{0};
+    };
+    
+    auto ring = std::make_unique<Ring>();
+    std::atomic<bool> go{false};
+    std::vector<Consumed> consumed(producers);
+    std::atomic<unsigned> pinned{0};
+    auto start_producers = [&](bool paced) {
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p, paced]() {
+                if (options.producer_cpu >= 0 && realtime::pin_thread(options.producer_cpu + static_cast<int>(p))) {
+                    pinned.fetch_add(1, std::memory_order_relaxed);
+                }
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                uint32_t count = paced ? ROUNDS : ITEMS / producers;
+                for (uint32_t i = 0; i < count; ++i) {
+                    RingItem item{Timestamp::now(), p, i};
+                    unsigned spins = 0;
+                    while (!ring->push(item)) {
+                        backoff(spins);
+                    }
+                    // Latency: one item in flight per producer
+                    spins = 0;
+                    while (paced && consumed[p].count.load(std::memory_order_acquire) <= i) {
+                        backoff(spins);
+                    }
+                }
+            });
+        }
+        return threads;
+    };
+    
+    // Streaming: as fast as the consumer keeps up
+    std::vector<std::thread> threads = start_producers(false);
+    uint32_t total = ITEMS / producers * producers;
+    uint64_t checksum = 0;
+    RingItem item;
+    measure();
+    uint64_t begin = Timestamp::now();
+    go.store(true, std::memory_order_release);
+    for (uint32_t received = 0; received < total;) {
+        unsigned spins = 0;
+        while (!ring->pop(item)) {
+            backoff(spins);
+        }
+        checksum += item.sequence;
+        ++received;
+    }
+    double seconds = Timestamp::to_nanoseconds(Timestamp::now() - begin) / 1e9;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << name << " streaming, " << producers << (producers > 1 ? " producers" : " producer")
+              << " (items/s, consumer counters):\n";
+    print_throughput("ring_handoff." + name + ".throughput", total, seconds);
+    
+    // One item in flight per producer: push to pop across the cores
+    go.store(false, std::memory_order_release);
+    threads = start_producers(true);
+    LatencyHistogram latency;
+    measure();
+    go.store(true, std::memory_order_release);
+    for (uint32_t received = 0; received < ROUNDS * producers; ++received) {
+        unsigned spins = 0;
+        while (!ring->pop(item)) {
+            backoff(spins);
+        }
+        latency.record(Timestamp::to_nanoseconds(Timestamp::now() - item.timestamp));
+        consumed[item.producer].count.store(item.sequence + 1, std::memory_order_release);
+        checksum += item.sequence;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << name << " push -> pop, one item in flight per producer (producer threads pinned: "
+              << pinned.load() << " of " << 2 * producers << ", checksum " << checksum << "):\n";
+    print_stats(latency, "ring_handoff." + name + ".latency");
 }
 
-int main() {
+} // namespace
+
+// Ring handoff between threads on chosen cores (--producer-cpu,
+// --consumer-cpu): the SPSC CircularBuffer of the pipeline stages and the
+// MPSC ring, streaming and one item at a time
+void benchmark_ring_handoff() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking cross-core ring handoff (producer cpu " << options.producer_cpu
+              << ", consumer cpu " << options.consumer_cpu << ", " << std::thread::hardware_concurrency()
+              << " CPUs)...\n\n";
+    
+    cpu_set_t saved_cpus;
+    bool restore_cpus = pthread_getaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus) == 0;
+    if (options.consumer_cpu >= 0 && !realtime::pin_thread(options.consumer_cpu)) {
+        std::cout << "(consumer not pinned to cpu " << options.consumer_cpu << ")\n";
+    }
+    if (std::thread::hardware_concurrency() < 2) {
+        std::cout << "(one CPU: waiters yield, the numbers are scheduler handoffs)\n";
+    }
+    
+    ring_handoff<CircularBuffer<RingItem, 4096>>("spsc", 1);
+    ring_handoff<MPSCCircularBuffer<RingItem, 4096>>("mpsc_1", 1);
+    ring_handoff<MPSCCircularBuffer<RingItem, 4096>>("mpsc_3", 3);
+    
+    if (restore_cpus) {
+        pthread_setaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus);
+    }
     std::cout << "\n";
-    std::cout << "================================================\n";
-    std::cout << "   HFT Trading System Performance Benchmarks   \n";
-    std::cout << "================================================\n\n";
+}
+
+// Name -> book on the simple feed path: the FNV-1a + strcmp hash map the
+// handler used before, against interned IDs (SIMD key compare + flat array)
+void benchmark_symbol_lookup() {
+    using namespace hft;
     
-    // Calibrate TSC
-    std::cout << "Calibrating TSC frequency...\n";
-    double tsc_freq = hft::Timestamp::calibrate_tsc_frequency();
-    std::cout << "TSC Frequency: " << tsc_freq / 1e9 << " GHz\n\n";
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 20000;
+    
+    for (size_t count : {size_t(8), size_t(16384)}) {
+        std::cout << "Benchmarking symbol -> book lookup (" << count << " symbols, random access)...\n\n";
+        
+        auto map = std::make_unique<LockFreeHashMap<const char*, uintptr_t, 32768>>();
+        SymbolTable symbols(count);
+        std::vector<uintptr_t> books(count);
+        std::vector<std::array<char, 16>> fields(count);
+        for (size_t i = 0; i < count; ++i) {
+            fields[i] = {};
+            std::snprintf(fields[i].data(), 16, "SYM%zu", i);
+            map->insert(fields[i].data(), i + 1);
+            books[symbols.intern(fields[i].data())] = i + 1;
+        }
+        
+        std::mt19937 rng(7);
+        std::vector<const char*> messages(BATCH * 256);
+        for (auto& message : messages) {
+            message = fields[rng() % count].data();
+        }
+        
+        uintptr_t found = 0;
+        LatencyHistogram hashed;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            const char* const* batch = &messages[(b % 256) * BATCH];
+            uint64_t start = Timestamp::now();
+            for (int i = 0; i < BATCH; ++i) {
+                uintptr_t* book = map->find(batch[i]);
+                found += book ? *book : 0;
+            }
+            hashed.record((Timestamp::now() - start) / BATCH);
+        }
+        std::cout << "LockFreeHashMap<const char*> find (CPU cycles per lookup):\n";
+        print_stats(hashed, "symbol_lookup.hash_map." + std::to_string(count), "tsc", BATCH);
+        
+        LatencyHistogram interned;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            const char* const* batch = &messages[(b % 256) * BATCH];
+            uint64_t start = Timestamp::now();
+            for (int i = 0; i < BATCH; ++i) {
+                uint32_t id = symbols.find_field(batch[i]);
+                found += id != SymbolTable::NO_SYMBOL ? books[id] : 0;
+            }
+            interned.record((Timestamp::now() - start) / BATCH);
+        }
+        std::cout << "SymbolTable::find_field + book array (CPU cycles per lookup):\n";
+        print_stats(interned, "symbol_lookup.interned." + std::to_string(count), "tsc", BATCH);
+        std::cout << "(checksum " << found << ")\n\n";
+    }
+}
+
+// Integer-keyed LockFreeHashMap (order IDs and the like) by load factor:
+// linear probing lengthens hits a little and misses a lot as it fills
+void benchmark_hashmap_load() {
+    using namespace hft;
     
-    benchmark_timestamp();
-    benchmark_order_book();
-    benchmark_cache_effects();
+    constexpr size_t CAPACITY = 1 << 16;      // 192-byte entries: 12 MB, past the caches
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 20000;
+    using Map = LockFreeHashMap<uint64_t, uint64_t, CAPACITY>;
     
-    std::cout << "\nBenchmarks complete!\n\n";
-    std::cout << "Key Takeaways for HFT:\n";
-    std::cout << "1. RDTSC overhead is typically < 50 CPU cycles\n";
-    std::cout << "2. Order book updates should be < 100ns\n";
-    std::cout << "3. Cache line alignment prevents false sharing\n";
-    std::cout << "4. Lock-free > locks for critical paths\n";
-    std::cout << "5. Every nanosecond counts!\n\n";
+    std::cout << "Benchmarking LockFreeHashMap<uint64_t> lookups by load factor (" << CAPACITY
+              << " slots, random keys)...\n\n";
+    
+    for (int percent : {25, 50, 75, 90}) {
+        auto map = std::make_unique<Map>();
+        std::mt19937_64 rng(42);
+        std::vector<uint64_t> keys(CAPACITY * percent / 100);
+        for (auto& key : keys) {
+            key = rng();
+            map->insert(key, key >> 3);
+        }
+        std::vector<uint64_t> hits(BATCH * 256);
+        std::vector<uint64_t> misses(BATCH * 256);
+        for (size_t i = 0; i < hits.size(); ++i) {
+            hits[i] = keys[rng() % keys.size()];
+            misses[i] = rng();                // 2^-48 odds of being present
+        }
+        
+        uint64_t found = 0;
+        std::string suffix = ".load_" + std::to_string(percent);
+        for (bool hit : {true, false}) {
+            const std::vector<uint64_t>& lookups = hit ? hits : misses;
+            LatencyHistogram latency;
+            measure();
+            for (int b = 0; b < BATCHES; ++b) {
+                const uint64_t* batch = &lookups[(b % 256) * BATCH];
+                uint64_t start = Timestamp::now();
+                for (int i = 0; i < BATCH; ++i) {
+                    uint64_t* value = map->find(batch[i]);
+                    found += value ? *value : 1;
+                }
+                latency.record((Timestamp::now() - start) / BATCH);
+            }
+            std::cout << "Load " << percent << " %, find() " << (hit ? "hit" : "miss")
+                      << " (CPU cycles per lookup):\n";
+            print_stats(latency, std::string("hashmap.find_") + (hit ? "hit" : "miss") + suffix, "tsc", BATCH);
+        }
+        std::cout << "(checksum " << found << ")\n\n";
+    }
+}
+
+void benchmark_feed_decoder() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking ITCH 5.0 / MoldUDP64 decoder...\n\n";
+    
+    constexpr size_t PACKETS = 4096;
+    constexpr size_t MESSAGES_PER_PACKET = 20;
+    constexpr int ROUNDS = 50;
+    
+    auto packets = build_itch_packets(PACKETS, MESSAGES_PER_PACKET);
+    
+    CountingHandler handler;
+    feed::FeedDecoder<feed::MoldUDP64Framing, itch::Itch50, CountingHandler> decoder(handler);
+    
+    LatencyHistogram latency;
+    size_t messages = 0;
+    
+    measure();
+    auto total_start = Timestamp::now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (const auto& pkt : packets) {
+            auto start = Timestamp::now();
+            messages += decoder.decode(pkt.data(), pkt.size());
+            auto end = Timestamp::now();
+            latency.record(Timestamp::to_nanoseconds(end - start));
+        }
+    }
+    auto total_end = Timestamp::now();
+    
+    double seconds = Timestamp::to_nanoseconds(total_end - total_start) / 1e9;
+    std::cout << "Messages decoded: " << messages << " (checksum " << handler.shares << ")\n";
+    std::cout << "Messages (counters per message):\n";
+    print_throughput("feed_decoder.messages", messages, seconds);
+    std::cout << "Per-packet Latency (" << MESSAGES_PER_PACKET << " messages):\n";
+    print_stats(latency, "feed_decoder.packet");
+}
+
+// Benchmark A/B arbitration: first copy delivered, second dropped
+void benchmark_feed_arbitration() {
+    using namespace hft;
+    using Line = FeedArbitrator::Line;
+    
+    std::cout << "Benchmarking A/B feed arbitration...\n\n";
+    
+    constexpr size_t PACKETS = 1000000;
+    
+    // One header-only template packet, the sequence is patched per send
+    char packet[64] = {};
+    std::memcpy(packet, "SESSION01 ", 10);
+    feed::write_be16(packet + 18, 1);
+    feed::write_be16(packet + 20, 19);
+    packet[22] = 'D';
+    constexpr size_t PACKET_LEN = 20 + 2 + 19;
+    
+    uint64_t delivered = 0;
+    auto arb = std::make_unique<FeedArbitrator>(
+        [&delivered](const char*, size_t) { ++delivered; });
+    arb->set_expected_sequence(1);
+    
+    // The whole session on the leading line, lines alternating, then the
+    // trailing copies (all behind the expected sequence by then)
+    LatencyHistogram first_copy;
+    measure();
+    for (uint64_t seq = 1; seq <= PACKETS; ++seq) {
+        feed::write_be64(packet + 10, seq);
+        auto start = Timestamp::now();
+        arb->on_packet((seq & 1) ? Line::A : Line::B, packet, PACKET_LEN);
+        auto end = Timestamp::now();
+        first_copy.record(Timestamp::to_nanoseconds(end - start));
+    }
+    
+    std::cout << "First Copy Latency (delivered):\n";
+    print_stats(first_copy, "feed_arbitration.first_copy");
+    
+    LatencyHistogram duplicate;
+    measure();
+    for (uint64_t seq = 1; seq <= PACKETS; ++seq) {
+        feed::write_be64(packet + 10, seq);
+        auto start = Timestamp::now();
+        arb->on_packet((seq & 1) ? Line::B : Line::A, packet, PACKET_LEN);
+        auto end = Timestamp::now();
+        duplicate.record(Timestamp::to_nanoseconds(end - start));
+    }
+    
+    std::cout << "Delivered: " << delivered << ", duplicates: " << arb->stats().duplicates << "\n";
+    std::cout << "Second Copy Latency (dropped):\n";
+    print_stats(duplicate, "feed_arbitration.duplicate");
+}
+
+// Benchmark feed capture (cost added to the receive path) and replay of
+// the captured session through MarketDataHandler
+void benchmark_feed_capture() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking feed capture journal and replay...\n\n";
+    
+    constexpr size_t PACKETS = 100000;
+    constexpr size_t MESSAGES_PER_PACKET = 20;
+    auto packets = build_itch_packets(PACKETS, MESSAGES_PER_PACKET);
+    std::string path = "/tmp/hft_benchmark_" + std::to_string(getpid()) + ".jrnl";
+    
+    size_t capacity = 0;
+    for (const auto& pkt : packets) {
+        capacity += journal::record_size(pkt.size());
+    }
+    FeedJournalWriter writer;
+    if (!writer.open(path, capacity)) {
+        std::cout << "capture: skipped (cannot create " << path << ")\n";
+        return;
+    }
+    
+    LatencyHistogram append;
+    measure();
+    for (const auto& pkt : packets) {
+        auto start = Timestamp::now();
+        writer.append(pkt.data(), pkt.size(), Timestamp::fast_wall_clock_ns());
+        auto end = Timestamp::now();
+        append.record(Timestamp::to_nanoseconds(end - start));
+    }
+    std::cout << "Captured " << writer.records() << " packets (" << writer.dropped() << " dropped, "
+              << packets[0].size() << " bytes each)\n";
+    std::cout << "Capture Append Latency:\n";
+    print_stats(append, "feed_capture.append");
+    writer.close();
+    
+    FeedJournalReader reader;
+    if (!reader.open(path)) {
+        unlink(path.c_str());
+        return;
+    }
+    
+    // Back to back through a fresh handler
+    MarketDataHandler handler;
+    handler.set_feed_protocol(FeedProtocol::ITCH50_MOLDUDP64);
+    FeedReplayer replayer(handler);
+    replayer.set_speed(0);
+    measure();
+    FeedReplayer::Stats stats = replayer.replay(reader);
+    double seconds = stats.elapsed_ns / 1e9;
+    std::cout << "Replay (as fast as possible): " << stats.packets << " packets, "
+              << (stats.bytes / seconds / 1e9) << " GB/s, handler time per packet: mean "
+              << Timestamp::to_nanoseconds(stats.processing_cycles) / std::max<uint64_t>(stats.packets, 1)
+              << " ns, max " << Timestamp::to_nanoseconds(stats.max_processing_cycles) << " ns\n";
+    std::cout << "Replayed messages (counters per message):\n";
+    print_throughput("feed_capture.replay", handler.messages_decoded(), seconds);
+    std::cout << "\n";
+    
+    reader.close();
+    unlink(path.c_str());
+}
+
+// Benchmark receive backends on the same replayed ITCH feed:
+// send -> transport -> MarketDataHandler (L3 book update)
+void benchmark_receive_transports() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking receive transports (replayed ITCH feed)...\n\n";
+    
+    constexpr size_t PACKETS = 20000;
+    constexpr size_t MESSAGES_PER_PACKET = 20;
+    constexpr size_t BURST = 32;
+    auto packets = build_itch_packets(PACKETS, MESSAGES_PER_PACKET);
+    
+    MarketDataHandler handler;
+    handler.set_feed_protocol(FeedProtocol::ITCH50_MOLDUDP64);
+    RxPacket rx[SocketTransport::MAX_BATCH];
+    
+    // Kernel sockets over loopback: the feed socket plays the exchange
+    int feed = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in feed_addr;
+    std::memset(&feed_addr, 0, sizeof(feed_addr));
+    feed_addr.sin_family = AF_INET;
+    feed_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(feed_addr);
+    if (feed < 0 || bind(feed, (struct sockaddr*)&feed_addr, sizeof(feed_addr)) < 0 ||
+        getsockname(feed, (struct sockaddr*)&feed_addr, &addr_len) < 0) {
+        std::cout << "socket: skipped (no loopback)\n";
+        return;
+    }
+    
+    SocketTransport::Options options;
+    options.batch_size = BURST;
+    SocketTransport sockets(options);
+    int source = sockets.open_unicast("127.0.0.1", ntohs(feed_addr.sin_port));
+    struct sockaddr_in rx_addr;
+    addr_len = sizeof(rx_addr);
+    if (source < 0 || !sockets.start() ||
+        getsockname(sockets.fd(source), (struct sockaddr*)&rx_addr, &addr_len) < 0) {
+        std::cout << "socket: skipped (transport setup failed)\n";
+        ::close(feed);
+        return;
+    }
+    
+    // One packet in flight: wire-to-book latency through the kernel stack
+    LatencyHistogram latency;
+    measure();
+    for (const auto& pkt : packets) {
+        auto start = Timestamp::now();
+        sendto(feed, pkt.data(), pkt.size(), 0, (struct sockaddr*)&rx_addr, sizeof(rx_addr));
+        int n;
+        while ((n = sockets.receive(rx, BURST, 0)) == 0) {
+            cpu_relax();
+        }
+        for (int i = 0; i < n; ++i) {
+            handler.process_message(rx[i].data, rx[i].len);
+        }
+        auto end = Timestamp::now();
+        latency.record(Timestamp::to_nanoseconds(end - start));
+    }
+    std::cout << "socket: send -> book latency (" << MESSAGES_PER_PACKET << " messages/packet, counters user space only):\n";
+    print_stats(latency, "receive_transports.socket");
+    
+    // Bursts: recvmmsg drains a whole burst per syscall
+    uint64_t calls_before = sockets.syscalls();
+    size_t received = 0;
+    measure();
+    auto burst_start = Timestamp::now();
+    for (size_t base = 0; base + BURST <= PACKETS; base += BURST) {
+        for (size_t i = 0; i < BURST; ++i) {
+            const auto& pkt = packets[base + i];
+            sendto(feed, pkt.data(), pkt.size(), 0, (struct sockaddr*)&rx_addr, sizeof(rx_addr));
+        }
+        for (size_t got = 0; got < BURST;) {
+            int n = sockets.receive(rx, BURST, 0);
+            for (int i = 0; i < n; ++i) {
+                handler.process_message(rx[i].data, rx[i].len);
+            }
+            got += std::max(n, 0);
+        }
+        received += BURST;
+    }
+    auto burst_end = Timestamp::now();
+    double seconds = Timestamp::to_nanoseconds(burst_end - burst_start) / 1e9;
+    std::cout << "socket: bursts of " << BURST << ", packets incl. send ("
+              << static_cast<double>(sockets.syscalls() - calls_before) / received
+              << " receive syscalls/packet):\n";
+    print_throughput("receive_transports.socket_burst", received, seconds);
+    
+    sockets.close();
+    ::close(feed);
+    
+    // AF_XDP needs an XDP redirect program and the feed on a NIC queue
+    // (loopback never reaches XDP): replay the same capture from a peer
+    const char* iface = std::getenv("HFT_XDP_IFACE");
+    if (!iface) {
+        std::cout << "af_xdp: skipped (set HFT_XDP_IFACE, HFT_XDP_GROUP, HFT_XDP_PORT "
+                     "and replay the feed onto that interface)\n";
+        return;
+    }
+    
+    const char* group = std::getenv("HFT_XDP_GROUP");
+    const char* port = std::getenv("HFT_XDP_PORT");
+    XdpTransport::Options xdp_options;
+    xdp_options.interface = iface;
+    XdpTransport xdp(xdp_options);
+    if (xdp.open_multicast(group ? group : "239.1.1.1",
+                           static_cast<uint16_t>(port ? std::atoi(port) : 9000)) < 0 ||
+        !xdp.start()) {
+        std::cout << "af_xdp: skipped (setup failed, see log)\n";
+        return;
+    }
+    
+    // Receive and apply whatever arrives for a few seconds
+    LatencyHistogram per_packet;
+    received = 0;
+    uint64_t window_end = Timestamp::wall_clock_ns() + 5'000'000'000ULL;
+    while (Timestamp::wall_clock_ns() < window_end) {
+        auto start = Timestamp::now();
+        int n = xdp.receive(rx, SocketTransport::MAX_BATCH, 0);
+        if (n <= 0) {
+            continue;
+        }
+        for (int i = 0; i < n; ++i) {
+            handler.process_message(rx[i].data, rx[i].len);
+        }
+        auto end = Timestamp::now();
+        per_packet.record(Timestamp::to_nanoseconds(end - start) / n);
+        received += n;
+    }
+    std::cout << "af_xdp (" << (xdp.zero_copy() ? "zero-copy" : "copy mode") << "): "
+              << received << " packets, "
+              << (received ? static_cast<double>(xdp.syscalls()) / received : 0.0)
+              << " syscalls/packet\n";
+    std::cout << "af_xdp: receive -> book per packet:\n";
+    print_stats(per_packet, "receive_transports.af_xdp");
+}
+
+// Benchmark timestamp/RDTSC
+void benchmark_timestamp() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking Timestamp Operations...\n\n";
+    
+    constexpr int ITERATIONS = 1000000;
+    LatencyHistogram rdtsc_latency;
+    
+    std::cout << "Running " << ITERATIONS << " RDTSC calls...\n";
+    
+    measure();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        uint64_t start = Timestamp::now();
+        uint64_t end = Timestamp::now();
+        
+        rdtsc_latency.record(end - start);
+    }
+    
+    std::cout << "RDTSC Overhead (CPU cycles):\n";
+    print_stats(rdtsc_latency, "timestamp.rdtsc", "tsc");
+    
+    // Wall clock: clock_gettime (vDSO) vs TSC + calibrated offset
+    uint64_t sink = 0;
+    measure();
+    auto start = Timestamp::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        sink += Timestamp::wall_clock_ns();
+    }
+    auto end = Timestamp::now();
+    std::cout << "wall_clock_ns() calls:\n";
+    print_throughput("timestamp.wall_clock_ns", ITERATIONS, Timestamp::to_nanoseconds(end - start) / 1e9);
+    
+    measure();
+    start = Timestamp::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        sink += Timestamp::fast_wall_clock_ns();
+    }
+    end = Timestamp::now();
+    std::cout << "fast_wall_clock_ns() calls:\n";
+    print_throughput("timestamp.fast_wall_clock_ns", ITERATIONS, Timestamp::to_nanoseconds(end - start) / 1e9);
+    
+    std::cout << "Clock skew after calibration: "
+              << static_cast<int64_t>(Timestamp::fast_wall_clock_ns() - Timestamp::wall_clock_ns())
+              << " ns (checksum " << (sink & 1) << ")\n\n";
+}
+
+void benchmark_pipeline() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking pipeline rings and feed thread cost...\n\n";
+    
+    // Ring transfer per item: one by one vs batches of 32 (one index
+    // store per batch on each side)
+    constexpr int ROUNDS = 20000;
+    constexpr size_t BATCH = 32;
+    auto ring = std::make_unique<CircularBuffer<TradingPipeline::BookEvent, 4096>>();
+    TradingPipeline::BookEvent items[BATCH] = {};
+    LatencyHistogram single_latency;
+    measure();
+    for (int round = 0; round < ROUNDS; ++round) {
+        uint64_t start = Timestamp::now();
+        for (size_t i = 0; i < BATCH; ++i) {
+            ring->push(items[i]);
+        }
+        for (size_t i = 0; i < BATCH; ++i) {
+            ring->pop(items[i]);
+        }
+        uint64_t end = Timestamp::now();
+        single_latency.record((end - start) / BATCH);
+    }
+    std::cout << "push()/pop() per event (CPU cycles):\n";
+    print_stats(single_latency, "pipeline.push_pop", "tsc", BATCH);
+    
+    LatencyHistogram batch_latency;
+    measure();
+    for (int round = 0; round < ROUNDS; ++round) {
+        uint64_t start = Timestamp::now();
+        ring->push_batch(items, BATCH);
+        ring->pop_batch(items, BATCH);
+        uint64_t end = Timestamp::now();
+        batch_latency.record((end - start) / BATCH);
+    }
+    std::cout << "push_batch()/pop_batch() per event (CPU cycles):\n";
+    print_stats(batch_latency, "pipeline.push_pop_batch", "tsc", BATCH);
+    
+    // Feed thread time per record: strategy inline, handed to the strategy
+    // thread per update, or conflated per book
+    constexpr int ITERATIONS = 100000;
+    struct Record {
+        char symbol[16];
+        uint8_t side;
+        uint8_t level;
+        double price;
+        double quantity;
+        uint64_t timestamp;
+    } __attribute__((packed)) record;
+    std::memset(&record, 0, sizeof(record));
+    std::strncpy(record.symbol, "AAPL", sizeof(record.symbol) - 1);
+    record.price = 100.0;
+    
+    TCPSender sender("127.0.0.1", 1);
+    OrderManager manager(sender);
+    ArbitrageStrategy strategy(manager, ArbitrageStrategy::Parameters{});
+    const char* modes[] = {"Inline (StrategyRouter)", "Pipelined (event queued)", "Pipelined (conflated)"};
+    const char* mode_names[] = {"pipeline.feed_inline", "pipeline.feed_queued", "pipeline.feed_conflated"};
+    for (int mode = 0; mode < 3; ++mode) {
+        MarketDataHandler handler;
+        handler.add_symbol("AAPL");
+        StrategyRouter router(handler);
+        router.subscribe("AAPL", &strategy);
+        TradingPipeline::Options options;
+        options.conflate = mode == 2;
+        TradingPipeline pipeline(handler, router, manager, sender, options);
+        if (mode > 0) {
+            pipeline.start();
+        }
+        
+        LatencyHistogram feed_latency;
+        measure();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            record.quantity = 100 + (i & 7);
+            uint64_t start = Timestamp::now();
+            handler.process_message(reinterpret_cast<const char*>(&record), sizeof(record));
+            uint64_t end = Timestamp::now();
+            feed_latency.record(end - start);
+        }
+        PerfCounters::Values feed_counters = measured();
+        pipeline.stop();
+        std::cout << modes[mode] << " feed thread per record (CPU cycles):\n";
+        print_stats(feed_latency, mode_names[mode], "tsc", 1, &feed_counters);
+        if (mode == 1) {
+            std::cout << "  events dropped: " << pipeline.events_dropped()
+                      << ", max queueing delay: " << pipeline.max_queue_delay_ns() << " ns\n";
+        } else if (mode == 2) {
+            std::cout << "  strategy evaluations: " << pipeline.events_processed() << " for "
+                      << ITERATIONS << " updates\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+// Feed shards: messages per second through 1 to 8 handlers, one driver
+// thread per shard standing in for its receiver (pinned to CPU s while
+// there are enough), each fed only its shard's symbols as its channels
+// would carry them; every 8th symbol is routed to a strategy through the
+// shard's ring
+void benchmark_sharded_feed() {
+    using namespace hft;
+    
+    unsigned cpus = std::thread::hardware_concurrency();
+    std::cout << "Benchmarking sharded feed handling (" << cpus << " CPUs)...\n\n";
+    if (cpus < 2) {
+        std::cout << "(one CPU: the shards take turns, throughput cannot scale here)\n";
+    }
+    
+    constexpr size_t SYMBOLS = 512;
+    constexpr size_t MESSAGES = 800000;             // Every run, all shards
+    constexpr size_t RECORDS_PER_PACKET = 16;
+    struct Record {
+        char symbol[16];
+        uint8_t side;
+        uint8_t level;
+        double price;
+        double quantity;
+        uint64_t timestamp;
+    } __attribute__((packed));
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < SYMBOLS; ++i) {
+        symbols.push_back("S" + std::to_string(1000 + i));
+    }
+    
+    TCPSender sender("127.0.0.1", 1);
+    OrderManager manager(sender);
+    ArbitrageStrategy strategy(manager, ArbitrageStrategy::Parameters{});
+    for (size_t shards : {1, 2, 4, 8}) {
+        FeedPartition partition;
+        partition.shards.resize(shards);
+        ShardedFeed::Options feed_options;
+        feed_options.max_symbols = SYMBOLS;
+        ShardedFeed feed(partition, manager, feed_options);
+        for (size_t i = 0; i < SYMBOLS; ++i) {
+            if (i % 8 == 0) {
+                feed.subscribe(symbols[i], &strategy);
+            } else {
+                feed.add_symbol(symbols[i]);
+            }
+        }
+        
+        // Each shard's stream, in packets of RECORDS_PER_PACKET
+        std::vector<std::vector<Record>> streams(shards);
+        for (size_t m = 0; m < MESSAGES; ++m) {
+            const std::string& symbol = symbols[(m * 7) % SYMBOLS];
+            Record record;
+            std::memset(&record, 0, sizeof(record));
+            std::strncpy(record.symbol, symbol.c_str(), sizeof(record.symbol) - 1);
+            record.side = m & 1;
+            record.level = 0;
+            record.price = 100.0 + (record.side ? 0.01 : -0.01) + (m & 3) * 0.01;
+            record.quantity = 100 + (m & 15);
+            streams[feed.shard_of(symbol)].push_back(record);
+        }
+        
+        feed.start();
+        std::atomic<bool> go{false};
+        std::atomic<unsigned> pinned{0};
+        std::vector<std::thread> drivers;
+        std::vector<PerfCounters::Values> driver_counters(shards);
+        for (size_t s = 0; s < shards; ++s) {
+            drivers.emplace_back([&, s]() {
+                if (shards < cpus && realtime::pin_thread(static_cast<int>(s))) {
+                    pinned.fetch_add(1);
+                }
+                MarketDataHandler& handler = feed.handler(s);
+                const std::vector<Record>& stream = streams[s];
+                PerfCounters thread_counters;
+                thread_counters.open();
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                PerfCounters::Values start_counters = thread_counters.read();
+                for (size_t i = 0; i < stream.size(); i += RECORDS_PER_PACKET) {
+                    size_t records = std::min(RECORDS_PER_PACKET, stream.size() - i);
+                    handler.process_message(reinterpret_cast<const char*>(&stream[i]), records * sizeof(Record));
+                }
+                driver_counters[s] = thread_counters.read().since(start_counters);
+            });
+        }
+        measure();
+        uint64_t begin = Timestamp::now();
+        go.store(true, std::memory_order_release);
+        for (auto& driver : drivers) {
+            driver.join();
+        }
+        double seconds = Timestamp::to_nanoseconds(Timestamp::now() - begin) / 1e9;
+        feed.stop();
+        
+        uint64_t decoded = 0;
+        for (size_t s = 0; s < shards; ++s) {
+            decoded += feed.handler(s).messages_decoded();
+        }
+        PerfCounters::Values total = PerfCounters::Values::sum(driver_counters.data(), driver_counters.size());
+        std::cout << shards << (shards > 1 ? " shards" : " shard") << " (driver threads pinned: "
+                  << pinned.load() << " of " << shards << ", " << decoded << " decoded, "
+                  << feed.events_processed() << " strategy events, " << feed.events_dropped()
+                  << " dropped; counters of all drivers):\n";
+        print_throughput("sharded_feed.shards_" + std::to_string(shards), MESSAGES, seconds, &total);
+    }
+    std::cout << "\n";
+}
+
+// Benchmark cache effects
+void benchmark_cache_effects() {
+    std::cout << "\nBenchmarking Cache Effects...\n\n";
+    
+    // This demonstrates why cache line alignment matters
+    struct UnalignedData {
+        double value1;
+        double value2;
+    };
+    
+    struct alignas(64) AlignedData {
+        double value1;
+        char padding[64 - sizeof(double)];
+        double value2;
+    };
+    
+    constexpr int ITERATIONS = 10000000;
+    
+    // Unaligned access
+    UnalignedData unaligned[2] = {{1.0, 2.0}, {3.0, 4.0}};
+    auto start = hft::Timestamp::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        unaligned[0].value1 += 1.0;
+        unaligned[1].value2 += 1.0;
+    }
+    auto end = hft::Timestamp::now();
+    uint64_t unaligned_time = hft::Timestamp::to_nanoseconds(end - start);
+    
+    // Aligned access
+    AlignedData aligned[2] = {};
+    aligned[0].value1 = 1.0;
+    aligned[1].value2 = 3.0;
+    start = hft::Timestamp::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        aligned[0].value1 += 1.0;
+        aligned[1].value2 += 1.0;
+    }
+    end = hft::Timestamp::now();
+    uint64_t aligned_time = hft::Timestamp::to_nanoseconds(end - start);
+    
+    std::cout << "Unaligned (false sharing): " << unaligned_time << " ns\n";
+    std::cout << "Aligned (no false sharing): " << aligned_time << " ns\n";
+    std::cout << "Speedup: " << (double)unaligned_time / aligned_time << "x\n\n";
+}
+
+// Pool allocate + free: the shared lock-free stack against a per-thread
+// cache, on one core and with several threads hitting one pool
+void benchmark_memory_pool() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking memory pool (allocate + deallocate)...\n\n";
+    
+    struct Node {
+        uint64_t payload[6];
+    };
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 20000;
+    MemoryPool<Node> pool(1 << 16);
+    
+    for (bool cached : {false, true}) {
+        MemoryPool<Node>::Cache cache(pool);
+        Node* held[BATCH / 4];
+        LatencyHistogram pair_latency;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            uint64_t start = Timestamp::now();
+            for (int i = 0; i < BATCH; i += BATCH / 4) {
+                for (int k = 0; k < BATCH / 4; ++k) {
+                    held[k] = cached ? cache.allocate() : pool.allocate();
+                }
+                for (int k = 0; k < BATCH / 4; ++k) {
+                    cached ? cache.deallocate(held[k]) : pool.deallocate(held[k]);
+                }
+            }
+            uint64_t end = Timestamp::now();
+            pair_latency.record((end - start) / BATCH);
+        }
+        std::cout << (cached ? "Cache" : "Shared stack") << ", one thread (CPU cycles per allocate + free):\n";
+        print_stats(pair_latency, cached ? "memory_pool.cache" : "memory_pool.shared_stack", "tsc", BATCH);
+    }
+    
+    // Throughput with every thread on the same pool
+    unsigned threads = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+    constexpr int PAIRS = 2000000;
+    for (bool cached : {false, true}) {
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        std::vector<PerfCounters::Values> worker_counters(threads);
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&pool, &go, &worker_counters, cached, t]() {
+                MemoryPool<Node>::Cache cache(pool);
+                PerfCounters thread_counters;
+                thread_counters.open();
+                while (!go.load(std::memory_order_acquire)) {}
+                PerfCounters::Values start_counters = thread_counters.read();
+                for (int i = 0; i < PAIRS; ++i) {
+                    Node* node = cached ? cache.allocate() : pool.allocate();
+                    cached ? cache.deallocate(node) : pool.deallocate(node);
+                }
+                worker_counters[t] = thread_counters.read().since(start_counters);
+            });
+        }
+        uint64_t start = Timestamp::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = Timestamp::to_nanoseconds(Timestamp::now() - start) / 1e9;
+        PerfCounters::Values total = PerfCounters::Values::sum(worker_counters.data(), worker_counters.size());
+        std::cout << (cached ? "Cache" : "Shared stack") << ", " << threads
+                  << " threads, allocate+free pairs (counters of all threads):\n";
+        print_throughput(std::string(cached ? "memory_pool.cache" : "memory_pool.shared_stack") + ".threads_" +
+                             std::to_string(threads),
+                         static_cast<uint64_t>(threads) * PAIRS, seconds, &total);
+    }
+    std::cout << "\n";
+}
+
+void benchmark_logger() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking Async Logger...\n\n";
+    
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    Logger& logger = Logger::instance();
+    logger.flush();
+    logger.set_output_fd(null_fd);
+    
+    // Stay under the ring size between flushes so nothing is dropped
+    constexpr int BATCHES = 200;
+    constexpr int PER_BATCH = static_cast<int>(Logger::RING_SIZE) / 2;
+    LatencyHistogram log_latency;
+    uint64_t dropped_before = logger.dropped();
+    const char* symbol = "AAPL";
+    
+    // Counters: the producer side only, not the flushes
+    PerfCounters::Values producer_counters;
+    for (int b = 0; b < BATCHES; ++b) {
+        PerfCounters::Values before = counters.read();
+        for (int i = 0; i < PER_BATCH; ++i) {
+            uint64_t order_id = static_cast<uint64_t>(b) * PER_BATCH + i;
+            uint64_t start = Timestamp::now();
+            LOG_ERROR("Order {} {} rejected: size {} exceeds limit {}", order_id, symbol, 150.0, 100.0);
+            uint64_t end = Timestamp::now();
+            log_latency.record(end - start);
+        }
+        PerfCounters::Values batch[2] = {producer_counters, counters.read().since(before)};
+        producer_counters = b == 0 ? batch[1] : PerfCounters::Values::sum(batch, 2);
+        logger.flush();
+    }
+    
+    std::cout << "LOG_ERROR with 4 arguments (CPU cycles):\n";
+    print_stats(log_latency, "logger.log_error", "tsc", 1, &producer_counters);
+    std::cout << "Dropped: " << (logger.dropped() - dropped_before) << "\n\n";
+    
+    logger.set_output_fd(STDOUT_FILENO);
+    ::close(null_fd);
+}
+
+void benchmark_order_gateway() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking order gateway (bid/ask pairs over loopback TCP)...\n\n";
+    
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (listener < 0 || bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listener, 1) < 0 || getsockname(listener, (struct sockaddr*)&addr, &addr_len) < 0) {
+        std::cout << "skipped (no loopback)\n\n";
+        return;
+    }
+    
+    TCPSender sender("127.0.0.1", ntohs(addr.sin_port));
+    if (!sender.connect()) {
+        std::cout << "skipped (connect failed)\n\n";
+        return;
+    }
+    int gateway = accept(listener, nullptr, nullptr);
+    std::thread drain([gateway]() {
+        char buffer[65536];
+        while (recv(gateway, buffer, sizeof(buffer), 0) > 0) {
+        }
+    });
+    
+    constexpr int PAIRS = 20000;
+    Order order;
+    std::memset(&order, 0, sizeof(order));
+    
+    for (int batched = 0; batched < 2; ++batched) {
+        LatencyHistogram pair_latency;
+        uint64_t syscalls = sender.send_syscalls();
+        measure();
+        for (int i = 0; i < PAIRS; ++i) {
+            uint64_t start = Timestamp::now();
+            if (batched) {
+                sender.begin_batch();
+            }
+            order.side = Order::Side::BUY;
+            sender.send_order(order);
+            order.side = Order::Side::SELL;
+            sender.send_order(order);
+            if (batched) {
+                sender.flush();
+            }
+            uint64_t end = Timestamp::now();
+            pair_latency.record(end - start);
+        }
+        
+        std::cout << (batched ? "Batched pair (one sendmsg)" : "Unbatched pair")
+                  << " - send syscalls/pair: "
+                  << static_cast<double>(sender.send_syscalls() - syscalls) / PAIRS
+                  << " (CPU cycles):\n";
+        print_stats(pair_latency, batched ? "order_gateway.pair_batched" : "order_gateway.pair", "tsc");
+        std::cout << "\n";
+    }
+    
+    sender.disconnect();
+    drain.join();
+    close(gateway);
+    close(listener);
+}
+
+// Tick to order through a real socket: simple-feed packets -> handler ->
+// StrategyRouter -> MarketMakingStrategy -> OrderManager (risk) ->
+// TCPSender -> a gateway thread on loopback that acknowledges orders and
+// replaces (and cancels) the way a venue does, the acks coming back
+// through the sender's reader thread to the order manager
+void benchmark_tick_to_order() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking tick to order (market making, loopback gateway)...\n\n";
+    
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (listener < 0 || bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listener, 1) < 0 || getsockname(listener, (struct sockaddr*)&addr, &addr_len) < 0) {
+        std::cout << "skipped (no loopback)\n\n";
+        return;
+    }
+    
+    TCPSender sender("127.0.0.1", ntohs(addr.sin_port));
+    if (!sender.connect()) {
+        std::cout << "skipped (connect failed)\n\n";
+        return;
+    }
+    int gateway = accept(listener, nullptr, nullptr);
+    
+    OrderManager manager(sender);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 1000000000;
+    limits.max_order_burst = 1000000;
+    manager.set_risk_limits(limits);
+    sender.set_execution_callback([&manager](const ExecutionReport& report) {
+        manager.enqueue_execution_report(report);
+    });
+    sender.start_reader();
+    
+    // Gateway: reads the raw order structs, answers each, and stamps when
+    // the first request of a tick came off its socket
+    std::atomic<uint64_t> tick_start{0};
+    LatencyHistogram wire_latency;
+    std::thread venue([gateway, &tick_start, &wire_latency]() {
+        std::vector<char> buffer(1 << 16);
+        std::vector<ExecutionReport> reports;
+        size_t length = 0;
+        uint64_t stamped = 0;
+        for (;;) {
+            ssize_t n = recv(gateway, buffer.data() + length, buffer.size() - length, 0);
+            if (n <= 0) {
+                return;
+            }
+            uint64_t now = Timestamp::now();
+            uint64_t start = tick_start.load(std::memory_order_acquire);
+            if (start != stamped) {
+                wire_latency.record(Timestamp::to_nanoseconds(now - start));
+                stamped = start;
+            }
+            length += static_cast<size_t>(n);
+            size_t at = 0;
+            reports.clear();
+            for (;;) {
+                char type = length - at ? buffer[at] : 0;
+                size_t size = type == 'X' ? sizeof(CancelRequest) : type == 'U' ? sizeof(ReplaceRequest) : sizeof(Order);
+                if (length - at < size) {
+                    break;
+                }
+                ExecutionReport report{};
+                report.timestamp = Timestamp::fast_wall_clock_ns();
+                if (type == 'X') {
+                    CancelRequest cancel;
+                    std::memcpy(&cancel, buffer.data() + at, size);
+                    report.type = ExecutionReport::Type::CANCELED;
+                    report.order_id = cancel.order_id;
+                } else if (type == 'U') {
+                    ReplaceRequest replace;
+                    std::memcpy(&replace, buffer.data() + at, size);
+                    report.type = ExecutionReport::Type::ACK;
+                    report.order_id = replace.new_order_id;
+                    report.price = replace.price;
+                    report.leaves_quantity = replace.quantity;
+                } else {
+                    Order order;
+                    std::memcpy(&order, buffer.data() + at, size);
+                    report.type = ExecutionReport::Type::ACK;
+                    report.order_id = order.order_id;
+                    report.price = order.price;
+                    report.leaves_quantity = order.quantity;
+                }
+                reports.push_back(report);
+                at += size;
+            }
+            std::memmove(buffer.data(), buffer.data() + at, length - at);
+            length -= at;
+            if (!reports.empty()) {
+                send(gateway, reports.data(), reports.size() * sizeof(ExecutionReport), MSG_NOSIGNAL);
+            }
+        }
+    });
+    
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    StrategyRouter router(handler);
+    MarketMakingStrategy::Parameters params;
+    params.symbol = "AAPL";
+    MarketMakingStrategy strategy(manager, params);
+    router.subscribe("AAPL", &strategy);
+    
+    // Both sides of the book per packet, the mid walking a cent a tick;
+    // feed clock 200 us per tick so every tick may requote
+    struct Record {
+        char symbol[16];
+        uint8_t side;
+        uint8_t level;
+        double price;
+        double quantity;
+        uint64_t timestamp;
+    } __attribute__((packed)) records[2];
+    std::memset(records, 0, sizeof(records));
+    for (int side = 0; side < 2; ++side) {
+        std::strncpy(records[side].symbol, "AAPL", sizeof(records[side].symbol) - 1);
+        records[side].side = static_cast<uint8_t>(side);
+        records[side].quantity = 500;
+    }
+    constexpr int TICKS = 50000;
+    constexpr uint64_t TICK_SPACING_NS = 200000;
+    uint64_t feed_clock = Timestamp::fast_wall_clock_ns() - TICKS * TICK_SPACING_NS;
+    double mid = 100.0;
+    std::mt19937 rng(7);
+    
+    auto stages = std::make_unique<TickToTrade::Histograms>();
+    TickToTrade::attach(stages.get());
+    const LatencyHistogram& traded = stages->stage[TickToTrade::TOTAL];
+    LatencyHistogram tick_latency;
+    uint64_t quiet_ticks = 0;
+    measure();
+    uint64_t loop_start = Timestamp::now();
+    for (int i = 0; i < TICKS; ++i) {
+        mid += (rng() & 1) ? 0.01 : -0.01;
+        records[0].price = mid - 0.005;
+        records[1].price = mid + 0.005;
+        uint64_t rx_timestamp_ns = feed_clock + i * TICK_SPACING_NS;
+        uint64_t traded_before = traded.count();
+        uint64_t start = Timestamp::now();
+        tick_start.store(start, std::memory_order_release);
+        handler.process_message(reinterpret_cast<const char*>(records), sizeof(records), rx_timestamp_ns);
+        uint64_t end = Timestamp::now();
+        if (traded.count() != traded_before) {
+            tick_latency.record(Timestamp::to_nanoseconds(end - start));
+        } else {
+            ++quiet_ticks;
+        }
+    }
+    double seconds = Timestamp::to_nanoseconds(Timestamp::now() - loop_start) / 1e9;
+    TickToTrade::attach(nullptr);
+    std::cout << TICKS << " ticks, " << TICKS - quiet_ticks << " sent requests (counters per tick):\n";
+    print_throughput("tick_to_order.ticks", TICKS, seconds);
+    
+    // Let the last acks arrive, then shut the venue down
+    for (uint64_t reports = 0; reports != sender.reports_received();) {
+        reports = sender.reports_received();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    manager.process_execution_reports();
+    sender.disconnect();
+    venue.join();
+    close(gateway);
+    close(listener);
+    
+    std::cout << sender.orders_sent() << " new orders, " << sender.reports_received()
+              << " reports received from the gateway\n";
+    std::cout << "Tick -> requests written to the socket, ticks that sent:\n";
+    print_stats(tick_latency, "tick_to_order.send");
+    std::cout << "Tick -> first request read by the gateway:\n";
+    print_stats(wire_latency, "tick_to_order.wire");
+    std::cout << "Stages (p50 / p99 ns):\n";
+    for (int s = TickToTrade::DECODE; s < TickToTrade::TOTAL; ++s) {
+        const LatencyHistogram& stage = stages->stage[s];
+        std::cout << "  " << TickToTrade::stage_name(static_cast<TickToTrade::Stage>(s)) << ": "
+                  << stage.value_at_percentile(50) << " / " << stage.value_at_percentile(99) << "\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmark_order_encoding() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking order message construction...\n\n";
+    
+    constexpr int ITERATIONS = 100000;
+    const char* symbol = "AAPL";
+    uint64_t checksum = 0;
+    
+    // Per-order build: clear, copy the symbol, fill every field
+    LatencyHistogram build_latency;
+    measure();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        uint64_t start = Timestamp::now();
+        Order order;
+        std::memset(&order, 0, sizeof(order));
+        std::strncpy(order.symbol, symbol, sizeof(order.symbol) - 1);
+        order.order_id = static_cast<uint64_t>(i);
+        order.side = (i & 1) ? Order::Side::SELL : Order::Side::BUY;
+        order.type = Order::Type::LIMIT;
+        order.price = 100.0 + (i & 15) * 0.01;
+        order.quantity = 100;
+        order.timestamp = start;
+        checksum += static_cast<uint8_t>(reinterpret_cast<const char*>(&order)[i & 31]);
+        uint64_t end = Timestamp::now();
+        build_latency.record(end - start);
+    }
+    std::cout << "Order struct built per order (CPU cycles):\n";
+    print_stats(build_latency, "order_encoding.build", "tsc");
+    
+    // Pre-encoded OUCH template: patch token, shares, price, TIF
+    OuchEncoder encoder;
+    encoder.add_symbol(symbol);
+    Order order;
+    std::memset(&order, 0, sizeof(order));
+    std::strncpy(order.symbol, symbol, sizeof(order.symbol) - 1);
+    order.type = Order::Type::LIMIT;
+    order.quantity = 100;
+    LatencyHistogram encode_latency;
+    measure();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        uint64_t start = Timestamp::now();
+        order.order_id = static_cast<uint64_t>(i);
+        order.side = (i & 1) ? Order::Side::SELL : Order::Side::BUY;
+        order.price = 100.0 + (i & 15) * 0.01;
+        EncodedMessage message = encoder.encode_new(order);
+        checksum += static_cast<uint8_t>(message.data[i & 31]);
+        uint64_t end = Timestamp::now();
+        encode_latency.record(end - start);
+    }
+    std::cout << "OUCH Enter Order from template (CPU cycles):\n";
+    print_stats(encode_latency, "order_encoding.ouch_template", "tsc");
+    std::cout << "(checksum " << checksum << ")\n\n";
+}
+
+void benchmark_risk_checks() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking pre-trade risk checks (4096 symbols, random access)...\n\n";
+    
+    constexpr size_t SYMBOLS = 4096;
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 20000;
+    
+    RiskEngine risk(SYMBOLS);
+    RiskEngine::Limits limits;
+    limits.max_order_size = 1000;
+    limits.max_position = 5000;
+    limits.max_notional = 1e9;
+    limits.max_orders_per_second = 1000000000;
+    limits.max_order_burst = 1000000;
+    risk.set_limits(limits);
+    
+    // Every symbol carries some open exposure
+    std::vector<std::string> names;
+    std::vector<uint32_t> indices;
+    for (size_t i = 0; i < SYMBOLS; ++i) {
+        names.push_back("SYM" + std::to_string(i));
+        uint32_t index = risk.symbol_index(names.back().c_str());
+        risk.adjust_open(index, Order::Side::BUY, 1000, RiskEngine::to_ticks(50.0), 1);
+        indices.push_back(index);
+    }
+    
+    std::mt19937 rng(42);
+    std::vector<uint32_t> order_symbols(BATCH * 256);
+    for (auto& symbol : order_symbols) {
+        symbol = indices[rng() % SYMBOLS];
+    }
+    int64_t ticks = RiskEngine::to_ticks(50.0);
+    uint64_t rejects = 0;
+    
+    // Pass path, then every order over the position limit: same cost
+    for (int64_t lots : {100, 4500}) {
+        LatencyHistogram check_latency;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            const uint32_t* symbols = &order_symbols[(b % 256) * BATCH];
+            uint64_t start = Timestamp::now();
+            for (int i = 0; i < BATCH; ++i) {
+                rejects += risk.check(symbols[i], Order::Side::BUY, lots, lots, lots * ticks, start) != 0;
+            }
+            uint64_t end = Timestamp::now();
+            check_latency.record((end - start) / BATCH);
+        }
+        std::cout << (lots == 100 ? "check(), passing" : "check(), rejected") << " (CPU cycles per check):\n";
+        print_stats(check_latency, lots == 100 ? "risk_checks.pass" : "risk_checks.reject", "tsc", BATCH);
+    }
+    
+    // With the symbol lookup submit_order() does: Order::symbol fields,
+    // rotating through every symbol or repeating one
+    std::vector<std::array<char, 16>> fields(SYMBOLS);
+    for (size_t i = 0; i < SYMBOLS; ++i) {
+        fields[i] = {};
+        std::strncpy(fields[i].data(), names[i].c_str(), 15);
+    }
+    for (size_t stride : {size_t(1), size_t(0)}) {
+        LatencyHistogram lookup_latency;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            uint64_t start = Timestamp::now();
+            for (int i = 0; i < BATCH; ++i) {
+                uint32_t symbol = risk.order_symbol(fields[((b * BATCH + i) * stride) % SYMBOLS].data());
+                rejects += risk.check(symbol, Order::Side::BUY, 100, 100, 100 * ticks, start) != 0;
+            }
+            uint64_t end = Timestamp::now();
+            lookup_latency.record((end - start) / BATCH);
+        }
+        std::cout << "order_symbol() + check(), " << (stride ? "rotating symbols" : "same symbol")
+                  << " (CPU cycles per order):\n";
+        print_stats(lookup_latency, stride ? "risk_checks.lookup_rotating" : "risk_checks.lookup_same", "tsc", BATCH);
+    }
+    std::cout << "(rejects " << rejects << ")\n\n";
+}
+
+// What a reloadable parameter block costs the tick path: the RCU read
+// against a plain struct, idle and with a writer publishing every 100 us
+void benchmark_parameter_reads() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking reloadable parameter reads (RcuCell)...\n\n";
+    
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 50000;
+    struct Parameters {
+        double spread_target = 0.0002;
+        double quote_size = 100;
+        double max_position = 1000;
+        double skew_factor = 0.5;
+        double edge = 0.0001;
+    };
+    
+    Parameters plain;
+    RcuCell<Parameters> cell;
+    size_t reader = cell.add_reader();
+    double sink = 0;
+    
+    LatencyHistogram plain_latency;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        uint64_t start = Timestamp::now();
+        for (int i = 0; i < BATCH; ++i) {
+            const Parameters* params = &plain;
+            asm volatile("" : "+r"(params));
+            sink += params->spread_target * params->quote_size;
+        }
+        uint64_t end = Timestamp::now();
+        plain_latency.record((end - start) / BATCH);
+    }
+    std::cout << "Plain struct (CPU cycles per tick):\n";
+    print_stats(plain_latency, "parameter_reads.plain", "tsc", BATCH);
+    
+    for (int publishing = 0; publishing < 2; ++publishing) {
+        std::atomic<bool> stop{false};
+        std::thread writer;
+        if (publishing) {
+            writer = std::thread([&cell, &stop]() {
+                Parameters next;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    next.quote_size += 1;
+                    cell.publish(next);
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+        }
+        LatencyHistogram read_latency;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            uint64_t start = Timestamp::now();
+            for (int i = 0; i < BATCH; ++i) {
+                const Parameters* params = cell.read(reader);
+                sink += params->spread_target * params->quote_size;
+            }
+            uint64_t end = Timestamp::now();
+            read_latency.record((end - start) / BATCH);
+        }
+        PerfCounters::Values read_counters = measured();
+        stop.store(true);
+        if (writer.joinable()) {
+            writer.join();
+        }
+        std::cout << "RcuCell::read(), " << (publishing ? "writer publishing every 100 us" : "no writer")
+                  << " (CPU cycles per tick):\n";
+        print_stats(read_latency, publishing ? "parameter_reads.rcu_publishing" : "parameter_reads.rcu", "tsc",
+                    BATCH, &read_counters);
+    }
+    cell.remove_reader(reader);
+    std::cout << "(" << cell.version() << " versions, sink " << sink << ")\n\n";
+}
+
+void benchmark_fair_value() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking basket fair value (500-name ETF, one constituent tick)...\n\n";
+    
+    constexpr uint32_t NAMES = 500;
+    constexpr int BATCH = 64;
+    constexpr int BATCHES = 5000;
+    
+    FairValueEngine engine(1024, UINT32_MAX);
+    uint32_t etf = engine.add_basket("ETF", 10.0);
+    std::vector<uint32_t> instrument(NAMES);
+    std::vector<double> weights(NAMES), prices(NAMES);
+    char name[16];
+    for (uint32_t i = 0; i < NAMES; ++i) {
+        std::snprintf(name, sizeof(name), "C%03u", i);
+        weights[i] = 0.001 * (1 + i % 7);
+        engine.add_component(etf, name, weights[i]);
+    }
+    engine.finalize();
+    for (uint32_t i = 0; i < NAMES; ++i) {
+        std::snprintf(name, sizeof(name), "C%03u", i);
+        instrument[i] = engine.instrument(name);
+        prices[i] = 50.0 + i * 0.1;
+    }
+    FairValueEngine::Signal signals[4];
+    for (uint32_t i = 0; i < NAMES; ++i) {
+        engine.on_price(instrument[i], prices[i], signals, 4);
+    }
+    engine.on_price(engine.instrument("ETF"), engine.fair_value(etf), signals, 4);
+    
+    // The same ticks for every variant, each moving its name a cent
+    std::mt19937 rng(7);
+    std::vector<uint32_t> ticked(static_cast<size_t>(BATCH) * BATCHES);
+    for (auto& i : ticked) {
+        i = rng() % NAMES;
+    }
+    double sink = 0;
+    
+    // Recompute the whole basket on every tick (scalar)
+    LatencyHistogram full;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        const uint32_t* batch = &ticked[static_cast<size_t>(b) * BATCH];
+        uint64_t start = Timestamp::now();
+        for (int k = 0; k < BATCH; ++k) {
+            prices[batch[k]] += (k & 1) ? 0.01 : -0.01;
+            double value = 0.0;
+            for (uint32_t i = 0; i < NAMES; ++i) {
+                value += weights[i] * prices[i];
+            }
+            sink += value;
+        }
+        full.record((Timestamp::now() - start) / BATCH);
+    }
+    std::cout << "Full recompute per tick, scalar (CPU cycles):\n";
+    print_stats(full, "fair_value.full_scalar", "tsc", BATCH);
+    
+    // Same with the engine's row layout
+    LatencyHistogram gathered;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        uint64_t start = Timestamp::now();
+        for (int k = 0; k < BATCH; ++k) {
+            sink += engine.recompute(etf);
+        }
+        gathered.record((Timestamp::now() - start) / BATCH);
+    }
+    std::cout << "FairValueEngine::recompute(basket), AVX2 row (CPU cycles):\n";
+    print_stats(gathered, "fair_value.recompute_row", "tsc", BATCH);
+    
+    // Incremental: only the ticked name's contribution
+    LatencyHistogram incremental;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        const uint32_t* batch = &ticked[static_cast<size_t>(b) * BATCH];
+        uint64_t start = Timestamp::now();
+        for (int k = 0; k < BATCH; ++k) {
+            uint32_t i = batch[k];
+            prices[i] += (k & 1) ? 0.01 : -0.01;
+            sink += static_cast<double>(engine.on_price(instrument[i], prices[i], signals, 4));
+        }
+        incremental.record((Timestamp::now() - start) / BATCH);
+    }
+    std::cout << "FairValueEngine::on_price(), incremental (CPU cycles):\n";
+    print_stats(incremental, "fair_value.incremental", "tsc", BATCH);
+    std::cout << "(max drift " << engine.max_drift() << ", checksum " << sink << ")\n\n";
+}
+
+void benchmark_strategy_dispatch() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking tick delivery to strategies...\n\n";
+    
+    constexpr int ITERATIONS = 200000;
+    OrderBook book("AAPL");
+    for (size_t i = 0; i < OrderBook::MAX_DEPTH; ++i) {
+        book.update_bid(i, 100.0 - i * 0.01, 100);
+        book.update_ask(i, 100.01 + i * 0.01, 100);
+    }
+    
+    // What the strategy reads per tick
+    LatencyHistogram snapshot_latency;
+    double sink = 0;
+    measure();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        uint64_t start = Timestamp::now();
+        sink += book.get_snapshot().mid_price();
+        uint64_t end = Timestamp::now();
+        snapshot_latency.record(end - start);
+    }
+    std::cout << "get_snapshot() (CPU cycles):\n";
+    print_stats(snapshot_latency, "strategy_dispatch.get_snapshot", "tsc");
+    
+    LatencyHistogram top_latency;
+    measure();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        uint64_t start = Timestamp::now();
+        sink += book.get_top().mid_price();
+        uint64_t end = Timestamp::now();
+        top_latency.record(end - start);
+    }
+    std::cout << "get_top() (CPU cycles):\n";
+    print_stats(top_latency, "strategy_dispatch.get_top", "tsc");
+    
+    // One simple-feed record through the handler to a no-op strategy
+    struct Record {
+        char symbol[16];
+        uint8_t side;
+        uint8_t level;
+        double price;
+        double quantity;
+        uint64_t timestamp;
+    } __attribute__((packed)) record;
+    std::memset(&record, 0, sizeof(record));
+    std::strncpy(record.symbol, "AAPL", sizeof(record.symbol) - 1);
+    record.price = 100.0;
+    record.quantity = 100;
+    
+    TCPSender sender("127.0.0.1", 1);
+    OrderManager manager(sender);
+    ArbitrageStrategy strategy(manager, ArbitrageStrategy::Parameters{});
+    for (int routed = 0; routed < 2; ++routed) {
+        MarketDataHandler handler;
+        handler.add_symbol("AAPL");
+        std::unique_ptr<StrategyRouter> router;
+        if (routed) {
+            router = std::make_unique<StrategyRouter>(handler);
+            router->subscribe("AAPL", &strategy);
+        } else {
+            handler.register_callback([&strategy](const OrderBook& b) { strategy.on_order_book_update(b); });
+        }
+        
+        LatencyHistogram tick_latency;
+        measure();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            record.quantity = 100 + (i & 7);
+            uint64_t start = Timestamp::now();
+            handler.process_message(reinterpret_cast<const char*>(&record), sizeof(record));
+            uint64_t end = Timestamp::now();
+            tick_latency.record(end - start);
+        }
+        std::cout << (routed ? "StrategyRouter (static dispatch)" : "std::function callback")
+                  << " per record (CPU cycles):\n";
+        print_stats(tick_latency, routed ? "strategy_dispatch.router" : "strategy_dispatch.callback", "tsc");
+    }
+    std::cout << "(sink " << sink << ")\n\n";
+}
+
+// Requests a market maker sends on a walk of sub-cent mid moves: quotes
+// are kept on the tick grid and a side is amended only when its price or
+// size moved by its requote threshold (loopback sender, acks at once)
+void benchmark_quote_cache() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking quote diffing (market making, sub-tick mid walk)...\n\n";
+    
+    struct Record {
+        char symbol[16];
+        uint8_t side;
+        uint8_t level;
+        double price;
+        double quantity;
+        uint64_t timestamp;
+    } __attribute__((packed)) records[2];
+    std::memset(records, 0, sizeof(records));
+    for (int side = 0; side < 2; ++side) {
+        std::strncpy(records[side].symbol, "AAPL", sizeof(records[side].symbol) - 1);
+        records[side].side = static_cast<uint8_t>(side);
+        records[side].quantity = 500;
+    }
+    constexpr int TICKS = 50000;
+    constexpr uint64_t TICK_SPACING_NS = 200000;    // Past the pacing interval
+    
+    for (uint32_t requote_ticks : {1u, 2u}) {
+        TCPSender sender("127.0.0.1", 1);
+        sender.set_loopback(true);
+        OrderManager manager(sender);
+        OrderManager::RiskLimits limits;
+        limits.max_orders_per_second = 1000000000;
+        limits.max_order_burst = 1000000;
+        manager.set_risk_limits(limits);
+        sender.set_execution_callback([&manager](const ExecutionReport& report) {
+            manager.enqueue_execution_report(report);
+        });
+        
+        MarketDataHandler handler;
+        handler.add_symbol("AAPL");
+        StrategyRouter router(handler);
+        MarketMakingStrategy::Parameters params;
+        params.symbol = "AAPL";
+        params.requote_ticks = requote_ticks;
+        MarketMakingStrategy strategy(manager, params);
+        router.subscribe("AAPL", &strategy);
+        
+        // Mid moves up to 0.4 cent a tick: most ticks leave both sides on
+        // their grid price
+        double mid = 100.0;
+        std::mt19937 rng(7);
+        uint64_t feed_clock = Timestamp::fast_wall_clock_ns() - TICKS * TICK_SPACING_NS;
+        LatencyHistogram tick_latency;
+        measure();
+        for (int i = 0; i < TICKS; ++i) {
+            mid += (static_cast<double>(rng() % 9) - 4.0) * 0.001;
+            records[0].price = mid - 0.005;
+            records[1].price = mid + 0.005;
+            uint64_t start = Timestamp::now();
+            handler.process_message(reinterpret_cast<const char*>(records), sizeof(records),
+                                    feed_clock + i * TICK_SPACING_NS);
+            uint64_t end = Timestamp::now();
+            tick_latency.record(end - start);
+            manager.process_execution_reports();
+        }
+        
+        uint64_t sent = strategy.quotes_sent();
+        uint64_t unchanged = strategy.quotes_unchanged();
+        std::cout << "requote_ticks=" << requote_ticks << ": " << TICKS << " ticks, " << sent
+                  << " requests sent, " << unchanged << " side updates skipped ("
+                  << static_cast<double>(sent) / TICKS << " requests per tick)\n";
+        std::cout << "Per tick, decode to quote decision (CPU cycles):\n";
+        print_stats(tick_latency, "quote_cache.requote_" + std::to_string(requote_ticks), "tsc");
+    }
+}
+
+// Recording cost of the fixed-memory histogram against the sample vector
+// it replaces, and the per-tick cost of the tick-to-trade stamps
+void benchmark_latency_histogram() {
+    using namespace hft;
+    
+    std::cout << "Benchmarking latency histograms and stage stamps...\n\n";
+    
+    constexpr int BATCH = 1000;
+    constexpr int BATCHES = 2000;
+    constexpr size_t SAMPLES = static_cast<size_t>(BATCH) * BATCHES;
+    
+    // Latency-like values: mostly hundreds of ns, a tail into the ms range
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> values(SAMPLES);
+    for (auto& value : values) {
+        uint64_t r = rng();
+        value = 200 + (r & 0x1FF) + ((r >> 20) % 1000 == 0 ? (r >> 40) % 2000000 : 0);
+    }
+    
+    LatencyHistogram histogram;
+    LatencyHistogram record_latency;
+    measure();
+    for (int b = 0; b < BATCHES; ++b) {
+        const uint64_t* batch = &values[static_cast<size_t>(b) * BATCH];
+        uint64_t start = Timestamp::now();
+        for (int i = 0; i < BATCH; ++i) {
+            histogram.record(batch[i]);
+        }
+        uint64_t end = Timestamp::now();
+        record_latency.record((end - start) / BATCH);
+    }
+    std::cout << "LatencyHistogram::record() (CPU cycles per sample):\n";
+    print_stats(record_latency, "latency_histogram.record", "tsc", BATCH);
+    
+    // Percentiles: bucket walk vs sorting every sample
+    uint64_t start = Timestamp::now();
+    uint64_t p99 = histogram.value_at_percentile(99);
+    uint64_t bucket_ns = Timestamp::to_nanoseconds(Timestamp::now() - start);
+    
+    start = Timestamp::now();
+    std::vector<uint64_t> samples;
+    for (uint64_t value : values) {
+        samples.push_back(value);
+    }
+    uint64_t fill_ns = Timestamp::to_nanoseconds(Timestamp::now() - start);
+    start = Timestamp::now();
+    std::sort(samples.begin(), samples.end());
+    uint64_t exact_p99 = samples[static_cast<size_t>(SAMPLES * 0.99)];
+    uint64_t sort_ns = Timestamp::to_nanoseconds(Timestamp::now() - start);
+    
+    std::cout << "p99 of " << SAMPLES << " samples: " << p99 << " ns from buckets in "
+              << bucket_ns / 1000 << " us (exact " << exact_p99 << ")\n";
+    std::cout << "Sample vector: " << fill_ns / SAMPLES << " ns per push_back, "
+              << SAMPLES * sizeof(uint64_t) / 1024 << " KB, sort " << sort_ns / 1000 << " us; histogram "
+              << sizeof(LatencyHistogram) / 1024 << " KB fixed\n\n";
+    
+    // Stage stamps of one traded tick, attached and not
+    auto stages = std::make_unique<TickToTrade::Histograms>();
+    for (bool attached : {false, true}) {
+        TickToTrade::attach(attached ? stages.get() : nullptr);
+        LatencyHistogram tick_latency;
+        measure();
+        for (int b = 0; b < BATCHES; ++b) {
+            uint64_t begin = Timestamp::now();
+            for (int i = 0; i < BATCH / 10; ++i) {
+                TickToTrade::Packet packet(0);
+                TickToTrade::mark(TickToTrade::DECODE);
+                TickToTrade::mark(TickToTrade::BOOK);
+                TickToTrade::mark(TickToTrade::STRATEGY);
+                TickToTrade::mark(TickToTrade::RISK);
+                TickToTrade::mark(TickToTrade::ENCODE);
+                TickToTrade::sent();
+            }
+            uint64_t end = Timestamp::now();
+            tick_latency.record((end - begin) / (BATCH / 10));
+        }
+        std::cout << "Tick-to-trade stamps per tick, " << (attached ? "recording" : "not attached")
+                  << " (CPU cycles):\n";
+        print_stats(tick_latency, attached ? "latency_histogram.stamps_recording" : "latency_histogram.stamps_detached",
+                    "tsc", BATCH / 10);
+    }
+    TickToTrade::attach(nullptr);
+    std::cout << "Ticks recorded: " << stages->stage[TickToTrade::TOTAL].count() << "\n\n";
+}
+
+namespace {
+
+struct Benchmark {
+    const char* name;           // Prefix of its result names
+    void (*run)();
+};
+
+// In run order
+const Benchmark BENCHMARKS[] = {
+    {"timestamp", benchmark_timestamp},
+    {"latency_histogram", benchmark_latency_histogram},
+    {"memory_pool", benchmark_memory_pool},
+    {"logger", benchmark_logger},
+    {"order_book", benchmark_order_book},
+    {"snapshot_contention", benchmark_snapshot_contention},
+    {"book_depth", benchmark_book_depth},
+    {"depth_analytics", benchmark_depth_analytics},
+    {"shm_books", benchmark_shm_books},
+    {"l3_book", benchmark_l3_book},
+    {"symbol_lookup", benchmark_symbol_lookup},
+    {"hashmap", benchmark_hashmap_load},
+    {"ring_handoff", benchmark_ring_handoff},
+    {"feed_decoder", benchmark_feed_decoder},
+    {"feed_arbitration", benchmark_feed_arbitration},
+    {"feed_capture", benchmark_feed_capture},
+    {"receive_transports", benchmark_receive_transports},
+    {"order_gateway", benchmark_order_gateway},
+    {"order_encoding", benchmark_order_encoding},
+    {"risk_checks", benchmark_risk_checks},
+    {"parameter_reads", benchmark_parameter_reads},
+    {"fair_value", benchmark_fair_value},
+    {"strategy_dispatch", benchmark_strategy_dispatch},
+    {"quote_cache", benchmark_quote_cache},
+    {"tick_to_order", benchmark_tick_to_order},
+    {"pipeline", benchmark_pipeline},
+    {"sharded_feed", benchmark_sharded_feed},
+    {"cache_effects", benchmark_cache_effects},
+};
+
+void usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --filter a,b          Only benchmarks whose name contains a or b\n"
+              << "  --list                Benchmark names\n"
+              << "  --json FILE           Results as JSON lines (one object per result)\n"
+              << "  --baseline FILE       Compare with an earlier --json file, exit 1 on regressions\n"
+              << "  --tolerance X         Allowed regression for --baseline (default 0.10)\n"
+              << "  --producer-cpu N      Cross-core benchmarks: producers on N, N+1, ...\n"
+              << "  --consumer-cpu N      Cross-core benchmarks: consumer on N\n";
+}
+
+bool selected(const char* name) {
+    if (hft::options.filters.empty()) {
+        return true;
+    }
+    for (const std::string& filter : hft::options.filters) {
+        if (std::strstr(name, filter.c_str())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    using hft::options;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--list") {
+            for (const Benchmark& benchmark : BENCHMARKS) {
+                std::cout << benchmark.name << "\n";
+            }
+            return 0;
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        ++i;
+        if (arg == "--filter") {
+            std::stringstream list(value);
+            std::string filter;
+            while (std::getline(list, filter, ',')) {
+                options.filters.push_back(filter);
+            }
+        } else if (arg == "--json") {
+            options.json_path = value;
+        } else if (arg == "--baseline") {
+            options.baseline_path = value;
+        } else if (arg == "--tolerance") {
+            options.tolerance = std::atof(value);
+        } else if (arg == "--producer-cpu") {
+            options.producer_cpu = std::atoi(value);
+        } else if (arg == "--consumer-cpu") {
+            options.consumer_cpu = std::atoi(value);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    
+    std::cout << "\n";
+    std::cout << "================================================\n";
+    std::cout << "   HFT Trading System Performance Benchmarks   \n";
+    std::cout << "================================================\n\n";
+    
+    // Calibrate TSC
+    std::cout << "Calibrating TSC frequency...\n";
+    double tsc_freq = hft::Timestamp::calibrate_tsc_frequency();
+    std::cout << "TSC Frequency: " << tsc_freq / 1e9 << " GHz"
+              << (hft::Timestamp::tsc_enabled() ? "" : " (no invariant TSC, using chrono)") << "\n";
+    
+    // Hardware counters of the main thread (benchmarks open their own on
+    // the threads they start)
+    if (hft::counters.open()) {
+        std::cout << "Perf counters: cycles"
+                  << (hft::counters.counting(hft::PerfCounters::INSTRUCTIONS) ? ", instructions" : "")
+                  << (hft::counters.counting(hft::PerfCounters::CACHE_MISSES) ? ", cache misses" : "")
+                  << (hft::counters.counting(hft::PerfCounters::BRANCH_MISSES) ? ", branch misses" : "")
+                  << " (user space)\n\n";
+    } else {
+        std::cout << "Perf counters: unavailable (no PMU, or kernel.perf_event_paranoid too high)\n\n";
+    }
+    
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        if (selected(benchmark.name)) {
+            benchmark.run();
+        }
+    }
+    
+    std::cout << "\nBenchmarks complete!\n\n";
+    std::cout << "Key Takeaways for HFT:\n";
+    std::cout << "1. RDTSC overhead is typically < 50 CPU cycles\n";
+    std::cout << "2. Order book updates should be < 100ns\n";
+    std::cout << "3. Cache line alignment prevents false sharing\n";
+    std::cout << "4. Lock-free > locks for critical paths\n";
+    std::cout << "5. Every nanosecond counts!\n\n";
+    
+    if (!options.json_path.empty()) {
+        if (!hft::write_json(options.json_path, tsc_freq)) {
+            return 2;
+        }
+        std::cout << hft::results.size() << " results written to " << options.json_path << "\n";
+    }
+    if (!options.baseline_path.empty()) {
+        int regressions = hft::compare_baseline(options.baseline_path, options.tolerance);
+        if (regressions != 0) {
+            return regressions < 0 ? 2 : 1;
+        }
+    }
     
     return 0;
 }
@@ -153,6 +153,16 @@ inline uint32_t byte_swap_32(uint32_t x) {
 #endif
 }
 
+inline uint16_t byte_swap_16(uint16_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(x);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(x);
+#else
+    return static_cast<uint16_t>((x >> 8) | (x << 8));
+#endif
+}
+
 // Compact price representation (avoid floating point in some cases)
 // Store price as integer ticks
 struct CompactPrice {
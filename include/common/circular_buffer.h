@@ -32,6 +32,38 @@ public:
         return true;
     }
     
+    // Producer: Slot to fill in place, nullptr if full
+    // The item becomes visible to the consumer on commit_back()
+    T* back_slot() {
+        size_t current_tail = tail_.load(std::memory_order_relaxed);
+        size_t next_tail = (current_tail + 1) & (SIZE - 1);
+        if (next_tail == head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &buffer_[current_tail];
+    }
+    
+    void commit_back() {
+        size_t current_tail = tail_.load(std::memory_order_relaxed);
+        tail_.store((current_tail + 1) & (SIZE - 1), std::memory_order_release);
+    }
+    
+    // Producer: Push up to count items, published with one release store
+    // Returns how many fit (0 if full)
+    size_t push_batch(const T* items, size_t count) {
+        size_t current_tail = tail_.load(std::memory_order_relaxed);
+        size_t free_slots = (head_.load(std::memory_order_acquire) - current_tail - 1) & (SIZE - 1);
+        size_t n = count < free_slots ? count : free_slots;
+        
+        for (size_t i = 0; i < n; ++i) {
+            buffer_[(current_tail + i) & (SIZE - 1)] = items[i];
+        }
+        if (n > 0) {
+            tail_.store((current_tail + n) & (SIZE - 1), std::memory_order_release);
+        }
+        return n;
+    }
+    
     // Consumer: Pop (non-blocking)
     bool pop(T& item) {
         size_t current_head = head_.load(std::memory_order_relaxed);
@@ -46,6 +78,42 @@ public:
         return true;
     }
     
+    // Consumer: Pop up to max items, released with one store
+    // Returns how many were copied out (0 if empty)
+    size_t pop_batch(T* items, size_t max) {
+        size_t current_head = head_.load(std::memory_order_relaxed);
+        size_t available = (tail_.load(std::memory_order_acquire) - current_head) & (SIZE - 1);
+        size_t n = max < available ? max : available;
+        
+        for (size_t i = 0; i < n; ++i) {
+            items[i] = buffer_[(current_head + i) & (SIZE - 1)];
+        }
+        if (n > 0) {
+            head_.store((current_head + n) & (SIZE - 1), std::memory_order_release);
+        }
+        return n;
+    }
+    
+    // Consumer: Oldest item in place, nullptr if empty
+    // Avoids copying large items that may stay queued
+    T* front() {
+        size_t current_head = head_.load(std::memory_order_relaxed);
+        if (current_head == tail_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &buffer_[current_head];
+    }
+    
+    // Consumer: Drop the oldest item (after front())
+    bool pop() {
+        size_t current_head = head_.load(std::memory_order_relaxed);
+        if (current_head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        head_.store((current_head + 1) & (SIZE - 1), std::memory_order_release);
+        return true;
+    }
+    
     // Check if empty (approximate)
     bool empty() const {
         return head_.load(std::memory_order_acquire) == 
@@ -73,9 +141,10 @@ public:
     static constexpr size_t SIZE = Capacity;
     static_assert((SIZE & (SIZE - 1)) == 0, "Capacity must be power of 2");
     
+    // Slot i is free for the push at tail i (a pop frees it for tail i + SIZE)
     MPSCCircularBuffer() : head_(0), tail_(0) {
-        for (auto& entry : buffer_) {
-            entry.sequence.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < SIZE; ++i) {
+            buffer_[i].sequence.store(i, std::memory_order_relaxed);
         }
     }
     
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <cstdint>
 
 namespace hft {
@@ -11,32 +13,112 @@ struct Config {
     // Network settings
     std::string market_data_multicast_ip = "239.1.1.1";
     uint16_t market_data_port = 9000;
+    std::string market_data_line_b_ip;      // Empty = single line
+    uint16_t market_data_line_b_port = 9001;
+    std::string recovery_server_ip;         // MoldUDP64 rerequest server
+    uint16_t recovery_server_port = 9100;
+    // More groups served by the market data thread: "ip:port,ip:port"
+    std::vector<std::pair<std::string, uint16_t>> market_data_channels;
+    size_t market_data_batch_size = 16;     // Datagrams per recvmmsg
+    bool market_data_busy_poll = false;     // Spin instead of epoll_wait
+    std::string market_data_transport = "socket"; // "socket" or "af_xdp"
+    std::string market_data_rx_timestamping = "none"; // "none", "software" or "hardware"
+    std::string xdp_interface;              // AF_XDP: NIC carrying the feed
+    uint32_t xdp_queue = 0;                 // AF_XDP: RX queue bound to the socket
+    std::string xdp_xskmap_path = "/sys/fs/bpf/xsks_map";
+    std::string market_data_capture_path;   // Feed capture journal, empty = off
+    size_t market_data_capture_mb = 1024;   // Preallocated journal size
+    std::string replay_journal;             // Replay this capture instead of listening
+    std::string shm_books;                  // Publish books to this shm region, empty = off
+    size_t shm_books_ring = 65536;          // Update notices kept for readers
+    double replay_speed = 1.0;              // 1 = original pacing, 0 = as fast as possible
     std::string order_gateway_ip = "127.0.0.1";
     uint16_t order_gateway_port = 8000;
+    bool order_gateway_busy_poll = false;   // Reader spins instead of epoll_wait
+    std::string order_protocol = "raw";     // "raw" (Order structs) or "ouch42"
+    std::string ouch_token_prefix = "HF";   // OUCH: 2-character order token prefix
+    std::string ouch_firm;                  // OUCH: MPID, empty = port default
     
     // CPU affinity
     int market_data_cpu = 1;
     int strategy_cpu = 2;
     int order_manager_cpu = 3;
+    int logger_cpu = 0;                     // Log writer: keep off the critical cores
+    int realtime_priority = 0;              // SCHED_FIFO of the stage threads, 0 = off
+    
+    // Pre-open warm-up: memory locked, synthetic ticks through the inline
+    // path until its latencies settle (see trading/warmup.h)
+    bool warmup = true;
+    bool lock_memory = true;
+    size_t warmup_min_ticks = 20000;
+    size_t warmup_max_ticks = 500000;
+    
+    // Threading: strategy inline on the market data thread, or pipelined
+    // (strategy on strategy_cpu, order sending on order_manager_cpu)
+    bool pipeline_mode = false;
+    bool pipeline_busy_poll = false;        // Pipeline stages spin instead of yielding
+    bool pipeline_conflation = false;       // Strategy sees only the newest state per book
+    
+    // Feed shards: symbols and channels split across this many market data
+    // handlers, each with its own receiver core (feed_shard.<i>.* keys, see
+    // trading/sharded_feed.h); 1 = one handler
+    size_t feed_shards = 1;
     
     // Trading parameters
+    // One market making strategy per symbol; strategy keys can be set per
+    // symbol as <symbol>.<key> (e.g. AAPL.quote_size), see main.cpp
+    std::vector<std::string> symbols = {"AAPL", "MSFT", "GOOGL"};
+    size_t max_symbols = 4096;              // Books the market data handler can hold
     double max_position_size = 1000.0;
     double max_order_size = 100.0;
+    uint32_t max_orders_per_second = 100;   // Token bucket rate, all symbols
+    uint32_t max_order_burst = 20;          // Token bucket depth
     double spread_threshold = 0.0001; // 1 bps
     
+    // Basket arbitrage: baskets and weights from a file ("<basket>
+    // <component> <weight>" lines), empty = off
+    std::string arbitrage_basket_file;
+    double arbitrage_threshold_bps = 5.0;   // Basket vs fair value spread that signals
+    double arbitrage_order_size = 100.0;    // Basket units per signal
+    double arbitrage_tick_size = 0.01;      // Grid of the IOC limit prices
+    
+    // Backtest (hft_backtest): a grid of spread_target x skew_factor runs
+    // over replay_journal on a simulated venue
+    std::vector<double> backtest_spread_targets;    // Empty = the configured ones
+    std::vector<double> backtest_skew_factors;
+    size_t backtest_threads = 0;            // 0 = one per core
+    double backtest_order_latency_us = 20.0;    // Strategy -> simulated venue
+    double backtest_report_latency_us = 20.0;   // Venue -> order manager
+    
+    // Feed format: "simple", "itch50_moldudp64" or "itch50_framed"
+    std::string feed_protocol = "simple";
+    
     // Performance
     size_t order_book_depth = 10;
     bool enable_kernel_bypass = false;
+    bool latency_stages = true;             // Tick-to-trade stage histograms (inline trading)
+    size_t latency_report_interval_s = 10;  // Stage percentiles printed every N s, 0 = at exit only
     
     // Load config from file
+    // Known keys are applied to the fields above, all keys stay available
+    // through get<T>()
     bool load(const std::string& filename);
     
     // Get parameter
     template<typename T>
     T get(const std::string& key) const;
     
+    // Check if a key was present in the loaded file
+    bool has(const std::string& key) const { return params_.count(key) != 0; }
+    
+    // "ip:port,ip:port" list (entries without a port are skipped)
+    static std::vector<std::pair<std::string, uint16_t>> parse_channels(const std::string& list);
+    
 private:
     std::unordered_map<std::string, std::string> params_;
+    
+    // Copy parsed values of known keys into the typed fields
+    void apply_params();
 };
 
 } // namespace hft
@@ -4,9 +4,32 @@
 #include <cstring>
 #include <array>
 #include <atomic>
+#include <new>
+#include "common/bit_utils.h"
+#include "common/huge_pages.h"
 
 namespace hft {
 
+namespace detail {
+
+// FNV-1a over the raw bytes of a key
+inline uint64_t fnv1a(const void* key, size_t len) {
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+    
+    uint64_t hash = FNV_OFFSET;
+    const char* data = static_cast<const char*>(key);
+    
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<uint64_t>(data[i]);
+        hash *= FNV_PRIME;
+    }
+    
+    return hash;
+}
+
+} // namespace detail
+
 // Lock-free hash map with linear probing
 // Used for symbol->order book lookups in hot path
 // Cache-friendly, no allocations after initialization
@@ -98,18 +121,7 @@ private:
     
     // FNV-1a hash
     static uint64_t hash(const K& key) {
-        constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
-        constexpr uint64_t FNV_PRIME = 1099511628211ULL;
-        
-        uint64_t hash = FNV_OFFSET;
-        const char* data = reinterpret_cast<const char*>(&key);
-        
-        for (size_t i = 0; i < sizeof(K); ++i) {
-            hash ^= static_cast<uint64_t>(data[i]);
-            hash *= FNV_PRIME;
-        }
-        
-        return hash;
+        return detail::fnv1a(&key, sizeof(K));
     }
     
     static bool keys_equal(const K& a, const K& b) {
@@ -195,6 +207,17 @@ public:
         return nullptr;
     }
     
+    // Visit every entry (writer thread, not safe against concurrent inserts)
+    template<typename F>
+    void for_each(F&& fn) {
+        for (auto& entry : entries_) {
+            uint64_t h = entry.hash.load(std::memory_order_acquire);
+            if (h != Entry::EMPTY && h != Entry::TOMBSTONE) {
+                fn(static_cast<const char*>(entry.key), entry.value);
+            }
+        }
+    }
+    
 private:
     std::array<Entry, SIZE> entries_;
     
@@ -212,4 +235,158 @@ private:
     }
 };
 
+// Open-addressing hash map with runtime capacity and deletion
+// Same FNV-1a + linear probing scheme as LockFreeHashMap<K, V, N>, for
+// tables that are too large for an inline array (e.g. millions of live
+// order IDs) or that see constant insert/erase churn:
+// - Capacity fixed at construction, slots live in one HugePageBuffer
+// - Compact slots (key + value + flag), no per-field cache line padding
+// - Backward-shift erase: no tombstones, probe lengths never degrade
+// Single-threaded: owned and mutated by one thread (e.g. the feed thread).
+template<typename K, typename V>
+class FlatHashMap {
+public:
+    // capacity = max live entries; the table is sized for <= 50% load
+    // (numa_node: see HugePageBuffer)
+    explicit FlatHashMap(size_t capacity, int numa_node = -1)
+        : mask_(bits::next_power_of_2(capacity < 4 ? 8 : capacity * 2) - 1)
+        , table_((mask_ + 1) * sizeof(Slot), numa_node) {
+        slots_ = static_cast<Slot*>(table_.data());
+        if (!slots_) {
+            mask_ = 0;
+            return;
+        }
+        for (size_t i = 0; i <= mask_; ++i) {
+            new (&slots_[i]) Slot();
+        }
+        max_size_ = (mask_ + 1) / 2;
+    }
+    
+    ~FlatHashMap() {
+        if (slots_) {
+            for (size_t i = 0; i <= mask_; ++i) {
+                slots_[i].~Slot();
+            }
+        }
+    }
+    
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+    
+    // Insert or update, false if the map is at capacity
+    bool insert(const K& key, const V& value) {
+        size_t idx = home(key);
+        
+        while (slots_[idx].used) {
+            if (slots_[idx].key == key) {
+                slots_[idx].value = value;
+                return true;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        
+        if (size_ >= max_size_) {
+            return false;
+        }
+        
+        slots_[idx].key = key;
+        slots_[idx].value = value;
+        slots_[idx].used = true;
+        ++size_;
+        return true;
+    }
+    
+    V* find(const K& key) {
+        size_t idx = home(key);
+        
+        while (slots_[idx].used) {
+            if (slots_[idx].key == key) {
+                return &slots_[idx].value;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        
+        return nullptr;
+    }
+    
+    const V* find(const K& key) const {
+        return const_cast<FlatHashMap*>(this)->find(key);
+    }
+    
+    bool erase(const K& key) {
+        size_t idx = home(key);
+        
+        while (slots_[idx].used) {
+            if (slots_[idx].key == key) {
+                remove_at(idx);
+                return true;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        
+        return false;
+    }
+    
+    // Visit every entry as fn(key, value) (not for the hot path)
+    template<typename F>
+    void for_each(F&& fn) {
+        for (size_t i = 0; i <= mask_ && slots_; ++i) {
+            if (slots_[i].used) {
+                fn(slots_[i].key, slots_[i].value);
+            }
+        }
+    }
+    
+    void clear() {
+        for (size_t i = 0; i <= mask_ && slots_; ++i) {
+            slots_[i] = Slot();
+        }
+        size_ = 0;
+    }
+    
+    size_t size() const { return size_; }
+    size_t capacity() const { return max_size_; }
+    
+private:
+    struct Slot {
+        K key{};
+        V value{};
+        bool used = false;
+    };
+    
+    size_t mask_;
+    HugePageBuffer table_;
+    Slot* slots_ = nullptr;
+    size_t size_ = 0;
+    size_t max_size_ = 0;
+    
+    size_t home(const K& key) const {
+        return detail::fnv1a(&key, sizeof(K)) & mask_;
+    }
+    
+    // Close the gap left at idx by shifting back later members of the
+    // same probe run whose home slot is at or before the gap
+    void remove_at(size_t idx) {
+        size_t gap = idx;
+        size_t next = idx;
+        
+        for (;;) {
+            next = (next + 1) & mask_;
+            if (!slots_[next].used) {
+                break;
+            }
+            
+            size_t dist_home = (next - home(slots_[next].key)) & mask_;
+            size_t dist_gap = (next - gap) & mask_;
+            if (dist_home >= dist_gap) {
+                slots_[gap] = slots_[next];
+                gap = next;
+            }
+        }
+        
+        slots_[gap] = Slot();
+        --size_;
+    }
+};
+
 } // namespace hft
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace hft {
+
+// Page-aligned anonymous memory mapping for large pre-allocated structures
+// (pools, hash tables, rings). Mappings of at least one huge page try
+// MAP_HUGETLB first (explicit 2MB pages, see docs/TUNING.md) and fall back
+// to normal pages with a transparent huge page hint. Fewer pages means
+// fewer TLB misses when the hot path walks millions of pooled objects.
+//
+// A NUMA node can be given (numa_node_of_cpu() of the thread that will use
+// the memory): pages are then placed on that node when first touched, so
+// the owning core never reads its pool across the socket interconnect.
+//
+// Memory is zero-filled by the kernel. Move-only, unmapped on destruction.
+class HugePageBuffer {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    HugePageBuffer() = default;
+
+    // numa_node < 0: default policy (first touch)
+    explicit HugePageBuffer(size_t bytes, int numa_node = -1) {
+        if (bytes == 0) {
+            return;
+        }
+
+#ifdef MAP_HUGETLB
+        if (bytes >= HUGE_PAGE_SIZE) {
+            size_t rounded = round_up(bytes, HUGE_PAGE_SIZE);
+            void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                data_ = p;
+                size_ = rounded;
+                huge_ = true;
+                prefer_node(numa_node);
+                return;
+            }
+        }
+#endif
+
+        // No reserved huge pages: regular pages, ask for THP promotion
+        size_t rounded = round_up(bytes, PAGE_SIZE);
+        void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return;
+        }
+#ifdef MADV_HUGEPAGE
+        if (rounded >= HUGE_PAGE_SIZE) {
+            madvise(p, rounded, MADV_HUGEPAGE);
+        }
+#endif
+        data_ = p;
+        size_ = rounded;
+        prefer_node(numa_node);
+    }
+
+    ~HugePageBuffer() { release(); }
+
+    HugePageBuffer(HugePageBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , huge_(std::exchange(other.huge_, false)) {}
+
+    HugePageBuffer& operator=(HugePageBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            huge_ = std::exchange(other.huge_, false);
+        }
+        return *this;
+    }
+
+    HugePageBuffer(const HugePageBuffer&) = delete;
+    HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+
+    void* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+
+    // True if backed by explicit huge pages (MAP_HUGETLB)
+    bool is_huge() const noexcept { return huge_; }
+
+    explicit operator bool() const noexcept { return data_ != nullptr; }
+
+    static constexpr size_t round_up(size_t value, size_t align) noexcept {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    // NUMA node of a CPU (sysfs), -1 if unknown or cpu < 0
+    static int numa_node_of_cpu(int cpu) {
+        if (cpu < 0) {
+            return -1;
+        }
+        char path[64];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+        DIR* dir = opendir(path);
+        if (!dir) {
+            return -1;
+        }
+        int node = -1;
+        while (dirent* entry = readdir(dir)) {
+            if (std::strncmp(entry->d_name, "node", 4) == 0 &&
+                std::sscanf(entry->d_name + 4, "%d", &node) == 1) {
+                break;
+            }
+        }
+        closedir(dir);
+        return node;
+    }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    bool huge_ = false;
+
+    // Nothing is touched yet, so the policy applies to every page. Preferred
+    // rather than bound: a full node falls back instead of failing faults.
+    void prefer_node(int numa_node) noexcept {
+#ifdef SYS_mbind
+        constexpr int MPOL_PREFERRED_MODE = 1;
+        if (numa_node >= 0 && numa_node < 64) {
+            unsigned long mask = 1UL << numa_node;
+            syscall(SYS_mbind, data_, size_, MPOL_PREFERRED_MODE, &mask, 64UL + 1, 0U);
+        }
+#else
+        (void)numa_node;
+#endif
+    }
+
+    void release() noexcept {
+        if (data_) {
+            munmap(data_, size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "common/bit_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace hft {
+
+// Log-linear (HDR-style) histogram of latencies, or of any unsigned value
+//
+// Values below 2 * SUB_BUCKETS are counted exactly. Above that, every power
+// of two is split into SUB_BUCKETS equal buckets, so a bucket is never
+// wider than 1/32 of the values it holds (about 3% relative error) over
+// the whole 64-bit range. Counts live in a fixed array: record() allocates
+// nothing and takes a handful of instructions (one lzcnt, a shift and an
+// add for the bucket, then the counters), whatever the value.
+//
+// One writer per histogram: each thread records into its own. Any thread
+// may read it meanwhile (relaxed counters; a read racing record() can be a
+// sample short). Threads' histograms combine with merge(), and the
+// difference of two reads of one histogram (subtract()) gives the samples
+// recorded in between.
+class alignas(64) LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram& other) { copy(other); }
+    LatencyHistogram& operator=(const LatencyHistogram& other) {
+        if (this != &other) {
+            copy(other);
+        }
+        return *this;
+    }
+
+    // Writer thread only
+    void record(uint64_t value) noexcept {
+        bump(counts_[bucket_of(value)], 1);
+        bump(count_, 1);
+        bump(sum_, value);
+        if (value < min_.load(std::memory_order_relaxed)) {
+            min_.store(value, std::memory_order_relaxed);
+        }
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Add other's samples (this histogram's writer)
+    void merge(const LatencyHistogram& other) noexcept {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            bump(counts_[i], other.counts_[i].load(std::memory_order_relaxed));
+        }
+        bump(count_, other.count_.load(std::memory_order_relaxed));
+        bump(sum_, other.sum_.load(std::memory_order_relaxed));
+        uint64_t other_min = other.min_.load(std::memory_order_relaxed);
+        uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+        if (other_min < min_.load(std::memory_order_relaxed)) {
+            min_.store(other_min, std::memory_order_relaxed);
+        }
+        if (other_max > max_.load(std::memory_order_relaxed)) {
+            max_.store(other_max, std::memory_order_relaxed);
+        }
+    }
+
+    // Remove the samples of an earlier read of the same histogram. Min and
+    // max of what is left are known to bucket precision only.
+    void subtract(const LatencyHistogram& earlier) noexcept {
+        size_t lowest = BUCKETS;
+        size_t highest = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            uint64_t n = counts_[i].load(std::memory_order_relaxed) -
+                         earlier.counts_[i].load(std::memory_order_relaxed);
+            counts_[i].store(n, std::memory_order_relaxed);
+            if (n) {
+                lowest = lowest == BUCKETS ? i : lowest;
+                highest = i;
+            }
+        }
+        count_.store(count_.load(std::memory_order_relaxed) -
+                     earlier.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) -
+                   earlier.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (lowest == BUCKETS) {
+            min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        } else {
+            min_.store(std::max(min_.load(std::memory_order_relaxed), lowest_value(lowest)),
+                       std::memory_order_relaxed);
+            max_.store(std::min(max_.load(std::memory_order_relaxed), highest_value(highest)),
+                       std::memory_order_relaxed);
+        }
+    }
+
+    // Writer thread only
+    void reset() noexcept {
+        for (auto& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    uint64_t min() const noexcept { return count() ? min_.load(std::memory_order_relaxed) : 0; }
+    uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+    double mean() const noexcept {
+        uint64_t n = count();
+        return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // Smallest value with at least percentile % of the samples at or below
+    // it, as the upper end of its bucket (capped by max()); 0 when empty
+    uint64_t value_at_percentile(double percentile) const noexcept {
+        uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        double wanted = std::ceil(percentile / 100.0 * static_cast<double>(n));
+        uint64_t target = wanted < 1 ? 1 : static_cast<uint64_t>(wanted);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                return std::min(highest_value(i), max());
+            }
+        }
+        return max();
+    }
+
+    // Bucket holding value, and the range of values a bucket holds
+    static size_t bucket_of(uint64_t value) noexcept {
+        int shift = bits::log2_floor(value | SUB_BUCKETS) - SUB_BUCKET_BITS;
+        return (static_cast<size_t>(shift) << SUB_BUCKET_BITS) + static_cast<size_t>(value >> shift);
+    }
+
+    static uint64_t lowest_value(size_t bucket) noexcept {
+        size_t shift = bucket < 2 * SUB_BUCKETS ? 0 : (bucket >> SUB_BUCKET_BITS) - 1;
+        return static_cast<uint64_t>(bucket - (shift << SUB_BUCKET_BITS)) << shift;
+    }
+
+    static uint64_t highest_value(size_t bucket) noexcept {
+        size_t shift = bucket < 2 * SUB_BUCKETS ? 0 : (bucket >> SUB_BUCKET_BITS) - 1;
+        return lowest_value(bucket) + ((1ULL << shift) - 1);
+    }
+
+private:
+    std::atomic<uint64_t> counts_[BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_{0};
+
+    // Single writer: plain load/add/store, no locked instruction
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void copy(const LatencyHistogram& other) noexcept {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts_[i].store(other.counts_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        count_.store(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum_.store(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        min_.store(other.min_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        max_.store(other.max_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+};
+
+} // namespace hft
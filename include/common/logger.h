@@ -1,14 +1,34 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
-#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "common/circular_buffer.h"
 #include "common/timestamp.h"
 
 namespace hft {
 
 // Lock-free, low-latency logger
-// Uses ring buffer to avoid allocations in critical path
+// The calling thread only copies a record into its own SPSC ring: the
+// format string pointer (string literals only, enforced by the macros),
+// the raw argument bytes and a TSC-derived timestamp. A background writer
+// formats the records and writes them out in batches. A full ring drops
+// the record and counts it; nothing is ever overwritten.
+//
+// A thread's ring is handed back when the thread exits and, once the
+// writer has drained it, reused by the next thread that logs: threads
+// that come and go keep at most one ring per thread alive at a time.
+//
+// Format strings use "{}" placeholders: LOG_WARN("Order {} rejected", id).
+// Arguments: integers, floating point, bool, char and C strings (copied,
+// truncated to what fits in the record).
 class Logger {
 public:
     enum class Level : uint8_t {
@@ -19,10 +39,16 @@ public:
         CRITICAL = 4
     };
     
-    struct LogEntry {
-        uint64_t timestamp;
+    static constexpr size_t RING_SIZE = 1024;       // Records per thread
+    static constexpr size_t ARG_BYTES = 104;        // Encoded argument space
+    
+    // One log call as queued by the producer (two cache lines)
+    struct alignas(64) Record {
+        uint64_t timestamp;      // fast_wall_clock_ns()
+        const char* format;      // Static string: the record's format ID
         Level level;
-        char message[256];
+        uint8_t arg_bytes;
+        char args[ARG_BYTES];
     };
     
     static Logger& instance() {
@@ -30,30 +56,147 @@ public:
         return logger;
     }
     
-    void log(Level level, const char* message);
+    template<typename... Args>
+    void log(Level level, const char* format, Args... args) {
+        if (level < min_level_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        
+        ThreadRing* ring = thread_ring();
+        Record* record = ring->records.back_slot();
+        if (!record) {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        
+        record->timestamp = Timestamp::fast_wall_clock_ns();
+        record->format = format;
+        record->level = level;
+        size_t used = 0;
+        (encode(record->args, used, args), ...);
+        record->arg_bytes = static_cast<uint8_t>(used);
+        ring->records.commit_back();
+    }
     
     void set_level(Level level) { min_level_.store(level, std::memory_order_relaxed); }
     
+    // Pin the writer thread (use a non-critical core), -1 = unpinned
+    void set_writer_cpu(int cpu) { writer_cpu_.store(cpu, std::memory_order_relaxed); }
+    
+    // Destination of formatted lines (default stdout); the caller owns fd
+    void set_output_fd(int fd) { output_fd_.store(fd, std::memory_order_relaxed); }
+    
+    // Format and write everything queued so far (blocks until written)
     void flush();
     
+    // Records written / dropped because a thread's ring was full
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const;
+    
+    // Rings allocated: threads logging now plus rings waiting for reuse
+    size_t rings() const;
+
 private:
     Logger();
     ~Logger();
     
-    static constexpr size_t BUFFER_SIZE = 1024 * 16;
-    std::array<LogEntry, BUFFER_SIZE> buffer_;
-    std::atomic<size_t> write_index_{0};
+    // Argument encoding: a type tag byte followed by the value
+    enum class ArgType : uint8_t { I64, U64, F64, BOOL, CHAR, STR };
+    
+    struct ThreadRing {
+        CircularBuffer<Record, RING_SIZE> records;
+        alignas(64) std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};   // Owner thread exited
+        uint64_t dropped_reported = 0;   // Writer side
+        bool free = false;               // On the free list (rings_mutex_)
+    };
+    
+    template<typename T>
+    static void put(char* args, size_t& used, ArgType type, const T& value) {
+        if (used + 1 + sizeof(T) > ARG_BYTES) {
+            return;
+        }
+        args[used] = static_cast<char>(type);
+        std::memcpy(args + used + 1, &value, sizeof(T));
+        used += 1 + sizeof(T);
+    }
+    
+    static void put_string(char* args, size_t& used, const char* s, size_t len) {
+        if (used + 2 > ARG_BYTES) {
+            return;
+        }
+        len = std::min(len, ARG_BYTES - used - 2);
+        args[used] = static_cast<char>(ArgType::STR);
+        args[used + 1] = static_cast<char>(len);
+        std::memcpy(args + used + 2, s, len);
+        used += 2 + len;
+    }
+    
+    template<typename T>
+    static void encode(char* args, size_t& used, const T& value) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            put(args, used, ArgType::BOOL, static_cast<uint8_t>(value));
+        } else if constexpr (std::is_same_v<U, char>) {
+            put(args, used, ArgType::CHAR, value);
+        } else if constexpr (std::is_enum_v<U>) {
+            put(args, used, ArgType::I64, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            put(args, used, ArgType::I64, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<U>) {
+            put(args, used, ArgType::U64, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<U>) {
+            put(args, used, ArgType::F64, static_cast<double>(value));
+        } else if constexpr (std::is_convertible_v<U, std::string_view>) {
+            std::string_view s(value);
+            put_string(args, used, s.data(), s.size());
+        } else {
+            static_assert(std::is_arithmetic_v<U>, "Unsupported log argument type");
+        }
+    }
+    
+    // This thread's ring, registered on first use
+    ThreadRing* thread_ring() {
+        thread_local ThreadRing* ring = nullptr;
+        if (__builtin_expect(ring == nullptr, 0)) {
+            ring = register_thread();
+        }
+        return ring;
+    }
+    
+    ThreadRing* register_thread();
+    void recycle(ThreadRing* ring);
+    
+    // Writer side
+    void writer_loop();
+    size_t drain();
+    void format(const Record& record);
+    void append(const char* data, size_t len);
+    void write_out();
+    
     std::atomic<Level> min_level_{Level::INFO};
+    std::atomic<int> writer_cpu_{-1};
+    std::atomic<int> output_fd_{1};
+    std::atomic<uint64_t> written_{0};
+    
+    // Rings live as long as the logger (threads may exit with records
+    // queued); retired ones go to free_rings_ once drained
+    mutable std::mutex rings_mutex_;
+    std::vector<std::unique_ptr<ThreadRing>> rings_;
+    std::vector<ThreadRing*> free_rings_;
+    std::mutex drain_mutex_;    // Writer thread vs flush()
+    std::vector<ThreadRing*> draining_;
+    std::vector<char> out_;
     
-    // Background thread for flushing logs
-    void flush_worker();
     std::atomic<bool> running_{true};
+    std::thread writer_;
 };
 
 // Convenience macros
-#define LOG_DEBUG(msg) hft::Logger::instance().log(hft::Logger::Level::DEBUG, msg)
-#define LOG_INFO(msg) hft::Logger::instance().log(hft::Logger::Level::INFO, msg)
-#define LOG_WARN(msg) hft::Logger::instance().log(hft::Logger::Level::WARNING, msg)
-#define LOG_ERROR(msg) hft::Logger::instance().log(hft::Logger::Level::ERROR, msg)
+// The "" concatenation rejects anything but a string literal format
+#define LOG_DEBUG(fmt, ...) hft::Logger::instance().log(hft::Logger::Level::DEBUG, "" fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_INFO(fmt, ...) hft::Logger::instance().log(hft::Logger::Level::INFO, "" fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_WARN(fmt, ...) hft::Logger::instance().log(hft::Logger::Level::WARNING, "" fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_ERROR(fmt, ...) hft::Logger::instance().log(hft::Logger::Level::ERROR, "" fmt __VA_OPT__(,) __VA_ARGS__)
 
 } // namespace hft
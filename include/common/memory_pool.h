@@ -3,56 +3,74 @@
 #include <atomic>
 #include <cstdint>
 #include <new>
-#include <array>
+#include <utility>
+#include "common/huge_pages.h"
 
 namespace hft {
 
 // Lock-free memory pool allocator
 // Pre-allocates memory to avoid malloc/free in hot path
 // Uses lock-free stack for recycling
-template<typename T, size_t PoolSize>
+//
+// Storage is a single HugePageBuffer mapping (objects and one link word
+// per object) sized at construction: PoolSize is the default capacity,
+// MemoryPool<T>(n) sizes it at runtime (e.g. from config). Give the NUMA
+// node of the core that uses the pool to place the arena there.
+//
+// The free list is a Treiber stack of object indexes. Its head packs the
+// top index with a pop counter in one 64-bit word, so a pop that raced
+// with another pop and push of the same object (ABA) fails its CAS instead
+// of linking a stale successor. Any thread may allocate and deallocate.
+//
+// A thread that allocates and frees a lot keeps a Cache (magazine): it
+// serves allocate/deallocate from a small private array and moves half a
+// magazine to or from the shared stack with one CAS when it runs dry or
+// fills up, so the steady state takes no locked instruction at all.
+template<typename T, size_t PoolSize = 0>
 class MemoryPool {
 public:
-    MemoryPool() {
-        // Initialize free list
-        for (size_t i = 0; i < PoolSize; ++i) {
-            free_list_[i].store(i, std::memory_order_relaxed);
+    MemoryPool() requires (PoolSize > 0) : MemoryPool(PoolSize) {}
+    
+    explicit MemoryPool(size_t capacity, int numa_node = -1)
+        : capacity_(capacity < MAX_CAPACITY ? capacity : MAX_CAPACITY)
+        , arena_(arena_bytes(capacity_), numa_node) {
+        if (!arena_) {
+            capacity_ = 0; // Mapping failed: every allocate() returns nullptr
         }
-        free_count_.store(PoolSize, std::memory_order_relaxed);
+        
+        char* base = static_cast<char*>(arena_.data());
+        storage_ = reinterpret_cast<Storage*>(base);
+        next_ = reinterpret_cast<std::atomic<uint32_t>*>(base + links_offset(capacity_));
+        
+        // Initialize free list: 0, 1, 2, ... from the top
+        for (size_t i = 0; i < capacity_; ++i) {
+            uint32_t next = i + 1 < capacity_ ? static_cast<uint32_t>(i + 1) : END;
+            new (&next_[i]) std::atomic<uint32_t>(next);
+        }
+        head_.store(pack(capacity_ ? 0 : END, 0), std::memory_order_relaxed);
+        free_count_.store(capacity_, std::memory_order_relaxed);
     }
     
     ~MemoryPool() {
         // Destroy all allocated objects
-        for (size_t i = 0; i < PoolSize; ++i) {
-            if (allocated_[i]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (next_[i].load(std::memory_order_relaxed) == ALLOCATED) {
                 reinterpret_cast<T*>(&storage_[i])->~T();
             }
         }
     }
     
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+    
     // Allocate object (construct in-place)
     template<typename... Args>
     T* allocate(Args&&... args) {
-        size_t count = free_count_.load(std::memory_order_acquire);
-        
-        while (count > 0) {
-            if (free_count_.compare_exchange_weak(count, count - 1,
-                std::memory_order_acq_rel)) {
-                
-                // Pop from free list
-                size_t idx = free_list_[count - 1].load(std::memory_order_acquire);
-                allocated_[idx] = true;
-                
-                // Construct object in-place
-                T* ptr = reinterpret_cast<T*>(&storage_[idx]);
-                new (ptr) T(std::forward<Args>(args)...);
-                
-                return ptr;
-            }
-            count = free_count_.load(std::memory_order_acquire);
+        uint32_t idx;
+        if (pop(&idx, 1) == 0) {
+            return nullptr; // Pool exhausted
         }
-        
-        return nullptr; // Pool exhausted
+        return construct(idx, std::forward<Args>(args)...);
     }
     
     // Deallocate object
@@ -62,41 +80,180 @@ public:
         // Destroy object
         ptr->~T();
         
-        // Calculate index
-        size_t idx = (reinterpret_cast<char*>(ptr) - 
-                     reinterpret_cast<char*>(storage_)) / sizeof(Storage);
-        
-        allocated_[idx] = false;
-        
-        // Push back to free list
-        size_t count = free_count_.load(std::memory_order_acquire);
-        free_list_[count].store(idx, std::memory_order_release);
-        free_count_.fetch_add(1, std::memory_order_release);
+        uint32_t idx = index_of(ptr);
+        push(idx, idx, 1);
     }
     
-    // Get available count
+    // Objects on the shared free list (not counting those held by caches)
     size_t available() const {
         return free_count_.load(std::memory_order_acquire);
     }
     
+    // Total number of objects the pool can hold
+    size_t capacity() const { return capacity_; }
+    
+    // True if the pool is backed by explicit huge pages
+    bool uses_huge_pages() const { return arena_.is_huge(); }
+    
     // Check if pointer belongs to this pool
     bool owns(T* ptr) const {
         return ptr >= reinterpret_cast<const T*>(storage_) &&
-               ptr < reinterpret_cast<const T*>(storage_ + PoolSize);
+               ptr < reinterpret_cast<const T*>(storage_ + capacity_);
     }
     
+    // Per-thread front end of a pool (one owner thread, destroyed before
+    // the pool: remaining objects go back on destruction)
+    class Cache {
+    public:
+        static constexpr uint32_t SIZE = 32;
+        
+        explicit Cache(MemoryPool& pool) : pool_(pool) {}
+        ~Cache() { flush(count_); }
+        
+        Cache(const Cache&) = delete;
+        Cache& operator=(const Cache&) = delete;
+        
+        template<typename... Args>
+        T* allocate(Args&&... args) {
+            if (__builtin_expect(count_ == 0, 0)) {
+                count_ = pool_.pop(items_, SIZE / 2);
+                if (count_ == 0) {
+                    return nullptr;
+                }
+            }
+            return pool_.construct(items_[--count_], std::forward<Args>(args)...);
+        }
+        
+        void deallocate(T* ptr) {
+            if (!ptr) return;
+            ptr->~T();
+            if (__builtin_expect(count_ == SIZE, 0)) {
+                flush(SIZE / 2);
+            }
+            uint32_t idx = pool_.index_of(ptr);
+            pool_.next_[idx].store(CACHED, std::memory_order_relaxed);
+            items_[count_++] = idx;
+        }
+        
+        // Free objects held here
+        size_t cached() const { return count_; }
+        
+        MemoryPool& pool() const { return pool_; }
+        
+    private:
+        MemoryPool& pool_;
+        uint32_t count_ = 0;
+        uint32_t items_[SIZE];
+        
+        // Return the newest n as one chain
+        void flush(uint32_t n) {
+            if (n == 0) {
+                return;
+            }
+            uint32_t* chain = items_ + count_ - n;
+            for (uint32_t i = 0; i + 1 < n; ++i) {
+                pool_.next_[chain[i]].store(chain[i + 1], std::memory_order_relaxed);
+            }
+            pool_.push(chain[0], chain[n - 1], n);
+            count_ -= n;
+        }
+    };
+    
 private:
     // Storage with proper alignment
     struct alignas(alignof(T)) Storage {
         unsigned char data[sizeof(T)];
     };
     
-    Storage storage_[PoolSize];
-    bool allocated_[PoolSize]{};
+    // Link word of an object: next free index, or what the object is
+    static constexpr uint32_t END = UINT32_MAX;            // Bottom of the stack
+    static constexpr uint32_t ALLOCATED = UINT32_MAX - 1;  // Constructed
+    static constexpr uint32_t CACHED = UINT32_MAX - 2;     // Free, held by a Cache
+    static constexpr size_t MAX_CAPACITY = UINT32_MAX - 2;
+    
+    // Arena layout: [Storage x n][atomic<uint32_t> x n]
+    static constexpr size_t links_offset(size_t n) {
+        return HugePageBuffer::round_up(n * sizeof(Storage), alignof(std::atomic<uint32_t>));
+    }
+    
+    static constexpr size_t arena_bytes(size_t n) {
+        return links_offset(n) + n * sizeof(std::atomic<uint32_t>);
+    }
+    
+    static_assert(alignof(Storage) <= HugePageBuffer::PAGE_SIZE,
+                  "Pool objects must not need more than page alignment");
+    
+    // Head word: top index (low half), pop count (high half)
+    static constexpr uint64_t pack(uint32_t index, uint64_t pops) {
+        return (pops << 32) | index;
+    }
+    static constexpr uint32_t top(uint64_t head) { return static_cast<uint32_t>(head); }
+    static constexpr uint64_t pops(uint64_t head) { return head >> 32; }
+    
+    uint32_t index_of(const T* ptr) const {
+        return static_cast<uint32_t>((reinterpret_cast<const char*>(ptr) -
+                                      reinterpret_cast<const char*>(storage_)) / sizeof(Storage));
+    }
+    
+    template<typename... Args>
+    T* construct(uint32_t idx, Args&&... args) {
+        next_[idx].store(ALLOCATED, std::memory_order_relaxed);
+        T* ptr = reinterpret_cast<T*>(&storage_[idx]);
+        new (ptr) T(std::forward<Args>(args)...);
+        return ptr;
+    }
+    
+    // Pop up to max indexes with one CAS. The links walked may change under
+    // us; only an unchanged head (same top, same pop count) commits them.
+    // Popped objects are marked CACHED until constructed.
+    uint32_t pop(uint32_t* out, uint32_t max) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t idx = top(head);
+            if (idx == END) {
+                return 0;
+            }
+            uint32_t n = 0;
+            while (n < max && idx < capacity_) {
+                out[n++] = idx;
+                idx = next_[idx].load(std::memory_order_relaxed);
+            }
+            if (idx != END && idx >= capacity_) {
+                // Walked into an object popped meanwhile
+                head = head_.load(std::memory_order_acquire);
+                continue;
+            }
+            if (head_.compare_exchange_weak(head, pack(idx, pops(head) + 1),
+                                            std::memory_order_acquire, std::memory_order_acquire)) {
+                for (uint32_t i = 0; i < n; ++i) {
+                    next_[out[i]].store(CACHED, std::memory_order_relaxed);
+                }
+                free_count_.fetch_sub(n, std::memory_order_relaxed);
+                return n;
+            }
+        }
+    }
+    
+    // Push the chain first -> ... -> last (n objects, already linked)
+    // Counted before they are visible, so a pop never takes the count below 0
+    void push(uint32_t first, uint32_t last, uint32_t n) {
+        free_count_.fetch_add(n, std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        do {
+            next_[last].store(top(head), std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(head, pack(first, pops(head)),
+                                              std::memory_order_release, std::memory_order_relaxed));
+    }
+    
+    size_t capacity_;
+    HugePageBuffer arena_;
+    
+    Storage* storage_ = nullptr;
+    std::atomic<uint32_t>* next_ = nullptr; // Link word per object
     
     // Lock-free free list
-    alignas(64) std::atomic<size_t> free_count_;
-    std::array<std::atomic<size_t>, PoolSize> free_list_;
+    alignas(64) std::atomic<uint64_t> head_;
+    std::atomic<size_t> free_count_;
 };
 
 // RAII wrapper for pool-allocated objects
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace hft {
+
+// Hardware counters of the calling thread (perf_event_open): cycles,
+// instructions, cache misses (last level) and branch misses, user space
+// only, opened as one group so every ratio comes from the same interval
+//
+// Counting starts at open() and never stops; read() returns the running
+// totals, and an interval is the difference of two reads (a read is one
+// syscall: take them around a loop, not inside it). When the PMU has
+// fewer counters than asked for the kernel multiplexes the group and the
+// totals are scaled up by the time it was not counting.
+//
+// Without a PMU (most VMs and containers) or with perf_event_paranoid > 2
+// open() fails and read() returns invalid values; events the PMU lacks are
+// left out while the rest count.
+class PerfCounters {
+public:
+    enum Event : uint8_t {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        EVENTS
+    };
+
+    struct Values {
+        bool valid = false;                 // Cycles counted
+        bool counted[EVENTS] = {};
+        double value[EVENTS] = {};
+
+        // Counts from earlier to this read
+        Values since(const Values& earlier) const {
+            Values interval = *this;
+            interval.valid = valid && earlier.valid;
+            for (int e = 0; e < EVENTS; ++e) {
+                interval.counted[e] = counted[e] && earlier.counted[e];
+                interval.value[e] = interval.counted[e] ? value[e] - earlier.value[e] : 0.0;
+            }
+            return interval;
+        }
+
+        // Intervals of several threads added up; an event counts only if
+        // it counted in all of them
+        static Values sum(const Values* intervals, size_t count) {
+            Values total;
+            total.valid = count > 0;
+            for (int e = 0; e < EVENTS; ++e) {
+                total.counted[e] = count > 0;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                total.valid = total.valid && intervals[i].valid;
+                for (int e = 0; e < EVENTS; ++e) {
+                    total.counted[e] = total.counted[e] && intervals[i].counted[e];
+                    total.value[e] += intervals[i].value[e];
+                }
+            }
+            for (int e = 0; e < EVENTS; ++e) {
+                total.value[e] = total.counted[e] ? total.value[e] : 0.0;
+            }
+            return total;
+        }
+    };
+
+    PerfCounters() = default;
+    ~PerfCounters() { close(); }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    static const char* event_name(Event event) {
+        switch (event) {
+            case CYCLES: return "cycles";
+            case INSTRUCTIONS: return "instructions";
+            case CACHE_MISSES: return "cache_misses";
+            case BRANCH_MISSES: return "branch_misses";
+            case EVENTS: break;
+        }
+        return "?";
+    }
+
+    // The calling thread from now on; false when not even cycles open
+    bool open() {
+        close();
+#ifdef __linux__
+        static constexpr uint64_t CONFIG[EVENTS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (int e = 0; e < EVENTS; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = CONFIG[e];
+            attr.disabled = e == CYCLES;        // The leader starts the group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, e == CYCLES ? -1 : fds_[CYCLES], 0));
+            if (fd < 0) {
+                if (e == CYCLES) {
+                    return false;
+                }
+                continue;
+            }
+            fds_[e] = fd;
+            slot_[e] = members_++;
+        }
+        ioctl(fds_[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        for (int e = EVENTS - 1; e >= 0; --e) {
+            if (fds_[e] >= 0) {
+                ::close(fds_[e]);
+            }
+            fds_[e] = -1;
+            slot_[e] = -1;
+        }
+#endif
+        members_ = 0;
+    }
+
+    bool available() const { return fds_[CYCLES] >= 0; }
+    bool counting(Event event) const { return fds_[event] >= 0; }
+
+    // Totals since open()
+    Values read() const {
+        Values values;
+#ifdef __linux__
+        if (!available()) {
+            return values;
+        }
+        // nr, time enabled, time running, one value per member
+        uint64_t buffer[3 + EVENTS] = {};
+        ssize_t n = ::read(fds_[CYCLES], buffer, sizeof(buffer));
+        if (n < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buffer[0] != members_ || buffer[2] == 0) {
+            return values;
+        }
+        double scale = static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]);
+        for (int e = 0; e < EVENTS; ++e) {
+            if (slot_[e] >= 0) {
+                values.counted[e] = true;
+                values.value[e] = static_cast<double>(buffer[3 + slot_[e]]) * scale;
+            }
+        }
+        values.valid = true;
+#endif
+        return values;
+    }
+
+private:
+    int fds_[EVENTS] = {-1, -1, -1, -1};
+    int slot_[EVENTS] = {-1, -1, -1, -1};   // Position in the group read
+    uint64_t members_ = 0;
+};
+
+} // namespace hft
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace hft {
+
+// Versioned value read without locks (read-copy-update)
+//
+// Writers publish a whole new version with one pointer swap; readers get
+// the current version with one acquire load and may keep using it until
+// their next read(). A replaced version is retired, not freed: it is
+// reclaimed once every registered reader has read a newer one (a
+// quiescent-state grace period: each reader announces the version it
+// last saw in its own cache line, written only when the version changes).
+// Retired versions wait while a reader is idle, so a reader that stops
+// reading should remove_reader().
+//
+// Readers: one slot per thread or object holding on to a version, taken
+// with add_reader() (cold). Writers (publish, reclaim, snapshot) may be
+// any threads; they serialize on a mutex and allocate, off the hot path.
+template<typename T>
+class RcuCell {
+public:
+    static constexpr size_t MAX_READERS = 8;
+    static constexpr size_t NO_READER = MAX_READERS;
+
+    explicit RcuCell(const T& initial = T{})
+        : current_(new Node{initial, 1}) {
+    }
+
+    // No reader may be left
+    ~RcuCell() {
+        for (Node* node : retired_) {
+            delete node;
+        }
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    // Reader slot, NO_READER when all are taken; its first read() can see
+    // nothing older than the version current now
+    size_t add_reader() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < MAX_READERS; ++i) {
+            if (readers_[i].seen.load(std::memory_order_relaxed) == OFFLINE) {
+                readers_[i].seen.store(current_.load(std::memory_order_relaxed)->version,
+                                       std::memory_order_relaxed);
+                return i;
+            }
+        }
+        return NO_READER;
+    }
+
+    // The reader holds no version any more
+    void remove_reader(size_t reader) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readers_[reader].seen.store(OFFLINE, std::memory_order_release);
+    }
+
+    // Hot path: the current version, valid until this reader's next read()
+    const T* read(size_t reader) {
+        Node* node = current_.load(std::memory_order_acquire);
+        std::atomic<uint64_t>& seen = readers_[reader].seen;
+        if (__builtin_expect(seen.load(std::memory_order_relaxed) != node->version, 0)) {
+            // Done with every older version: they may be freed
+            seen.store(node->version, std::memory_order_release);
+        }
+        return &node->value;
+    }
+
+    // Make value the current version; returns its version number. The
+    // previous one is retired and whatever the readers have moved past is
+    // freed.
+    uint64_t publish(const T& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Node* old = current_.load(std::memory_order_relaxed);
+        Node* node = new Node{value, old->version + 1};
+        current_.store(node, std::memory_order_release);
+        retired_.push_back(old);
+        reclaim_locked();
+        return node->version;
+    }
+
+    // Free retired versions no reader can still hold; returns how many
+    // are left waiting for a reader
+    size_t reclaim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return reclaim_locked();
+    }
+
+    // Copy of the current version (writer side, any thread)
+    T snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return current_.load(std::memory_order_relaxed)->value;
+    }
+
+    // Newest version number (1 = the initial value)
+    uint64_t version() const { return current_.load(std::memory_order_acquire)->version; }
+
+private:
+    static constexpr uint64_t OFFLINE = UINT64_MAX;
+
+    struct Node {
+        T value;
+        uint64_t version;
+    };
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> seen{OFFLINE};    // Oldest version still in use
+    };
+
+    alignas(64) std::atomic<Node*> current_;
+    ReaderSlot readers_[MAX_READERS];
+
+    mutable std::mutex mutex_;
+    std::vector<Node*> retired_;                // Oldest first
+
+    size_t reclaim_locked() {
+        uint64_t oldest = OFFLINE;
+        for (const ReaderSlot& reader : readers_) {
+            uint64_t seen = reader.seen.load(std::memory_order_acquire);
+            oldest = seen < oldest ? seen : oldest;
+        }
+        size_t freed = 0;
+        while (freed < retired_.size() && retired_[freed]->version < oldest) {
+            delete retired_[freed++];
+        }
+        retired_.erase(retired_.begin(), retired_.begin() + static_cast<std::ptrdiff_t>(freed));
+        return retired_.size();
+    }
+};
+
+} // namespace hft
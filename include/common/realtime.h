@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hft {
+
+// Process and thread setup for the trading threads: memory locked and
+// faulted in before the open, threads pinned and run at real-time
+// priority. Each call reports whether the kernel agreed; all of them need
+// privileges (CAP_IPC_LOCK / RLIMIT_MEMLOCK, CAP_SYS_NICE / RLIMIT_RTPRIO)
+// that a development box usually lacks, and the system runs without.
+namespace realtime {
+
+// Lock every current and future page in RAM (mlockall). Locking faults in
+// every mapping, so nothing mapped before the call page-faults afterwards.
+inline bool lock_memory() noexcept {
+#ifdef MCL_FUTURE
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+    return false;
+#endif
+}
+
+// Write-fault every page of [data, data + bytes) without changing its
+// contents (safe while other threads use the memory); returns the bytes
+// covered. MADV_POPULATE_WRITE (Linux 5.14) does it in one call; older
+// kernels get an atomic add of 0 per page.
+inline size_t prefault(void* data, size_t bytes) noexcept {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(data) & ~(page - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(data) + bytes;
+    if (bytes == 0) {
+        return 0;
+    }
+#ifdef __linux__
+    constexpr int POPULATE_WRITE = 23;   // MADV_POPULATE_WRITE
+    if (madvise(reinterpret_cast<void*>(begin), end - begin, POPULATE_WRITE) == 0) {
+        return end - begin;
+    }
+#endif
+    for (uintptr_t p = begin; p < end; p += page) {
+        __atomic_fetch_add(reinterpret_cast<char*>(p), 0, __ATOMIC_RELAXED);
+    }
+    return end - begin;
+}
+
+// Prefault every writable mapping of the process (/proc/self/maps): heap,
+// pools, rings, books, stacks, shared memory regions. The fallback when
+// lock_memory() is refused. Returns the bytes covered.
+inline size_t prefault_writable() {
+    std::FILE* maps = std::fopen("/proc/self/maps", "r");
+    if (!maps) {
+        return 0;
+    }
+    // Read it all first: faulting pages in can change the mappings
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), maps)) > 0) {
+        text.append(chunk, n);
+    }
+    std::fclose(maps);
+
+    size_t covered = 0;
+    size_t line = 0;
+    while (line < text.size()) {
+        size_t next = text.find('\n', line);
+        if (next == std::string::npos) {
+            next = text.size();
+        }
+        unsigned long begin, end;
+        char perms[5];
+        char name[256] = "";
+        if (std::sscanf(text.c_str() + line, "%lx-%lx %4s %*s %*s %*s %255[^\n]",
+                        &begin, &end, perms, name) >= 3 &&
+            perms[0] == 'r' && perms[1] == 'w' &&
+            std::strcmp(name, "[vvar]") != 0 && std::strcmp(name, "[vsyscall]") != 0) {
+            covered += prefault(reinterpret_cast<void*>(begin), end - begin);
+        }
+        line = next + 1;
+    }
+    return covered;
+}
+
+// Pin the calling thread to one CPU (cpu < 0: leave it)
+inline bool pin_thread(int cpu) noexcept {
+#ifdef __linux__
+    if (cpu < 0) {
+        return true;
+    }
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// SCHED_FIFO at priority (1-99) for the calling thread; 0 leaves it as it
+// is. A spinning FIFO thread owns its core: pin it to an isolated one.
+inline bool set_thread_priority(int priority) noexcept {
+#ifdef __linux__
+    if (priority <= 0) {
+        return true;
+    }
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+    (void)priority;
+    return false;
+#endif
+}
+
+} // namespace realtime
+
+} // namespace hft
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include "common/bit_utils.h"
+#include "common/huge_pages.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace hft {
+
+// Symbol interning: names -> dense IDs (0, 1, 2, ... in intern order)
+//
+// IDs index flat arrays (books, positions) so the hot path never hashes a
+// string once a symbol is known. For messages that only carry a name, the
+// table itself is compact: a probe slot is the name as a 16-byte zero-padded
+// key, compared against the message field with one SIMD instruction, next
+// to a 4-byte ID. Names are up to MAX_NAME characters (longer ones are cut,
+// like Order::symbol); 8-character ITCH stock names fit as they are.
+//
+// Capacity is set at construction (the table is twice that, so probe runs
+// stay short). Intern and erase from one thread before lookups start (at
+// subscribe time); find from any thread afterwards. Erased IDs are not
+// reused.
+class SymbolTable {
+public:
+    static constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+    static constexpr size_t MAX_NAME = 15;
+
+    explicit SymbolTable(size_t capacity)
+        : capacity_(capacity)
+        , slot_count_(bits::next_power_of_2(capacity < 4 ? 8 : capacity * 2))
+        , mask_(slot_count_ - 1)
+        , shift_(64 - bits::log2_floor(slot_count_))
+        , storage_(slot_count_ * (sizeof(Key) + sizeof(uint32_t)))
+        , keys_(static_cast<Key*>(storage_.data()))
+        , ids_(keys_ ? reinterpret_cast<uint32_t*>(keys_ + slot_count_) : nullptr)
+        , names_(std::make_unique<Key[]>(capacity)) {
+        if (!keys_) {
+            capacity_ = 0; // Mapping failed: every lookup misses
+        }
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // ID of name, assigning the next one if it is new
+    // NO_SYMBOL: empty name or table full
+    uint32_t intern(const char* name) {
+        Key key = key_of(name);
+        if (is_empty(key) || !keys_) {
+            return NO_SYMBOL;
+        }
+        size_t idx = home(key);
+        while (!is_empty(keys_[idx])) {
+            if (equal(keys_[idx], key)) {
+                return ids_[idx];
+            }
+            idx = (idx + 1) & mask_;
+        }
+        if (next_id_ >= capacity_) {
+            return NO_SYMBOL;
+        }
+        uint32_t id = next_id_++;
+        keys_[idx] = key;
+        ids_[idx] = id;
+        names_[id] = key;
+        ++size_;
+        return id;
+    }
+
+    // NUL-terminated name (cut to MAX_NAME like intern)
+    uint32_t find(const char* name) const noexcept {
+        return find_key(key_of(name));
+    }
+
+    // Fixed 16-byte, NUL-padded field of a message (bytes after the first
+    // NUL are ignored); reads all 16 bytes
+    uint32_t find_field(const char* field) const noexcept {
+        return find_key(key_of_field(field));
+    }
+
+    // Forget name; its ID stays retired
+    bool erase(const char* name) noexcept {
+        Key key = key_of(name);
+        if (is_empty(key) || !keys_) {
+            return false;
+        }
+        size_t idx = home(key);
+        while (!equal(keys_[idx], key)) {
+            if (is_empty(keys_[idx])) {
+                return false;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        names_[ids_[idx]] = Key{};
+
+        // Backward-shift deletion: pull later members of the run into the
+        // hole so probes never need tombstones
+        size_t hole = idx;
+        size_t next = (hole + 1) & mask_;
+        while (!is_empty(keys_[next])) {
+            size_t ideal = home(keys_[next]);
+            if (((next - ideal) & mask_) >= ((next - hole) & mask_)) {
+                keys_[hole] = keys_[next];
+                ids_[hole] = ids_[next];
+                hole = next;
+            }
+            next = (next + 1) & mask_;
+        }
+        keys_[hole] = Key{};
+        --size_;
+        return true;
+    }
+
+    // Name of an ID ("" if unknown or erased)
+    const char* name(uint32_t id) const noexcept {
+        return id < next_id_ ? reinterpret_cast<const char*>(names_[id].word) : "";
+    }
+
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return capacity_; }
+
+    // One past the highest ID handed out (size of ID-indexed arrays)
+    uint32_t id_limit() const noexcept { return next_id_; }
+
+private:
+    // Name bytes, zero padded; all zero = empty slot
+    struct alignas(16) Key {
+        uint64_t word[2];
+    };
+
+    size_t capacity_;
+    size_t slot_count_;
+    size_t mask_;
+    int shift_;
+    HugePageBuffer storage_;             // keys_ then ids_, zero filled
+    Key* keys_;
+    uint32_t* ids_;
+    std::unique_ptr<Key[]> names_;       // By ID
+    uint32_t next_id_ = 0;
+    size_t size_ = 0;
+
+    static Key key_of(const char* name) noexcept {
+        Key key{};
+        std::memcpy(key.word, name, strnlen(name, MAX_NAME));
+        return key;
+    }
+
+    // Keep the bytes before the first NUL (at most MAX_NAME), zero the rest
+    static Key key_of_field(const char* field) noexcept {
+        Key key;
+#if defined(__SSE2__)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(field));
+        unsigned nuls = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128()))) | 0x8000u;
+        __m128i length = _mm_set1_epi8(static_cast<char>(bits::count_trailing_zeros(nuls)));
+        __m128i index = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        _mm_store_si128(reinterpret_cast<__m128i*>(key.word),
+                        _mm_and_si128(bytes, _mm_cmpgt_epi8(length, index)));
+#else
+        key = Key{};
+        std::memcpy(key.word, field, strnlen(field, MAX_NAME));
+#endif
+        return key;
+    }
+
+    static bool equal(const Key& a, const Key& b) noexcept {
+#if defined(__SSE4_1__)
+        __m128i diff = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(a.word)),
+                                     _mm_load_si128(reinterpret_cast<const __m128i*>(b.word)));
+        return _mm_testz_si128(diff, diff);
+#elif defined(__SSE2__)
+        __m128i same = _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(a.word)),
+                                      _mm_load_si128(reinterpret_cast<const __m128i*>(b.word)));
+        return _mm_movemask_epi8(same) == 0xFFFF;
+#else
+        return a.word[0] == b.word[0] && a.word[1] == b.word[1];
+#endif
+    }
+
+    static bool is_empty(const Key& key) noexcept {
+        return (key.word[0] | key.word[1]) == 0;
+    }
+
+    // Multiplicative mix; the top bits pick the slot
+    size_t home(const Key& key) const noexcept {
+        uint64_t h = (key.word[0] ^ (key.word[1] * 0x9E3779B97F4A7C15ULL)) * 0xFF51AFD7ED558CCDULL;
+        return static_cast<size_t>(h >> shift_);
+    }
+
+    uint32_t find_key(const Key& key) const noexcept {
+        if (is_empty(key) || !keys_) {
+            return NO_SYMBOL;
+        }
+        size_t idx = home(key);
+        while (true) {
+            const Key& slot = keys_[idx];
+            if (equal(slot, key)) {
+                return ids_[idx];
+            }
+            if (is_empty(slot)) {
+                return NO_SYMBOL;
+            }
+            idx = (idx + 1) & mask_;
+        }
+    }
+};
+
+} // namespace hft
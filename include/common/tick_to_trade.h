@@ -0,0 +1,115 @@
+#pragma once
+
+#include "common/latency_histogram.h"
+#include "common/timestamp.h"
+#include <cstdint>
+#include <string>
+
+namespace hft {
+
+// Tick-to-trade breakdown of the inline path, where one thread takes a
+// packet from the wire to the order socket
+//
+// Each stage stamps the counter where it ends; when the orders of a tick
+// are written to the socket the stamps of the packet being processed are
+// turned into per-stage times (ns) and recorded into the histograms the
+// thread attached. With several orders in a tick, stages run up to the
+// last one; a stage the tick skipped (no risk check for a cancel) counts
+// 0, so the stages of a sample always add up to its TOTAL.
+//
+// Stamps are thread-local: a thread without histograms (the gateway
+// reader, pipelined strategy and sender stages, tests) pays one branch
+// per stamp and records nothing. Export from another thread by copying the
+// histograms (merge() several threads' sets, subtract() the previous copy
+// for an interval).
+class TickToTrade {
+public:
+    enum Stage : uint8_t {
+        RECV,        // Wire receive -> handed to the handler (packets with an rx stamp)
+        DECODE,      // -> feed message decoded
+        BOOK,        // -> top of book published
+        STRATEGY,    // -> order, replace or cancel submitted
+        RISK,        // -> pre-trade checks passed
+        ENCODE,      // -> encoded into the send ring
+        SEND,        // -> written to the socket
+        TOTAL,       // Handed to the handler -> written to the socket
+        STAGES
+    };
+
+    static const char* stage_name(Stage stage);
+
+    // One thread's stage times
+    struct Histograms {
+        LatencyHistogram stage[STAGES];
+
+        void merge(const Histograms& other) {
+            for (int s = 0; s < STAGES; ++s) {
+                stage[s].merge(other.stage[s]);
+            }
+        }
+
+        void subtract(const Histograms& earlier) {
+            for (int s = 0; s < STAGES; ++s) {
+                stage[s].subtract(earlier.stage[s]);
+            }
+        }
+    };
+
+    // Record the calling thread's ticks into histograms (nullptr: stop)
+    static void attach(Histograms* histograms) noexcept {
+        trace_.histograms = histograms;
+        trace_.stamp[RECV] = 0;
+    }
+
+    // Brackets one packet in the handler: stamps RECV on entry, forgets the
+    // packet on exit so later orders (timers) are not charged to it
+    class Packet {
+    public:
+        explicit Packet(uint64_t rx_timestamp_ns) noexcept {
+            Trace& trace = trace_;
+            if (__builtin_expect(trace.histograms != nullptr, 0)) {
+                trace.stamp[RECV] = Timestamp::now();
+                trace.rx_timestamp_ns = rx_timestamp_ns;
+            }
+        }
+
+        ~Packet() { trace_.stamp[RECV] = 0; }
+
+        Packet(const Packet&) = delete;
+        Packet& operator=(const Packet&) = delete;
+    };
+
+    static void mark(Stage stage) noexcept {
+        Trace& trace = trace_;
+        if (__builtin_expect(trace.histograms != nullptr, 0)) {
+            trace.stamp[stage] = Timestamp::now();
+        }
+    }
+
+    // Orders written: stamp SEND and record the tick (once per book update)
+    static void sent() noexcept {
+        Trace& trace = trace_;
+        if (__builtin_expect(trace.histograms != nullptr, 0)) {
+            trace.stamp[SEND] = Timestamp::now();
+            commit(trace);
+        }
+    }
+
+    // p50/p90/p99/p99.9/max per stage, one line each
+    static std::string report(const Histograms& histograms);
+
+private:
+    // Zero-initialized (thread storage)
+    struct Trace {
+        Histograms* histograms;
+        uint64_t stamp[TOTAL];              // Counter at the end of each stage
+        uint64_t rx_timestamp_ns;           // Of the packet being processed
+        uint64_t committed;                 // SEND stamp of the last recorded tick
+    };
+
+    static inline thread_local Trace trace_;
+
+    static void commit(Trace& trace) noexcept;
+};
+
+} // namespace hft
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <chrono>
 
@@ -15,6 +16,12 @@ namespace hft {
 
 // High-precision timestamp using hardware counters
 // This is critical for HFT - we need nanosecond precision
+//
+// calibrate_tsc_frequency() runs once at startup, before other threads
+// start. It measures the counter rate, stores a fixed-point ticks-to-ns
+// factor and anchors the counter to the wall clock. Until then the
+// conversion assumes 3.0 GHz. Without an invariant TSC (x86 CPUID
+// 80000007h EDX[8]) now() falls back to std::chrono and returns ns.
 class Timestamp {
 public:
     using value_type = uint64_t;
@@ -24,9 +31,12 @@ public:
     // ARM: CNTVCT_EL0 virtual counter (< 20 CPU cycles)
     static inline value_type now() noexcept {
 #if defined(HFT_X86)
-        // Use RDTSCP to prevent instruction reordering on x86
-        unsigned int aux;
-        return __rdtscp(&aux);
+        if (__builtin_expect(!use_chrono_, 1)) {
+            // Use RDTSCP to prevent instruction reordering on x86
+            unsigned int aux;
+            return __rdtscp(&aux);
+        }
+        return chrono_ns();
 #elif defined(HFT_ARM)
         // Use ARM performance counter
         uint64_t val;
@@ -34,34 +44,87 @@ public:
         return val;
 #else
         // Fallback to chrono (slower but portable)
-        auto now = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(
-            now.time_since_epoch()).count();
+        return chrono_ns();
 #endif
     }
     
     // Convert TSC to nanoseconds
+    // Fixed point: ns = ticks * mult >> SHIFT, one widening multiply
+    // instead of a double divide; exact to ~1 ppb for any 64-bit delta
     static inline uint64_t to_nanoseconds(value_type tsc) noexcept {
-        // This would be calibrated at startup
-        // For now, assume 3.0 GHz CPU
-        constexpr double tsc_freq = 3.0e9;
-        return static_cast<uint64_t>(tsc / tsc_freq * 1e9);
+        return static_cast<uint64_t>(
+            (static_cast<unsigned __int128>(tsc) * ns_mult_) >> NS_SHIFT);
     }
     
     // Get wall clock time (slower but needed for logging)
     static inline uint64_t wall_clock_ns() noexcept {
-        auto now = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(
-            now.time_since_epoch()).count();
+        return chrono_ns();
+    }
+    
+    // Wall clock time (same epoch as wall_clock_ns() and kernel receive
+    // timestamps) derived from the counter and the calibration anchor:
+    // no clock_gettime on the hot path. Drifts with the TSC against NTP
+    // adjustments; resync_wall_clock() re-anchors it.
+    static inline uint64_t fast_wall_clock_ns() noexcept {
+        return wall_clock_at(now());
+    }
+    
+    // Same clock at an earlier now() reading (the current wall clock until
+    // calibrated)
+    static inline uint64_t wall_clock_at(value_type tsc) noexcept {
+        if (__builtin_expect(!calibrated_, 0)) {
+            return chrono_ns();
+        }
+        return wall_offset_ns_.load(std::memory_order_relaxed) + to_nanoseconds(tsc);
     }
     
     // Calibrate TSC frequency (called once at startup)
     static double calibrate_tsc_frequency();
     
+    // Re-anchor fast_wall_clock_ns() to the wall clock (off the hot path,
+    // e.g. from a timer every few seconds; safe while other threads read)
+    static void resync_wall_clock() noexcept;
+    
+    // Counter rate in Hz (3.0e9 until calibrated)
+    static double tsc_frequency() noexcept { return tsc_frequency_; }
+    
+    // False when now() uses std::chrono (no invariant TSC)
+    static bool tsc_enabled() noexcept { return !use_chrono_; }
+    
+    // CPU reports a constant-rate TSC that keeps running in deep C-states
+    static bool has_invariant_tsc() noexcept;
+    
 private:
-    static inline double tsc_frequency_ = 0.0;
+    static constexpr uint32_t NS_SHIFT = 32;
+    
+    static inline uint64_t chrono_ns() noexcept {
+        auto now = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now.time_since_epoch()).count();
+    }
+    
+    // Set by calibrate_tsc_frequency(), read-only afterwards
+    static inline double tsc_frequency_ = 3.0e9;
+    static inline uint64_t ns_mult_ = (1ULL << NS_SHIFT) / 3;  // 1e9 / 3.0e9 in 32.32
+    static inline bool use_chrono_ = false;
+    static inline bool calibrated_ = false;
+    // Wall clock minus to_nanoseconds(counter), modulo 2^64: one word so
+    // a resync never tears against a reader
+    static inline std::atomic<uint64_t> wall_offset_ns_{0};
+    
+    static void set_frequency(double hz) noexcept;
 };
 
+// Spin-wait hint for busy loops (seqlock retries, ring polling)
+// Frees pipeline resources for the sibling hyper-thread
+static inline void cpu_relax() noexcept {
+#if defined(HFT_X86)
+    _mm_pause();
+#elif defined(HFT_ARM)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
 // Measures latency of a code block
 class LatencyMeasure {
 public:
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace hft {
+
+// Depth kernels over one book side stored as parallel arrays (price[i],
+// quantity[i], best level first), as OrderBook keeps them
+//
+// Arrays must be 32-byte aligned and padded to a multiple of LANES
+// entries; only the first n entries are used. With AVX2 a book of 10
+// levels is three 4-wide blocks, each a masked load, a multiply-add and,
+// for fill(), an in-register prefix sum; otherwise plain loops (which the
+// compiler vectorizes where it can).
+namespace depth {
+
+constexpr size_t LANES = 4;
+
+// Quantity and price x quantity of a range of levels
+struct Totals {
+    double quantity = 0.0;
+    double notional = 0.0;
+
+    // Average price (0 if empty)
+    double vwap() const { return quantity > 0 ? notional / quantity : 0.0; }
+};
+
+#if defined(__AVX2__)
+namespace detail {
+
+// Lanes block, block + 1, ... below n
+inline __m256d lanes_below(size_t block, size_t n) {
+    __m256i index = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(block)),
+                                     _mm256_setr_epi64x(0, 1, 2, 3));
+    return _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(n)), index));
+}
+
+inline double horizontal_sum(__m256d v) {
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+// a * b + c
+inline __m256d multiply_add(__m256d a, __m256d b, __m256d c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+
+// Inclusive prefix sum of the four lanes
+inline __m256d prefix_sum(__m256d v) {
+    __m256d zero = _mm256_setzero_pd();
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 3)), zero, 0x1));
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 3, 2)), zero, 0x3));
+    return v;
+}
+
+} // namespace detail
+#endif
+
+// Sum of quantity[i], i < n
+inline double sum(const double* quantity, size_t n) {
+#if defined(__AVX2__)
+    __m256d total = _mm256_setzero_pd();
+    for (size_t block = 0; block < n; block += LANES) {
+        __m256d q = _mm256_and_pd(_mm256_load_pd(quantity + block), detail::lanes_below(block, n));
+        total = _mm256_add_pd(total, q);
+    }
+    return detail::horizontal_sum(total);
+#else
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        total += quantity[i];
+    }
+    return total;
+#endif
+}
+
+// Quantity and notional of the first n levels
+inline Totals totals(const double* price, const double* quantity, size_t n) {
+    Totals result;
+#if defined(__AVX2__)
+    __m256d q_total = _mm256_setzero_pd();
+    __m256d n_total = _mm256_setzero_pd();
+    for (size_t block = 0; block < n; block += LANES) {
+        __m256d q = _mm256_and_pd(_mm256_load_pd(quantity + block), detail::lanes_below(block, n));
+        q_total = _mm256_add_pd(q_total, q);
+        n_total = detail::multiply_add(_mm256_load_pd(price + block), q, n_total);
+    }
+    result.quantity = detail::horizontal_sum(q_total);
+    result.notional = detail::horizontal_sum(n_total);
+#else
+    for (size_t i = 0; i < n; ++i) {
+        result.quantity += quantity[i];
+        result.notional += price[i] * quantity[i];
+    }
+#endif
+    return result;
+}
+
+// Walk the first n levels until size is filled: what was filled (less
+// than size if the levels run out) and its notional
+inline Totals fill(const double* price, const double* quantity, size_t n, double size) {
+    Totals result;
+#if defined(__AVX2__)
+    // Each level takes min(quantity, size - quantity ahead of it), >= 0
+    __m256d zero = _mm256_setzero_pd();
+    __m256d wanted = _mm256_set1_pd(size);
+    __m256d ahead = zero;
+    __m256d q_total = zero;
+    __m256d n_total = zero;
+    for (size_t block = 0; block < n; block += LANES) {
+        __m256d q = _mm256_and_pd(_mm256_load_pd(quantity + block), detail::lanes_below(block, n));
+        __m256d through = _mm256_add_pd(ahead, detail::prefix_sum(q));
+        __m256d left = _mm256_max_pd(_mm256_sub_pd(wanted, _mm256_sub_pd(through, q)), zero);
+        __m256d take = _mm256_min_pd(q, left);
+        q_total = _mm256_add_pd(q_total, take);
+        n_total = detail::multiply_add(_mm256_load_pd(price + block), take, n_total);
+        ahead = _mm256_permute4x64_pd(through, _MM_SHUFFLE(3, 3, 3, 3));
+        if (_mm256_cvtsd_f64(ahead) >= size) {
+            break; // Filled within this block
+        }
+    }
+    result.quantity = detail::horizontal_sum(q_total);
+    result.notional = detail::horizontal_sum(n_total);
+#else
+    for (size_t i = 0; i < n && result.quantity < size; ++i) {
+        double take = std::min(quantity[i], size - result.quantity);
+        result.quantity += take;
+        result.notional += price[i] * take;
+    }
+#endif
+    return result;
+}
+
+} // namespace depth
+
+} // namespace hft
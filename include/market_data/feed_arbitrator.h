@@ -0,0 +1,173 @@
+#pragma once
+
+#include "market_data/feed_decoder.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+
+namespace hft {
+
+// Sequence tracking, A/B line arbitration and gap recovery for one
+// MoldUDP64 channel.
+// Both lines carry the same packets; the first copy of each sequence
+// range is delivered and the slower copy is dropped after a header
+// compare. Packets ahead of the expected sequence are held, in sequence
+// order, while the gap is filled by:
+// 1. the other line (usually within a packet or two)
+// 2. a retransmission request to the rerequest server
+// 3. a snapshot, once retransmission attempts are exhausted or the
+//    buffer overflows
+// and are replayed in order as soon as the hole is closed.
+//
+// Single threaded: feed all lines and poll() from the receiver thread.
+// The packet buffer is large (BUFFER_PACKETS * MAX_PACKET_SIZE), keep
+// instances on the heap.
+class FeedArbitrator {
+public:
+    enum class Line : uint8_t {
+        A = 0,
+        B = 1,
+        RECOVERY = 2   // Retransmissions from the rerequest server
+    };
+    static constexpr size_t LINE_COUNT = 3;
+
+    enum class Result : uint8_t {
+        DELIVERED,     // In sequence (plus any buffered packets it unblocked)
+        DUPLICATE,     // Nothing new: seen on another line, or a heartbeat
+        BUFFERED,      // Ahead of sequence, held until the gap is filled
+        DROPPED        // Malformed, too large or no room to buffer
+    };
+
+    static constexpr size_t MAX_PACKET_SIZE = 2048;  // Ethernet MTU + headroom
+    static constexpr size_t BUFFER_PACKETS = 256;    // Held while a gap is open
+
+    // In-order packets; each starts exactly at the next expected sequence
+    // (overlapping retransmissions are trimmed before delivery)
+    using PacketCallback = std::function<void(const char* data, size_t len)>;
+
+    // Request count messages starting at sequence from the rerequest server
+    using RetransmitCallback = std::function<void(const char* session, uint64_t sequence, uint16_t count)>;
+
+    // Rebuild downstream state from a snapshot and set next_sequence to the
+    // first sequence it does not cover. Return false if not available yet
+    // (retried on poll()).
+    using SnapshotCallback = std::function<bool(uint64_t& next_sequence)>;
+
+    struct Stats {
+        std::array<uint64_t, LINE_COUNT> packets{};   // Received per line
+        std::array<uint64_t, LINE_COUNT> first{};     // Delivered first per line
+        uint64_t duplicates = 0;
+        uint64_t gaps = 0;
+        uint64_t buffered = 0;
+        uint64_t replayed = 0;            // Buffered packets delivered later
+        uint64_t dropped = 0;
+        uint64_t retransmit_requests = 0;
+        uint64_t snapshots = 0;
+        uint64_t lost_messages = 0;       // Skipped with no way to recover
+    };
+
+    explicit FeedArbitrator(PacketCallback on_packet);
+
+    FeedArbitrator(const FeedArbitrator&) = delete;
+    FeedArbitrator& operator=(const FeedArbitrator&) = delete;
+
+    void set_retransmit_callback(RetransmitCallback callback) { retransmit_ = std::move(callback); }
+    void set_snapshot_callback(SnapshotCallback callback) { snapshot_ = std::move(callback); }
+
+    // Packets seen ahead of sequence before a retransmission is requested
+    // (gives the other line a chance to fill a one-line drop first)
+    void set_gap_tolerance(size_t packets) { gap_tolerance_ = packets; }
+
+    // Unanswered requests are re-sent after timeout_ns; after max_attempts
+    // the arbitrator falls back to a snapshot
+    void set_retransmit_timeout(uint64_t timeout_ns, uint32_t max_attempts) {
+        retransmit_timeout_ns_ = timeout_ns;
+        max_retransmit_attempts_ = max_attempts;
+    }
+
+    // Next sequence expected; 0 syncs to the first packet received
+    void set_expected_sequence(uint64_t sequence) { expected_ = sequence; }
+    uint64_t expected_sequence() const noexcept { return expected_; }
+
+    // Hot path: one datagram from a line
+    Result on_packet(Line line, const char* data, size_t len);
+
+    // Timer tick from the receive loop while in_recovery(): re-sends a
+    // stalled retransmission request or escalates to a snapshot
+    void poll(uint64_t now_ns);
+
+    bool in_recovery() const noexcept { return gap_open_ || snapshot_pending_; }
+    size_t buffered() const { return held_count_; }
+
+    // MoldUDP64 session of the channel (from the first packet received)
+    const char* session() const noexcept { return session_; }
+
+    const Stats& stats() const noexcept { return stats_; }
+
+private:
+    struct BufferedPacket {
+        uint64_t sequence;
+        uint32_t count;
+        uint16_t length;
+        Line line;
+        char data[MAX_PACKET_SIZE];
+    };
+
+    PacketCallback deliver_;
+    RetransmitCallback retransmit_;
+    SnapshotCallback snapshot_;
+
+    uint64_t expected_ = 0;
+    char session_[10] = {};
+
+    // Gap state
+    bool gap_open_ = false;
+    bool snapshot_pending_ = false;
+    bool request_pending_ = false;
+    size_t ahead_ = 0;                 // Packets seen ahead since the gap opened
+    uint64_t hole_end_ = 0;            // Lowest sequence seen past the hole
+    uint64_t requested_end_ = 0;       // One past the last requested sequence
+    uint64_t request_time_ns_ = 0;     // 0 = stamp on the next poll()
+    uint32_t attempts_ = 0;
+
+    size_t gap_tolerance_ = 2;
+    uint64_t retransmit_timeout_ns_ = 50'000'000;
+    uint32_t max_retransmit_attempts_ = 3;
+
+    // Held packets: fixed slots listed in sequence order (the lines
+    // interleave, so arrival order is not sequence order)
+    std::array<BufferedPacket, BUFFER_PACKETS> slots_;
+    std::array<uint16_t, BUFFER_PACKETS> held_;     // [0, held_count_) by sequence
+    std::array<uint16_t, BUFFER_PACKETS> free_;     // [0, free_count_)
+    size_t held_count_ = 0;
+    size_t free_count_ = 0;
+    char scratch_[MAX_PACKET_SIZE];    // Trimmed packet under construction
+    Stats stats_;
+
+    // Deliver a packet that starts at or before expected_
+    void deliver(Line line, const char* data, size_t len, uint64_t sequence, uint64_t count);
+
+    // Hold a packet that is ahead of sequence
+    Result hold(Line line, const char* data, size_t len, uint64_t sequence, uint64_t count);
+
+    // Hand the first count held packets' slots back
+    void release_front(size_t count);
+
+    // Replay buffered packets that are now in sequence, then re-evaluate
+    // the gap (recovery paths pass false so they cannot re-enter themselves)
+    void drain(bool allow_requests = true);
+
+    // A packet (or heartbeat) showed the stream is ahead of expected_
+    void note_ahead(uint64_t sequence);
+
+    // Ask for [expected_, hole_end_), or fall back to a snapshot
+    void request_retransmit();
+    void request_snapshot();
+
+    // Give up on the hole: resume at hole_end_
+    void skip_gap();
+
+    void close_gap();
+};
+
+} // namespace hft
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "common/bit_utils.h"
+#include <cstdint>
+#include <cstring>
+
+namespace hft {
+
+namespace feed {
+
+// Big-endian field loads (exchange protocols are network byte order)
+// memcpy keeps unaligned loads legal; compilers emit a single mov + bswap
+inline uint16_t read_be16(const char* p) noexcept {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return bits::byte_swap_16(v);
+#endif
+}
+
+inline uint32_t read_be32(const char* p) noexcept {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return bits::byte_swap_32(v);
+#endif
+}
+
+inline uint64_t read_be64(const char* p) noexcept {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return bits::byte_swap_64(v);
+#endif
+}
+
+// 6-byte timestamps (ITCH nanoseconds since midnight)
+inline uint64_t read_be48(const char* p) noexcept {
+    return (static_cast<uint64_t>(read_be16(p)) << 32) | read_be32(p + 2);
+}
+
+// Big-endian stores (building rerequests and trimmed packets)
+inline void write_be16(char* p, uint16_t v) noexcept {
+#if __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    v = bits::byte_swap_16(v);
+#endif
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline void write_be64(char* p, uint64_t v) noexcept {
+#if __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    v = bits::byte_swap_64(v);
+#endif
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// Framing policies
+// A framing splits a packet into messages. It provides:
+// - PacketHeader: per-packet metadata (sequence numbers for gap detection)
+// - parse_header(): validates the packet, returns the first message offset
+// - next_message(): yields one message at a time, false when done
+
+// Generic framing: back-to-back [u16 big-endian length][message] records
+struct LengthPrefixedFraming {
+    struct PacketHeader {
+        uint64_t sequence = 0;      // Not carried by this framing
+        uint16_t message_count = 0;
+    };
+
+    static bool parse_header(const char*, size_t, PacketHeader&, size_t& offset) noexcept {
+        offset = 0;
+        return true;
+    }
+
+    static bool next_message(const char* data, size_t len, size_t& offset,
+                             const char*& msg, size_t& msg_len) noexcept {
+        if (offset + 2 > len) {
+            return false;
+        }
+        size_t n = read_be16(data + offset);
+        if (offset + 2 + n > len) {
+            return false; // Truncated record
+        }
+        msg = data + offset + 2;
+        msg_len = n;
+        offset += 2 + n;
+        return true;
+    }
+};
+
+// NASDAQ MoldUDP64 downstream packet:
+// [session 10][sequence u64][message count u16] then length-prefixed
+// messages. sequence is the number of the first message in the packet.
+struct MoldUDP64Framing {
+    static constexpr size_t HEADER_SIZE = 20;
+    static constexpr uint16_t END_OF_SESSION = 0xFFFF;
+
+    struct PacketHeader {
+        char session[10] = {};
+        uint64_t sequence = 0;
+        uint16_t message_count = 0; // 0 = heartbeat
+    };
+
+    static bool parse_header(const char* data, size_t len, PacketHeader& header,
+                             size_t& offset) noexcept {
+        if (len < HEADER_SIZE) {
+            return false;
+        }
+        std::memcpy(header.session, data, sizeof(header.session));
+        header.sequence = read_be64(data + 10);
+        header.message_count = read_be16(data + 18);
+        offset = HEADER_SIZE;
+        return true;
+    }
+
+    static bool next_message(const char* data, size_t len, size_t& offset,
+                             const char*& msg, size_t& msg_len) noexcept {
+        return LengthPrefixedFraming::next_message(data, len, offset, msg, msg_len);
+    }
+};
+
+// Decoder = framing + protocol + handler, all resolved at compile time.
+// Protocol::dispatch<Handler>() routes each message to a handler method
+// with no virtual call; every message in the packet is decoded.
+template<typename Framing, typename Protocol, typename Handler>
+class FeedDecoder {
+public:
+    using PacketHeader = typename Framing::PacketHeader;
+
+    explicit FeedDecoder(Handler& handler) : handler_(handler) {}
+
+    // Decode one packet, returns the number of messages dispatched
+    size_t decode(const char* data, size_t len) {
+        size_t offset = 0;
+        if (!Framing::parse_header(data, len, header_, offset)) {
+            ++malformed_packets_;
+            return 0;
+        }
+
+        size_t count = 0;
+        const char* msg = nullptr;
+        size_t msg_len = 0;
+        while (Framing::next_message(data, len, offset, msg, msg_len)) {
+            Protocol::dispatch(msg, msg_len, handler_);
+            ++count;
+        }
+
+        if (offset != len) {
+            ++malformed_packets_; // Trailing bytes or truncated message
+        }
+
+        return count;
+    }
+
+    // Header of the last decoded packet
+    const PacketHeader& last_header() const noexcept { return header_; }
+
+    uint64_t malformed_packets() const noexcept { return malformed_packets_; }
+
+private:
+    Handler& handler_;
+    PacketHeader header_{};
+    uint64_t malformed_packets_ = 0;
+};
+
+} // namespace feed
+
+} // namespace hft
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace hft {
+
+// Append-only market data journal
+//
+// File layout: a 64-byte header, then records back to back, each a 16-byte
+// record header (payload length, timestamp) plus the payload padded to 8
+// bytes. A zero length marks the end, so a journal cut short by a crash
+// still reads up to its last complete record.
+namespace journal {
+
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'J', 'R', 'N', 'L', '1'};
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity;          // Record bytes preallocated
+    uint64_t used;              // Record bytes written
+    uint64_t records;
+    uint64_t created_ns;        // CLOCK_REALTIME
+    uint8_t reserved[16];
+};
+static_assert(sizeof(FileHeader) == 64, "journal header is one cache line");
+
+struct RecordHeader {
+    uint32_t length;            // Payload bytes, 0 = end of journal
+    uint32_t reserved;
+    uint64_t timestamp_ns;      // Packet receive time (CLOCK_REALTIME)
+};
+static_assert(sizeof(RecordHeader) == 16, "journal record header is 16 bytes");
+
+inline size_t record_size(size_t payload) {
+    return sizeof(RecordHeader) + ((payload + 7) & ~static_cast<size_t>(7));
+}
+
+} // namespace journal
+
+// Capture side: the whole file is created, allocated, mapped and touched
+// by open(), so append() is a copy into mapped memory: no system call and
+// no page fault. A full journal refuses packets (counted) instead of
+// growing, and so are empty packets (their zero length would read as the
+// end of the journal). Single writer thread.
+class FeedJournalWriter {
+public:
+    FeedJournalWriter() = default;
+    ~FeedJournalWriter();
+
+    FeedJournalWriter(const FeedJournalWriter&) = delete;
+    FeedJournalWriter& operator=(const FeedJournalWriter&) = delete;
+
+    // Create (truncate) path with room for capacity bytes of records
+    bool open(const std::string& path, size_t capacity);
+
+    // Trim the file to what was written and unmap it
+    void close();
+
+    bool is_open() const { return records_ != nullptr; }
+
+    // Writer thread: one packet and its receive time
+    bool append(const char* data, size_t len, uint64_t timestamp_ns) {
+        size_t size = journal::record_size(len);
+        if (__builtin_expect(len == 0 || size > capacity_ - used_, 0)) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Payload first, length last: a torn record reads as the end
+        char* out = records_ + used_;
+        uint32_t length = static_cast<uint32_t>(len);
+        std::memcpy(out + sizeof(journal::RecordHeader), data, len);
+        std::memcpy(out + offsetof(journal::RecordHeader, timestamp_ns), &timestamp_ns, sizeof(timestamp_ns));
+        std::atomic_signal_fence(std::memory_order_release);
+        std::memcpy(out, &length, sizeof(length));
+
+        used_ += size;
+        header_->used = used_;
+        header_->records = ++count_;
+        captured_.store(count_, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Counters (relaxed, readable from any thread)
+    uint64_t records() const { return captured_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    int fd_ = -1;
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    journal::FileHeader* header_ = nullptr;
+    char* records_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    uint64_t count_ = 0;
+
+    std::atomic<uint64_t> captured_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+// Read side: maps a journal read-only and walks its records in order
+class FeedJournalReader {
+public:
+    struct Record {
+        const char* data;
+        uint32_t len;
+        uint64_t timestamp_ns;
+    };
+
+    FeedJournalReader() = default;
+    ~FeedJournalReader();
+
+    FeedJournalReader(const FeedJournalReader&) = delete;
+    FeedJournalReader& operator=(const FeedJournalReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return records_ != nullptr; }
+
+    // Record at offset (0 = first): false at the end, otherwise advances
+    // offset to the next record
+    bool next(size_t& offset, Record& record) const {
+        if (offset + sizeof(journal::RecordHeader) > size_) {
+            return false;
+        }
+        journal::RecordHeader header;
+        std::memcpy(&header, records_ + offset, sizeof(header));
+        size_t size = journal::record_size(header.length);
+        if (header.length == 0 || size > size_ - offset) {
+            return false;
+        }
+        record.data = records_ + offset + sizeof(header);
+        record.len = header.length;
+        record.timestamp_ns = header.timestamp_ns;
+        offset += size;
+        return true;
+    }
+
+    // As recorded in the header (a journal not closed cleanly may hold
+    // fewer complete records)
+    uint64_t records() const { return records_count_; }
+    size_t bytes() const { return size_; }
+
+private:
+    int fd_ = -1;
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    const char* records_ = nullptr;
+    size_t size_ = 0;                  // Record bytes that may be valid
+    uint64_t records_count_ = 0;
+};
+
+} // namespace hft
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "market_data/feed_journal.h"
+#include "market_data/market_data_handler.h"
+#include "common/tick_to_trade.h"
+#include <atomic>
+#include <cstdint>
+
+namespace hft {
+
+// Replays a captured journal into MarketDataHandler::process_message
+//
+// Packets go in in capture order (deterministic, same message mix as
+// production), at the original pacing, scaled by a speed multiplier, or
+// back to back. Each packet is handed over with the replay time as its
+// receive timestamp, so wire-to-order figures measure this process rather
+// than the age of the capture.
+class FeedReplayer {
+public:
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        uint64_t elapsed_ns = 0;
+        uint64_t max_lateness_ns = 0;        // Behind schedule (paced replays)
+        uint64_t processing_cycles = 0;      // Inside process_message (counter ticks)
+        uint64_t max_processing_cycles = 0;  // Slowest packet
+    };
+
+    explicit FeedReplayer(MarketDataHandler& handler) : handler_(handler) {}
+
+    // 1.0 = original pacing, 10.0 = ten times faster, 0 = as fast as possible
+    void set_speed(double speed) { speed_ = speed > 0 ? speed : 0.0; }
+    double speed() const { return speed_; }
+
+    // Tick-to-trade stages of the replaying thread (attached for the
+    // duration of replay())
+    void set_latency_stages(TickToTrade::Histograms* histograms) { latency_stages_ = histograms; }
+
+    // Replay the whole journal on the calling thread; a cleared stop flag
+    // (if given) ends it early
+    Stats replay(const FeedJournalReader& journal, const std::atomic<bool>* running = nullptr);
+
+private:
+    MarketDataHandler& handler_;
+    double speed_ = 1.0;
+    TickToTrade::Histograms* latency_stages_ = nullptr;
+
+    // Wait until elapsed_ns since start_tsc, returns how late we are
+    static uint64_t wait_until(uint64_t start_tsc, uint64_t elapsed_ns);
+};
+
+} // namespace hft
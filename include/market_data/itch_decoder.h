@@ -0,0 +1,273 @@
+#pragma once
+
+#include "market_data/feed_decoder.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace hft {
+
+// NASDAQ TotalView-ITCH 5.0
+// Wire messages are decoded into host-order structs and passed to the
+// handler by a 256-entry constexpr jump table indexed by message type.
+// Prices are 4-decimal fixed point (ticks of 0.0001).
+namespace itch {
+
+constexpr double PRICE_TICK = 0.0001;
+
+struct MessageHeader {
+    char type;
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint64_t timestamp; // Nanoseconds since midnight
+};
+
+struct SystemEvent : MessageHeader {           // 'S'
+    char event_code;
+};
+
+struct StockDirectory : MessageHeader {        // 'R'
+    char stock[8];                             // Space padded
+    char market_category;
+    char financial_status;
+    uint32_t round_lot_size;
+};
+
+struct AddOrder : MessageHeader {              // 'A', 'F'
+    uint64_t order_ref;
+    char side;                                 // 'B' or 'S'
+    uint32_t shares;
+    char stock[8];
+    uint32_t price;
+    char attribution[4];                       // 'F' only, else spaces
+};
+
+struct OrderExecuted : MessageHeader {         // 'E'
+    uint64_t order_ref;
+    uint32_t executed_shares;
+    uint64_t match_number;
+};
+
+struct OrderExecutedWithPrice : OrderExecuted { // 'C'
+    char printable;
+    uint32_t execution_price;
+};
+
+struct OrderCancel : MessageHeader {           // 'X'
+    uint64_t order_ref;
+    uint32_t cancelled_shares;
+};
+
+struct OrderDelete : MessageHeader {           // 'D'
+    uint64_t order_ref;
+};
+
+struct OrderReplace : MessageHeader {          // 'U'
+    uint64_t original_order_ref;
+    uint64_t new_order_ref;
+    uint32_t shares;
+    uint32_t price;
+};
+
+struct Trade : MessageHeader {                 // 'P' (non-cross)
+    uint64_t order_ref;
+    char side;
+    uint32_t shares;
+    char stock[8];
+    uint32_t price;
+    uint64_t match_number;
+};
+
+// Handlers derive from NullHandler and hide only the callbacks they need;
+// calls resolve statically against the derived type
+struct NullHandler {
+    void on_system_event(const SystemEvent&) {}
+    void on_stock_directory(const StockDirectory&) {}
+    void on_add_order(const AddOrder&) {}
+    void on_order_executed(const OrderExecuted&) {}
+    void on_order_executed_with_price(const OrderExecutedWithPrice&) {}
+    void on_order_cancel(const OrderCancel&) {}
+    void on_order_delete(const OrderDelete&) {}
+    void on_order_replace(const OrderReplace&) {}
+    void on_trade(const Trade&) {}
+    void on_unhandled(const char* /*msg*/, size_t /*len*/) {}
+};
+
+// Protocol policy for feed::FeedDecoder
+struct Itch50 {
+    // Wire length per message type, 0 for types we do not decode
+    static constexpr std::array<uint8_t, 256> MESSAGE_LENGTH = [] {
+        std::array<uint8_t, 256> len{};
+        len['S'] = 12;
+        len['R'] = 39;
+        len['A'] = 36;
+        len['F'] = 40;
+        len['E'] = 31;
+        len['C'] = 36;
+        len['X'] = 23;
+        len['D'] = 19;
+        len['U'] = 35;
+        len['P'] = 44;
+        return len;
+    }();
+
+    template<typename Handler>
+    static void dispatch(const char* msg, size_t len, Handler& handler) {
+        if (len == 0) {
+            return;
+        }
+        uint8_t type = static_cast<uint8_t>(msg[0]);
+        if (len < MESSAGE_LENGTH[type] || MESSAGE_LENGTH[type] == 0) {
+            handler.on_unhandled(msg, len);
+            return;
+        }
+        Table<Handler>::entries[type](msg, handler);
+    }
+
+private:
+    static void read_header(const char* p, MessageHeader& m) noexcept {
+        m.type = p[0];
+        m.stock_locate = feed::read_be16(p + 1);
+        m.tracking_number = feed::read_be16(p + 3);
+        m.timestamp = feed::read_be48(p + 5);
+    }
+
+    template<typename Handler>
+    static void unhandled(const char* p, Handler& h) {
+        h.on_unhandled(p, MESSAGE_LENGTH[static_cast<uint8_t>(p[0])]);
+    }
+
+    template<typename Handler>
+    static void system_event(const char* p, Handler& h) {
+        SystemEvent m;
+        read_header(p, m);
+        m.event_code = p[11];
+        h.on_system_event(m);
+    }
+
+    template<typename Handler>
+    static void stock_directory(const char* p, Handler& h) {
+        StockDirectory m;
+        read_header(p, m);
+        std::memcpy(m.stock, p + 11, 8);
+        m.market_category = p[19];
+        m.financial_status = p[20];
+        m.round_lot_size = feed::read_be32(p + 21);
+        h.on_stock_directory(m);
+    }
+
+    static void read_add_order(const char* p, AddOrder& m) noexcept {
+        read_header(p, m);
+        m.order_ref = feed::read_be64(p + 11);
+        m.side = p[19];
+        m.shares = feed::read_be32(p + 20);
+        std::memcpy(m.stock, p + 24, 8);
+        m.price = feed::read_be32(p + 32);
+    }
+
+    template<typename Handler>
+    static void add_order(const char* p, Handler& h) {
+        AddOrder m;
+        read_add_order(p, m);
+        std::memset(m.attribution, ' ', sizeof(m.attribution));
+        h.on_add_order(m);
+    }
+
+    template<typename Handler>
+    static void add_order_mpid(const char* p, Handler& h) {
+        AddOrder m;
+        read_add_order(p, m);
+        std::memcpy(m.attribution, p + 36, sizeof(m.attribution));
+        h.on_add_order(m);
+    }
+
+    template<typename Handler>
+    static void order_executed(const char* p, Handler& h) {
+        OrderExecuted m;
+        read_header(p, m);
+        m.order_ref = feed::read_be64(p + 11);
+        m.executed_shares = feed::read_be32(p + 19);
+        m.match_number = feed::read_be64(p + 23);
+        h.on_order_executed(m);
+    }
+
+    template<typename Handler>
+    static void order_executed_with_price(const char* p, Handler& h) {
+        OrderExecutedWithPrice m;
+        read_header(p, m);
+        m.order_ref = feed::read_be64(p + 11);
+        m.executed_shares = feed::read_be32(p + 19);
+        m.match_number = feed::read_be64(p + 23);
+        m.printable = p[31];
+        m.execution_price = feed::read_be32(p + 32);
+        h.on_order_executed_with_price(m);
+    }
+
+    template<typename Handler>
+    static void order_cancel(const char* p, Handler& h) {
+        OrderCancel m;
+        read_header(p, m);
+        m.order_ref = feed::read_be64(p + 11);
+        m.cancelled_shares = feed::read_be32(p + 19);
+        h.on_order_cancel(m);
+    }
+
+    template<typename Handler>
+    static void order_delete(const char* p, Handler& h) {
+        OrderDelete m;
+        read_header(p, m);
+        m.order_ref = feed::read_be64(p + 11);
+        h.on_order_delete(m);
+    }
+
+    template<typename Handler>
+    static void order_replace(const char* p, Handler& h) {
+        OrderReplace m;
+        read_header(p, m);
+        m.original_order_ref = feed::read_be64(p + 11);
+        m.new_order_ref = feed::read_be64(p + 19);
+        m.shares = feed::read_be32(p + 27);
+        m.price = feed::read_be32(p + 31);
+        h.on_order_replace(m);
+    }
+
+    template<typename Handler>
+    static void trade(const char* p, Handler& h) {
+        Trade m;
+        read_header(p, m);
+        m.order_ref = feed::read_be64(p + 11);
+        m.side = p[19];
+        m.shares = feed::read_be32(p + 20);
+        std::memcpy(m.stock, p + 24, 8);
+        m.price = feed::read_be32(p + 32);
+        m.match_number = feed::read_be64(p + 36);
+        h.on_trade(m);
+    }
+
+    template<typename Handler>
+    struct Table {
+        using Fn = void (*)(const char*, Handler&);
+
+        static constexpr std::array<Fn, 256> entries = [] {
+            std::array<Fn, 256> t{};
+            for (auto& fn : t) {
+                fn = &unhandled<Handler>;
+            }
+            t['S'] = &system_event<Handler>;
+            t['R'] = &stock_directory<Handler>;
+            t['A'] = &add_order<Handler>;
+            t['F'] = &add_order_mpid<Handler>;
+            t['E'] = &order_executed<Handler>;
+            t['C'] = &order_executed_with_price<Handler>;
+            t['X'] = &order_cancel<Handler>;
+            t['D'] = &order_delete<Handler>;
+            t['U'] = &order_replace<Handler>;
+            t['P'] = &trade<Handler>;
+            return t;
+        }();
+    };
+};
+
+} // namespace itch
+
+} // namespace hft
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "market_data/tick_order_book.h"
+#include "common/hashmap.h"
+#include "common/memory_pool.h"
+#include <cstdint>
+#include <string>
+
+namespace hft {
+
+// Order-by-order (L3) book for ITCH-style feeds
+// Maintains every resting order in price-time priority:
+// - Orders and price levels are pooled (MemoryPool), nothing is allocated
+//   after construction regardless of how many orders are live
+// - Order ID -> order node via an open-addressing FlatHashMap
+// - Each price level is an intrusive doubly-linked FIFO of its orders
+// - The aggregated level (quantity, order count) is maintained
+//   incrementally and mirrored into a TickOrderBook, which provides best
+//   bid/ask and the L2 depth view; its far-level overflow is reserved for
+//   max_levels per side, so levels away from the touch and re-centring do
+//   not allocate either
+//
+// Single writer (the feed thread), which allocates through pool caches:
+// add/delete churn takes no locked instruction. numa_node places the
+// pools and tables (HugePageBuffer::numa_node_of_cpu of the feed core).
+class L3OrderBook {
+public:
+    using Side = OrderBook::Side;
+
+    struct PriceQueue;
+
+    // One resting order (48 bytes)
+    struct OrderNode {
+        uint64_t order_id = 0;
+        uint64_t price_ticks = 0;
+        uint32_t quantity = 0;
+        Side side = Side::BID;
+        PriceQueue* level = nullptr;
+        OrderNode* prev = nullptr;
+        OrderNode* next = nullptr;
+    };
+
+    // FIFO of orders resting at one price
+    struct PriceQueue {
+        uint64_t price_ticks = 0;
+        uint64_t total_quantity = 0;
+        uint32_t order_count = 0;
+        Side side = Side::BID;
+        OrderNode* head = nullptr;   // Oldest order (first to fill)
+        OrderNode* tail = nullptr;
+    };
+
+    // max_orders bounds live orders; max_levels bounds live price levels
+    // (defaults to one level per order, i.e. never the limiting factor)
+    L3OrderBook(const std::string& symbol, double tick_size, size_t max_orders,
+                size_t max_levels = 0, size_t depth = OrderBook::MAX_DEPTH,
+                int numa_node = -1);
+
+    L3OrderBook(const L3OrderBook&) = delete;
+    L3OrderBook& operator=(const L3OrderBook&) = delete;
+
+    // ITCH 'A'/'F': new order joins the back of its level.
+    // False on duplicate ID, zero quantity or pool exhaustion.
+    bool add_order(uint64_t order_id, Side side, uint64_t price_ticks, uint32_t quantity);
+
+    // ITCH 'E'/'C': executed shares leave the order (removed when done)
+    bool execute_order(uint64_t order_id, uint32_t quantity);
+
+    // ITCH 'X': partial cancel, keeps queue position
+    bool cancel_order(uint64_t order_id, uint32_t quantity);
+
+    // ITCH 'D': remove the order entirely
+    bool delete_order(uint64_t order_id);
+
+    // ITCH 'U': replace under a new ID, loses time priority
+    bool replace_order(uint64_t order_id, uint64_t new_order_id,
+                       uint64_t price_ticks, uint32_t quantity);
+
+    // In-place modify: a size decrease at the same price keeps priority,
+    // a price change or size increase sends the order to the back
+    bool modify_order(uint64_t order_id, uint64_t price_ticks, uint32_t quantity);
+
+    const OrderNode* find_order(uint64_t order_id) const;
+    const PriceQueue* find_level(Side side, uint64_t price_ticks) const;
+
+    // Aggregated price-level view (best bid/ask, L2 depth)
+    const TickOrderBook& levels() const noexcept { return levels_; }
+
+    // Side of the last level that changed (lets callers republish one side)
+    Side last_side() const noexcept { return last_side_; }
+
+    size_t order_count() const noexcept { return orders_.size(); }
+    size_t level_count() const noexcept { return queue_index_.size(); }
+    size_t order_capacity() const noexcept { return order_pool_.capacity(); }
+    bool uses_huge_pages() const noexcept { return order_pool_.uses_huge_pages(); }
+
+    const std::string& symbol() const { return levels_.symbol(); }
+
+    void clear();
+
+private:
+    MemoryPool<OrderNode> order_pool_;
+    MemoryPool<PriceQueue> queue_pool_;
+    MemoryPool<OrderNode>::Cache order_cache_;
+    MemoryPool<PriceQueue>::Cache queue_cache_;
+    FlatHashMap<uint64_t, OrderNode*> orders_;
+    FlatHashMap<uint64_t, PriceQueue*> queue_index_;
+    TickOrderBook levels_;
+    Side last_side_ = Side::BID;
+
+    static uint64_t level_key(Side side, uint64_t price_ticks) noexcept {
+        return (price_ticks << 1) | static_cast<uint64_t>(side);
+    }
+
+    OrderNode* lookup(uint64_t order_id) {
+        OrderNode** node = orders_.find(order_id);
+        return node ? *node : nullptr;
+    }
+
+    // Queue for a price, created on first use (nullptr if pool exhausted)
+    PriceQueue* get_or_create_level(Side side, uint64_t price_ticks);
+
+    void append(PriceQueue* level, OrderNode* node);
+    void unlink(OrderNode* node);
+
+    // Reduce an order by quantity, removing it when nothing is left
+    void reduce(OrderNode* node, uint32_t quantity);
+
+    // Push the level aggregate into the L2 view, drop empty queues
+    void publish(PriceQueue* level);
+};
+
+} // namespace hft
@@ -1,49 +1,187 @@
 #pragma once
 
 #include "market_data/order_book.h"
-#include "common/hashmap.h"
-#include "common/circular_buffer.h"
+#include "market_data/l3_order_book.h"
+#include "market_data/shm_book.h"
 #include "common/memory_pool.h"
+#include "common/symbol_table.h"
+#include "common/tick_to_trade.h"
 #include <memory>
 #include <functional>
+#include <vector>
 
 namespace hft {
 
 // Callback for order book updates
 using OrderBookCallback = std::function<void(const OrderBook&)>;
 
+// Per-tick book listener: a plain function and its context, called only for
+// books that have subscribers (OrderBook::subscribers()). The trading layer
+// installs one and dispatches statically from there: StrategyRouter runs
+// the strategies inline, TradingPipeline hands the update to its strategy
+// thread.
+using BookListener = void (*)(void* context, const OrderBook& book);
+
+// Execution printed by the feed (ITCH 'E', 'C' and 'P'). Unlike book
+// states, prints cannot be conflated: each one is delivered once, in feed
+// order, after the book update it caused.
+struct TradePrint {
+    double price;
+    double quantity;
+    uint64_t match_number;
+    uint64_t rx_timestamp_ns;        // Wire receive time of the packet (0 = unknown)
+    OrderBook::Side resting_side;    // Side of the order that was hit
+};
+
+// Same contract as BookListener: subscribed books only
+using TradeListener = void (*)(void* context, const OrderBook& book, const TradePrint& trade);
+
+// Wire protocol of the incoming datagrams
+enum class FeedProtocol : uint8_t {
+    SIMPLE = 0,          // Packed MarketDataMessage records, back to back
+    ITCH50_MOLDUDP64,    // NASDAQ TotalView-ITCH 5.0 over MoldUDP64
+    ITCH50_FRAMED        // ITCH 5.0 with 2-byte length prefixes, no packet header
+};
+
 // Market data handler - processes incoming market data
-// In production, this would parse FIX, ITCH, or proprietary protocols
+// Decoders are selected per feed (set_feed_protocol) and dispatch
+// statically per message; order-level feeds (ITCH) are rebuilt in an
+// L3OrderBook per symbol and published into the OrderBook top levels
+//
+// Symbols are interned when added (add_symbol) into dense IDs, and books
+// are kept in a flat array by ID. Up to max_symbols books, set at
+// construction. Books and L3 books are placed on numa_node (that of the
+// feed core, HugePageBuffer::numa_node_of_cpu; -1 = first touch).
 class MarketDataHandler {
 public:
-    MarketDataHandler();
+    static constexpr size_t DEFAULT_MAX_SYMBOLS = 4096;
+    
+    explicit MarketDataHandler(size_t max_symbols = DEFAULT_MAX_SYMBOLS, int numa_node = -1);
     ~MarketDataHandler();
     
-    // Register callback for order book updates
+    // Register callback for order book updates (every book, every update;
+    // for tools and tests - trading goes through set_book_listener)
     void register_callback(OrderBookCallback callback);
     
-    // Get order book for a symbol (using lock-free hash map)
+    // Install the listener for books with subscribers
+    void set_book_listener(BookListener listener, void* context) {
+        listener_ = listener;
+        listener_context_ = context;
+    }
+    
+    // Install the listener for trade prints on books with subscribers
+    void set_trade_listener(TradeListener listener, void* context) {
+        trade_listener_ = listener;
+        trade_listener_context_ = context;
+    }
+    
+    // Mirror every book update into a shared memory region for other
+    // processes (nullptr: stop). Names the symbols tracked so far, later
+    // ones as they are added. Before the feed starts, or on the feed thread.
+    void set_publisher(ShmBookPublisher* publisher);
+    ShmBookPublisher* publisher() const { return publisher_; }
+    
+    // Get order book for a symbol (nullptr if not tracked)
     OrderBook* get_order_book(const char* symbol);
     OrderBook* get_order_book(const std::string& symbol);
     
-    // Process market data message
+    // By interned ID (symbol_id / add_symbol)
+    OrderBook* get_order_book(uint32_t symbol_id) {
+        return symbol_id < books_.size() ? books_[symbol_id] : nullptr;
+    }
+    
+    // ID of a tracked symbol, SymbolTable::NO_SYMBOL otherwise
+    uint32_t symbol_id(const char* symbol) const { return symbols_.find(symbol); }
+    
+    // Symbols tracked / the most that can be
+    size_t symbol_count() const { return symbols_.size(); }
+    size_t max_symbols() const { return symbols_.capacity(); }
+    
+    // Process market data packet (every message it carries)
+    // rx_timestamp_ns is the packet's wire receive time (0 = unknown); the
+    // books it updates carry it into their snapshots
     // This is the hot path - must be extremely fast
-    void process_message(const char* data, size_t len);
+    void process_message(const char* data, size_t len, uint64_t rx_timestamp_ns = 0);
     
-    // Add a symbol to track
-    void add_symbol(const std::string& symbol);
+    // Add a symbol to track (at subscribe time, before the feed starts)
+    // Returns its ID, or SymbolTable::NO_SYMBOL when full
+    uint32_t add_symbol(const std::string& symbol);
+    
+    // Select the decoder used by process_message (default SIMPLE)
+    void set_feed_protocol(FeedProtocol protocol) { protocol_ = protocol; }
+    FeedProtocol feed_protocol() const { return protocol_; }
+    
+    // Live order capacity of each per-symbol L3 book (order-level feeds)
+    // Takes effect for books created after the call
+    void set_l3_capacity(size_t max_orders_per_symbol) { l3_capacity_ = max_orders_per_symbol; }
+    
+    // Levels kept per side of every book (order_book_depth), 1 to
+    // OrderBook::MAX_DEPTH: deeper SIMPLE levels are dropped, ITCH books
+    // publish this many levels
+    void set_book_depth(size_t levels);
+    size_t book_depth() const { return book_depth_; }
+    
+    // Order-level book behind an OrderBook (nullptr until the feed maps it)
+    const L3OrderBook* get_l3_book(const std::string& symbol) const;
+    
+    // Empty every book before a snapshot is replayed into them
+    // (feed thread only)
+    void reset_books();
+    
+    // reset_books() and drop the ITCH stock locate mappings, for a feed
+    // that assigns its own (a new session after synthetic warm-up
+    // traffic). L3 books stay allocated and are reused by symbol.
+    void forget_locates();
+    
+    // Messages dispatched / packets rejected by the decoders
+    uint64_t messages_decoded() const { return messages_decoded_; }
+    uint64_t malformed_packets() const;
     
 private:
-    // Lock-free hash map for O(1) symbol lookup (replaces std::unordered_map)
-    LockFreeHashMap<const char*, OrderBook*, 256> order_book_map_;
+    // Symbol -> dense ID, and ID -> book
+    SymbolTable symbols_;
+    std::vector<OrderBook*> books_;
     
     // Memory pool for order books (avoid heap fragmentation)
-    MemoryPool<OrderBook, 256> order_book_pool_;
-    
-    // Circular buffer for incoming messages (lock-free pipeline)
-    CircularBuffer<const char*, 4096> message_queue_;
+    MemoryPool<OrderBook> order_book_pool_;
     
     OrderBookCallback callback_;
+    BookListener listener_ = nullptr;
+    void* listener_context_ = nullptr;
+    TradeListener trade_listener_ = nullptr;
+    void* trade_listener_context_ = nullptr;
+    ShmBookPublisher* publisher_ = nullptr;
+    
+    FeedProtocol protocol_ = FeedProtocol::SIMPLE;
+    size_t l3_capacity_ = 1 << 16;
+    size_t book_depth_ = OrderBook::MAX_DEPTH;
+    int numa_node_;
+    uint64_t messages_decoded_ = 0;
+    uint64_t rx_timestamp_ns_ = 0;   // Of the packet being processed
+    
+    // ITCH decoding state (stock locate maps, L3 books, decoders)
+    struct ItchState;
+    std::unique_ptr<ItchState> itch_;
+    
+    void notify(const OrderBook& book) {
+        if (book.subscribers() && listener_) {
+            TickToTrade::mark(TickToTrade::BOOK);
+            listener_(listener_context_, book);
+        }
+        if (__builtin_expect(static_cast<bool>(callback_), 0)) {
+            callback_(book);
+        }
+        // After the local strategies: they are on the tick-to-trade path
+        if (publisher_) {
+            publisher_->publish(book);
+        }
+    }
+    
+    void notify_trade(const OrderBook& book, const TradePrint& trade) {
+        if (book.subscribers() && trade_listener_) {
+            trade_listener_(trade_listener_context_, book, trade);
+        }
+    }
     
     // Message parsing (simplified for demo)
     struct MarketDataMessage {
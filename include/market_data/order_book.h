@@ -4,17 +4,21 @@
 #include <array>
 #include <cstdint>
 #include <limits>
+#include <string>
 #include "common/timestamp.h"
+#include "market_data/depth_analytics.h"
 
 namespace hft {
 
-// Price level in the order book
-// Aligned to cache line to avoid false sharing
-struct alignas(64) PriceLevel {
+// Strategies subscribed to a book (defined by the trading layer)
+struct BookSubscribers;
+
+// One price level, as passed between books (set_levels, get_levels)
+// OrderBook itself stores levels column-wise, see SideLevels
+struct PriceLevel {
     double price = 0.0;
     double quantity = 0.0;
     uint32_t order_count = 0;
-    uint32_t _padding; // Ensure 64-byte alignment
     
     void reset() {
         price = 0.0;
@@ -24,7 +28,10 @@ struct alignas(64) PriceLevel {
 };
 
 // Lock-free order book implementation
-// Uses atomic operations for thread-safe updates without locks
+// Single writer (market data thread), many readers (strategy threads)
+// Readers are kept consistent with a seqlock: the writer makes the
+// version odd while it mutates levels and even again when it is done,
+// readers copy the book and retry if the version moved underneath them.
 // This is critical for HFT - locks introduce too much latency
 class OrderBook {
 public:
@@ -35,28 +42,77 @@ public:
         ASK = 1
     };
     
+    // One side's levels as parallel arrays, best first, zero past the
+    // depth: 240 bytes (4 cache lines) instead of a line per level, and
+    // laid out for the depth kernels (padded to whole SIMD vectors)
+    struct SideLevels {
+        static constexpr size_t CAPACITY = (MAX_DEPTH + depth::LANES - 1) / depth::LANES * depth::LANES;
+        
+        alignas(32) double price[CAPACITY];
+        alignas(32) double quantity[CAPACITY];
+        uint32_t order_count[CAPACITY];
+        
+        PriceLevel operator[](size_t i) const { return PriceLevel{price[i], quantity[i], order_count[i]}; }
+        
+        void set(size_t i, const PriceLevel& level) {
+            price[i] = level.price;
+            quantity[i] = level.quantity;
+            order_count[i] = level.order_count;
+        }
+        
+        void reset(size_t i) { set(i, PriceLevel{}); }
+    };
+    
     struct Book {
-        alignas(64) std::array<PriceLevel, MAX_DEPTH> levels;
+        alignas(64) SideLevels levels{};
         alignas(64) std::atomic<uint32_t> depth{0};
         alignas(64) std::atomic<uint64_t> sequence{0};
     };
     
+    // Default number of read attempts for try_get_snapshot()
+    static constexpr uint32_t DEFAULT_MAX_SPINS = 64;
+    
     OrderBook(const std::string& symbol);
     
     // Update order book (called from market data thread)
+    // Outside of begin_update()/end_update() each call is its own
+    // seqlock write section.
     void update_bid(size_t level, double price, double quantity);
     void update_ask(size_t level, double price, double quantity);
     
+    // Replace one side with count levels (best first), clearing the rest
+    // Used to publish the top of a deeper book (TickOrderBook/L3)
+    void set_levels(Side side, const PriceLevel* levels, size_t count);
+    
+    // Group several level updates into one atomic change as seen by readers
+    // (e.g. all levels carried by one feed packet). Calls may nest; only
+    // the outermost pair touches the seqlock. Writer thread only.
+    void begin_update() noexcept;
+    void end_update() noexcept;
+    
+    // Receive time (CLOCK_REALTIME ns) of the feed packet behind the next
+    // level update; call inside begin_update()/end_update() so readers see
+    // it together with the levels. Writer thread only.
+    void set_rx_timestamp(uint64_t rx_timestamp_ns) noexcept {
+        rx_timestamp_ns_.store(rx_timestamp_ns, std::memory_order_relaxed);
+    }
+    uint64_t rx_timestamp_ns() const noexcept {
+        return rx_timestamp_ns_.load(std::memory_order_relaxed);
+    }
+    
     // Snapshot access (called from strategy thread)
     // Returns copy to avoid locking - small enough to copy efficiently
     struct Snapshot {
-        std::array<PriceLevel, MAX_DEPTH> bids;
-        std::array<PriceLevel, MAX_DEPTH> asks;
+        SideLevels bids;
+        SideLevels asks;
         uint32_t bid_depth;
         uint32_t ask_depth;
         uint64_t bid_sequence;
         uint64_t ask_sequence;
+        uint64_t version;    // Seqlock version the copy was validated against
+        uint32_t retries;    // Torn reads discarded before this copy
         uint64_t timestamp;
+        uint64_t rx_timestamp_ns; // Wire receive time of the last applied update (0 = unknown)
         
         double best_bid() const { return bid_depth > 0 ? bids[0].price : 0.0; }
         double best_ask() const { return ask_depth > 0 ? asks[0].price : std::numeric_limits<double>::max(); }
@@ -66,17 +122,130 @@ public:
             double mid = mid_price();
             return mid > 0 ? (spread() / mid) * 10000.0 : 0.0;
         }
+        
+        // Depth analytics over the best `levels` levels (market_data/depth_analytics.h)
+        
+        // Quantity resting on one side
+        double depth_quantity(Side side, size_t levels = MAX_DEPTH) const {
+            const SideLevels& book = side == Side::BID ? bids : asks;
+            return depth::sum(book.quantity, std::min<size_t>(levels, depth_of(side)));
+        }
+        
+        // (bid - ask) / (bid + ask) quantity, in [-1, 1]; 0 if both empty
+        double imbalance(size_t levels = MAX_DEPTH) const {
+            double bid = depth_quantity(Side::BID, levels);
+            double ask = depth_quantity(Side::ASK, levels);
+            return bid + ask > 0 ? (bid - ask) / (bid + ask) : 0.0;
+        }
+        
+        // Each side's average price weighted by the other side's quantity
+        // (levels = 1: the classic top-of-book microprice); mid if a side
+        // is empty
+        double microprice(size_t levels = 1) const {
+            depth::Totals bid = depth::totals(bids.price, bids.quantity, std::min<size_t>(levels, bid_depth));
+            depth::Totals ask = depth::totals(asks.price, asks.quantity, std::min<size_t>(levels, ask_depth));
+            if (bid.quantity <= 0 || ask.quantity <= 0) {
+                return mid_price();
+            }
+            return (bid.vwap() * ask.quantity + ask.vwap() * bid.quantity) / (bid.quantity + ask.quantity);
+        }
+        
+        // All of the above from one pass per side, for signals that use
+        // them together on every tick
+        struct DepthFeatures {
+            double bid_quantity;
+            double ask_quantity;
+            double imbalance;
+            double microprice;
+        };
+        
+        DepthFeatures depth_features(size_t levels = MAX_DEPTH) const {
+            depth::Totals bid = depth::totals(bids.price, bids.quantity, std::min<size_t>(levels, bid_depth));
+            depth::Totals ask = depth::totals(asks.price, asks.quantity, std::min<size_t>(levels, ask_depth));
+            double total = bid.quantity + ask.quantity;
+            DepthFeatures features;
+            features.bid_quantity = bid.quantity;
+            features.ask_quantity = ask.quantity;
+            features.imbalance = total > 0 ? (bid.quantity - ask.quantity) / total : 0.0;
+            features.microprice = bid.quantity > 0 && ask.quantity > 0
+                ? (bid.notional * ask.quantity / bid.quantity + ask.notional * bid.quantity / ask.quantity) / total
+                : mid_price();
+            return features;
+        }
+        
+        // Average price of taking size from one side (BID: selling into
+        // the bids); with filled, how much of size the book could take
+        double vwap_to_size(Side side, double size, double* filled = nullptr) const {
+            const SideLevels& book = side == Side::BID ? bids : asks;
+            depth::Totals taken = depth::fill(book.price, book.quantity, depth_of(side), size);
+            if (filled) {
+                *filled = taken.quantity;
+            }
+            return taken.vwap();
+        }
+        
+        uint32_t depth_of(Side side) const { return side == Side::BID ? bid_depth : ask_depth; }
+    };
+    
+    // Best level of each side only: what most strategies react to, without
+    // copying MAX_DEPTH cache lines per side
+    struct Top {
+        double bid_price;
+        double bid_quantity;
+        double ask_price;
+        double ask_quantity;
+        uint32_t bid_depth;
+        uint32_t ask_depth;
+        uint64_t version;
+        uint64_t rx_timestamp_ns; // Wire receive time of the last applied update (0 = unknown)
+        
+        double best_bid() const { return bid_depth > 0 ? bid_price : 0.0; }
+        double best_ask() const { return ask_depth > 0 ? ask_price : std::numeric_limits<double>::max(); }
+        double mid_price() const { return (best_bid() + best_ask()) / 2.0; }
+        double spread() const { return best_ask() - best_bid(); }
+        double spread_bps() const { 
+            double mid = mid_price();
+            return mid > 0 ? (spread() / mid) * 10000.0 : 0.0;
+        }
+        
+        // Top-of-book imbalance and microprice (see Snapshot)
+        double imbalance() const {
+            double bid = bid_depth > 0 ? bid_quantity : 0.0;
+            double ask = ask_depth > 0 ? ask_quantity : 0.0;
+            return bid + ask > 0 ? (bid - ask) / (bid + ask) : 0.0;
+        }
+        double microprice() const {
+            if (bid_depth == 0 || ask_depth == 0 || bid_quantity + ask_quantity <= 0) {
+                return mid_price();
+            }
+            return (bid_price * ask_quantity + ask_price * bid_quantity) / (bid_quantity + ask_quantity);
+        }
     };
     
+    // Consistent copy of both sides, retries until no write overlapped it
     Snapshot get_snapshot() const;
     
+    // Consistent top of book, same seqlock protocol as get_snapshot()
+    Top get_top() const;
+    
+    // Bounded variant: gives up after max_spins torn/in-progress reads and
+    // returns false ("stale") instead of spinning behind a busy writer.
+    // On false the contents of snap are unspecified - keep the previous
+    // snapshot in a separate buffer if it is still needed.
+    bool try_get_snapshot(Snapshot& snap, uint32_t max_spins = DEFAULT_MAX_SPINS) const;
+    
+    // Current seqlock version (odd while a write is in progress)
+    uint64_t version() const noexcept {
+        return version_.load(std::memory_order_acquire);
+    }
+    
     // Get top of book (most common operation - highly optimized)
     inline double best_bid() const noexcept {
-        return bids_.levels[0].price;
+        return bids_.levels.price[0];
     }
     
     inline double best_ask() const noexcept {
-        return asks_.levels[0].price;
+        return asks_.levels.price[0];
     }
     
     inline double mid_price() const noexcept {
@@ -85,13 +254,37 @@ public:
     
     const std::string& symbol() const { return symbol_; }
     
+    // Strategies routed this book's updates (nullptr = none). Set before
+    // the feed starts, read by the feed thread on every update.
+    void set_subscribers(BookSubscribers* subscribers) noexcept { subscribers_ = subscribers; }
+    BookSubscribers* subscribers() const noexcept { return subscribers_; }
+    
+    // Dense ID given by MarketDataHandler::add_symbol (UINT32_MAX = none)
+    void set_symbol_id(uint32_t id) noexcept { symbol_id_ = id; }
+    uint32_t symbol_id() const noexcept { return symbol_id_; }
+    
+    // Live levels of one side, writer thread only (readers use snapshots);
+    // for copying the book out, e.g. into a shared memory region
+    const Book& book(Side side) const noexcept { return side == Side::BID ? bids_ : asks_; }
+    
 private:
     std::string symbol_;
     alignas(64) Book bids_;
     alignas(64) Book asks_;
     
+    // Seqlock version covering both sides
+    alignas(64) std::atomic<uint64_t> version_{0};
+    uint32_t write_nesting_ = 0; // Writer-private, no synchronization needed
+    std::atomic<uint64_t> rx_timestamp_ns_{0};
+    BookSubscribers* subscribers_ = nullptr;
+    uint32_t symbol_id_ = UINT32_MAX;
+    
     // Helper to update a level
     void update_level(Book& book, size_t level, double price, double quantity);
+    
+    // One read attempt, false if a write overlapped the copy
+    bool read_snapshot(Snapshot& snap) const noexcept;
+    bool read_top(Top& top) const noexcept;
 };
 
 } // namespace hft
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "market_data/order_book.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace hft {
+
+// Order books published into a POSIX shared memory object, for other
+// processes on the host (risk monitors, loggers, secondary strategies)
+//
+// Region layout: a header, one slot per symbol ID (MarketDataHandler's
+// dense IDs), then a broadcast ring of update notices. A slot is an
+// OrderBook's seqlock protocol over its own copy of the levels: the first
+// cache line holds the version and the top of book (so a reader of the
+// best prices touches one line), then both sides column-wise as OrderBook
+// stores them. Each publish also appends the symbol ID to the ring and
+// bumps the header's published count; readers follow that count to learn
+// which books changed instead of scanning every slot.
+namespace shm {
+
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'B', 'O', 'O', 'K', '1'};
+constexpr uint32_t VERSION = 1;
+
+struct Header {
+    char magic[8];                      // Written last: the region is ready
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_size;
+    uint32_t max_symbols;
+    uint32_t ring_size;                 // Notices, power of 2
+    uint32_t publisher_pid;
+    uint64_t created_ns;                // CLOCK_REALTIME
+    uint8_t reserved[24];
+
+    alignas(64) std::atomic<uint32_t> symbol_count{0}; // Slots named so far (IDs below)
+    std::atomic<uint32_t> closed{0};    // Publisher has shut down
+
+    alignas(64) std::atomic<uint64_t> published{0};    // Notices written
+};
+static_assert(sizeof(Header) == 192, "shm header is three cache lines");
+
+struct BookSlot {
+    char symbol[16];                    // Set before symbol_count covers the slot
+    uint8_t reserved[48];
+
+    // Seqlock version (odd while the publisher copies) and the top of book
+    alignas(64) std::atomic<uint64_t> version{0};
+    uint32_t bid_depth;
+    uint32_t ask_depth;
+    uint64_t rx_timestamp_ns;
+    double bid_price;
+    double bid_quantity;
+    double ask_price;
+    double ask_quantity;
+
+    alignas(64) OrderBook::SideLevels bids;
+    OrderBook::SideLevels asks;
+    uint64_t bid_sequence;
+    uint64_t ask_sequence;
+};
+static_assert(sizeof(BookSlot) % 64 == 0, "slots are whole cache lines");
+
+// Notice i (0-based) is (low 32 bits of i + 1) << 32 | symbol ID, so a
+// reader can tell the notice it expects from one written a lap later
+using Notice = std::atomic<uint64_t>;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "shared atomics must be lock-free to work across processes");
+
+inline size_t region_size(size_t max_symbols, size_t ring_size) {
+    return sizeof(Header) + max_symbols * sizeof(BookSlot) + ring_size * sizeof(Notice);
+}
+
+} // namespace shm
+
+// Publisher side: the region is created, sized and touched by open(), so
+// publish() is a copy into mapped memory: no system call, no page fault.
+// Single writer (the feed thread, via MarketDataHandler::set_publisher).
+class ShmBookPublisher {
+public:
+    static constexpr size_t DEFAULT_RING_SIZE = 1 << 16;
+
+    ShmBookPublisher() = default;
+    ~ShmBookPublisher();
+
+    ShmBookPublisher(const ShmBookPublisher&) = delete;
+    ShmBookPublisher& operator=(const ShmBookPublisher&) = delete;
+
+    // Create name ("/hft_books") with room for max_symbols books and
+    // ring_size notices (rounded up to a power of 2). An object left by an
+    // earlier run is unlinked first; readers still mapping it keep a valid,
+    // closed region.
+    bool open(const std::string& name, size_t max_symbols, size_t ring_size = DEFAULT_RING_SIZE);
+
+    // Mark the region closed, unmap and unlink it
+    void close();
+
+    bool is_open() const { return slots_ != nullptr; }
+
+    // Name the slot of a symbol ID (before the ID is published)
+    bool add_symbol(uint32_t id, const char* symbol);
+
+    // Copy a book into its slot (by OrderBook::symbol_id()) and post a
+    // notice. Writer thread of the book, outside its update section.
+    void publish(const OrderBook& book) {
+        uint32_t id = book.symbol_id();
+        if (__builtin_expect(id >= max_symbols_, 0)) {
+            return; // Not tracked by the handler, or region not open
+        }
+        const OrderBook::Book& bids = book.book(OrderBook::Side::BID);
+        const OrderBook::Book& asks = book.book(OrderBook::Side::ASK);
+        shm::BookSlot& slot = slots_[id];
+
+        uint64_t v = slot.version.load(std::memory_order_relaxed);
+        slot.version.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.bid_depth = bids.depth.load(std::memory_order_relaxed);
+        slot.ask_depth = asks.depth.load(std::memory_order_relaxed);
+        slot.rx_timestamp_ns = book.rx_timestamp_ns();
+        slot.bid_price = bids.levels.price[0];
+        slot.bid_quantity = bids.levels.quantity[0];
+        slot.ask_price = asks.levels.price[0];
+        slot.ask_quantity = asks.levels.quantity[0];
+        slot.bids = bids.levels;
+        slot.asks = asks.levels;
+        slot.bid_sequence = bids.sequence.load(std::memory_order_relaxed);
+        slot.ask_sequence = asks.sequence.load(std::memory_order_relaxed);
+
+        slot.version.store(v + 2, std::memory_order_release);
+
+        // Notice before the count: a reader that sees the count sees it
+        uint64_t n = published_;
+        ring_[n & ring_mask_].store(((n + 1) << 32) | id, std::memory_order_release);
+        header_->published.store(n + 1, std::memory_order_release);
+        published_ = n + 1;
+    }
+
+    // Books published (read on the writer thread, or after it stopped)
+    uint64_t published() const { return published_; }
+
+    size_t max_symbols() const { return max_symbols_; }
+    size_t ring_size() const { return ring_mask_ + 1; }
+
+private:
+    std::string name_;
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    shm::Header* header_ = nullptr;
+    shm::BookSlot* slots_ = nullptr;
+    shm::Notice* ring_ = nullptr;
+    uint32_t max_symbols_ = 0;
+    size_t ring_mask_ = 0;
+    uint64_t published_ = 0;
+};
+
+// Reader side: maps a published region read-only. Books are read with the
+// OrderBook snapshot types and bounded seqlock retries; poll() follows the
+// notice ring for event-driven reads. One reader object per thread (the
+// ring cursor is private to it); any number of reader processes.
+class ShmBookReader {
+public:
+    // poll(): notices were overwritten before this reader got to them
+    static constexpr uint32_t RESYNC = UINT32_MAX;
+    static constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+
+    ShmBookReader() = default;
+    ~ShmBookReader();
+
+    ShmBookReader(const ShmBookReader&) = delete;
+    ShmBookReader& operator=(const ShmBookReader&) = delete;
+
+    // False if name does not exist, is not ready yet or has another layout
+    // Notices published before open() are not delivered
+    bool open(const std::string& name);
+    void close();
+
+    bool is_open() const { return slots_ != nullptr; }
+
+    // Symbols named so far (IDs 0 .. symbols() - 1)
+    uint32_t symbols() const {
+        return header_->symbol_count.load(std::memory_order_acquire);
+    }
+    const char* symbol(uint32_t id) const { return id < symbols() ? slots_[id].symbol : ""; }
+
+    // ID of a symbol, NO_SYMBOL if it is not published (linear scan:
+    // resolve once, then read by ID)
+    uint32_t find(const char* symbol) const;
+
+    // Consistent copy of one book; false if the ID is unknown or the
+    // publisher kept it busy for max_spins attempts
+    bool read(uint32_t id, OrderBook::Snapshot& snap,
+              uint32_t max_spins = OrderBook::DEFAULT_MAX_SPINS) const;
+    bool read_top(uint32_t id, OrderBook::Top& top,
+                  uint32_t max_spins = OrderBook::DEFAULT_MAX_SPINS) const;
+
+    // Next book updated since the last poll (a book updated twice comes up
+    // twice; read it for its latest state). False when caught up. RESYNC
+    // when the ring lapped this reader: updates were missed, so re-read
+    // every book of interest.
+    bool poll(uint32_t& symbol_id) {
+        uint64_t head = header_->published.load(std::memory_order_acquire);
+        if (cursor_ == head) {
+            return false;
+        }
+        if (__builtin_expect(head - cursor_ <= ring_mask_ + 1, 1)) {
+            uint64_t notice = ring_[cursor_ & ring_mask_].load(std::memory_order_acquire);
+            if (static_cast<uint32_t>(notice >> 32) == static_cast<uint32_t>(cursor_ + 1)) {
+                symbol_id = static_cast<uint32_t>(notice);
+                ++cursor_;
+                return true;
+            }
+        }
+        // Lapped (before or while reading the notice)
+        cursor_ = header_->published.load(std::memory_order_acquire);
+        ++lapped_;
+        symbol_id = RESYNC;
+        return true;
+    }
+
+    // Notices not yet polled (may exceed the ring: poll() will RESYNC)
+    uint64_t pending() const {
+        return header_->published.load(std::memory_order_acquire) - cursor_;
+    }
+
+    // RESYNCs returned so far
+    uint64_t lapped() const { return lapped_; }
+
+    // The publisher shut down (a restarted one creates a new region: reopen)
+    bool publisher_closed() const {
+        return header_->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    size_t max_symbols() const { return max_symbols_; }
+
+private:
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    const shm::Header* header_ = nullptr;
+    const shm::BookSlot* slots_ = nullptr;
+    const shm::Notice* ring_ = nullptr;
+    uint32_t max_symbols_ = 0;
+    size_t ring_mask_ = 0;
+    uint64_t cursor_ = 0;
+    uint64_t lapped_ = 0;
+};
+
+} // namespace hft
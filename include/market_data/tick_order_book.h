@@ -0,0 +1,173 @@
+#pragma once
+
+#include "market_data/order_book.h"
+#include "common/bit_utils.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hft {
+
+// Full-depth price-level (L2) order book keyed on integer ticks
+// Unlike OrderBook, levels are addressed by price, not by the feed's
+// level index, so depth is not capped at OrderBook::MAX_DEPTH.
+//
+// Layout per side:
+// - Dense ladder: a window of ladder_ticks consecutive prices around the
+//   touch, one 16-byte slot per tick (4 levels per cache line)
+// - Two-level occupancy bitmap over the ladder: best price is found with
+//   one CLZ/CTZ on the summary word plus one on the level word
+// - Sparse overflow for far levels outside the window: a flat array
+//   sorted by price, reserved for overflow_levels levels per side at
+//   construction
+//
+// Invariant: overflow levels are always worse than every ladder level.
+// The window is re-centred when the touch moves outside it or when the
+// ladder drains, so best price lookups never touch the overflow on the
+// hot path. Updates inside the window are O(1); far levels and
+// re-centring are binary searches and memmoves in the reserved array, so
+// nothing is allocated unless a side holds more than overflow_levels far
+// levels at once.
+//
+// Single writer. Readers on other threads should use OrderBook snapshots.
+class TickOrderBook {
+public:
+    using Side = OrderBook::Side;
+
+    // One summary word covers 64 level words
+    static constexpr size_t MAX_LADDER_TICKS = 64 * 64;
+    static constexpr size_t DEFAULT_LADDER_TICKS = 1024;
+    static constexpr size_t DEFAULT_OVERFLOW_LEVELS = 4096;
+    static constexpr uint64_t NO_PRICE = ~0ULL;
+
+    // Aggregated quantity at one price (cache-dense, no per-level padding)
+    struct TickLevel {
+        double quantity = 0.0;
+        uint32_t order_count = 0;
+        uint32_t _padding = 0;
+    };
+
+    TickOrderBook(const std::string& symbol, double tick_size,
+                  size_t depth = OrderBook::MAX_DEPTH,
+                  size_t ladder_ticks = DEFAULT_LADDER_TICKS,
+                  size_t overflow_levels = DEFAULT_OVERFLOW_LEVELS);
+
+    // Insert, modify or delete (quantity <= 0) the level at a price
+    void update(Side side, uint64_t price_ticks, double quantity, uint32_t order_count = 1);
+
+    // Convenience for double-priced feeds (rounds to the nearest tick)
+    void update_price(Side side, double price, double quantity, uint32_t order_count = 1) {
+        update(side, to_ticks(price), quantity, order_count);
+    }
+
+    void update_bid(double price, double quantity) { update_price(Side::BID, price, quantity); }
+    void update_ask(double price, double quantity) { update_price(Side::ASK, price, quantity); }
+
+    // Level at an exact price, nullptr if empty
+    const TickLevel* find(Side side, uint64_t price_ticks) const;
+
+    // Top of book in ticks, NO_PRICE if the side is empty
+    uint64_t best_bid_ticks() const noexcept { return bids_.best(); }
+    uint64_t best_ask_ticks() const noexcept { return asks_.best(); }
+
+    // Top of book as price, same conventions as OrderBook::Snapshot
+    double best_bid() const noexcept;
+    double best_ask() const noexcept;
+
+    // Copy up to min(max_levels, depth()) levels, best first
+    size_t get_levels(Side side, PriceLevel* out, size_t max_levels) const;
+
+    // Number of levels reported by get_levels (order_book_depth)
+    void set_depth(size_t depth) noexcept { depth_ = depth; }
+    size_t depth() const noexcept { return depth_; }
+
+    // Non-empty levels on a side (ladder + overflow)
+    size_t level_count(Side side) const noexcept {
+        return side == Side::BID ? bids_.count : asks_.count;
+    }
+
+    void clear();
+
+    uint64_t to_ticks(double price) const noexcept {
+        return bits::CompactPrice::from_double(price, tick_size_).ticks;
+    }
+
+    double to_price(uint64_t ticks) const noexcept {
+        return bits::CompactPrice{ticks}.to_double(tick_size_);
+    }
+
+    double tick_size() const noexcept { return tick_size_; }
+    size_t ladder_ticks() const noexcept { return ladder_ticks_; }
+    const std::string& symbol() const { return symbol_; }
+
+private:
+    struct FarLevel {
+        uint64_t ticks;
+        TickLevel level;
+    };
+
+    struct Ladder {
+        bool is_bid = true;
+        uint64_t base = 0;                  // Tick of slot 0
+        uint64_t summary = 0;               // Bit w set: words[w] != 0
+        size_t count = 0;                   // Non-empty levels, incl. overflow
+        std::vector<TickLevel> slots;
+        std::vector<uint64_t> words;
+        std::vector<FarLevel> overflow;     // Ascending price
+
+        // First far level at or above ticks
+        std::vector<FarLevel>::iterator lower_bound(uint64_t ticks) noexcept;
+        std::vector<FarLevel>::const_iterator lower_bound(uint64_t ticks) const noexcept;
+
+        bool in_window(uint64_t ticks) const noexcept {
+            return ticks >= base && ticks - base < slots.size();
+        }
+
+        void mark(size_t idx) noexcept {
+            bits::set_bit(words[idx >> 6], static_cast<int>(idx & 63));
+            bits::set_bit(summary, static_cast<int>(idx >> 6));
+        }
+
+        void unmark(size_t idx) noexcept {
+            bits::clear_bit(words[idx >> 6], static_cast<int>(idx & 63));
+            if (words[idx >> 6] == 0) {
+                bits::clear_bit(summary, static_cast<int>(idx >> 6));
+            }
+        }
+
+        // Best ladder slot index (caller checks summary != 0)
+        size_t best_index() const noexcept {
+            if (is_bid) {
+                int w = bits::log2_floor(summary);
+                return (static_cast<size_t>(w) << 6) | bits::log2_floor(words[w]);
+            }
+            int w = bits::count_trailing_zeros(summary);
+            return (static_cast<size_t>(w) << 6) | bits::count_trailing_zeros(words[w]);
+        }
+
+        uint64_t best() const noexcept;
+
+        // Next occupied slot after idx moving away from the touch,
+        // returns slots.size() when there is none
+        size_t next_index(size_t idx) const noexcept;
+
+        // Move the window so that touch sits inside it, keeping the
+        // overflow-is-worse invariant
+        void recenter(uint64_t touch);
+    };
+
+    std::string symbol_;
+    double tick_size_;
+    size_t depth_;
+    size_t ladder_ticks_;
+    Ladder bids_;
+    Ladder asks_;
+
+    Ladder& ladder(Side side) noexcept { return side == Side::BID ? bids_ : asks_; }
+    const Ladder& ladder(Side side) const noexcept { return side == Side::BID ? bids_ : asks_; }
+
+    void set_level(Ladder& l, uint64_t ticks, double quantity, uint32_t order_count);
+    void erase_level(Ladder& l, uint64_t ticks);
+};
+
+} // namespace hft
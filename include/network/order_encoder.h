@@ -0,0 +1,40 @@
+#pragma once
+
+#include "network/tcp_sender.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace hft {
+
+// One encoded order-entry message
+// data points into encoder-owned memory and stays valid until the next
+// encode call of the same kind; len == 0 means it could not be encoded.
+struct EncodedMessage {
+    const char* data;
+    size_t len;
+};
+
+// Venue order-entry protocol behind TCPSender
+// Backends:
+// - OuchEncoder: NASDAQ OUCH 4.2 over SoupBinTCP
+// - FIX / SBE: same interface, not implemented yet
+// Messages are pre-encoded per symbol and side at startup (add_symbol);
+// the encode calls only patch the per-order fields in place. Encoders are
+// driven by the thread that sends orders.
+class OrderEncoder {
+public:
+    virtual ~OrderEncoder() = default;
+
+    virtual const char* name() const noexcept = 0;
+
+    // Build the templates of an instrument (startup, not the hot path)
+    virtual bool add_symbol(const char* symbol) = 0;
+
+    // New order; len 0 if the symbol was never added
+    virtual EncodedMessage encode_new(const Order& order) = 0;
+
+    virtual EncodedMessage encode_replace(const ReplaceRequest& request) = 0;
+    virtual EncodedMessage encode_cancel(const CancelRequest& request) = 0;
+};
+
+} // namespace hft
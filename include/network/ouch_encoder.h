@@ -0,0 +1,80 @@
+#pragma once
+
+#include "network/order_encoder.h"
+#include <vector>
+
+namespace hft {
+
+// NASDAQ OUCH 4.2 order entry, framed as SoupBinTCP unsequenced data
+// packets (2-byte length, 'U', message).
+//
+// Enter Order templates exist per symbol and side with every static field
+// (stock, side, firm, display, capacity, ...) already encoded; encode_new()
+// patches the order token, shares, price and time in force. Prices are
+// integer 1/10000 units (bits::CompactPrice), numbers big-endian.
+//
+// Order tokens are the prefix followed by the order ID as 12 hex digits,
+// so IDs must stay below 2^48. OUCH carries no client timestamp; the
+// order's timestamp is not sent.
+//
+// Responses still come back as ExecutionReport frames: decoding OUCH
+// outbound messages belongs with a SoupBinTCP session layer (login,
+// heartbeats), which this tree does not have yet.
+class OuchEncoder final : public OrderEncoder {
+public:
+    static constexpr size_t ENTER_ORDER_SIZE = 49;
+    static constexpr size_t REPLACE_ORDER_SIZE = 47;
+    static constexpr size_t CANCEL_ORDER_SIZE = 19;
+    static constexpr size_t SOUP_HEADER_SIZE = 3;      // Length + packet type
+    static constexpr size_t TOKEN_SIZE = 14;
+    static constexpr double PRICE_TICK = 0.0001;
+    static constexpr uint32_t MARKET_PRICE = 2000000000;  // $200,000.0000
+    static constexpr uint32_t TIF_DAY = 99999;         // Until market close
+    static constexpr uint32_t TIF_IOC = 0;
+
+    struct Options {
+        char token_prefix[3] = "HF";   // 2 characters, unique per session
+        char firm[5] = "";             // MPID, blank = port default
+        char display = 'Y';            // 'Y' displayed, 'N' hidden, ...
+        char capacity = 'P';           // 'A' agency, 'P' principal, 'R' riskless
+        char intermarket_sweep = 'N';
+        char cross_type = 'N';         // 'N' continuous market
+        char customer_type = ' ';      // ' ' port default
+        uint32_t minimum_quantity = 0;
+    };
+
+    OuchEncoder() : OuchEncoder(Options{}) {}
+    explicit OuchEncoder(const Options& options);
+
+    const char* name() const noexcept override { return "ouch42"; }
+
+    bool add_symbol(const char* symbol) override;
+
+    EncodedMessage encode_new(const Order& order) override;
+    EncodedMessage encode_replace(const ReplaceRequest& request) override;
+    EncodedMessage encode_cancel(const CancelRequest& request) override;
+
+    size_t symbols() const { return symbols_.size(); }
+
+private:
+    // One framed message, padded to a cache line
+    struct alignas(64) Frame {
+        char bytes[64];
+    };
+
+    struct SymbolTemplates {
+        uint64_t stock;            // Stock field (8 chars, space padded) as a key
+        Frame enter[2];            // Indexed by Order::Side
+    };
+
+    Options options_;
+    std::vector<SymbolTemplates> symbols_;
+    Frame replace_;
+    Frame cancel_;
+
+    void write_token(char* out, uint64_t order_id) const;
+    static uint32_t encode_price(double price);
+    static uint32_t encode_shares(double quantity);
+};
+
+} // namespace hft
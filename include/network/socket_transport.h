@@ -0,0 +1,74 @@
+#pragma once
+
+#include "network/transport.h"
+#include "common/huge_pages.h"
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace hft {
+
+// Kernel UDP socket transport (default backend)
+// All sockets are non-blocking. receive() waits in a level-triggered
+// epoll (timeout > 0) or sweeps every socket (timeout 0), and drains each
+// ready socket with recvmmsg into a pre-registered ring of aligned slots.
+// With timestamping enabled each slot also gets a control buffer for the
+// SO_TIMESTAMPING message, parsed into RxPacket::rx_timestamp_ns.
+class SocketTransport : public Transport {
+public:
+    static constexpr size_t MAX_BATCH = 64;
+    static constexpr size_t DATAGRAM_SIZE = 9216; // Jumbo frame payload, 64B multiple
+    static constexpr size_t CONTROL_SIZE = 128;   // Per-slot cmsg space (scm_timestamping)
+
+    struct Options {
+        size_t batch_size = 16;   // Ring slots = most packets per receive()
+        int busy_poll_us = 0;     // SO_BUSY_POLL, 0 = off
+        int incoming_cpu = -1;    // SO_INCOMING_CPU, -1 = off
+        RxTimestamping timestamping = RxTimestamping::NONE;
+    };
+
+    SocketTransport();
+    explicit SocketTransport(const Options& options);
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    const char* name() const noexcept override { return "socket"; }
+
+    int open_multicast(const std::string& group, uint16_t port) override;
+    int open_unicast(const std::string& ip, uint16_t port) override;
+    bool start() override;
+    int receive(RxPacket* packets, size_t max, int timeout_ms) override;
+    bool send(int source, const char* data, size_t len) override;
+    void close() override;
+
+    uint64_t syscalls() const noexcept override { return syscalls_; }
+
+    // Socket behind a source (-1 if unknown)
+    int fd(int source) const;
+
+private:
+    Options options_;
+    std::vector<int> fds_;      // Indexed by source id
+    int epoll_fd_ = -1;
+    uint64_t syscalls_ = 0;
+
+    // options_.batch_size * DATAGRAM_SIZE; message headers point into it
+    // once and are reused by every call
+    HugePageBuffer ring_;
+#ifdef __linux__
+    std::vector<struct mmsghdr> msgs_;
+#endif
+    std::vector<struct iovec> iovecs_;
+    std::vector<char> control_;  // CONTROL_SIZE per slot when timestamping
+
+    // Apply socket optimizations
+    void optimize_socket(int fd);
+
+    // Drain one socket into ring slots [filled, capacity)
+    // Returns packets added, -1 on a socket error
+    int drain(uint32_t source, RxPacket* packets, size_t filled, size_t capacity);
+};
+
+} // namespace hft
@@ -4,12 +4,15 @@
 #include <cstdint>
 #include <atomic>
 #include <thread>
-#include <queue>
-#include <mutex>
+#include <functional>
+#include <memory>
+#include <vector>
 #include <sys/socket.h>
 
 namespace hft {
 
+class OrderEncoder;
+
 // Order message structure
 struct Order {
     enum class Side : uint8_t {
@@ -29,43 +32,182 @@ struct Order {
     Type type;
     double price;
     double quantity;
+    uint64_t timestamp;   // Wire receive time of the market data that triggered
+                          // the order (CLOCK_REALTIME ns)
+} __attribute__((packed));
+
+// Cancel and cancel/replace requests for a resting order. The leading
+// type byte follows OUCH ('X' cancel, 'U' replace).
+struct CancelRequest {
+    char type = 'X';
+    uint64_t order_id;
+} __attribute__((packed));
+
+struct ReplaceRequest {
+    char type = 'U';
+    uint64_t order_id;          // Order being replaced
+    uint64_t new_order_id;      // ID of the order once replaced
+    double price;
+    double quantity;            // New open quantity
     uint64_t timestamp;
 } __attribute__((packed));
 
+// Gateway response, fixed-size binary frames on the order connection
+struct ExecutionReport {
+    enum class Type : uint8_t {
+        ACK = 0,         // Order (or replace, under the new ID) accepted
+        REJECT = 1,      // Order refused, see reason
+        FILL = 2,        // (Partial) execution
+        CANCELED = 3     // Order removed from the book
+    };
+    
+    Type type;
+    uint8_t reason;            // REJECT: venue reason code
+    uint64_t order_id;
+    double price;              // FILL: execution price
+    double quantity;           // FILL: executed quantity
+    double leaves_quantity;    // Quantity still open after this report
+    uint64_t timestamp;        // Gateway time (CLOCK_REALTIME ns)
+} __attribute__((packed));
+
 // TCP sender for order submission
-// Uses optimizations for low-latency order placement
+// - Non-blocking socket, orders are copied into a preallocated byte ring
+// - Orders queued between begin_batch() and flush() leave in one sendmsg
+//   (one iovec per contiguous ring segment)
+// - Short writes and EAGAIN keep the unsent bytes queued; the reader thread
+//   finishes them when the socket turns writable. A full ring refuses the
+//   order instead of dropping part of it.
+// - A pinned reader thread decodes execution reports from the gateway
+// - With an OrderEncoder set, orders go out in the venue protocol (e.g.
+//   OUCH); without one the structs below are sent as they are
+//
+// Orders are queued from one thread (the strategy); flushing is shared with
+// the reader thread through a try-lock flag.
 class TCPSender {
 public:
+    // How the reader thread waits for gateway data
+    enum class WaitMode : uint8_t {
+        EPOLL,       // epoll_wait with a short timeout
+        BUSY_POLL    // Non-blocking recv in a loop, never sleeps
+    };
+    
+    static constexpr size_t RING_SIZE = 1 << 20;   // Outbound bytes, power of 2
+    
+    using ExecutionCallback = std::function<void(const ExecutionReport&)>;
+    
     TCPSender(const std::string& host, uint16_t port);
     ~TCPSender();
     
     // Connect to order gateway
     bool connect();
     
-    // Disconnect
+    // Disconnect (stops the reader)
     void disconnect();
     
     // Send order (critical path - must be fast!)
+    // Sent immediately unless a batch is open. False if not connected or
+    // the ring has no room (back-pressure); nothing is partially queued.
     bool send_order(const Order& order);
     
+    // Cancel / amend a resting order, same rules as send_order
+    bool send_cancel(const CancelRequest& request);
+    bool send_replace(const ReplaceRequest& request);
+    
+    // Venue protocol, before connect()
+    void set_encoder(std::unique_ptr<OrderEncoder> encoder);
+    OrderEncoder* encoder() const { return encoder_.get(); }
+    
+    // Queue raw bytes, same rules as send_order
+    bool send_bytes(const void* data, size_t len);
+    
+    // Coalesce everything queued until flush() into one write
+    void begin_batch() { batching_ = true; }
+    void flush();
+    
     // Enable TCP optimizations
     void enable_tcp_optimizations();
     
-    // Set CPU affinity
+    // Set CPU affinity (applied to the reader thread)
     void set_cpu_affinity(int cpu);
     
+    // SCHED_FIFO priority of the reader thread (0 = not real-time)
+    void set_realtime_priority(int priority) { realtime_priority_ = priority; }
+    
+    void set_wait_mode(WaitMode mode) { wait_mode_ = mode; }
+    
+    // Execution reports, called on the reader thread. Set before start_reader().
+    void set_execution_callback(ExecutionCallback callback) { execution_callback_ = std::move(callback); }
+    
+    // Reader thread for acks, rejects and fills (after connect())
+    void start_reader();
+    void stop_reader();
+    
     // Get connection status
     bool is_connected() const { return connected_.load(std::memory_order_acquire); }
     
+    // Warm-up: orders are encoded and queued as usual, then dropped instead
+    // of written (no connection needed) and answered at once through the
+    // execution callback, ACK for orders and replaces, CANCELED for cancels
+    // and IOC orders. Not counted in orders_sent(). Switch while no order
+    // is being sent.
+    void set_loopback(bool enabled) { loopback_ = enabled; }
+    bool loopback() const { return loopback_; }
+    
+    // Bytes queued but not yet accepted by the kernel
+    size_t pending_bytes() const {
+        return static_cast<size_t>(tail_.load(std::memory_order_acquire) -
+                                   head_.load(std::memory_order_acquire));
+    }
+    
+    // Counters (relaxed, readable from any thread)
+    uint64_t orders_sent() const { return orders_sent_.load(std::memory_order_relaxed); }
+    uint64_t send_syscalls() const { return send_syscalls_.load(std::memory_order_relaxed); }
+    uint64_t reports_received() const { return reports_received_.load(std::memory_order_relaxed); }
+
 private:
     std::string host_;
     uint16_t port_;
     int socket_fd_ = -1;
+    int epoll_fd_ = -1;
     std::atomic<bool> connected_{false};
     int cpu_affinity_ = -1;
+    int realtime_priority_ = 0;
+    bool loopback_ = false;
+    WaitMode wait_mode_ = WaitMode::EPOLL;
+    bool batching_ = false;
+    std::unique_ptr<OrderEncoder> encoder_;
+    
+    // Outbound ring: producer advances tail_, the flag holder advances head_
+    std::unique_ptr<char[]> ring_;
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> head_{0};
+    std::atomic<bool> flushing_{false};
+    bool write_armed_ = false;         // EPOLLOUT registered (flag holder only)
+    
+    alignas(64) std::atomic<uint64_t> orders_sent_{0};
+    std::atomic<uint64_t> send_syscalls_{0};
+    std::atomic<uint64_t> reports_received_{0};
+    
+    // Reader
+    ExecutionCallback execution_callback_;
+    std::vector<char> rx_buffer_;
+    size_t rx_length_ = 0;
+    std::atomic<bool> reading_{false};
+    std::thread reader_thread_;
     
     // Setup socket with low-latency options
     void optimize_socket();
+    
+    // Write queued bytes until done or the socket pushes back
+    void try_flush();
+    bool write_pending();
+    void arm_write(bool armed);
+    
+    void reader_loop();
+    bool read_reports();
+    
+    // Loopback mode: answer a request the way a venue would
+    void loopback_report(ExecutionReport::Type type, uint64_t order_id, double quantity);
 };
 
 } // namespace hft
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hft {
+
+// One received datagram payload
+// Zero-copy: data points into transport-owned memory (socket ring, AF_XDP
+// UMEM frame) and stays valid until the next receive() on the transport.
+struct RxPacket {
+    const char* data;
+    uint32_t len;
+    uint32_t source;            // Id returned by open_multicast()/open_unicast()
+    uint64_t rx_timestamp_ns;   // Receive time, CLOCK_REALTIME ns (0 = not captured)
+};
+
+// Where receive timestamps come from
+enum class RxTimestamping : uint8_t {
+    NONE,        // No timestamps
+    SOFTWARE,    // Kernel stamp when the driver hands over the packet
+    HARDWARE     // NIC stamp (interface must have RX stamping enabled),
+                 // software stamp when the NIC gave none
+};
+
+// Receive path behind UDPReceiver
+// Backends:
+// - SocketTransport: kernel UDP sockets, recvmmsg batches (default)
+// - XdpTransport: AF_XDP socket, frames straight from the NIC queue
+// A transport is driven by a single thread; sources are opened before
+// start() and live until close().
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual const char* name() const noexcept = 0;
+
+    // Join a multicast group and receive its datagrams
+    // Returns the source id, -1 on failure
+    virtual int open_multicast(const std::string& group, uint16_t port) = 0;
+
+    // Request/response endpoint (e.g. a retransmission server)
+    // Returns the source id, -1 on failure
+    virtual int open_unicast(const std::string& ip, uint16_t port) = 0;
+
+    // Called once all sources are open
+    virtual bool start() { return true; }
+
+    // Receive up to max packets from any source. With timeout_ms > 0 waits
+    // up to that long when nothing is pending, 0 never blocks.
+    // Releases the packets of the previous call.
+    // Returns the number of packets, -1 on a fatal error.
+    virtual int receive(RxPacket* packets, size_t max, int timeout_ms) = 0;
+
+    // Send a datagram on a unicast source
+    virtual bool send(int source, const char* data, size_t len) = 0;
+
+    virtual void close() = 0;
+
+    // Kernel crossings made so far (receive, wakeup and wait calls)
+    virtual uint64_t syscalls() const noexcept { return 0; }
+};
+
+} // namespace hft
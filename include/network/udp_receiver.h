@@ -1,22 +1,53 @@
 #pragma once
 
 #include "market_data/market_data_handler.h"
+#include "market_data/feed_arbitrator.h"
+#include "market_data/feed_journal.h"
+#include "network/transport.h"
+#include "common/timestamp.h"
+#include "common/tick_to_trade.h"
 #include <atomic>
+#include <memory>
+#include <string>
 #include <thread>
-#include <sys/socket.h>
-#include <netinet/in.h>
+#include <vector>
 
 namespace hft {
 
 // UDP receiver for market data
 // Uses kernel bypass techniques for low latency
+// - One pinned thread serves any number of channels (multicast groups or
+//   ports), waiting on all of them or busy polling
+// - Packets come from a pluggable Transport: kernel sockets drained with
+//   recvmmsg (default) or an AF_XDP socket fed straight by the NIC
+// - For sequenced feeds (ITCH 5.0 over MoldUDP64) each channel has its own
+//   FeedArbitrator: an optional B line is merged with the A line and gaps
+//   are recovered from the MoldUDP64 rerequest server
+// - Optional capture: every packet handed to the MarketDataHandler is
+//   appended to a FeedJournalWriter with its receive time, so FeedReplayer
+//   can feed the exact same input back later
 class UDPReceiver {
 public:
-    UDPReceiver(MarketDataHandler& handler, 
+    // How the receiver thread waits for data
+    enum class WaitMode : uint8_t {
+        EPOLL,       // epoll_wait with a short timeout, sleeps when idle
+        BUSY_POLL    // Non-blocking receive sweeps over every socket, never sleeps
+    };
+    
+    static constexpr size_t MAX_BATCH = 64;
+    static constexpr size_t DEFAULT_BATCH = 16;
+    
+    // Channel 0 is the given group
+    UDPReceiver(MarketDataHandler& handler,
                 const std::string& multicast_ip,
                 uint16_t port);
     ~UDPReceiver();
     
+    // Serve another multicast group/port from the same thread, with its own
+    // sequencing state. Returns the channel index. Call before start().
+    size_t add_channel(const std::string& multicast_ip, uint16_t port);
+    size_t channel_count() const { return channels_.size(); }
+    
     // Start receiving (spawns dedicated thread)
     void start();
     
@@ -26,27 +57,115 @@ public:
     // Set CPU affinity for receiver thread
     void set_cpu_affinity(int cpu);
     
+    // SCHED_FIFO priority of the receiver thread (0 = not real-time)
+    void set_realtime_priority(int priority) { realtime_priority_ = priority; }
+    
     // Enable kernel bypass optimizations
     void enable_kernel_bypass();
     
+    // Datagrams drained per receive call (1..MAX_BATCH), before start()
+    void set_batch_size(size_t datagrams);
+    size_t batch_size() const { return batch_size_; }
+    
+    // Receive backend, before start(). Defaults to a SocketTransport
+    // configured from batch size, kernel bypass and CPU affinity.
+    void set_transport(std::unique_ptr<Transport> transport) { transport_ = std::move(transport); }
+    
+    // Stamp every datagram on arrival (default SocketTransport only) and
+    // hand the stamp to MarketDataHandler with the packet. Packets replayed
+    // after a gap carry the stamp of the packet that completed it.
+    void set_rx_timestamping(RxTimestamping mode) { timestamping_ = mode; }
+    const Transport* transport() const { return transport_.get(); }
+    
+    // Capture journal, before start(). Packets are recorded as the handler
+    // gets them: after A/B arbitration and gap fill, one copy each.
+    // Unstamped packets get the time they were dispatched.
+    void set_capture(std::unique_ptr<FeedJournalWriter> journal) { capture_ = std::move(journal); }
+    const FeedJournalWriter* capture() const { return capture_.get(); }
+    
+    // Tick-to-trade stages of the receiver thread (inline trading), before
+    // start(). The histograms must outlive the thread; read them from any
+    // thread.
+    void set_latency_stages(TickToTrade::Histograms* histograms) { latency_stages_ = histograms; }
+    
+    void set_wait_mode(WaitMode mode) { wait_mode_ = mode; }
+    WaitMode wait_mode() const { return wait_mode_; }
+    
+    // Second multicast line carrying the same packets (A/B arbitration)
+    void set_line_b(const std::string& multicast_ip, uint16_t port, size_t channel = 0);
+    
+    // MoldUDP64 rerequest server for gap retransmissions
+    void set_recovery_server(const std::string& ip, uint16_t port, size_t channel = 0);
+    
+    // Sequencing state, e.g. to install a snapshot callback before start()
+    FeedArbitrator& arbitrator(size_t channel = 0) { return *channels_[channel].arbitrator; }
+    
+    // Receive counters (relaxed, readable from any thread)
+    uint64_t datagrams_received() const { return datagrams_.load(std::memory_order_relaxed); }
+    uint64_t receive_calls() const { return receive_calls_.load(std::memory_order_relaxed); }
+
 private:
+    struct Channel {
+        std::string multicast_ip;
+        uint16_t port = 0;
+        std::string line_b_ip;
+        uint16_t line_b_port = 0;
+        std::string recovery_ip;
+        uint16_t recovery_port = 0;
+        std::unique_ptr<FeedArbitrator> arbitrator;
+    };
+    
+    // What a transport source id carries
+    struct Source {
+        uint32_t channel;
+        FeedArbitrator::Line line;
+    };
+    
     MarketDataHandler& handler_;
-    std::string multicast_ip_;
-    uint16_t port_;
-    int socket_fd_ = -1;
+    std::vector<Channel> channels_;
+    std::vector<Source> sources_;      // Indexed by transport source id
+    std::unique_ptr<Transport> transport_;
+    RxTimestamping timestamping_ = RxTimestamping::NONE;
+    uint64_t rx_timestamp_ns_ = 0;     // Of the packet being dispatched
+    std::unique_ptr<FeedJournalWriter> capture_;
+    TickToTrade::Histograms* latency_stages_ = nullptr;
+    
+    size_t batch_size_ = DEFAULT_BATCH;
+    WaitMode wait_mode_ = WaitMode::EPOLL;
+    
+    std::atomic<uint64_t> datagrams_{0};
+    std::atomic<uint64_t> receive_calls_{0};
+    
     std::atomic<bool> running_{false};
     std::thread receiver_thread_;
     int cpu_affinity_ = -1;
+    int realtime_priority_ = 0;
     bool kernel_bypass_enabled_ = false;
     
     // Main receive loop (runs in dedicated thread)
     void receive_loop();
     
-    // Setup socket with low-latency options
+    // Hand a packet to the handler (and the capture journal)
+    void dispatch(const char* data, size_t len, uint64_t rx_timestamp_ns) {
+        if (__builtin_expect(capture_ != nullptr, 0)) {
+            capture_->append(data, len, rx_timestamp_ns ? rx_timestamp_ns : Timestamp::fast_wall_clock_ns());
+        }
+        handler_.process_message(data, len, rx_timestamp_ns);
+    }
+    
+    // Open every channel's lines and recovery endpoint on the transport
     bool setup_socket();
     
-    // Apply socket optimizations
-    void optimize_socket();
+    // Register a transport source id (false if open failed)
+    bool add_source(int id, uint32_t channel, FeedArbitrator::Line line);
+    
+    // Send a MoldUDP64 request packet for count messages from sequence
+    void send_retransmit_request(int source, const char* session, uint64_t sequence, uint16_t count);
+    
+    // Recovery timers of channels with an open gap
+    void poll_recovery(uint64_t now_ns);
+    
+    void close_sockets();
 };
 
 } // namespace hft
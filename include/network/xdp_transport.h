@@ -0,0 +1,164 @@
+#pragma once
+
+#include "network/transport.h"
+#include "network/socket_transport.h"
+#include "market_data/feed_decoder.h"
+#include "common/huge_pages.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace hft {
+
+// Locate the UDP payload in a raw Ethernet frame
+// Accepts Ethernet II with at most one 802.1Q tag, IPv4 (with options,
+// unfragmented) and UDP. dst_ip/dst_port are returned in host order.
+inline bool parse_udp_frame(const char* frame, size_t len,
+                            uint32_t& dst_ip, uint16_t& dst_port,
+                            const char*& payload, size_t& payload_len) noexcept {
+    constexpr size_t ETH_HEADER = 14;
+    constexpr size_t VLAN_TAG = 4;
+    constexpr size_t UDP_HEADER = 8;
+
+    if (len < ETH_HEADER + 20 + UDP_HEADER) {
+        return false;
+    }
+
+    size_t offset = 12;
+    uint16_t ether_type = feed::read_be16(frame + offset);
+    if (ether_type == 0x8100) {
+        offset += VLAN_TAG;
+        ether_type = feed::read_be16(frame + offset);
+    }
+    if (ether_type != 0x0800) {
+        return false;
+    }
+    offset += 2;
+
+    const auto* ip = reinterpret_cast<const uint8_t*>(frame + offset);
+    size_t ip_header = (ip[0] & 0x0F) * 4u;
+    if ((ip[0] >> 4) != 4 || ip_header < 20 || ip[9] != 17 /* UDP */ ||
+        offset + ip_header + UDP_HEADER > len) {
+        return false;
+    }
+
+    // More-fragments flag or a fragment offset: not a whole datagram
+    if (((ip[6] & 0x3F) | ip[7]) != 0) {
+        return false;
+    }
+
+    dst_ip = feed::read_be32(frame + offset + 16);
+    offset += ip_header;
+
+    dst_port = feed::read_be16(frame + offset + 2);
+    size_t udp_len = feed::read_be16(frame + offset + 4);
+    if (udp_len < UDP_HEADER || offset + udp_len > len) {
+        return false;
+    }
+
+    payload = frame + offset + UDP_HEADER;
+    payload_len = udp_len - UDP_HEADER;
+    return true;
+}
+
+// AF_XDP kernel-bypass transport
+// Frames are DMA'd by the NIC into a UMEM area shared with the kernel and
+// handed out as RxPacket pointers into that area: no copy between the wire
+// and MarketDataHandler::process_message. Frames go back to the fill ring
+// on the next receive().
+//
+// Needs an XDP program on the interface that redirects the feed traffic
+// of the queue into an XSKMAP pinned in bpffs (see docs/TUNING.md); this
+// transport inserts its socket into that map. Multicast groups are still
+// joined with a regular socket so IGMP keeps the switch forwarding them.
+// Unicast sources (retransmission requests) go through a SocketTransport.
+class XdpTransport : public Transport {
+public:
+    struct Options {
+        std::string interface;                            // e.g. "ens1f0"
+        uint32_t queue = 0;                               // NIC RX queue bound to the socket
+        std::string xskmap_path = "/sys/fs/bpf/xsks_map"; // Pinned XSKMAP
+        uint32_t frame_count = 4096;                      // UMEM frames, power of 2
+        uint32_t frame_size = 2048;                       // Power of 2 (2048 or 4096)
+        bool zero_copy = true;                            // Fall back to copy mode if unsupported
+        size_t batch_size = 64;                           // Most packets per receive()
+    };
+
+    explicit XdpTransport(const Options& options);
+    ~XdpTransport() override;
+
+    XdpTransport(const XdpTransport&) = delete;
+    XdpTransport& operator=(const XdpTransport&) = delete;
+
+    const char* name() const noexcept override { return "af_xdp"; }
+
+    int open_multicast(const std::string& group, uint16_t port) override;
+    int open_unicast(const std::string& ip, uint16_t port) override;
+    bool start() override;
+    int receive(RxPacket* packets, size_t max, int timeout_ms) override;
+    bool send(int source, const char* data, size_t len) override;
+    void close() override;
+
+    uint64_t syscalls() const noexcept override { return syscalls_ + control_.syscalls(); }
+
+    // True once bound with XDP_ZEROCOPY (false: kernel copy mode)
+    bool zero_copy() const noexcept { return zero_copy_active_; }
+
+    // Frames that reached the socket but matched no source
+    uint64_t unmatched_frames() const noexcept { return unmatched_; }
+
+private:
+    // Single producer/consumer ring shared with the kernel
+    struct Ring {
+        uint32_t* producer = nullptr;
+        uint32_t* consumer = nullptr;
+        uint32_t* flags = nullptr;
+        void* descs = nullptr;
+        uint32_t mask = 0;
+        void* map = nullptr;
+        size_t map_len = 0;
+    };
+
+    // Feed a source receives: destination group and port (host order)
+    struct Filter {
+        uint32_t ip;
+        uint16_t port;
+        uint32_t source;
+    };
+
+    // A source is either a filter on the XDP socket or a control socket
+    struct SourceEntry {
+        bool unicast;
+        int control_source;
+    };
+
+    Options options_;
+    int xsk_fd_ = -1;
+    HugePageBuffer umem_;
+    Ring rx_;
+    Ring fill_;
+    Ring completion_;
+    bool zero_copy_active_ = false;
+
+    std::vector<Filter> filters_;
+    std::vector<SourceEntry> sources_;
+    std::vector<int> membership_fds_;     // IGMP joins only, never read
+    std::vector<uint32_t> control_map_;   // Control source -> our source id
+    SocketTransport control_;
+
+    std::vector<uint64_t> held_;          // Frames handed out by the last receive()
+    uint64_t syscalls_ = 0;
+    uint64_t unmatched_ = 0;
+
+    bool setup_umem();
+    bool setup_rings();
+    bool bind_socket();
+    bool register_xskmap();
+
+    // Return frames to the kernel for reuse
+    void refill(const uint64_t* addrs, size_t count);
+
+    void unmap_ring(Ring& ring);
+};
+
+} // namespace hft
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "market_data/feed_journal.h"
+#include "market_data/market_data_handler.h"
+#include "trading/exchange_simulator.h"
+#include "trading/order_manager.h"
+#include "trading/strategy.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hft {
+
+// MarketMakingStrategy backtests over a captured feed
+//
+// A run builds its own handler, order manager, ExchangeSimulator and one
+// strategy per symbol, then replays the journal through them as fast as
+// the thread goes, on the capture's clock: book updates reach the venue
+// (fills of resting orders) and then the strategies, whose orders and
+// the venue's reports take the configured latencies.
+//
+// Runs share nothing but the read-only journal, so sweep() spreads
+// independent parameter sets over worker threads, one per core. A run's
+// result depends only on the journal and its parameters, except for the
+// order rate limit: it runs on the TSC, not on the feed, so runs leave it
+// open (the strategies pace their quotes on feed time).
+class Backtest {
+public:
+    struct Setup {
+        std::vector<std::string> symbols;
+        FeedProtocol feed_protocol = FeedProtocol::SIMPLE;
+        OrderManager::RiskLimits risk_limits;
+        ExchangeSimulator::Options venue;
+    };
+
+    // Strategy parameters of one run, one entry per symbol quoted
+    using ParameterSet = std::vector<MarketMakingStrategy::Parameters>;
+
+    struct Result {
+        double pnl = 0;                 // Marked to the last mid, all symbols
+        double max_drawdown = 0;        // Largest fall of pnl from its peak
+        double position = 0;            // Net at the end, all symbols
+        uint64_t orders = 0;            // Accepted by the venue
+        uint64_t fills = 0;
+        double filled_quantity = 0;
+        uint64_t packets = 0;
+        uint64_t elapsed_ns = 0;        // Wall time of the run
+    };
+
+    Backtest(const FeedJournalReader& journal, const Setup& setup);
+
+    // One run on the calling thread
+    Result run(const ParameterSet& parameters) const;
+
+    // Every set on up to threads workers (pinned to first_cpu, first_cpu + 1,
+    // ... when first_cpu >= 0); results in the order of sets
+    std::vector<Result> sweep(const std::vector<ParameterSet>& sets, size_t threads,
+                              int first_cpu = -1) const;
+
+private:
+    const FeedJournalReader& journal_;
+    Setup setup_;
+};
+
+} // namespace hft
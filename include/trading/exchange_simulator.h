@@ -0,0 +1,144 @@
+#pragma once
+
+#include "market_data/market_data_handler.h"
+#include "trading/order_manager.h"
+#include "common/hashmap.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace hft {
+
+// In-process venue for backtests, in place of the order gateway
+//
+// Takes the OrderManager's requests from its command queue (the same path
+// a TradingPipeline sender stage uses) and answers with execution reports
+// applied straight to the OrderManager. Both directions have a fixed
+// latency on the feed's clock: a request queued at feed time t reaches the
+// matching engine at t + order_latency_ns, its reports reach the order
+// manager report_latency_ns later.
+//
+// Our orders never enter the replayed book; matching is against it:
+// - An order that crosses the touch on arrival takes the opposite side at
+//   the touch (size up to the displayed quantity), the rest rests
+// - A resting order queues behind the displayed quantity at its price.
+//   The queue ahead only shrinks: to the level quantity when the level
+//   drops below it, to nothing when the level empties or we improve it
+// - Trade prints against our side fill us at our price if they traded
+//   through it. A print at our price fills only what it traded beyond the
+//   queue we had before the book update that reported the execution (the
+//   feed publishes that update first)
+// - A book that crosses a resting order fills it, up to the displayed
+//   opposite quantity
+// A replace keeps the queue position only when it keeps the price and does
+// not add quantity.
+//
+// Single thread: the one replaying the feed and running the strategies.
+class ExchangeSimulator {
+public:
+    struct Options {
+        uint64_t order_latency_ns = 20000;      // Strategy -> matching engine
+        uint64_t report_latency_ns = 20000;     // Matching engine -> order manager
+    };
+
+    // Venue reject reasons
+    static constexpr uint8_t REJECT_UNKNOWN_SYMBOL = 1;
+    static constexpr uint8_t REJECT_UNKNOWN_ORDER = 2;
+
+    struct Stats {
+        uint64_t orders = 0;                    // New orders accepted
+        uint64_t replaces = 0;
+        uint64_t cancels = 0;
+        uint64_t rejects = 0;
+        uint64_t fills = 0;
+        double filled_quantity = 0;
+        double filled_notional = 0;
+    };
+
+    // Installs itself as the order manager's command queue
+    ExchangeSimulator(MarketDataHandler& handler, OrderManager& order_manager, const Options& options);
+    ~ExchangeSimulator();
+
+    ExchangeSimulator(const ExchangeSimulator&) = delete;
+    ExchangeSimulator& operator=(const ExchangeSimulator&) = delete;
+
+    // Feed events, with the book already updated
+    void on_book(const OrderBook& book, const OrderBook::Top& top);
+    void on_trade(const OrderBook& book, const TradePrint& trade);
+
+    // Take the requests queued since the last call (sent now)
+    void collect();
+
+    // Move the venue clock to now_ns (feed time): requests and reports due
+    // by then take effect, in order
+    void advance(uint64_t now_ns);
+
+    uint64_t now() const { return now_ns_; }
+
+    // Requests and reports still in flight
+    size_t in_flight() const { return requests_.size() + reports_.size(); }
+
+    // Resting orders on the simulated venue
+    size_t resting_orders() const { return ids_.size(); }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Resting {
+        uint64_t order_id;
+        Order::Side side;
+        double price;
+        double leaves;
+        double queue_ahead;                     // Displayed quantity before us
+        double queue_before;                    // queue_ahead before the last book update
+    };
+
+    template<typename T>
+    struct Timed {
+        uint64_t due_ns;
+        T item;
+    };
+
+    MarketDataHandler& handler_;
+    OrderManager& order_manager_;
+    Options options_;
+    uint64_t now_ns_ = 0;
+    Stats stats_;
+
+    std::unique_ptr<OrderManager::CommandQueue> commands_;
+    std::deque<Timed<OrderCommand>> requests_;
+    std::deque<Timed<ExecutionReport>> reports_;
+
+    // Resting orders per routed book (BookSubscribers::slot), in priority
+    // order per side: best price first, then arrival
+    struct Book {
+        const OrderBook* book = nullptr;
+        std::vector<Resting> orders;
+    };
+    std::vector<Book> books_;
+    FlatHashMap<uint64_t, uint32_t> ids_;       // Order ID -> book slot
+    uint64_t match_ns_ = 0;                     // Venue time of the event being matched
+
+    void execute(const OrderCommand& command);
+    void on_new(const Order& order);
+    void on_replace(const ReplaceRequest& request);
+    void on_cancel(const CancelRequest& request);
+
+    // Match an arriving order, then rest what is left of it (limit orders)
+    void enter(Book& book, uint32_t slot, Resting order, bool rest);
+    void insert(Book& book, uint32_t slot, const Resting& order);
+    void fill(Resting& order, double quantity, double price);
+    void report(ExecutionReport::Type type, uint64_t order_id, double price, double quantity,
+                double leaves, uint8_t reason = 0);
+
+    Book* book_of(const OrderBook& book);
+    Resting* find(uint64_t order_id, uint32_t& slot);
+    void remove(uint32_t slot, uint64_t order_id);
+
+    static double displayed_at(const OrderBook& book, Order::Side side, double price);
+    static bool better(Order::Side side, double a, double b);     // a has priority over b
+    static bool same_price(double a, double b);
+};
+
+} // namespace hft
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "common/symbol_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hft {
+
+// Basket fair values kept up to date one constituent tick at a time
+//
+// A basket (an ETF against its constituents, a future against spot) is
+// traded as its own instrument and valued as cash + sum(weight[i] *
+// price[i]) over its components. Instruments (components and basket
+// instruments alike) get dense indexes. The weight matrix is stored sparse
+// both ways: per instrument (compressed columns: each basket holding it,
+// its weight and its slot in that basket's row, read on every tick) and
+// per basket (compressed rows of weights and prices, padded to whole AVX2
+// vectors). A tick writes its price into its row slots, so recomputing a
+// basket is a contiguous dot product, not a gather across all prices.
+//
+// on_price() applies weight * (new - old price) to the affected baskets
+// only, so a tick costs O(baskets holding the instrument), not O(basket
+// size). Incremental sums drift from rounding; every recompute_interval
+// ticks the next basket in turn is recomputed from its row, and
+// recompute() redoes them all.
+//
+// A basket's spread is its market price against its fair value, in bps of
+// the fair value; a signal is raised when it moves beyond +/-threshold or
+// comes back inside, once per change. Baskets stay silent until every
+// component and the basket instrument have a price.
+//
+// Set up (add_basket, add_component, finalize) before the first price;
+// then from one thread.
+class FairValueEngine {
+public:
+    static constexpr uint32_t NO_INDEX = UINT32_MAX;
+    static constexpr uint32_t DEFAULT_RECOMPUTE_INTERVAL = 4096;
+
+    struct Signal {
+        uint32_t basket;
+        int32_t side;           // +1 market rich (above fair), -1 cheap, 0 back inside
+        double market_price;
+        double fair_value;
+        double spread_bps;      // (market - fair) / fair
+    };
+
+    explicit FairValueEngine(size_t max_instruments = 1024,
+                             uint32_t recompute_interval = DEFAULT_RECOMPUTE_INTERVAL);
+
+    FairValueEngine(const FairValueEngine&) = delete;
+    FairValueEngine& operator=(const FairValueEngine&) = delete;
+
+    // New basket traded as symbol, NO_INDEX if the instruments are full
+    // or symbol is already a basket
+    uint32_t add_basket(const std::string& symbol, double threshold_bps, double cash = 0.0);
+
+    // weight units of symbol per basket unit (repeated: weights add up)
+    bool add_component(uint32_t basket, const std::string& symbol, double weight);
+
+    // "<basket> <component> <weight>" lines ('#' comments, "<basket> CASH
+    // <amount>" for the cash component); baskets are created on first use
+    // with threshold_bps. False (nothing loaded past the bad line) on a
+    // parse error.
+    bool load(const std::string& path, double threshold_bps);
+
+    // Build the sparse layouts; further setup calls finalize again
+    void finalize();
+
+    // Hot path: an instrument's new price (mid). Updates the baskets it is
+    // part of and, if it is a basket instrument, that basket's market
+    // price; writes a signal for each basket whose spread changed state
+    // (at most max_signals) and returns how many.
+    size_t on_price(uint32_t instrument, double price, Signal* signals, size_t max_signals) {
+        if (__builtin_expect(instrument >= finalized_ || price <= 0.0, 0)) {
+            return 0;
+        }
+        double old = prices_[instrument];
+        if (old == price) {
+            return 0;
+        }
+        prices_[instrument] = price;
+
+        size_t count = 0;
+        double delta = price - old;
+        for (uint32_t e = column_begin_[instrument]; e < column_begin_[instrument + 1]; ++e) {
+            const Entry& entry = columns_[e];
+            BasketState& basket = baskets_[entry.basket];
+            basket.fair_value += entry.weight * delta;
+            row_price_[entry.slot] = price;
+            if (old == 0.0) {
+                --basket.unpriced;
+            }
+            count += check(entry.basket, signals + count, max_signals - count);
+        }
+        uint32_t own = basket_of_[instrument];
+        if (own != NO_INDEX) {
+            BasketState& basket = baskets_[own];
+            if (basket.market_price == 0.0) {
+                --basket.unpriced;
+            }
+            basket.market_price = price;
+            count += check(own, signals + count, max_signals - count);
+        }
+
+        // Drift correction, one basket at a time
+        if (++ticks_ >= recompute_interval_ && !baskets_.empty()) {
+            ticks_ = 0;
+            recompute(next_recompute_);
+            next_recompute_ = next_recompute_ + 1 < baskets_.size() ? next_recompute_ + 1 : 0;
+        }
+        return count;
+    }
+
+    // Forget every price (baskets unpriced again, no signal state); the
+    // layouts stay
+    void reset_prices();
+
+    // Recompute one basket / every basket from the current prices;
+    // returns the largest correction applied, relative to the fair value
+    double recompute(uint32_t basket);
+    double recompute();
+
+    // Index of an instrument, NO_INDEX if no basket uses it
+    uint32_t instrument(const char* symbol) const { return instruments_.find(symbol); }
+    const char* instrument_symbol(uint32_t instrument) const { return instruments_.name(instrument); }
+    size_t instruments() const { return prices_.size(); }
+
+    size_t baskets() const { return baskets_.size(); }
+    uint32_t basket_instrument(uint32_t basket) const { return baskets_[basket].instrument; }
+    size_t basket_size(uint32_t basket) const { return row_size_[basket]; }
+    double fair_value(uint32_t basket) const { return baskets_[basket].fair_value; }
+    double market_price(uint32_t basket) const { return baskets_[basket].market_price; }
+    bool priced(uint32_t basket) const { return baskets_[basket].unpriced == 0; }
+
+    // Spread in bps (0 until priced)
+    double spread_bps(uint32_t basket) const {
+        const BasketState& b = baskets_[basket];
+        return b.unpriced == 0 && b.fair_value > 0 ? (b.market_price - b.fair_value) / b.fair_value * 1e4 : 0.0;
+    }
+
+    // Largest drift any recompute has corrected (relative to fair value)
+    double max_drift() const { return max_drift_; }
+
+private:
+    // Hot per-basket state, one array
+    struct BasketState {
+        double fair_value;
+        double market_price;
+        double cash;
+        double threshold;       // Fraction of fair value
+        uint32_t instrument;
+        uint32_t unpriced;      // Components + basket instrument without a price
+        int32_t side;           // Last signalled state
+        uint32_t reserved;
+    };
+
+    // One basket holding an instrument
+    struct Entry {
+        uint32_t basket;
+        uint32_t slot;          // In the basket's row
+        double weight;
+    };
+
+    struct Component {
+        uint32_t basket;
+        uint32_t instrument;
+        double weight;
+    };
+
+    SymbolTable instruments_;
+    uint32_t recompute_interval_;
+    std::vector<double> prices_;            // By instrument, 0 = none yet
+    std::vector<uint32_t> basket_of_;       // Instrument -> basket it prices
+    std::vector<BasketState> baskets_;
+    std::vector<Component> components_;     // As added
+
+    // Columns: instrument i's entries are [column_begin_[i], column_begin_[i + 1])
+    std::vector<uint32_t> column_begin_;
+    std::vector<Entry> columns_;
+
+    // Rows: basket b's are [row_begin_[b], row_begin_[b + 1]), padded with
+    // zero weights to a multiple of 4
+    std::vector<uint32_t> row_begin_;
+    std::vector<uint32_t> row_size_;        // Components, without the padding
+    std::vector<double> row_weight_;
+    std::vector<double> row_price_;         // Component prices, kept by on_price()
+
+    uint32_t finalized_ = 0;                // Instruments covered by the layouts
+    uint32_t ticks_ = 0;
+    uint32_t next_recompute_ = 0;
+    double max_drift_ = 0.0;
+
+    uint32_t intern(const std::string& symbol);
+
+    size_t check(uint32_t index, Signal* signals, size_t room) {
+        BasketState& basket = baskets_[index];
+        if (basket.unpriced != 0) {
+            return 0;
+        }
+        double spread = basket.market_price - basket.fair_value;
+        double limit = basket.threshold * basket.fair_value;
+        int32_t side = spread > limit ? 1 : (spread < -limit ? -1 : 0);
+        if (side == basket.side || room == 0) {
+            return 0;
+        }
+        basket.side = side;
+        signals->basket = index;
+        signals->side = side;
+        signals->market_price = basket.market_price;
+        signals->fair_value = basket.fair_value;
+        signals->spread_bps = basket.fair_value > 0 ? spread / basket.fair_value * 1e4 : 0.0;
+        return 1;
+    }
+};
+
+} // namespace hft
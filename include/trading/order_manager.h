@@ -1,67 +1,241 @@
 #pragma once
 
-#include "trading/strategy.h"
 #include "network/tcp_sender.h"
+#include "trading/risk_engine.h"
+#include "common/circular_buffer.h"
+#include "common/hashmap.h"
+#include "common/memory_pool.h"
+#include "common/rcu.h"
 #include <memory>
 #include <vector>
 #include <atomic>
 
 namespace hft {
 
+// Outbound request handed to a sender stage (pipelined mode)
+struct OrderCommand {
+    enum class Kind : uint8_t { NEW, REPLACE, CANCEL };
+
+    Kind kind;
+    union {
+        Order order;
+        ReplaceRequest replace;
+        CancelRequest cancel;
+    };
+
+    OrderCommand() : kind(Kind::NEW), order() {}
+    explicit OrderCommand(const Order& o) : kind(Kind::NEW), order(o) {}
+    explicit OrderCommand(const ReplaceRequest& r) : kind(Kind::REPLACE), replace(r) {}
+    explicit OrderCommand(const CancelRequest& c) : kind(Kind::CANCEL), cancel(c) {}
+
+    // ID the venue would answer under
+    uint64_t report_id() const {
+        switch (kind) {
+            case Kind::NEW: return order.order_id;
+            case Kind::REPLACE: return replace.new_order_id;
+            case Kind::CANCEL: return cancel.order_id;
+        }
+        return 0;
+    }
+};
+
 // Order manager - handles order lifecycle and risk management
+//
+// Every order lives in a pooled slot from submission until it is done,
+// indexed by order ID. Risk state is per symbol (RiskEngine): position and
+// filled notional move only on fills; open exposure is reserved when an
+// order is sent and released by its execution reports, so unacknowledged
+// orders still count against limits.
+//
+// Owned by one thread (the one that submits orders). Execution reports from
+// the gateway reader thread go through enqueue_execution_report() and are
+// applied by process_execution_reports() on the owner thread.
+//
+// Risk limits can also be published from any thread (a config reload):
+// the owner thread switches to the newest version in its next
+// process_execution_reports(), one acquire load when nothing changed.
+//
+// With a command queue set (TradingPipeline), accepted orders, replaces and
+// cancels are queued for a sender stage on another thread instead of being
+// written to the TCPSender here. An order that stage fails to send comes
+// back as a REJECT (reason REJECT_NOT_SENT) through the next
+// process_execution_reports(). Orders and replaces that never went out,
+// inline or from that stage, return their order rate token.
 class OrderManager {
 public:
-    OrderManager(TCPSender& order_sender);
-    
+    static constexpr size_t DEFAULT_MAX_ORDERS = 4096;
+    static constexpr size_t REPORT_QUEUE_SIZE = 4096;
+    static constexpr size_t COMMAND_QUEUE_SIZE = 4096;
+    static constexpr uint8_t REJECT_NOT_SENT = 0xFF;    // Reason of sender stage REJECTs
+
+    using CommandQueue = CircularBuffer<OrderCommand, COMMAND_QUEUE_SIZE>;
+
+    explicit OrderManager(TCPSender& order_sender, size_t max_open_orders = DEFAULT_MAX_ORDERS);
+
     // Submit order with risk checks
     bool submit_order(const Order& order);
-    
-    // Cancel order
+
+    // Cancel order (live or partially filled)
     bool cancel_order(uint64_t order_id);
     
-    // Risk limits
-    struct RiskLimits {
-        double max_order_size = 1000.0;
-        double max_position = 10000.0;
-        double max_notional = 1000000.0;
-        uint32_t max_orders_per_second = 100;
+    // Cancel every live or partially filled order in one batch; orders
+    // still waiting for an answer are skipped. Returns the cancels sent.
+    size_t cancel_all();
+
+    // Amend price/quantity of a resting order. The order keeps its slot and
+    // answers to new_order_id once the gateway acknowledges the replace;
+    // fills on the old ID are still applied until then.
+    bool replace_order(uint64_t order_id, uint64_t new_order_id, double price,
+                       double quantity, uint64_t timestamp);
+
+    // Order IDs for new orders and replaces, shared by every strategy
+    // submitting through this manager (owner thread)
+    uint64_t next_order_id() { return next_order_id_++; }
+
+    // Coalesce the orders of one tick into a single write (pipelined: a
+    // single queue publication)
+    void begin_batch();
+    void flush();
+
+    // Pipelined mode: queue outbound requests for the sender stage
+    // (nullptr: send on the owner thread). Set while no batch is open.
+    void set_command_queue(CommandQueue* queue) { commands_ = queue; }
+
+    // Sender stage thread: report a request it could not send
+    void enqueue_send_failure(const OrderCommand& command);
+
+    // Apply an execution report (owner thread)
+    void on_execution_report(const ExecutionReport& report);
+
+    // Gateway reader thread: queue a report for the owner thread. Spins if
+    // the queue is full; reports are never dropped.
+    void enqueue_execution_report(const ExecutionReport& report);
+
+    // Owner thread: apply queued reports (and published risk limits),
+    // returns how many reports
+    size_t process_execution_reports();
+
+    // Risk limits: defaults for every symbol plus the order rate
+    using RiskLimits = RiskEngine::Limits;
+
+    // Owner thread: in effect at once
+    void set_risk_limits(const RiskLimits& limits) {
+        publish_risk_limits(limits);
+        refresh_risk_limits();
+    }
+
+    // Any thread: in effect from the owner thread's next
+    // process_execution_reports(). The token bucket keeps its level unless
+    // the rate or burst changes.
+    void publish_risk_limits(const RiskLimits& limits) { limits_.publish(limits); }
+
+    // Copy of the newest published limits (any thread)
+    RiskLimits published_risk_limits() const { return limits_.snapshot(); }
+
+    // Free limit versions the owner thread has moved past (any thread)
+    void reclaim_risk_limits() { limits_.reclaim(); }
+
+    bool set_symbol_risk_limits(const char* symbol, const RiskLimits& limits) {
+        return risk_.set_symbol_limits(symbol, limits);
+    }
+    void set_order_rate(uint32_t max_orders_per_second, uint32_t max_order_burst) {
+        risk_.set_order_rate(max_orders_per_second, max_order_burst);
+    }
+
+    // Risk table index of a symbol (RiskEngine::NO_SYMBOL if the table is full)
+    uint32_t symbol_index(const char* symbol) { return risk_.symbol_index(symbol); }
+
+    // Filled position and notional of one symbol (signed: buys positive)
+    double get_position(uint32_t symbol) const { return risk_.position(symbol); }
+    double get_notional(uint32_t symbol) const { return risk_.notional(symbol); }
+
+    // Filled position and notional summed over all symbols
+    double get_position() const { return risk_.total_position(); }
+    double get_notional() const { return risk_.total_notional(); }
+
+    // Quantity and notional of orders sent but not yet filled or done
+    double open_buy_quantity() const { return risk_.total_open_buy_quantity(); }
+    double open_sell_quantity() const { return risk_.total_open_sell_quantity(); }
+    double open_notional() const { return risk_.total_open_notional(); }
+
+    const RiskEngine& risk() const { return risk_; }
+
+    // Order lifecycle
+    enum class OrderState : uint8_t {
+        PENDING_NEW,         // Sent, not yet acknowledged
+        LIVE,                // Resting on the venue
+        PARTIALLY_FILLED,    // Resting with some quantity executed
+        PENDING_CANCEL,      // Cancel sent
+        PENDING_REPLACE,     // Replace sent, new price/quantity not yet live
+        DONE                 // Filled, canceled or rejected; slot released
     };
-    
-    void set_risk_limits(const RiskLimits& limits);
-    
-    // Get current position
-    double get_position() const { return position_.load(std::memory_order_relaxed); }
-    
+
     // Order tracking
     struct OrderInfo {
         uint64_t order_id;
+        uint64_t replace_id;         // New ID while a replace is pending, else 0
+        uint32_t symbol;             // Risk table index
         Order::Side side;
+        OrderState state;
         double price;
-        double quantity;
+        double quantity;             // Order quantity (current version)
+        double filled_quantity;      // Executed so far, across replaces
+        double leaves_quantity;      // Still open on the venue
+        double pending_price;        // Replace in flight
+        double pending_quantity;
         uint64_t submit_time;
-        bool filled;
     };
-    
+
+    // Tracked order by current (or pending replace) ID, nullptr once done
+    const OrderInfo* find_order(uint64_t order_id) const;
+    size_t open_orders() const { return orders_.size() - pending_replaces_; }
+
+    // Reports for orders no longer (or never) tracked
+    uint64_t unknown_reports() const { return unknown_reports_; }
+
 private:
     TCPSender& order_sender_;
-    RiskLimits limits_;
-    
-    // Position tracking
-    alignas(64) std::atomic<double> position_{0.0};
-    alignas(64) std::atomic<double> notional_{0.0};
-    
-    // Order rate limiting
-    alignas(64) std::atomic<uint32_t> orders_this_second_{0};
-    alignas(64) std::atomic<uint64_t> last_second_timestamp_{0};
-    
-    // Risk checks
-    bool check_order_size(double size);
-    bool check_position_limit(Order::Side side, double size);
-    bool check_rate_limit();
-    bool check_notional_limit(double price, double size);
-    
-    // Update rate limiter
-    void update_rate_limiter();
+    RiskEngine risk_;
+
+    // Published limits and the version applied to risk_
+    RcuCell<RiskLimits> limits_;
+    size_t limits_reader_;
+    const RiskLimits* applied_limits_;
+
+    // Order table: slots from the pool, indexed by ID (an order pending a
+    // replace is indexed under both IDs)
+    MemoryPool<OrderInfo> pool_;
+    FlatHashMap<uint64_t, OrderInfo*> orders_;
+    size_t pending_replaces_ = 0;
+    uint64_t next_order_id_ = 1;
+    uint64_t unknown_reports_ = 0;
+
+    // Reader thread -> owner thread
+    CircularBuffer<ExecutionReport, REPORT_QUEUE_SIZE> reports_;
+
+    // Pipelined mode: owner -> sender stage, and its failures back
+    static constexpr size_t MAX_STAGED = 64;
+    CommandQueue* commands_ = nullptr;
+    std::unique_ptr<OrderCommand[]> staged_;         // Batch being built
+    size_t staged_count_ = 0;
+    bool batching_ = false;
+    CircularBuffer<ExecutionReport, REPORT_QUEUE_SIZE> send_failures_;
+
+    void refresh_risk_limits() {
+        const RiskLimits* limits = limits_.read(limits_reader_);
+        if (__builtin_expect(limits != applied_limits_, 0)) {
+            applied_limits_ = limits;
+            risk_.set_limits(*limits);
+        }
+    }
+
+    void queue_command(const OrderCommand& command);
+    void publish_staged();
+
+    // Open exposure bookkeeping (sign +1 reserves, -1 releases)
+    void adjust_open(const OrderInfo& order, double quantity, double price, int64_t sign);
+    void apply_fill(OrderInfo& order, const ExecutionReport& report);
+    void finish(OrderInfo& order);
 };
 
 } // namespace hft
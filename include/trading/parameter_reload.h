@@ -0,0 +1,60 @@
+#pragma once
+
+#include "common/config.h"
+#include "trading/order_manager.h"
+#include "trading/strategy.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hft {
+
+// Market making parameters of one symbol as the config sets them up: the
+// global keys, overridden by <symbol>.<key>
+MarketMakingStrategy::Parameters market_making_parameters(const Config& config, const std::string& symbol);
+
+// Default risk limits and order rate from the config
+OrderManager::RiskLimits risk_limits(const Config& config);
+
+// Sanity checks before anything trades on a set (false: the first problem
+// is logged)
+bool validate_parameters(const MarketMakingStrategy::Parameters& params);
+bool validate_risk_limits(const OrderManager::RiskLimits& limits);
+
+// Strategy parameters and risk limits reloaded while trading
+//
+// reload() (control thread, e.g. on SIGHUP) parses the config file again,
+// validates the risk limits and every registered strategy's parameters,
+// and only if all of them pass publishes them: each strategy and the order
+// manager switch with one pointer swap, on their own next tick, keeping
+// books, positions and resting orders. Other keys (symbols, threading,
+// network) keep their startup values.
+class ParameterReloader {
+public:
+    ParameterReloader(OrderManager& order_manager, std::string path);
+
+    ParameterReloader(const ParameterReloader&) = delete;
+    ParameterReloader& operator=(const ParameterReloader&) = delete;
+
+    // Setup: strategies whose parameters follow the file
+    void add_strategy(MarketMakingStrategy* strategy) { strategies_.push_back(strategy); }
+
+    // Parse, validate, publish; false (nothing published) if the file is
+    // unreadable or any value is rejected
+    bool reload();
+
+    // Free the versions the trading threads have moved past (call now and
+    // then after reloads)
+    void reclaim();
+
+    const std::string& path() const { return path_; }
+    uint64_t reloads() const { return reloads_; }
+
+private:
+    OrderManager& order_manager_;
+    std::string path_;
+    std::vector<MarketMakingStrategy*> strategies_;
+    uint64_t reloads_ = 0;
+};
+
+} // namespace hft
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "trading/strategy_router.h"
+#include "trading/order_manager.h"
+#include "market_data/market_data_handler.h"
+#include "network/tcp_sender.h"
+#include "common/circular_buffer.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace hft {
+
+// Staged threads: feed -> strategy -> order sender
+//
+// Replaces the inline dispatch of a StrategyRouter with three stages, each
+// on its own (pinned) thread, connected by SPSC rings:
+// - Feed thread (UDPReceiver): decodes and updates the books, then queues
+//   a BookEvent per update of a subscribed book. The event carries the top
+//   of book read right after the update, never a pointer into a receive
+//   buffer the feed reuses. A full ring drops the event (counted) rather
+//   than stall packet consumption.
+// - Strategy thread: pops events in batches and hands them to the book's
+//   strategies (StrategyRouter::dispatch), ticks on_timer() every
+//   millisecond. Owns the OrderManager from start() to stop().
+// - Sender thread: pops the OrderManager's commands in batches and writes
+//   each batch to the TCPSender with one flush.
+//
+// Conflating mode (Options::conflate) replaces the event ring with a dirty
+// bit per routed book: the feed sets the book's bit, the strategy thread
+// takes whole 64-book words, and evaluates each marked book once on its
+// newest state. A burst of updates on one symbol costs one evaluation,
+// however far behind the strategy is.
+//
+// Trade prints are never conflated or mixed into the book stream: they go
+// through their own ring and reach the strategies once each, in feed
+// order, after the book states of the same pass.
+//
+// Idle stages spin for a while, then yield (busy_poll: spin only).
+// start() and stop() are called with the feed stopped; stop() puts the
+// router back inline.
+class TradingPipeline {
+public:
+    static constexpr size_t EVENT_QUEUE_SIZE = 4096;
+    static constexpr size_t EVENT_BATCH = 32;
+    static constexpr size_t COMMAND_BATCH = 64;
+    static constexpr size_t TRADE_QUEUE_SIZE = 4096;
+    static constexpr size_t MAX_CONFLATED_BOOKS = 256;   // Routed books, conflating mode
+
+    struct Options {
+        int strategy_cpu = -1;          // -1 = not pinned
+        int sender_cpu = -1;
+        int realtime_priority = 0;      // SCHED_FIFO of both stages, 0 = not real-time
+        bool busy_poll = false;         // Never yield when idle
+        bool conflate = false;          // Newest state per book only
+    };
+
+    // Book update handed to the strategy thread
+    struct BookEvent {
+        const OrderBook* book;
+        uint64_t enqueue_tsc;           // Feed thread, when queued
+        OrderBook::Top top;
+    };
+
+    // Trade print handed to the strategy thread
+    struct TradeEvent {
+        const OrderBook* book;
+        TradePrint trade;
+    };
+
+    TradingPipeline(MarketDataHandler& handler, StrategyRouter& router,
+                    OrderManager& order_manager, TCPSender& order_sender,
+                    const Options& options);
+    ~TradingPipeline();
+
+    TradingPipeline(const TradingPipeline&) = delete;
+    TradingPipeline& operator=(const TradingPipeline&) = delete;
+
+    // Spawn the strategy and sender threads and take over the book listener
+    void start();
+
+    // Drain both stages, join them and restore inline dispatch
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_acquire); }
+    bool conflating() const { return conflate_; }
+
+    // Counters (relaxed, readable from any thread)
+    uint64_t events_queued() const { return events_queued_.load(std::memory_order_relaxed); }
+    uint64_t events_dropped() const { return events_dropped_.load(std::memory_order_relaxed); }
+    uint64_t events_processed() const { return events_processed_.load(std::memory_order_relaxed); }
+
+    // Conflating mode: updates folded into a book already marked dirty;
+    // events_processed() counts evaluations
+    uint64_t updates_conflated() const { return updates_conflated_.load(std::memory_order_relaxed); }
+
+    uint64_t trades_queued() const { return trades_queued_.load(std::memory_order_relaxed); }
+    uint64_t trades_dropped() const { return trades_dropped_.load(std::memory_order_relaxed); }
+    uint64_t trades_processed() const { return trades_processed_.load(std::memory_order_relaxed); }
+
+    uint64_t commands_sent() const { return commands_sent_.load(std::memory_order_relaxed); }
+    uint64_t send_failures() const { return send_failures_.load(std::memory_order_relaxed); }
+
+    // Longest feed -> strategy queueing delay seen (ns, event mode)
+    uint64_t max_queue_delay_ns() const { return max_queue_delay_ns_.load(std::memory_order_relaxed); }
+
+private:
+    MarketDataHandler& handler_;
+    StrategyRouter& router_;
+    OrderManager& order_manager_;
+    TCPSender& order_sender_;
+    Options options_;
+
+    std::unique_ptr<CircularBuffer<BookEvent, EVENT_QUEUE_SIZE>> events_;
+    std::unique_ptr<OrderManager::CommandQueue> commands_;
+    std::unique_ptr<CircularBuffer<TradeEvent, TRADE_QUEUE_SIZE>> trades_;
+
+    // Conflating mode: bit BookSubscribers::slot per routed book
+    static constexpr size_t DIRTY_WORDS = MAX_CONFLATED_BOOKS / 64;
+    bool conflate_ = false;
+    size_t dirty_words_ = 0;                          // Words in use
+    alignas(64) std::array<std::atomic<uint64_t>, DIRTY_WORDS> dirty_{};
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> strategy_running_{false};
+    std::atomic<bool> sender_running_{false};
+    std::thread strategy_thread_;
+    std::thread sender_thread_;
+
+    // Feed thread
+    alignas(64) std::atomic<uint64_t> events_queued_{0};
+    std::atomic<uint64_t> events_dropped_{0};
+    std::atomic<uint64_t> updates_conflated_{0};
+    std::atomic<uint64_t> trades_queued_{0};
+    std::atomic<uint64_t> trades_dropped_{0};
+    // Strategy thread
+    alignas(64) std::atomic<uint64_t> events_processed_{0};
+    std::atomic<uint64_t> max_queue_delay_ns_{0};
+    std::atomic<uint64_t> trades_processed_{0};
+    // Sender thread
+    alignas(64) std::atomic<uint64_t> commands_sent_{0};
+    std::atomic<uint64_t> send_failures_{0};
+
+    static void on_book_update(void* context, const OrderBook& book);
+    static void on_book_dirty(void* context, const OrderBook& book);
+    static void on_trade(void* context, const OrderBook& book, const TradePrint& trade);
+    void publish(const OrderBook& book);
+    void mark_dirty(const OrderBook& book);
+    void publish_trade(const OrderBook& book, const TradePrint& trade);
+
+    // Strategy thread passes, each returns the items handled
+    size_t process_events(BookEvent* batch, uint64_t& max_delay);
+    size_t process_dirty_books();
+    size_t process_trades();
+
+    void strategy_loop();
+    void sender_loop();
+    void idle(uint32_t& idle_spins) const;
+};
+
+} // namespace hft
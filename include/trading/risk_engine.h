@@ -0,0 +1,155 @@
+#pragma once
+
+#include "network/tcp_sender.h"
+#include "common/symbol_table.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace hft {
+
+// Pre-trade risk table, one cache line per symbol
+//
+// Limits are converted once to integer ticks (1/PRICE_SCALE) and lots
+// (shares) so a check is integer compares on a single line. check()
+// evaluates every limit and returns the failed ones as a bit mask; the
+// pass and reject paths run the same instructions.
+//
+// Order rate is a token bucket on the TSC shared by all symbols: it
+// refills continuously at max_orders_per_second and holds at most
+// max_order_burst tokens, so no window can see more than the burst on
+// top of the steady rate.
+//
+// State is written by the order owner thread only; the relaxed atomics
+// let other threads read positions for display.
+class RiskEngine {
+public:
+    static constexpr int64_t PRICE_SCALE = 10000;              // Ticks per currency unit
+    static constexpr size_t DEFAULT_MAX_SYMBOLS = 256;
+    static constexpr uint32_t NO_SYMBOL = SymbolTable::NO_SYMBOL;
+
+    struct Limits {
+        double max_order_size = 1000.0;
+        double max_position = 10000.0;
+        double max_notional = 1000000.0;
+        uint32_t max_orders_per_second = 100;     // All symbols together
+        uint32_t max_order_burst = 20;
+    };
+
+    // Failed checks, OR-ed into the result of check()
+    enum Reject : uint32_t {
+        ORDER_SIZE = 1U << 0,
+        POSITION = 1U << 1,
+        NOTIONAL = 1U << 2,
+        RATE = 1U << 3
+    };
+
+    explicit RiskEngine(size_t max_symbols = DEFAULT_MAX_SYMBOLS);
+
+    // Default limits for every symbol (existing ones too) and the order
+    // rate; after Timestamp calibration, the bucket is sized in counter ticks.
+    // The bucket is refilled only if the rate or burst changes.
+    void set_limits(const Limits& limits);
+
+    // Order rate and burst alone (the bucket starts full); symbol limits
+    // are kept
+    void set_order_rate(uint32_t max_orders_per_second, uint32_t max_order_burst);
+
+    // Override the size, position and notional limits of one symbol
+    bool set_symbol_limits(const char* symbol, const Limits& limits);
+
+    // Table index of a symbol, added with the default limits on first use;
+    // NO_SYMBOL once the table is full
+    uint32_t symbol_index(const char* symbol);
+
+    // Same for the 16-byte Order::symbol field: a repeat of the last symbol
+    // skips the table lookup
+    uint32_t order_symbol(const char* symbol) {
+        uint64_t key[2];
+        std::memcpy(key, symbol, sizeof(key));
+        if (__builtin_expect(key[0] == last_key_[0] && key[1] == last_key_[1], 1)) {
+            return last_index_;
+        }
+        return lookup_order_symbol(symbol, key);
+    }
+
+    // Run every check for an order adding added_lots on one side and
+    // added_notional (ticks x lots) of exposure. 0 means it passed and
+    // took a rate token.
+    uint32_t check(uint32_t symbol, Order::Side side, int64_t order_lots, int64_t added_lots,
+                   int64_t added_notional, uint64_t now_tsc);
+
+    // Give back the token of a passed check whose order never went out
+    // (the send failed), up to the burst
+    void refund_token();
+
+    // Open exposure bookkeeping (sign +1 reserves, -1 releases)
+    void adjust_open(uint32_t symbol, Order::Side side, int64_t lots, int64_t price_ticks, int64_t sign);
+
+    // Fill of lots at price_ticks: moves position and filled notional
+    void apply_fill(uint32_t symbol, Order::Side side, int64_t lots, int64_t price_ticks);
+
+    static int64_t to_ticks(double price) { return static_cast<int64_t>(price * PRICE_SCALE + (price < 0 ? -0.5 : 0.5)); }
+    static int64_t to_lots(double quantity) { return static_cast<int64_t>(quantity + (quantity < 0 ? -0.5 : 0.5)); }
+
+    // First failed check of a mask, for logging
+    static const char* reject_reason(uint32_t reject);
+
+    // Per symbol (any thread): filled position (signed: buys positive),
+    // filled notional, open quantity per side and open notional
+    double position(uint32_t symbol) const;
+    double notional(uint32_t symbol) const;
+    double open_buy_quantity(uint32_t symbol) const;
+    double open_sell_quantity(uint32_t symbol) const;
+    double open_notional(uint32_t symbol) const;
+
+    // Summed over all symbols
+    double total_position() const;
+    double total_notional() const;
+    double total_open_buy_quantity() const;
+    double total_open_sell_quantity() const;
+    double total_open_notional() const;
+
+    size_t symbols() const { return symbol_count_.load(std::memory_order_acquire); }
+    const Limits& limits() const { return limits_; }
+
+private:
+    struct alignas(64) SymbolRisk {
+        // Limits
+        int64_t max_order_lots;
+        int64_t max_position_lots;
+        int64_t max_notional;                  // Ticks x lots
+        // State
+        std::atomic<int64_t> position;         // Filled lots, signed
+        std::atomic<int64_t> notional;         // Filled ticks x lots, signed
+        std::atomic<int64_t> open_buy;         // Lots
+        std::atomic<int64_t> open_sell;
+        std::atomic<int64_t> open_notional;    // Ticks x lots
+    };
+    static_assert(sizeof(SymbolRisk) == 64, "one cache line per symbol");
+
+    Limits limits_;
+    size_t max_symbols_;
+    std::atomic<size_t> symbol_count_{0};      // Entries below are initialized
+    std::unique_ptr<SymbolRisk[]> table_;
+
+    // Symbol lookup (cold): interned IDs are the table indexes
+    SymbolTable index_;
+
+    // Last order symbol (raw 16 bytes) and its index
+    uint64_t last_key_[2] = {0, 0};
+    uint32_t last_index_ = NO_SYMBOL;
+
+    // Token bucket in counter ticks: one order costs token_cost_
+    int64_t token_cost_ = 0;
+    int64_t bucket_capacity_ = 0;
+    int64_t bucket_level_ = 0;
+    uint64_t bucket_last_ = 0;
+
+    void apply_limits(SymbolRisk& risk, const Limits& limits);
+    uint32_t lookup_order_symbol(const char* symbol, const uint64_t key[2]);
+    int64_t total(std::atomic<int64_t> SymbolRisk::*field) const;
+};
+
+} // namespace hft
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "trading/pipeline.h"
+#include "trading/strategy_router.h"
+#include "trading/order_manager.h"
+#include "market_data/market_data_handler.h"
+#include "common/circular_buffer.h"
+#include "common/config.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hft {
+
+// Which symbols and multicast channels each feed shard serves
+struct FeedPartition {
+    struct Shard {
+        int cpu = -1;                   // Receiver (feed) thread, -1 = not pinned
+        // Groups the shard's receiver joins; the first is its primary
+        std::vector<std::pair<std::string, uint16_t>> channels;
+        std::vector<std::string> symbols;   // Placed here by the config
+    };
+
+    std::vector<Shard> shards;
+    std::unordered_map<std::string, size_t> placed;     // Symbol -> shard, from the config
+
+    // Shard of a symbol: where the config placed it, otherwise by hash
+    size_t shard_of(const std::string& symbol) const;
+};
+
+// Partition map from the config: feed_shards shards (at least one), and
+// for shard i
+//   feed_shard.<i>.cpu=        receiver core (default market_data_cpu + i)
+//   feed_shard.<i>.channels=   ip:port,... (default every configured group:
+//                              each shard then keeps only its own symbols)
+//   feed_shard.<i>.symbols=    A,B,... (other symbols are hashed)
+FeedPartition feed_partition(const Config& config);
+
+// Feed handling split across shards
+//
+// Each shard has its own MarketDataHandler (books, L3 pools and decoder
+// state placed on the NUMA node of the shard's core), its own
+// StrategyRouter and its own receiver thread, so shards share no cache
+// lines on the feed path: a symbol's book lives in one shard only, and a
+// shard's receiver decodes only its channels (untracked symbols cost a
+// lookup).
+//
+// Strategies stay on one thread, the owner of the OrderManager: every shard
+// queues the updates of its subscribed books into its own SPSC ring to that
+// strategy thread (as TradingPipeline does for one handler), and a strategy
+// subscribed to symbols of several shards - basket arbitrage - is fed by
+// all of their rings. The strategy thread polls the shards round-robin in
+// batches, hands each event to the book's strategies, and ticks
+// process_execution_reports() and on_timer() every millisecond. Orders go
+// out from the strategy thread (inline sending). A full ring drops the
+// event (counted) rather than stall the shard's feed.
+//
+// Updates of one shard reach the strategies in feed order; updates of
+// different shards are not ordered relative to each other.
+//
+// Shards are set up (add_symbol, subscribe) before start(); start() and
+// stop() are called with the receivers stopped, stop() drains the rings
+// and puts every router back inline.
+class ShardedFeed {
+public:
+    static constexpr size_t EVENT_QUEUE_SIZE = TradingPipeline::EVENT_QUEUE_SIZE;
+    static constexpr size_t EVENT_BATCH = TradingPipeline::EVENT_BATCH;
+    static constexpr size_t TRADE_QUEUE_SIZE = TradingPipeline::TRADE_QUEUE_SIZE;
+
+    using BookEvent = TradingPipeline::BookEvent;
+    using TradeEvent = TradingPipeline::TradeEvent;
+
+    struct Options {
+        int strategy_cpu = -1;          // -1 = not pinned
+        int realtime_priority = 0;      // SCHED_FIFO of the strategy thread, 0 = not real-time
+        bool busy_poll = false;         // Never yield when idle
+        size_t max_symbols = MarketDataHandler::DEFAULT_MAX_SYMBOLS;   // Books per shard
+    };
+
+    ShardedFeed(FeedPartition partition, OrderManager& order_manager, const Options& options);
+    ~ShardedFeed();
+
+    ShardedFeed(const ShardedFeed&) = delete;
+    ShardedFeed& operator=(const ShardedFeed&) = delete;
+
+    size_t shards() const { return shards_.size(); }
+    const FeedPartition& partition() const { return partition_; }
+    MarketDataHandler& handler(size_t shard) { return shards_[shard]->handler; }
+    StrategyRouter& router(size_t shard) { return shards_[shard]->router; }
+    int cpu(size_t shard) const { return partition_.shards[shard].cpu; }
+    size_t shard_of(const std::string& symbol) const { return partition_.shard_of(symbol); }
+
+    // Track a symbol in its shard; returns the shard
+    size_t add_symbol(const std::string& symbol);
+
+    // Track the symbol and route its book to a strategy in its shard
+    bool subscribe(const std::string& symbol, StrategyRef strategy);
+
+    // Feed protocol of every shard
+    void set_feed_protocol(FeedProtocol protocol);
+
+    // Book depth of every shard (MarketDataHandler::set_book_depth)
+    void set_book_depth(size_t levels);
+
+    // Spawn the strategy thread and take over every shard's listeners
+    void start();
+
+    // Drain the rings, join the strategy thread, restore inline dispatch
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_acquire); }
+
+    // Counters over all shards (relaxed, readable from any thread)
+    uint64_t events_queued() const;
+    uint64_t events_dropped() const;
+    uint64_t events_processed() const;
+    uint64_t trades_queued() const;
+    uint64_t trades_dropped() const;
+    uint64_t trades_processed() const;
+
+private:
+    struct Shard {
+        Shard(size_t max_symbols, int numa_node);
+
+        MarketDataHandler handler;
+        StrategyRouter router;
+        std::unique_ptr<CircularBuffer<BookEvent, EVENT_QUEUE_SIZE>> events;
+        std::unique_ptr<CircularBuffer<TradeEvent, TRADE_QUEUE_SIZE>> trades;
+
+        // Feed thread of the shard
+        alignas(64) std::atomic<uint64_t> events_queued{0};
+        std::atomic<uint64_t> events_dropped{0};
+        std::atomic<uint64_t> trades_queued{0};
+        std::atomic<uint64_t> trades_dropped{0};
+        // Strategy thread
+        alignas(64) std::atomic<uint64_t> events_processed{0};
+        std::atomic<uint64_t> trades_processed{0};
+    };
+
+    FeedPartition partition_;
+    OrderManager& order_manager_;
+    Options options_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<StrategyRef> strategies_;       // Distinct, for on_timer()
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> strategy_running_{false};
+    std::thread strategy_thread_;
+
+    static void on_book_update(void* context, const OrderBook& book);
+    static void on_trade(void* context, const OrderBook& book, const TradePrint& trade);
+
+    // One shard's pass, returns the items handled
+    static size_t process(Shard& shard, BookEvent* batch);
+
+    uint64_t total(std::atomic<uint64_t> Shard::*counter) const;
+    void strategy_loop();
+};
+
+} // namespace hft
@@ -1,30 +1,63 @@
 #pragma once
 
 #include "market_data/order_book.h"
+#include "market_data/market_data_handler.h"
 #include "network/tcp_sender.h"
+#include "trading/order_manager.h"
+#include "trading/fair_value.h"
+#include "common/rcu.h"
 #include <atomic>
+#include <concepts>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace hft {
 
-// Base trading strategy interface
-class Strategy {
-public:
-    virtual ~Strategy() = default;
+// Trading strategy interface
+// Checked at compile time instead of a virtual base: StrategyRouter holds
+// the concrete types and calls them directly, so the per-tick calls can be
+// inlined.
+template<typename S>
+concept TradingStrategy = requires(S& strategy, const OrderBook& book, const OrderBook::Top& top,
+                                   const TradePrint& trade) {
+    // Called when a subscribed order book is updated (feed thread)
+    strategy.on_order_book_update(book);
+    
+    // Same with the top of book already read: the pipelined mode reads it
+    // on the feed thread and evaluates the strategy on its own thread
+    strategy.on_top_of_book(book, top);
     
-    // Called when order book is updated
-    virtual void on_order_book_update(const OrderBook& book) = 0;
+    // Every trade print of a subscribed book, in feed order (never
+    // conflated away)
+    strategy.on_trade(book, trade);
     
     // Called periodically (e.g., every millisecond)
-    virtual void on_timer() = 0;
+    strategy.on_timer();
+    
+    // Forget quotes and market state, e.g. after warm-up traffic; called
+    // with no order of the strategy open
+    strategy.reset();
     
     // Strategy name
-    virtual const char* name() const = 0;
+    { strategy.name() } -> std::convertible_to<const char*>;
 };
 
 // Market making strategy
-// Provides liquidity by quoting both bid and ask
-class MarketMakingStrategy : public Strategy {
+// Provides liquidity by quoting both bid and ask for one symbol. Keeps one
+// resting order per side and amends it with cancel/replace instead of
+// sending new orders.
+//
+// Quotes live on the venue's grid: each side's resting price and size are
+// kept in ticks and lots, each new target is rounded onto the grid (bids
+// down, asks up), and a side is only amended when its target moved by at
+// least requote_ticks or requote_lots. An unchanged quote costs no message
+// and does not start the quote pacing interval.
+//
+// Parameters can be replaced while trading (update_parameters(), any
+// thread): the tick path picks the newest version up with one acquire load
+// per book update and requotes at once with it.
+class MarketMakingStrategy final {
 public:
     struct Parameters {
         double spread_target = 0.0002;  // 2 bps target spread
@@ -32,58 +65,177 @@ public:
         double max_position = 1000.0;    // Max inventory
         double skew_factor = 0.5;        // How much to skew quotes based on position
         double edge = 0.0001;            // Edge to take (1 bp)
+        double tick_size = 0.01;         // Price increment of the venue
+        double lot_size = 1.0;           // Size increment of the venue
+        uint32_t requote_ticks = 1;      // Price move (ticks) that amends a quote
+        uint32_t requote_lots = 1;       // Size change (lots) that amends a quote
+        std::string symbol;              // Instrument quoted (required)
     };
     
-    MarketMakingStrategy(TCPSender& order_sender, const Parameters& params);
+    MarketMakingStrategy(OrderManager& order_manager, const Parameters& params);
+    
+    void on_order_book_update(const OrderBook& book) { on_top_of_book(book, book.get_top()); }
+    void on_top_of_book(const OrderBook& book, const OrderBook::Top& top);
+    void on_trade(const OrderBook& book, const TradePrint& trade);
+    void on_timer();
+    void reset();
+    const char* name() const { return "MarketMaking"; }
     
-    void on_order_book_update(const OrderBook& book) override;
-    void on_timer() override;
-    const char* name() const override { return "MarketMaking"; }
+    // Instrument quoted (fixed for the strategy's lifetime)
+    const std::string& symbol() const { return symbol_; }
     
-    // Get current position
-    double get_position() const { return position_.load(std::memory_order_relaxed); }
+    // Copy of the newest parameters (any thread)
+    Parameters parameters() const { return parameters_.snapshot(); }
     
-    // Get P&L
+    // Publish new parameters (any thread, e.g. a config reload); the next
+    // book update trades on them. False for another symbol.
+    bool update_parameters(const Parameters& params);
+    
+    // Free parameter versions the tick path has moved past (any thread)
+    void reclaim_parameters() { parameters_.reclaim(); }
+    
+    // Get current position in the quoted symbol (filled, from the order manager)
+    double get_position() const { return order_manager_.get_position(risk_symbol_); }
+    
+    // Get P&L: filled position marked to the last mid, net of its cost
+    // (updated on every book update)
     double get_pnl() const { return pnl_.load(std::memory_order_relaxed); }
     
+    // Last trade print seen in the quoted symbol (0 before the first)
+    double last_trade_price() const { return last_trade_price_.load(std::memory_order_relaxed); }
+    uint64_t trades_seen() const { return trades_seen_.load(std::memory_order_relaxed); }
+    
+    // Wire-to-order latency of the last quote: packet receive timestamp
+    // (NIC or kernel) to order handed to the sender. 0 until the feed
+    // delivers timestamped packets.
+    uint64_t last_wire_to_order_ns() const { return last_wire_to_order_ns_.load(std::memory_order_relaxed); }
+    
+    // Quote messages sent (new orders and amends) / sides left alone
+    // because their target was unchanged on the grid
+    uint64_t quotes_sent() const { return quotes_sent_.load(std::memory_order_relaxed); }
+    uint64_t quotes_unchanged() const { return quotes_unchanged_.load(std::memory_order_relaxed); }
+    
 private:
-    TCPSender& order_sender_;
-    Parameters params_;
+    OrderManager& order_manager_;
+    std::string symbol_;
+    uint32_t risk_symbol_;           // Risk table index of symbol_
+    
+    // Published parameters, and the version the tick path is on (valid
+    // until its next read)
+    RcuCell<Parameters> parameters_;
+    size_t parameters_reader_;
+    const Parameters* params_;
+    
+    // Resting quote per side. While an amend is in flight the order answers
+    // to either ID, depending on whether the venue takes the replace.
+    struct Quote {
+        uint64_t order_id = 0;       // 0 = none
+        uint64_t previous_id = 0;    // ID before the last replace
+        int64_t price_ticks = 0;     // Price and size last sent (placed or amended)
+        int64_t size_lots = 0;
+        bool stale = false;          // Sent on a grid a reload replaced: amend on the next requote
+    };
+    Quote bid_quote_;
+    Quote ask_quote_;
+    
+    // Prebuilt orders, per-quote fields patched in place
+    Order bid_template_;
+    Order ask_template_;
     
     // State tracking
-    alignas(64) std::atomic<double> position_{0.0};
     alignas(64) std::atomic<double> pnl_{0.0};
-    alignas(64) std::atomic<uint64_t> last_quote_time_{0};
-    
-    // Order IDs
-    std::atomic<uint64_t> next_order_id_{1};
+    alignas(64) std::atomic<uint64_t> last_quote_time_{0};   // Feed time (ns)
+    std::atomic<uint64_t> last_wire_to_order_ns_{0};
+    std::atomic<double> last_trade_price_{0.0};
+    std::atomic<uint64_t> trades_seen_{0};
+    std::atomic<uint64_t> quotes_sent_{0};
+    std::atomic<uint64_t> quotes_unchanged_{0};
     
     // Quote management
-    void update_quotes(const OrderBook::Snapshot& snapshot);
-    bool should_requote(const OrderBook::Snapshot& snapshot);
+    void apply_parameters(const Parameters* params);
+    void update_quotes(const OrderBook::Top& top, uint64_t now, uint64_t tick_ns);
+    bool quote_side(Quote& quote, Order& order, int64_t price_ticks, int64_t size_lots);
+    bool should_requote(const OrderBook::Top& top, uint64_t tick_ns);
     
     // Calculate fair value with inventory skew
     double calculate_fair_value(double mid, double position) const;
     
-    // Generate order ID
+    // Generate order ID (unique across the strategies of one order manager)
     uint64_t generate_order_id() {
-        return next_order_id_.fetch_add(1, std::memory_order_relaxed);
+        return order_manager_.next_order_id();
     }
 };
 
-// Arbitrage strategy (example)
-// Looks for price discrepancies between correlated instruments
-class ArbitrageStrategy : public Strategy {
+// Basket arbitrage (ETF against its constituents, future against spot)
+// Values each basket from its components' mids with a FairValueEngine and
+// reacts to its signals: when a basket instrument's mid moves beyond its
+// threshold from the fair value, an IOC order takes the basket side -
+// sells a rich basket, buys a cheap one - limited halfway between the
+// market and the fair value, rounded onto the tick grid on the passive
+// side (as the market maker's quotes). Components are not hedged here.
+//
+// Set the baskets up on fair_value() (add_basket/add_component or load),
+// call finalize(), then subscribe the strategy to the book of every
+// instrument the engine lists. Until finalize() it sees books and does
+// nothing.
+class ArbitrageStrategy final {
 public:
-    ArbitrageStrategy(TCPSender& order_sender);
+    struct Parameters {
+        double order_size = 100.0;          // Basket units per signal
+        double tick_size = 0.01;            // Price increment of the basket instruments
+        size_t max_instruments = 1024;      // Components and basket instruments
+        uint32_t recompute_interval = FairValueEngine::DEFAULT_RECOMPUTE_INTERVAL;
+    };
+    
+    ArbitrageStrategy(OrderManager& order_manager, const Parameters& params);
     
-    void on_order_book_update(const OrderBook& book) override;
-    void on_timer() override;
-    const char* name() const override { return "Arbitrage"; }
+    void on_order_book_update(const OrderBook& book) { on_top_of_book(book, book.get_top()); }
+    void on_top_of_book(const OrderBook& book, const OrderBook::Top& top);
+    void on_trade(const OrderBook& book, const TradePrint& trade);
+    void on_timer();
+    void reset();
+    const char* name() const { return "Arbitrage"; }
+    
+    FairValueEngine& fair_value() { return engine_; }
+    const FairValueEngine& fair_value() const { return engine_; }
+    
+    // Build the engine's layouts and the basket orders (after setup,
+    // before the feed starts)
+    void finalize();
+    
+    // Spread signals seen / orders they produced (relaxed, any thread)
+    uint64_t signals() const { return signals_.load(std::memory_order_relaxed); }
+    uint64_t orders_sent() const { return orders_sent_.load(std::memory_order_relaxed); }
     
 private:
-    [[maybe_unused]] TCPSender& order_sender_;
-    // Would track multiple order books and look for mispricings
+    static constexpr size_t MAX_SIGNALS = 16;       // Per tick
+    
+    OrderManager& order_manager_;
+    Parameters params_;
+    FairValueEngine engine_;
+    bool finalized_ = false;
+    
+    // Book -> engine instrument, resolved on a book's first update; open
+    // addressing on the book's address, so books of several handlers
+    // (feed shards, each numbering its symbols from 0) never collide
+    struct Resolved {
+        const OrderBook* book;
+        uint32_t instrument;
+    };
+    std::vector<Resolved> instrument_of_book_;      // Power of 2, at most half full
+    size_t books_resolved_ = 0;
+    
+    // Prebuilt IOC per basket, side/price/ID patched per signal
+    std::vector<Order> orders_;
+    
+    alignas(64) std::atomic<uint64_t> signals_{0};
+    std::atomic<uint64_t> orders_sent_{0};
+    
+    uint32_t resolve(const OrderBook& book);
+    void on_signal(const FairValueEngine::Signal& signal, uint64_t tick_ns);
 };
 
+static_assert(TradingStrategy<MarketMakingStrategy>);
+static_assert(TradingStrategy<ArbitrageStrategy>);
+
 } // namespace hft
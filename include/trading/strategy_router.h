@@ -0,0 +1,97 @@
+#pragma once
+
+#include "trading/strategy.h"
+#include "market_data/market_data_handler.h"
+#include <array>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace hft {
+
+// Every strategy type the router can dispatch to; a new strategy is added
+// here. Calls go through std::visit over the concrete types (a switch on
+// the index), never through a vtable.
+using StrategyRef = std::variant<MarketMakingStrategy*, ArbitrageStrategy*>;
+
+// Strategies subscribed to one OrderBook, reached from the book itself
+struct BookSubscribers {
+    static constexpr size_t MAX_STRATEGIES = 4;
+
+    std::array<StrategyRef, MAX_STRATEGIES> strategies;
+    uint32_t count = 0;
+    uint32_t slot = 0;          // Dense index of the book among the routed ones
+};
+
+// Per-symbol strategy routing
+// Installs itself as the handler's book listener; every update of a book
+// with subscribers is handed to those strategies in subscription order,
+// on the feed thread (or on the strategy thread of a TradingPipeline).
+// Books without subscribers cost a null check. Subscriptions are set up
+// before the feed starts.
+class StrategyRouter {
+public:
+    explicit StrategyRouter(MarketDataHandler& handler);
+    ~StrategyRouter();
+
+    StrategyRouter(const StrategyRouter&) = delete;
+    StrategyRouter& operator=(const StrategyRouter&) = delete;
+
+    // Route a symbol's book updates to a strategy; false if the handler
+    // does not track the symbol or its book has MAX_STRATEGIES already
+    bool subscribe(const std::string& symbol, StrategyRef strategy);
+
+    // Hand one update to the book's strategies (top of book read once)
+    static void dispatch(const OrderBook& book) { dispatch(book, book.get_top()); }
+
+    static void dispatch(const OrderBook& book, const OrderBook::Top& top) {
+        const BookSubscribers* subscribers = book.subscribers();
+        for (uint32_t i = 0; i < subscribers->count; ++i) {
+            std::visit([&book, &top](auto* strategy) { strategy->on_top_of_book(book, top); },
+                       subscribers->strategies[i]);
+        }
+    }
+
+    // Hand one trade print to the book's strategies
+    static void dispatch_trade(const OrderBook& book, const TradePrint& trade) {
+        const BookSubscribers* subscribers = book.subscribers();
+        for (uint32_t i = 0; i < subscribers->count; ++i) {
+            std::visit([&book, &trade](auto* strategy) { strategy->on_trade(book, trade); },
+                       subscribers->strategies[i]);
+        }
+    }
+
+    // (Re)install the router as the handler's book and trade listener:
+    // inline dispatch on the feed thread. Done by the constructor.
+    void attach() {
+        handler_.set_book_listener(&StrategyRouter::on_book_update, this);
+        handler_.set_trade_listener(&StrategyRouter::on_trade, this);
+    }
+
+    // Timer tick for every subscribed strategy (once each)
+    void on_timer();
+    
+    // reset() every subscribed strategy (once each)
+    void reset();
+
+    size_t strategies() const { return strategies_.size(); }
+
+    // Routed books by BookSubscribers::slot
+    size_t books() const { return books_.size(); }
+    const OrderBook* book(uint32_t slot) const { return books_[slot].book; }
+
+private:
+    MarketDataHandler& handler_;
+    struct Route {
+        OrderBook* book;
+        std::unique_ptr<BookSubscribers> subscribers;
+    };
+    std::vector<Route> books_;
+    std::vector<StrategyRef> strategies_;      // Distinct, for on_timer()
+
+    static void on_book_update(void*, const OrderBook& book) { dispatch(book); }
+    static void on_trade(void*, const OrderBook& book, const TradePrint& trade) { dispatch_trade(book, trade); }
+};
+
+} // namespace hft
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "market_data/market_data_handler.h"
+#include "trading/order_manager.h"
+#include "trading/strategy_router.h"
+#include "network/tcp_sender.h"
+#include "common/tick_to_trade.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hft {
+
+// Pre-open warm-up: the inline tick-to-trade path brought to steady state
+// before the first real packet (cold pages, caches and branch predictors
+// make the first ticks after the open many times slower than the rest)
+//
+// run(), on the thread that stands in for the feed thread:
+// 1. Memory is locked (mlockall); if that is refused, every writable
+//    mapping (pools, rings, books, stacks) is write-faulted instead.
+// 2. The thread moves to Options::cpu (the feed core, whose caches the
+//    receiver thread inherits) at Options::realtime_priority.
+// 3. Synthetic packets in the handler's feed protocol, round-robin over
+//    the routed books, run decode -> book -> strategy -> risk -> encode
+//    with the sender in loopback: encoded, never written, acknowledged on
+//    the spot, so resting quotes get amended the way they are live. Every
+//    batch_ticks packets the batch's tick-to-trade p50 and p99 are
+//    compared with the previous batch; stable_batches batches in a row
+//    within tolerance (after min_ticks) is steady state. max_ticks bounds
+//    the run either way.
+// 4. What the traffic left behind is undone: resting orders canceled
+//    (through the loopback), the order rate bucket refilled, books
+//    emptied and ITCH locates forgotten, strategies reset(), the book
+//    publisher (detached meanwhile) put back, the thread's CPU mask and
+//    scheduling restored.
+//
+// Call before the feed, the gateway reader and any TradingPipeline start
+// (pipelined stages are not on the inline path); the sender need not be
+// connected. The synthetic clock ends at the start of run(), so strategy
+// pacing only ever sees live ticks as newer.
+class Warmup {
+public:
+    struct Options {
+        int cpu = -1;                   // -1 = stay where the thread is
+        int realtime_priority = 0;      // SCHED_FIFO during the run, 0 = none
+        bool lock_memory = true;
+        uint64_t min_ticks = 20000;
+        uint64_t max_ticks = 500000;
+        uint64_t batch_ticks = 4096;
+        uint32_t stable_batches = 3;
+        double tolerance = 0.10;        // Batch to batch change of p50 and p99
+    };
+
+    struct Result {
+        bool memory_locked = false;
+        size_t prefaulted_bytes = 0;    // When locking was refused
+        bool pinned = false;
+        bool realtime = false;
+        bool steady = false;            // Converged before max_ticks
+        uint64_t ticks = 0;             // Synthetic packets
+        uint64_t samples = 0;           // Ticks that reached the sender
+        uint64_t orders_canceled = 0;   // Left resting at the end
+        uint64_t first_tick_ns = 0;     // Tick-to-trade of the very first sample
+        uint64_t first_p50_ns = 0;      // First batch: cold
+        uint64_t first_p99_ns = 0;
+        uint64_t last_p50_ns = 0;       // Last batch: warm
+        uint64_t last_p99_ns = 0;
+        uint64_t elapsed_ns = 0;        // Time to ready
+    };
+
+    Warmup(MarketDataHandler& handler, StrategyRouter& router, OrderManager& order_manager,
+           TCPSender& order_sender, const Options& options);
+
+    Warmup(const Warmup&) = delete;
+    Warmup& operator=(const Warmup&) = delete;
+
+    // The whole sequence on the calling thread; a cleared running flag
+    // ends the traffic early (the cleanup still runs)
+    Result run(const std::atomic<bool>* running = nullptr);
+
+    // Stage histograms of the synthetic traffic (after run())
+    const TickToTrade::Histograms& histograms() const { return *histograms_; }
+
+private:
+    // Synthetic market of one routed book
+    struct Book {
+        const OrderBook* book;
+        uint16_t locate;                // ITCH
+        uint64_t bid_ref;
+        uint64_t ask_ref;
+        double mid;
+    };
+
+    MarketDataHandler& handler_;
+    StrategyRouter& router_;
+    OrderManager& order_manager_;
+    TCPSender& order_sender_;
+    Options options_;
+    std::unique_ptr<TickToTrade::Histograms> histograms_;
+
+    std::vector<Book> books_;
+    std::vector<char> packet_;
+    uint64_t next_ref_ = 1;
+    uint64_t sequence_ = 1;             // MoldUDP64
+    uint64_t random_ = 0x9E3779B97F4A7C15ULL;
+
+    // Next packet for a book into packet_ (first: the book's opening orders)
+    void build_packet(Book& book, bool first, uint64_t rx_timestamp_ns);
+    void traffic(Result& result, const std::atomic<bool>* running);
+};
+
+} // namespace hft
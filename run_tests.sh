@@ -13,7 +13,23 @@ echo "2. Running Lock-Free Tests..."
 ./build/test_lockfree
 echo ""
 
-echo "3. Running Performance Benchmarks..."
+echo "3. Running Advanced Data Structure Tests..."
+./build/test_advanced_ds
+echo ""
+
+echo "4. Running Feed Decoder Tests..."
+./build/test_feed_decoder
+echo ""
+
+echo "5. Running Network Tests..."
+./build/test_network
+echo ""
+
+echo "6. Running Trading Tests..."
+./build/test_trading
+echo ""
+
+echo "7. Running Performance Benchmarks..."
 ./build/benchmark
 echo ""
 
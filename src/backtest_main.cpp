@@ -0,0 +1,121 @@
+#include "market_data/feed_journal.h"
+#include "market_data/market_data_handler.h"
+#include "trading/backtest.h"
+#include "trading/parameter_reload.h"
+#include "common/config.h"
+#include "common/logger.h"
+#include "common/timestamp.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Parameter sweep of MarketMakingStrategy over a captured feed
+//
+//   hft_backtest <config> [journal]
+//
+// Every backtest_spread_targets x backtest_skew_factors pair is one run
+// over the whole journal (replay_journal unless given), all symbols
+// quoted with that pair and otherwise the configured parameters.
+int main(int argc, char* argv[]) {
+    using namespace hft;
+    
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <config> [journal]\n";
+        return 1;
+    }
+    
+    Timestamp::calibrate_tsc_frequency();
+    
+    Config config;
+    if (!config.load(argv[1])) {
+        std::cerr << "Cannot load config " << argv[1] << "\n";
+        return 1;
+    }
+    std::string path = argc > 2 ? argv[2] : config.replay_journal;
+    
+    FeedJournalReader journal;
+    if (path.empty() || !journal.open(path)) {
+        std::cerr << "No journal to replay (set replay_journal or pass one)\n";
+        return 1;
+    }
+    
+    Backtest::Setup setup;
+    setup.symbols = config.symbols;
+    if (config.feed_protocol == "itch50_moldudp64") {
+        setup.feed_protocol = FeedProtocol::ITCH50_MOLDUDP64;
+    } else if (config.feed_protocol == "itch50_framed") {
+        setup.feed_protocol = FeedProtocol::ITCH50_FRAMED;
+    }
+    setup.risk_limits = risk_limits(config);
+    setup.venue.order_latency_ns = static_cast<uint64_t>(config.backtest_order_latency_us * 1000);
+    setup.venue.report_latency_ns = static_cast<uint64_t>(config.backtest_report_latency_us * 1000);
+    
+    // Per-symbol defaults, as the trading system sets them up
+    Backtest::ParameterSet base;
+    for (const std::string& symbol : config.symbols) {
+        base.push_back(market_making_parameters(config, symbol));
+    }
+    
+    // The grid; an empty axis keeps each symbol's own value
+    std::vector<double> spreads = config.backtest_spread_targets;
+    std::vector<double> skews = config.backtest_skew_factors;
+    std::vector<Backtest::ParameterSet> sets;
+    for (size_t i = 0; i < std::max<size_t>(spreads.size(), 1); ++i) {
+        for (size_t j = 0; j < std::max<size_t>(skews.size(), 1); ++j) {
+            Backtest::ParameterSet set = base;
+            for (auto& params : set) {
+                if (!spreads.empty()) params.spread_target = spreads[i];
+                if (!skews.empty()) params.skew_factor = skews[j];
+            }
+            sets.push_back(set);
+        }
+    }
+    
+    size_t threads = config.backtest_threads;
+    int first_cpu = -1;
+    if (threads == 0) {
+        // One worker per core, each pinned
+        threads = std::max(1u, std::thread::hardware_concurrency());
+        first_cpu = 0;
+    }
+    
+    std::cout << "Backtest: " << journal.records() << " packets from " << path << ", "
+              << sets.size() << " runs on " << std::min(threads, sets.size()) << " threads\n";
+    std::cout << "Venue latency: " << config.backtest_order_latency_us << " us in, "
+              << config.backtest_report_latency_us << " us out\n\n";
+    
+    uint64_t start = Timestamp::now();
+    Backtest backtest(journal, setup);
+    std::vector<Backtest::Result> results = backtest.sweep(sets, threads, first_cpu);
+    uint64_t elapsed_ns = Timestamp::to_nanoseconds(Timestamp::now() - start);
+    
+    std::cout << std::setw(12) << "spread" << std::setw(8) << "skew" << std::setw(14) << "P&L"
+              << std::setw(14) << "drawdown" << std::setw(10) << "fills" << std::setw(12) << "volume"
+              << std::setw(10) << "position" << std::setw(10) << "run ms" << "\n";
+    size_t best = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Backtest::Result& r = results[i];
+        const MarketMakingStrategy::Parameters& p = sets[i].front();
+        std::cout << std::setw(12) << p.spread_target << std::setw(8) << p.skew_factor
+                  << std::setw(14) << std::fixed << std::setprecision(2) << r.pnl
+                  << std::setw(14) << r.max_drawdown << std::setw(10) << r.fills
+                  << std::setw(12) << std::setprecision(0) << r.filled_quantity
+                  << std::setw(10) << r.position << std::setw(10) << r.elapsed_ns / 1000000
+                  << std::defaultfloat << std::setprecision(6) << "\n";
+        if (r.pnl > results[best].pnl) {
+            best = i;
+        }
+    }
+    
+    if (!results.empty()) {
+        std::cout << "\nBest: spread_target=" << sets[best].front().spread_target
+                  << " skew_factor=" << sets[best].front().skew_factor
+                  << " (P&L " << results[best].pnl << ")\n";
+    }
+    std::cout << "Sweep took " << elapsed_ns / 1000000 << " ms\n";
+    
+    return 0;
+}
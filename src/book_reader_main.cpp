@@ -0,0 +1,99 @@
+#include "market_data/shm_book.h"
+#include "common/timestamp.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Follows the books a trading process publishes to shared memory
+//
+//   hft_book_reader <region> [symbol ...]
+//
+// Polls the region's update notices and prints, once a second, the top of
+// book and update count of each symbol (all published symbols unless some
+// are given). Survives publisher restarts by reopening the region.
+
+namespace {
+
+std::atomic<bool> running{true};
+
+void signal_handler(int) {
+    running.store(false);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    using namespace hft;
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <region> [symbol ...]\n";
+        return 1;
+    }
+    std::string region = argv[1];
+    std::vector<std::string> wanted(argv + 2, argv + argc);
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+    Timestamp::calibrate_tsc_frequency();
+
+    ShmBookReader reader;
+    std::vector<uint64_t> updates;
+    auto next_report = std::chrono::steady_clock::now();
+
+    while (running.load(std::memory_order_relaxed)) {
+        if (!reader.is_open() || reader.publisher_closed()) {
+            if (!reader.open(region)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                continue;
+            }
+            updates.assign(reader.max_symbols(), 0);
+            std::cout << "Mapped " << region << " (" << reader.symbols() << " symbols)\n";
+        }
+
+        uint32_t id;
+        bool any = false;
+        while (reader.poll(id)) {
+            any = true;
+            if (id != ShmBookReader::RESYNC && id < updates.size()) {
+                ++updates[id];
+            }
+        }
+        if (!any) {
+            cpu_relax();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now < next_report) {
+            continue;
+        }
+        next_report = now + std::chrono::seconds(1);
+
+        for (uint32_t i = 0; i < reader.symbols(); ++i) {
+            const char* symbol = reader.symbol(i);
+            bool listed = wanted.empty();
+            for (const std::string& w : wanted) {
+                listed = listed || w == symbol;
+            }
+            OrderBook::Top top;
+            if (!listed || !reader.read_top(i, top)) {
+                continue;
+            }
+            std::printf("%-8s %10.4f x %-8.0f %10.4f x %-8.0f  %llu updates\n", symbol,
+                        top.best_bid(), top.bid_depth ? top.bid_quantity : 0.0,
+                        top.ask_depth ? top.ask_price : 0.0, top.ask_depth ? top.ask_quantity : 0.0,
+                        static_cast<unsigned long long>(updates[i]));
+            updates[i] = 0;
+        }
+        if (reader.lapped()) {
+            std::printf("(lapped %llu times: the notice ring is too small for this reader)\n",
+                        static_cast<unsigned long long>(reader.lapped()));
+        }
+        std::fflush(stdout);
+    }
+    return 0;
+}
@@ -26,6 +26,7 @@ bool Config::load(const std::string& filename) {
         }
     }
     
+    apply_params();
     return true;
 }
 
@@ -56,4 +57,134 @@ std::string Config::get(const std::string& key) const {
     return "";
 }
 
+std::vector<std::pair<std::string, uint16_t>> Config::parse_channels(const std::string& text) {
+    // Comma separated ip:port list
+    std::vector<std::pair<std::string, uint16_t>> channels;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon != std::string::npos) {
+            channels.emplace_back(item.substr(0, colon),
+                                  static_cast<uint16_t>(std::stoi(item.substr(colon + 1))));
+        }
+    }
+    return channels;
+}
+
+void Config::apply_params() {
+    if (has("market_data_multicast_ip")) market_data_multicast_ip = get<std::string>("market_data_multicast_ip");
+    if (has("market_data_port")) market_data_port = static_cast<uint16_t>(get<int>("market_data_port"));
+    if (has("market_data_line_b_ip")) market_data_line_b_ip = get<std::string>("market_data_line_b_ip");
+    if (has("market_data_line_b_port")) market_data_line_b_port = static_cast<uint16_t>(get<int>("market_data_line_b_port"));
+    if (has("recovery_server_ip")) recovery_server_ip = get<std::string>("recovery_server_ip");
+    if (has("recovery_server_port")) recovery_server_port = static_cast<uint16_t>(get<int>("recovery_server_port"));
+    if (has("market_data_channels")) market_data_channels = parse_channels(get<std::string>("market_data_channels"));
+    if (has("market_data_batch_size")) market_data_batch_size = static_cast<size_t>(get<int>("market_data_batch_size"));
+    if (has("market_data_busy_poll")) {
+        std::string v = get<std::string>("market_data_busy_poll");
+        market_data_busy_poll = (v == "true" || v == "1");
+    }
+    if (has("market_data_transport")) market_data_transport = get<std::string>("market_data_transport");
+    if (has("market_data_rx_timestamping")) market_data_rx_timestamping = get<std::string>("market_data_rx_timestamping");
+    if (has("xdp_interface")) xdp_interface = get<std::string>("xdp_interface");
+    if (has("xdp_queue")) xdp_queue = static_cast<uint32_t>(get<int>("xdp_queue"));
+    if (has("xdp_xskmap_path")) xdp_xskmap_path = get<std::string>("xdp_xskmap_path");
+    if (has("market_data_capture_path")) market_data_capture_path = get<std::string>("market_data_capture_path");
+    if (has("market_data_capture_mb")) market_data_capture_mb = static_cast<size_t>(get<int>("market_data_capture_mb"));
+    if (has("replay_journal")) replay_journal = get<std::string>("replay_journal");
+    if (has("shm_books")) shm_books = get<std::string>("shm_books");
+    if (has("shm_books_ring")) shm_books_ring = static_cast<size_t>(get<int>("shm_books_ring"));
+    if (has("replay_speed")) replay_speed = get<double>("replay_speed");
+    if (has("order_gateway_ip")) order_gateway_ip = get<std::string>("order_gateway_ip");
+    if (has("order_gateway_port")) order_gateway_port = static_cast<uint16_t>(get<int>("order_gateway_port"));
+    if (has("order_gateway_busy_poll")) {
+        std::string v = get<std::string>("order_gateway_busy_poll");
+        order_gateway_busy_poll = (v == "true" || v == "1");
+    }
+    if (has("order_protocol")) order_protocol = get<std::string>("order_protocol");
+    if (has("ouch_token_prefix")) ouch_token_prefix = get<std::string>("ouch_token_prefix");
+    if (has("ouch_firm")) ouch_firm = get<std::string>("ouch_firm");
+    
+    if (has("market_data_cpu")) market_data_cpu = get<int>("market_data_cpu");
+    if (has("strategy_cpu")) strategy_cpu = get<int>("strategy_cpu");
+    if (has("order_manager_cpu")) order_manager_cpu = get<int>("order_manager_cpu");
+    if (has("logger_cpu")) logger_cpu = get<int>("logger_cpu");
+    if (has("realtime_priority")) realtime_priority = get<int>("realtime_priority");
+    if (has("warmup")) {
+        std::string v = get<std::string>("warmup");
+        warmup = (v == "true" || v == "1");
+    }
+    if (has("lock_memory")) {
+        std::string v = get<std::string>("lock_memory");
+        lock_memory = (v == "true" || v == "1");
+    }
+    if (has("warmup_min_ticks")) warmup_min_ticks = static_cast<size_t>(get<int>("warmup_min_ticks"));
+    if (has("warmup_max_ticks")) warmup_max_ticks = static_cast<size_t>(get<int>("warmup_max_ticks"));
+    if (has("pipeline_mode")) {
+        std::string v = get<std::string>("pipeline_mode");
+        pipeline_mode = (v == "true" || v == "1");
+    }
+    if (has("pipeline_busy_poll")) {
+        std::string v = get<std::string>("pipeline_busy_poll");
+        pipeline_busy_poll = (v == "true" || v == "1");
+    }
+    if (has("pipeline_conflation")) {
+        std::string v = get<std::string>("pipeline_conflation");
+        pipeline_conflation = (v == "true" || v == "1");
+    }
+    if (has("feed_shards")) feed_shards = static_cast<size_t>(get<int>("feed_shards"));
+    
+    if (has("symbols")) {
+        // Comma separated
+        std::stringstream list(get<std::string>("symbols"));
+        std::string item;
+        symbols.clear();
+        while (std::getline(list, item, ',')) {
+            if (!item.empty()) {
+                symbols.push_back(item);
+            }
+        }
+    }
+    if (has("max_symbols")) max_symbols = static_cast<size_t>(get<int>("max_symbols"));
+    if (has("max_position_size")) max_position_size = get<double>("max_position_size");
+    if (has("max_order_size")) max_order_size = get<double>("max_order_size");
+    if (has("max_orders_per_second")) max_orders_per_second = static_cast<uint32_t>(get<int>("max_orders_per_second"));
+    if (has("max_order_burst")) max_order_burst = static_cast<uint32_t>(get<int>("max_order_burst"));
+    if (has("spread_threshold")) spread_threshold = get<double>("spread_threshold");
+    if (has("arbitrage_basket_file")) arbitrage_basket_file = get<std::string>("arbitrage_basket_file");
+    if (has("arbitrage_threshold_bps")) arbitrage_threshold_bps = get<double>("arbitrage_threshold_bps");
+    if (has("arbitrage_order_size")) arbitrage_order_size = get<double>("arbitrage_order_size");
+    if (has("arbitrage_tick_size")) arbitrage_tick_size = get<double>("arbitrage_tick_size");
+    
+    auto parse_doubles = [this](const char* key, std::vector<double>& values) {
+        std::stringstream list(get<std::string>(key));
+        std::string item;
+        values.clear();
+        while (std::getline(list, item, ',')) {
+            if (!item.empty()) {
+                values.push_back(std::stod(item));
+            }
+        }
+    };
+    if (has("backtest_spread_targets")) parse_doubles("backtest_spread_targets", backtest_spread_targets);
+    if (has("backtest_skew_factors")) parse_doubles("backtest_skew_factors", backtest_skew_factors);
+    if (has("backtest_threads")) backtest_threads = static_cast<size_t>(get<int>("backtest_threads"));
+    if (has("backtest_order_latency_us")) backtest_order_latency_us = get<double>("backtest_order_latency_us");
+    if (has("backtest_report_latency_us")) backtest_report_latency_us = get<double>("backtest_report_latency_us");
+    
+    if (has("feed_protocol")) feed_protocol = get<std::string>("feed_protocol");
+    
+    if (has("order_book_depth")) order_book_depth = static_cast<size_t>(get<int>("order_book_depth"));
+    if (has("enable_kernel_bypass")) {
+        std::string v = get<std::string>("enable_kernel_bypass");
+        enable_kernel_bypass = (v == "true" || v == "1");
+    }
+    if (has("latency_stages")) {
+        std::string v = get<std::string>("latency_stages");
+        latency_stages = (v == "true" || v == "1");
+    }
+    if (has("latency_report_interval_s")) latency_report_interval_s = static_cast<size_t>(get<int>("latency_report_interval_s"));
+}
+
 } // namespace hft
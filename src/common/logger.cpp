@@ -1,53 +1,260 @@
 #include "common/logger.h"
-#include <cstring>
-#include <iostream>
-#include <thread>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace hft {
 
+namespace {
+
+constexpr size_t WRITE_BATCH = 64 * 1024;   // Bytes buffered per write()
+
+const char* level_name(Logger::Level level) {
+    switch (level) {
+        case Logger::Level::DEBUG: return "DEBUG";
+        case Logger::Level::INFO: return "INFO";
+        case Logger::Level::WARNING: return "WARN";
+        case Logger::Level::ERROR: return "ERROR";
+        case Logger::Level::CRITICAL: return "CRIT";
+    }
+    return "?";
+}
+
+} // namespace
+
 Logger::Logger() {
-    // Start background flush thread
-    std::thread flush_thread(&Logger::flush_worker, this);
-    flush_thread.detach();
+    out_.reserve(WRITE_BATCH * 2);
+    writer_ = std::thread(&Logger::writer_loop, this);
 }
 
 Logger::~Logger() {
     running_.store(false, std::memory_order_release);
+    if (writer_.joinable()) {
+        writer_.join();
+    }
     flush();
 }
 
-void Logger::log(Level level, const char* message) {
-    if (level < min_level_.load(std::memory_order_relaxed)) {
-        return;
+Logger::ThreadRing* Logger::register_thread() {
+    // Cold path: once per thread
+    ThreadRing* ring;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        if (!free_rings_.empty()) {
+            ring = free_rings_.back();
+            free_rings_.pop_back();
+            ring->free = false;
+            ring->retired.store(false, std::memory_order_relaxed);
+        } else {
+            rings_.push_back(std::make_unique<ThreadRing>());
+            ring = rings_.back().get();
+        }
     }
     
-    // Get next write position (lock-free)
-    size_t index = write_index_.fetch_add(1, std::memory_order_acq_rel) % BUFFER_SIZE;
-    
-    auto& entry = buffer_[index];
-    entry.timestamp = Timestamp::wall_clock_ns();
-    entry.level = level;
-    std::strncpy(entry.message, message, sizeof(entry.message) - 1);
-    entry.message[sizeof(entry.message) - 1] = '\0';
+    // Retired after the thread's last record (release: the writer sees
+    // every record before the flag)
+    struct Retire {
+        ThreadRing* ring;
+        ~Retire() { ring->retired.store(true, std::memory_order_release); }
+    };
+    thread_local Retire retire{ring};
+    return ring;
+}
+
+void Logger::recycle(ThreadRing* ring) {
+    // Writer side, drain_mutex_ held: empty after its owner retired means
+    // nothing more can arrive
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    if (!ring->free && ring->retired.load(std::memory_order_acquire) && ring->records.front() == nullptr) {
+        ring->free = true;
+        free_rings_.push_back(ring);
+    }
+}
+
+uint64_t Logger::dropped() const {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    uint64_t total = 0;
+    for (const auto& ring : rings_) {
+        total += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t Logger::rings() const {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    return rings_.size();
 }
 
 void Logger::flush() {
-    // In production, this would write to disk or network
-    // For now, just print to stdout
-    for (size_t i = 0; i < BUFFER_SIZE; ++i) {
-        const auto& entry = buffer_[i];
-        if (entry.timestamp > 0) {
-            std::cout << entry.timestamp << " [" << static_cast<int>(entry.level) 
-                      << "] " << entry.message << std::endl;
-        }
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    while (drain() > 0) {
     }
+    write_out();
 }
 
-void Logger::flush_worker() {
+void Logger::writer_loop() {
+    int pinned_cpu = -1;
+    
     while (running_.load(std::memory_order_acquire)) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        // In production, would flush to disk here
+#ifdef __linux__
+        int cpu = writer_cpu_.load(std::memory_order_relaxed);
+        if (cpu >= 0 && cpu != pinned_cpu) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(cpu, &cpuset);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+            pinned_cpu = cpu;
+        }
+#endif
+
+        size_t drained;
+        {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            drained = drain();
+            write_out();
+        }
+        
+        // Idle: producers never wait on us, so a short sleep is fine
+        if (drained == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    (void)pinned_cpu;
+}
+
+size_t Logger::drain() {
+    // Called with drain_mutex_ held
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        draining_.clear();
+        for (const auto& ring : rings_) {
+            draining_.push_back(ring.get());
+        }
+    }
+    
+    size_t count = 0;
+    for (ThreadRing* ring : draining_) {
+        while (Record* record = ring->records.front()) {
+            format(*record);
+            ring->records.pop();
+            ++count;
+            if (out_.size() >= WRITE_BATCH) {
+                write_out();
+            }
+        }
+        
+        uint64_t dropped = ring->dropped.load(std::memory_order_relaxed);
+        if (dropped != ring->dropped_reported) {
+            Record note{};
+            note.timestamp = Timestamp::fast_wall_clock_ns();
+            note.format = "Logger dropped {} records (ring full)";
+            note.level = Level::WARNING;
+            size_t used = 0;
+            encode(note.args, used, dropped - ring->dropped_reported);
+            note.arg_bytes = static_cast<uint8_t>(used);
+            format(note);
+            ring->dropped_reported = dropped;
+        }
+        
+        if (__builtin_expect(ring->retired.load(std::memory_order_acquire), 0)) {
+            recycle(ring);
+        }
+    }
+    written_.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+void Logger::append(const char* data, size_t len) {
+    out_.insert(out_.end(), data, data + len);
+}
+
+void Logger::format(const Record& record) {
+    char number[32];
+    auto append_number = [&](auto value) {
+        auto result = std::to_chars(number, number + sizeof(number), value);
+        append(number, static_cast<size_t>(result.ptr - number));
+    };
+    
+    append_number(record.timestamp);
+    append(" [", 2);
+    const char* level = level_name(record.level);
+    append(level, std::strlen(level));
+    append("] ", 2);
+    
+    // Substitute arguments for "{}" in order; surplus placeholders stay
+    size_t pos = 0;
+    for (const char* p = record.format; *p; ++p) {
+        if (p[0] != '{' || p[1] != '}' || pos >= record.arg_bytes) {
+            out_.push_back(*p);
+            continue;
+        }
+        ++p;
+        
+        auto type = static_cast<ArgType>(record.args[pos]);
+        const char* value = record.args + pos + 1;
+        switch (type) {
+            case ArgType::I64: {
+                int64_t v;
+                std::memcpy(&v, value, sizeof(v));
+                append_number(v);
+                pos += 1 + sizeof(v);
+                break;
+            }
+            case ArgType::U64: {
+                uint64_t v;
+                std::memcpy(&v, value, sizeof(v));
+                append_number(v);
+                pos += 1 + sizeof(v);
+                break;
+            }
+            case ArgType::F64: {
+                double v;
+                std::memcpy(&v, value, sizeof(v));
+                append_number(v);
+                pos += 1 + sizeof(v);
+                break;
+            }
+            case ArgType::BOOL: {
+                const char* v = value[0] ? "true" : "false";
+                append(v, std::strlen(v));
+                pos += 2;
+                break;
+            }
+            case ArgType::CHAR:
+                out_.push_back(value[0]);
+                pos += 2;
+                break;
+            case ArgType::STR: {
+                size_t len = static_cast<uint8_t>(value[0]);
+                append(value + 1, len);
+                pos += 2 + len;
+                break;
+            }
+        }
+    }
+    out_.push_back('\n');
+}
+
+void Logger::write_out() {
+    int fd = output_fd_.load(std::memory_order_relaxed);
+    size_t offset = 0;
+    while (offset < out_.size()) {
+        ssize_t n = ::write(fd, out_.data() + offset, out_.size() - offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;  // Nowhere to report it; drop the batch
+        }
+        offset += static_cast<size_t>(n);
     }
+    out_.clear();
 }
 
 } // namespace hft
@@ -0,0 +1,74 @@
+#include "common/tick_to_trade.h"
+#include <cstdio>
+
+namespace hft {
+
+const char* TickToTrade::stage_name(Stage stage) {
+    switch (stage) {
+        case RECV: return "recv";
+        case DECODE: return "decode";
+        case BOOK: return "book";
+        case STRATEGY: return "strategy";
+        case RISK: return "risk";
+        case ENCODE: return "encode";
+        case SEND: return "send";
+        case TOTAL: return "tick-to-trade";
+        case STAGES: break;
+    }
+    return "?";
+}
+
+void TickToTrade::commit(Trace& trace) noexcept {
+    // Only orders caused by a book update of the packet in hand, each
+    // update once, and only if it put something on the wire
+    uint64_t start = trace.stamp[RECV];
+    if (start == 0 || trace.stamp[BOOK] < start || trace.stamp[BOOK] <= trace.committed ||
+        trace.stamp[ENCODE] < trace.stamp[BOOK]) {
+        return;
+    }
+    trace.committed = trace.stamp[SEND];
+
+    Histograms& histograms = *trace.histograms;
+    if (trace.rx_timestamp_ns) {
+        uint64_t handed_over = Timestamp::wall_clock_at(start);
+        if (handed_over > trace.rx_timestamp_ns) {
+            histograms.stage[RECV].record(handed_over - trace.rx_timestamp_ns);
+        }
+    }
+
+    // Stamps older than the previous stage belong to earlier ticks
+    uint64_t previous = start;
+    for (int s = DECODE; s <= SEND; ++s) {
+        uint64_t stamp = trace.stamp[s];
+        if (stamp > previous) {
+            histograms.stage[s].record(Timestamp::to_nanoseconds(stamp - previous));
+            previous = stamp;
+        } else {
+            histograms.stage[s].record(0);
+        }
+    }
+    histograms.stage[TOTAL].record(Timestamp::to_nanoseconds(trace.stamp[SEND] - start));
+}
+
+std::string TickToTrade::report(const Histograms& histograms) {
+    std::string text;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-14s %10s %8s %8s %8s %8s %8s  (ns)\n",
+                  "stage", "samples", "p50", "p90", "p99", "p99.9", "max");
+    text += line;
+    for (int s = 0; s < STAGES; ++s) {
+        const LatencyHistogram& h = histograms.stage[s];
+        std::snprintf(line, sizeof(line), "%-14s %10llu %8llu %8llu %8llu %8llu %8llu\n",
+                      stage_name(static_cast<Stage>(s)),
+                      static_cast<unsigned long long>(h.count()),
+                      static_cast<unsigned long long>(h.value_at_percentile(50)),
+                      static_cast<unsigned long long>(h.value_at_percentile(90)),
+                      static_cast<unsigned long long>(h.value_at_percentile(99)),
+                      static_cast<unsigned long long>(h.value_at_percentile(99.9)),
+                      static_cast<unsigned long long>(h.max()));
+        text += line;
+    }
+    return text;
+}
+
+} // namespace hft
@@ -1,25 +1,109 @@
 #include "common/timestamp.h"
 #include <thread>
 
+#if defined(HFT_X86)
+#include <cpuid.h>
+#endif
+
 namespace hft {
 
+bool Timestamp::has_invariant_tsc() noexcept {
+#if defined(HFT_X86)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+#elif defined(HFT_ARM)
+    // The generic timer runs at a fixed rate by architecture
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Timestamp::set_frequency(double hz) noexcept {
+    tsc_frequency_ = hz;
+    ns_mult_ = static_cast<uint64_t>(1e9 / hz * static_cast<double>(1ULL << NS_SHIFT) + 0.5);
+}
+
 double Timestamp::calibrate_tsc_frequency() {
-    // Measure TSC frequency by comparing with wall clock
-    auto wall_start = std::chrono::high_resolution_clock::now();
-    auto tsc_start = now();
+#if defined(HFT_X86)
+    // A TSC that changes rate or stops cannot be converted to time
+    if (!has_invariant_tsc()) {
+        use_chrono_ = true;
+        set_frequency(1e9);
+        resync_wall_clock();
+        calibrated_ = true;
+        return tsc_frequency_;
+    }
+#elif defined(HFT_ARM)
+    // The counter advertises its own frequency
+    uint64_t hz;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(hz));
+    set_frequency(static_cast<double>(hz));
+    resync_wall_clock();
+    calibrated_ = true;
+    return tsc_frequency_;
+#else
+    set_frequency(1e9);
+    resync_wall_clock();
+    calibrated_ = true;
+    return tsc_frequency_;
+#endif
+    
+    // Measure TSC frequency by comparing with a monotonic clock. Each end
+    // point brackets the clock read with two counter reads and keeps the
+    // tightest try, so read jitter stays far below the 100ms window.
+    auto sample = [](uint64_t& tsc, int64_t& clock_ns) {
+        uint64_t best_gap = ~0ULL;
+        for (int i = 0; i < 8; ++i) {
+            uint64_t before = now();
+            auto clock = std::chrono::steady_clock::now();
+            uint64_t after = now();
+            if (after - before < best_gap) {
+                best_gap = after - before;
+                tsc = before + (after - before) / 2;
+                clock_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    clock.time_since_epoch()).count();
+            }
+        }
+    };
+    
+    uint64_t tsc_start, tsc_end;
+    int64_t clock_start, clock_end;
+    sample(tsc_start, clock_start);
     
     // Sleep for a short duration
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
     
-    auto tsc_end = now();
-    auto wall_end = std::chrono::high_resolution_clock::now();
+    sample(tsc_end, clock_end);
     
-    auto wall_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        wall_end - wall_start).count();
+    auto wall_duration = clock_end - clock_start;
     auto tsc_duration = tsc_end - tsc_start;
     
-    tsc_frequency_ = static_cast<double>(tsc_duration) / wall_duration * 1e9;
+    set_frequency(static_cast<double>(tsc_duration) / wall_duration * 1e9);
+    resync_wall_clock();
+    calibrated_ = true;
     return tsc_frequency_;
 }
 
+void Timestamp::resync_wall_clock() noexcept {
+    // Bracket the clock read with two counter reads and keep the tightest
+    // of a few tries so the anchor pair is within tens of nanoseconds
+    uint64_t best_gap = ~0ULL;
+    uint64_t offset = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint64_t before = now();
+        uint64_t wall = chrono_ns();
+        uint64_t after = now();
+        if (after - before < best_gap) {
+            best_gap = after - before;
+            offset = wall - to_nanoseconds(before + (after - before) / 2);
+        }
+    }
+    wall_offset_ns_.store(offset, std::memory_order_relaxed);
+}
+
 } // namespace hft
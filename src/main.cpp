@@ -1,23 +1,41 @@
 #include "market_data/market_data_handler.h"
 #include "market_data/order_book.h"
+#include "market_data/feed_journal.h"
+#include "market_data/feed_replay.h"
+#include "market_data/shm_book.h"
 #include "network/udp_receiver.h"
+#include "network/xdp_transport.h"
 #include "network/tcp_sender.h"
+#include "network/ouch_encoder.h"
 #include "trading/strategy.h"
+#include "trading/strategy_router.h"
+#include "trading/pipeline.h"
+#include "trading/sharded_feed.h"
 #include "trading/order_manager.h"
+#include "trading/warmup.h"
+#include "trading/parameter_reload.h"
 #include "common/config.h"
 #include "common/logger.h"
+#include "common/tick_to_trade.h"
 #include "common/timestamp.h"
+#include <algorithm>
 #include <iostream>
+#include <cstring>
 #include <memory>
+#include <vector>
 #include <csignal>
 #include <atomic>
+#include <unistd.h>
 
 std::atomic<bool> running{true};
+std::atomic<bool> reload_requested{false};
 
 void signal_handler(int signal) {
     if (signal == SIGINT || signal == SIGTERM) {
         std::cout << "\nShutting down...\n";
         running.store(false);
+    } else if (signal == SIGHUP) {
+        reload_requested.store(true);
     }
 }
 
@@ -32,11 +50,17 @@ int main(int argc, char* argv[]) {
     // Setup signal handlers
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
+    std::signal(SIGHUP, signal_handler);
     
     // Calibrate timestamp
     std::cout << "Calibrating TSC...\n";
     double tsc_freq = Timestamp::calibrate_tsc_frequency();
-    std::cout << "TSC Frequency: " << tsc_freq / 1e9 << " GHz\n\n";
+    if (Timestamp::tsc_enabled()) {
+        std::cout << "TSC Frequency: " << tsc_freq / 1e9 << " GHz\n\n";
+    } else {
+        std::cout << "No invariant TSC, timestamps use the system clock\n\n";
+    }
+    uint64_t startup_tsc = Timestamp::now();
     
     // Load configuration
     Config config;
@@ -50,58 +74,289 @@ int main(int argc, char* argv[]) {
     std::cout << "Market Data: " << config.market_data_multicast_ip 
               << ":" << config.market_data_port << "\n";
     std::cout << "Order Gateway: " << config.order_gateway_ip 
-              << ":" << config.order_gateway_port << "\n\n";
+              << ":" << config.order_gateway_port << "\n";
+    std::cout << "Feed Protocol: " << config.feed_protocol << "\n";
+    std::cout << "Order Book Depth: " << config.order_book_depth << " levels\n\n";
     
     // Initialize components
     std::cout << "Initializing trading system...\n\n";
+    Logger::instance().set_writer_cpu(config.logger_cpu);
     
-    // 1. Market data handler
-    MarketDataHandler md_handler;
-    md_handler.add_symbol("AAPL");
-    md_handler.add_symbol("MSFT");
-    md_handler.add_symbol("GOOGL");
+    // 1. Market data handler (and its shared memory publisher, which
+    // must outlive it); with feed_shards > 1 one per shard instead, set up
+    // with the strategies (5.)
+    bool sharded = config.feed_shards > 1;
+    ShmBookPublisher book_publisher;
+    MarketDataHandler md_handler(std::max(config.max_symbols, config.symbols.size()),
+                                 HugePageBuffer::numa_node_of_cpu(config.market_data_cpu));
+    for (const std::string& symbol : config.symbols) {
+        md_handler.add_symbol(symbol);
+    }
+    FeedProtocol feed_protocol = FeedProtocol::SIMPLE;
+    if (config.feed_protocol == "itch50_moldudp64") {
+        feed_protocol = FeedProtocol::ITCH50_MOLDUDP64;
+    } else if (config.feed_protocol == "itch50_framed") {
+        feed_protocol = FeedProtocol::ITCH50_FRAMED;
+    }
+    md_handler.set_feed_protocol(feed_protocol);
+    md_handler.set_book_depth(config.order_book_depth);
+    if (!config.shm_books.empty() && sharded) {
+        // One writer per region: shards would need one each
+        std::cout << "shm_books is not published with feed_shards > 1\n";
+    } else if (!config.shm_books.empty() &&
+               book_publisher.open(config.shm_books, md_handler.max_symbols(), config.shm_books_ring)) {
+        md_handler.set_publisher(&book_publisher);
+    }
     
     // 2. TCP sender for orders
     TCPSender order_sender(config.order_gateway_ip, config.order_gateway_port);
     order_sender.set_cpu_affinity(config.order_manager_cpu);
+    order_sender.set_realtime_priority(config.realtime_priority);
     order_sender.enable_tcp_optimizations();
+    if (config.order_gateway_busy_poll) {
+        order_sender.set_wait_mode(TCPSender::WaitMode::BUSY_POLL);
+    }
+    
+    if (config.order_protocol == "ouch42") {
+        // Every message template is encoded here, before trading starts
+        OuchEncoder::Options ouch;
+        std::strncpy(ouch.token_prefix, config.ouch_token_prefix.c_str(), sizeof(ouch.token_prefix) - 1);
+        std::strncpy(ouch.firm, config.ouch_firm.c_str(), sizeof(ouch.firm) - 1);
+        auto encoder = std::make_unique<OuchEncoder>(ouch);
+        for (const std::string& symbol : config.symbols) {
+            encoder->add_symbol(symbol.c_str());
+        }
+        order_sender.set_encoder(std::move(encoder));
+    }
     
     // Note: In demo mode, we won't actually connect
     std::cout << "[DEMO MODE] Skipping TCP connection to order gateway\n";
     
     // 3. Order manager with risk limits
     OrderManager order_manager(order_sender);
-    OrderManager::RiskLimits limits;
-    limits.max_order_size = config.max_order_size;
-    limits.max_position = config.max_position_size;
-    order_manager.set_risk_limits(limits);
+    order_manager.set_risk_limits(risk_limits(config));
+    order_sender.set_execution_callback([&order_manager](const ExecutionReport& report) {
+        order_manager.enqueue_execution_report(report);
+    });
     
-    // 4. Trading strategy
-    MarketMakingStrategy::Parameters strategy_params;
-    strategy_params.spread_target = config.spread_threshold;
-    strategy_params.max_position = config.max_position_size;
+    // 4. Trading strategies: one per symbol, each with its own parameters
+    // (<symbol>.<key> overrides the defaults). SIGHUP reloads them and the
+    // risk limits from the config file without stopping.
+    std::vector<std::unique_ptr<MarketMakingStrategy>> strategies;
+    ParameterReloader reloader(order_manager, argc > 1 ? argv[1] : "");
+    for (const std::string& symbol : config.symbols) {
+        strategies.push_back(std::make_unique<MarketMakingStrategy>(order_manager,
+                                                                    market_making_parameters(config, symbol)));
+        reloader.add_strategy(strategies.back().get());
+    }
     
-    auto strategy = std::make_unique<MarketMakingStrategy>(order_sender, strategy_params);
+    // Basket arbitrage over every instrument of the basket file
+    std::unique_ptr<ArbitrageStrategy> arbitrage;
+    if (!config.arbitrage_basket_file.empty()) {
+        ArbitrageStrategy::Parameters arbitrage_params;
+        arbitrage_params.order_size = config.arbitrage_order_size;
+        arbitrage_params.tick_size = config.arbitrage_tick_size;
+        arbitrage_params.max_instruments = md_handler.max_symbols();
+        arbitrage = std::make_unique<ArbitrageStrategy>(order_manager, arbitrage_params);
+        if (arbitrage->fair_value().load(config.arbitrage_basket_file, config.arbitrage_threshold_bps)) {
+            arbitrage->finalize();
+        } else {
+            arbitrage.reset();
+        }
+    }
     
-    // 5. Register callback for market data updates
-    md_handler.register_callback([&strategy](const OrderBook& book) {
-        strategy->on_order_book_update(book);
-    });
+    // 5. Route each book's updates to its strategies (static dispatch).
+    // Sharded: each symbol in the handler and router of its shard, the
+    // strategies on one thread fed by every shard
+    std::unique_ptr<ShardedFeed> sharded_feed;
+    if (sharded) {
+        ShardedFeed::Options shard_options;
+        shard_options.strategy_cpu = config.strategy_cpu;
+        shard_options.realtime_priority = config.realtime_priority;
+        shard_options.busy_poll = config.pipeline_busy_poll;
+        shard_options.max_symbols = md_handler.max_symbols();
+        sharded_feed = std::make_unique<ShardedFeed>(feed_partition(config), order_manager, shard_options);
+        sharded_feed->set_feed_protocol(feed_protocol);
+        sharded_feed->set_book_depth(config.order_book_depth);
+    }
+    auto subscribe = [&sharded_feed, &md_handler](StrategyRouter& routes, const std::string& symbol,
+                                                  StrategyRef strategy) {
+        if (sharded_feed) {
+            return sharded_feed->subscribe(symbol, strategy);
+        }
+        md_handler.add_symbol(symbol);
+        return routes.subscribe(symbol, strategy);
+    };
+    StrategyRouter router(md_handler);
+    for (const auto& strategy : strategies) {
+        subscribe(router, strategy->symbol(), strategy.get());
+    }
+    if (arbitrage) {
+        const FairValueEngine& engine = arbitrage->fair_value();
+        for (uint32_t i = 0; i < engine.instruments(); ++i) {
+            subscribe(router, engine.instrument_symbol(i), arbitrage.get());
+        }
+    }
     
-    // 6. UDP receiver for market data
-    UDPReceiver udp_receiver(md_handler, config.market_data_multicast_ip, 
-                             config.market_data_port);
-    udp_receiver.set_cpu_affinity(config.market_data_cpu);
-    if (config.enable_kernel_bypass) {
-        udp_receiver.enable_kernel_bypass();
+    // Pre-open warm-up on the feed core (each shard's, in turn), before
+    // any stage thread starts
+    auto warm_up = [&](MarketDataHandler& handler, StrategyRouter& routes, int cpu) {
+        Warmup::Options warmup_options;
+        warmup_options.cpu = cpu;
+        warmup_options.realtime_priority = config.realtime_priority;
+        warmup_options.lock_memory = config.lock_memory;
+        warmup_options.min_ticks = config.warmup_min_ticks;
+        warmup_options.max_ticks = config.warmup_max_ticks;
+        Warmup warmup(handler, routes, order_manager, order_sender, warmup_options);
+        std::cout << "Warming up (synthetic ticks, sending suppressed)...\n";
+        Warmup::Result warm = warmup.run(&running);
+        if (warm.memory_locked) {
+            std::cout << "  Memory locked (mlockall)\n";
+        } else {
+            std::cout << "  Memory not locked, prefaulted " << (warm.prefaulted_bytes >> 20) << " MB\n";
+        }
+        std::cout << "  " << warm.ticks << " ticks, " << warm.samples << " reached the sender"
+                  << (warm.steady ? ", steady" : ", not steady by warmup_max_ticks") << "\n";
+        std::cout << "  Tick-to-trade first " << warm.first_tick_ns << " ns, p50 " << warm.first_p50_ns << " -> " << warm.last_p50_ns
+                  << " ns, p99 " << warm.first_p99_ns << " -> " << warm.last_p99_ns << " ns\n";
+        std::cout << "  Warm-up took " << warm.elapsed_ns / 1000000.0 << " ms\n\n";
+    };
+    if (config.warmup && sharded_feed) {
+        for (size_t i = 0; i < sharded_feed->shards(); ++i) {
+            if (sharded_feed->router(i).books() == 0) {
+                continue;           // Nothing routed: nothing to warm
+            }
+            std::cout << "Feed shard " << i << ": ";
+            warm_up(sharded_feed->handler(i), sharded_feed->router(i), sharded_feed->cpu(i));
+        }
+    } else if (config.warmup) {
+        warm_up(md_handler, router, config.market_data_cpu);
     }
     
-    std::cout << "System initialized successfully!\n\n";
+    // Pipelined mode: strategies and order sending on their own cores
+    // (sharded feeds have their own strategy thread)
+    std::unique_ptr<TradingPipeline> pipeline;
+    if (config.pipeline_mode && sharded_feed) {
+        std::cout << "pipeline_mode is ignored with feed_shards > 1\n";
+    } else if (config.pipeline_mode) {
+        TradingPipeline::Options pipeline_options;
+        pipeline_options.strategy_cpu = config.strategy_cpu;
+        pipeline_options.sender_cpu = config.order_manager_cpu;
+        pipeline_options.realtime_priority = config.realtime_priority;
+        pipeline_options.busy_poll = config.pipeline_busy_poll;
+        pipeline_options.conflate = config.pipeline_conflation;
+        pipeline = std::make_unique<TradingPipeline>(md_handler, router, order_manager,
+                                                     order_sender, pipeline_options);
+        pipeline->start();
+    }
+    if (sharded_feed) {
+        sharded_feed->start();
+    }
+    
+    // 6. UDP receiver for market data; sharded, one per shard on the
+    // shard's core, joined to the shard's groups only (its first group is
+    // the primary, the B line and recovery server go with the main group;
+    // AF_XDP: shard i binds queue xdp_queue + i, captures go to
+    // <market_data_capture_path>.<i>)
+    std::vector<std::unique_ptr<UDPReceiver>> receivers;
+    auto add_receiver = [&config, &receivers](MarketDataHandler& handler, int cpu,
+                                              const std::vector<std::pair<std::string, uint16_t>>& channels,
+                                              uint32_t xdp_queue, const std::string& capture_path) {
+        auto receiver = std::make_unique<UDPReceiver>(handler, channels[0].first, channels[0].second);
+        UDPReceiver& udp_receiver = *receiver;
+        udp_receiver.set_cpu_affinity(cpu);
+        udp_receiver.set_realtime_priority(config.realtime_priority);
+        bool main_group = channels[0].first == config.market_data_multicast_ip &&
+                          channels[0].second == config.market_data_port;
+        if (main_group && !config.market_data_line_b_ip.empty()) {
+            udp_receiver.set_line_b(config.market_data_line_b_ip, config.market_data_line_b_port);
+        }
+        if (main_group && !config.recovery_server_ip.empty()) {
+            udp_receiver.set_recovery_server(config.recovery_server_ip, config.recovery_server_port);
+        }
+        for (size_t i = 1; i < channels.size(); ++i) {
+            udp_receiver.add_channel(channels[i].first, channels[i].second);
+        }
+        udp_receiver.set_batch_size(config.market_data_batch_size);
+        if (config.market_data_busy_poll) {
+            udp_receiver.set_wait_mode(UDPReceiver::WaitMode::BUSY_POLL);
+        }
+        if (config.enable_kernel_bypass) {
+            udp_receiver.enable_kernel_bypass();
+        }
+        if (config.market_data_rx_timestamping == "software") {
+            udp_receiver.set_rx_timestamping(RxTimestamping::SOFTWARE);
+        } else if (config.market_data_rx_timestamping == "hardware") {
+            udp_receiver.set_rx_timestamping(RxTimestamping::HARDWARE);
+        }
+        if (config.market_data_transport == "af_xdp") {
+            XdpTransport::Options xdp;
+            xdp.interface = config.xdp_interface;
+            xdp.queue = xdp_queue;
+            xdp.xskmap_path = config.xdp_xskmap_path;
+            xdp.batch_size = config.market_data_batch_size;
+            udp_receiver.set_transport(std::make_unique<XdpTransport>(xdp));
+        }
+        if (!capture_path.empty()) {
+            auto journal = std::make_unique<FeedJournalWriter>();
+            if (journal->open(capture_path, config.market_data_capture_mb << 20)) {
+                udp_receiver.set_capture(std::move(journal));
+            }
+        }
+        receivers.push_back(std::move(receiver));
+    };
+    if (sharded_feed) {
+        for (size_t i = 0; i < sharded_feed->shards(); ++i) {
+            std::string capture_path = config.market_data_capture_path.empty() ? ""
+                : config.market_data_capture_path + "." + std::to_string(i);
+            add_receiver(sharded_feed->handler(i), sharded_feed->cpu(i), sharded_feed->partition().shards[i].channels,
+                         config.xdp_queue + static_cast<uint32_t>(i), capture_path);
+        }
+    } else {
+        std::vector<std::pair<std::string, uint16_t>> channels = {
+            {config.market_data_multicast_ip, config.market_data_port}};
+        channels.insert(channels.end(), config.market_data_channels.begin(), config.market_data_channels.end());
+        add_receiver(md_handler, config.market_data_cpu, channels, config.xdp_queue, config.market_data_capture_path);
+    }
+    // Tick-to-trade stages, one set per thread that trades inline
+    auto receiver_stages = std::make_unique<TickToTrade::Histograms>();
+    auto replay_stages = std::make_unique<TickToTrade::Histograms>();
+    if (config.latency_stages && !sharded_feed) {
+        receivers[0]->set_latency_stages(receiver_stages.get());
+    }
+    auto stage_totals = [&receiver_stages, &replay_stages]() {
+        TickToTrade::Histograms totals = *receiver_stages;
+        totals.merge(*replay_stages);
+        return totals;
+    };
+    
+    std::cout << "System initialized successfully!\n";
+    std::cout << "Time to ready: " << Timestamp::to_nanoseconds(Timestamp::now() - startup_tsc) / 1000000.0
+              << " ms\n\n";
     std::cout << "Components:\n";
     std::cout << "  ✓ Market Data Handler\n";
+    if (book_publisher.is_open()) {
+        std::cout << "  ✓ Books published to shared memory " << config.shm_books << "\n";
+    }
     std::cout << "  ✓ Order Book Engine (lock-free)\n";
-    std::cout << "  ✓ Trading Strategy: " << strategy->name() << "\n";
+    std::cout << "  ✓ Trading Strategies: " << strategies.size() << " x MarketMaking (one per symbol)\n";
+    if (arbitrage) {
+        std::cout << "  ✓ Basket arbitrage: " << arbitrage->fair_value().baskets() << " baskets over "
+                  << arbitrage->fair_value().instruments() << " instruments\n";
+    }
     std::cout << "  ✓ Order Manager (with risk controls)\n";
+    if (pipeline) {
+        std::cout << "  ✓ Pipelined: strategy on CPU " << config.strategy_cpu
+                  << ", order sending on CPU " << config.order_manager_cpu
+                  << (pipeline->conflating() ? " (conflated books)" : "") << "\n";
+    }
+    if (sharded_feed) {
+        std::cout << "  ✓ Feed shards: " << sharded_feed->shards() << " (receiver CPUs";
+        for (size_t i = 0; i < sharded_feed->shards(); ++i) {
+            std::cout << " " << sharded_feed->cpu(i);
+        }
+        std::cout << "), strategies on CPU " << config.strategy_cpu << "\n";
+    }
     std::cout << "  ✓ Network Stack (UDP/TCP)\n\n";
     
     std::cout << "Performance optimizations:\n";
@@ -116,7 +371,9 @@ int main(int argc, char* argv[]) {
     std::cout << "\n";
     
     // Note: In production, we would:
-    // - Start the UDP receiver: udp_receiver.start();
+    // - Connect and start the execution report reader:
+    //   order_sender.connect(); order_sender.start_reader();
+    // - Start the UDP receivers: receiver->start() for each
     // - Run the main event loop
     // - Process fills and updates
     
@@ -143,26 +400,104 @@ int main(int argc, char* argv[]) {
     std::cout << "  • High-precision timestamping (RDTSC)\n";
     std::cout << "  • Risk management and order validation\n\n";
     
-    std::cout << "Press Ctrl+C to exit...\n";
+    // Replay mode: a captured session through the same handler and strategies
+    if (!config.replay_journal.empty() && sharded_feed) {
+        std::cout << "Replay runs on one feed handler: set feed_shards=1 to replay "
+                  << config.replay_journal << "\n\n";
+    } else if (!config.replay_journal.empty()) {
+        FeedJournalReader journal;
+        if (journal.open(config.replay_journal)) {
+            FeedReplayer replayer(md_handler);
+            replayer.set_speed(config.replay_speed);
+            if (config.latency_stages) {
+                replayer.set_latency_stages(replay_stages.get());
+            }
+            std::cout << "Replaying " << config.replay_journal << " (" << journal.records()
+                      << " packets, speed " << config.replay_speed << ")...\n";
+            FeedReplayer::Stats stats = replayer.replay(journal, &running);
+            uint64_t per_packet_ns = stats.packets ? Timestamp::to_nanoseconds(stats.processing_cycles) / stats.packets : 0;
+            std::cout << "Replayed " << stats.packets << " packets in " << stats.elapsed_ns / 1000
+                      << " us, " << per_packet_ns << " ns per packet in the handler";
+            if (replayer.speed() > 0) {
+                std::cout << ", at most " << stats.max_lateness_ns / 1000 << " us behind schedule";
+            }
+            std::cout << "\n\n";
+            if (replay_stages->stage[TickToTrade::TOTAL].count()) {
+                std::cout << "Tick-to-trade during the replay:\n" << TickToTrade::report(*replay_stages) << "\n";
+            }
+        }
+    }
     
-    // Main loop (in demo mode, just wait for signal)
+    std::cout << "Press Ctrl+C to exit";
+    if (!reloader.path().empty()) {
+        std::cout << ", kill -HUP " << getpid() << " to reload parameters";
+    }
+    std::cout << "...\n";
+    
+    // Main loop (in demo mode, just wait for signal); doubles as the
+    // control thread for parameter reloads
+    TickToTrade::Histograms reported = stage_totals();
+    size_t seconds = 0;
+    size_t polls = 0;
     while (running.load()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        
+        // Reload on SIGHUP: published to the trading threads, which switch
+        // on their next tick; retired versions are freed once they have
+        if (reload_requested.exchange(false)) {
+            std::cout << (reloader.reload() ? "Parameters reloaded from " : "Parameter reload rejected: ")
+                      << reloader.path() << "\n";
+        }
+        reloader.reclaim();
+        if (++polls % 10 != 0) {
+            continue;
+        }
+        
+        // Keep the TSC-derived wall clock on NTP time
+        Timestamp::resync_wall_clock();
+        
+        // Stage percentiles of the last interval, off the trading threads
+        if (config.latency_stages && config.latency_report_interval_s &&
+            ++seconds % config.latency_report_interval_s == 0) {
+            TickToTrade::Histograms totals = stage_totals();
+            TickToTrade::Histograms interval = totals;
+            interval.subtract(reported);
+            reported = totals;
+            if (interval.stage[TickToTrade::TOTAL].count()) {
+                std::cout << "Tick-to-trade, last " << config.latency_report_interval_s << " s:\n"
+                          << TickToTrade::report(interval);
+            }
+        }
         
         // In production, would process events here
         // For demo, just show we're alive
         static int counter = 0;
         if (++counter % 10 == 0) {
-            std::cout << "System running... (Position: " 
-                      << strategy->get_position() << ", P&L: $" 
-                      << strategy->get_pnl() << ")\n";
+            for (const auto& strategy : strategies) {
+                std::cout << "System running... (" << strategy->symbol()
+                          << " position: " << strategy->get_position() << ", P&L: $"
+                          << strategy->get_pnl() << ")\n";
+            }
         }
     }
     
+    if (pipeline) {
+        pipeline->stop();
+    }
+    if (sharded_feed) {
+        sharded_feed->stop();
+    }
+    
     std::cout << "\nShutdown complete.\n";
     std::cout << "Final stats:\n";
-    std::cout << "  Position: " << strategy->get_position() << "\n";
-    std::cout << "  P&L: $" << strategy->get_pnl() << "\n\n";
+    for (const auto& strategy : strategies) {
+        std::cout << "  " << strategy->symbol() << " position: " << strategy->get_position()
+                  << ", P&L: $" << strategy->get_pnl() << "\n";
+    }
+    if (config.latency_stages && stage_totals().stage[TickToTrade::TOTAL].count()) {
+        std::cout << "Tick-to-trade, whole session:\n" << TickToTrade::report(stage_totals());
+    }
+    std::cout << "\n";
     
     return 0;
 }
@@ -0,0 +1,301 @@
+#include "market_data/feed_arbitrator.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace hft {
+
+namespace {
+
+constexpr size_t HEADER_SIZE = feed::MoldUDP64Framing::HEADER_SIZE;
+constexpr uint64_t MAX_REQUEST = 0xFFFE; // 0xFFFF is the end-of-session marker
+
+} // namespace
+
+FeedArbitrator::FeedArbitrator(PacketCallback on_packet)
+    : deliver_(std::move(on_packet)) {
+    for (size_t i = 0; i < BUFFER_PACKETS; ++i) {
+        free_[free_count_++] = static_cast<uint16_t>(i);
+    }
+}
+
+FeedArbitrator::Result FeedArbitrator::on_packet(Line line, const char* data, size_t len) {
+    ++stats_.packets[static_cast<size_t>(line)];
+
+    if (len < HEADER_SIZE) {
+        ++stats_.dropped;
+        return Result::DROPPED;
+    }
+
+    uint64_t sequence = feed::read_be64(data + 10);
+    uint16_t raw_count = feed::read_be16(data + 18);
+    uint64_t count = raw_count == feed::MoldUDP64Framing::END_OF_SESSION ? 0 : raw_count;
+
+    if (expected_ == 0) {
+        expected_ = sequence;
+    }
+    if (session_[0] == '\0') {
+        std::memcpy(session_, data, sizeof(session_));
+    }
+
+    // Fast path: the slower line's copy of a delivered packet
+    if (sequence + count <= expected_) {
+        ++stats_.duplicates;
+        return Result::DUPLICATE;
+    }
+
+    if (sequence <= expected_) {
+        deliver(line, data, len, sequence, count);
+        if (gap_open_) {
+            drain();
+        }
+        return Result::DELIVERED;
+    }
+
+    if (count == 0) {
+        // Heartbeat announcing messages we never received
+        note_ahead(sequence);
+        return Result::DUPLICATE;
+    }
+
+    return hold(line, data, len, sequence, count);
+}
+
+void FeedArbitrator::deliver(Line line, const char* data, size_t len,
+                             uint64_t sequence, uint64_t count) {
+    const char* out = data;
+    size_t out_len = len;
+
+    if (sequence < expected_) {
+        // Overlapping retransmission: skip the messages already delivered
+        // and rewrite the header so the packet starts at expected_
+        size_t offset = HEADER_SIZE;
+        for (uint64_t s = sequence; s < expected_; ++s) {
+            if (offset + 2 > len) {
+                ++stats_.dropped;
+                return;
+            }
+            offset += 2 + feed::read_be16(data + offset);
+        }
+        if (offset > len || HEADER_SIZE + (len - offset) > MAX_PACKET_SIZE) {
+            ++stats_.dropped;
+            return;
+        }
+
+        std::memcpy(scratch_, data, sizeof(session_));
+        feed::write_be64(scratch_ + 10, expected_);
+        feed::write_be16(scratch_ + 18, static_cast<uint16_t>(sequence + count - expected_));
+        std::memcpy(scratch_ + HEADER_SIZE, data + offset, len - offset);
+        out = scratch_;
+        out_len = HEADER_SIZE + (len - offset);
+    }
+
+    expected_ = sequence + count;
+    ++stats_.first[static_cast<size_t>(line)];
+    deliver_(out, out_len);
+}
+
+FeedArbitrator::Result FeedArbitrator::hold(Line line, const char* data, size_t len,
+                                            uint64_t sequence, uint64_t count) {
+    if (len > MAX_PACKET_SIZE) {
+        ++stats_.dropped;
+        note_ahead(sequence);
+        return Result::DROPPED;
+    }
+
+    if (held_count_ == BUFFER_PACKETS) {
+        // The hole outlived the buffer, stop waiting for retransmissions
+        if (!snapshot_pending_) {
+            LOG_WARN("Feed gap overflowed the arbitration buffer");
+            request_pending_ = false;
+            request_snapshot();
+            if (sequence + count <= expected_) {
+                ++stats_.duplicates;
+                return Result::DUPLICATE;
+            }
+            if (sequence <= expected_) {
+                deliver(line, data, len, sequence, count);
+                drain();
+                return Result::DELIVERED;
+            }
+        }
+        // Still full (snapshot outstanding): the lowest sequence goes
+        // first, the snapshot will cover it
+        if (held_count_ == BUFFER_PACKETS) {
+            release_front(1);
+            ++stats_.dropped;
+        }
+    }
+
+    // Copied in place, the packet is too large to build on the stack
+    // and push by value
+    uint16_t index = free_[--free_count_];
+    BufferedPacket* slot = &slots_[index];
+    slot->sequence = sequence;
+    slot->count = static_cast<uint32_t>(count);
+    slot->length = static_cast<uint16_t>(len);
+    slot->line = line;
+    std::memcpy(slot->data, data, len);
+
+    // Usually the highest sequence so far: search from the back. Equal
+    // sequences (the other line's copy) stay in arrival order.
+    size_t pos = held_count_;
+    while (pos > 0 && slots_[held_[pos - 1]].sequence > sequence) {
+        --pos;
+    }
+    std::memmove(&held_[pos + 1], &held_[pos], (held_count_ - pos) * sizeof(held_[0]));
+    held_[pos] = index;
+    ++held_count_;
+    ++stats_.buffered;
+
+    note_ahead(sequence);
+    return Result::BUFFERED;
+}
+
+void FeedArbitrator::note_ahead(uint64_t sequence) {
+    if (!gap_open_) {
+        gap_open_ = true;
+        ++stats_.gaps;
+        ahead_ = 0;
+        hole_end_ = sequence;
+    } else {
+        hole_end_ = std::min(hole_end_, sequence);
+    }
+    ++ahead_;
+
+    if (!request_pending_ && !snapshot_pending_ && ahead_ > gap_tolerance_) {
+        request_retransmit();
+    }
+}
+
+void FeedArbitrator::release_front(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        free_[free_count_++] = held_[i];
+    }
+    held_count_ -= count;
+    std::memmove(&held_[0], &held_[count], held_count_ * sizeof(held_[0]));
+}
+
+void FeedArbitrator::drain(bool allow_requests) {
+    size_t done = 0;
+    for (; done < held_count_; ++done) {
+        BufferedPacket* p = &slots_[held_[done]];
+        if (p->sequence + p->count <= expected_) {
+            ++stats_.duplicates;
+        } else if (p->sequence <= expected_) {
+            deliver(p->line, p->data, p->length, p->sequence, p->count);
+            ++stats_.replayed;
+        } else {
+            break;
+        }
+    }
+    release_front(done);
+
+    BufferedPacket* next = held_count_ > 0 ? &slots_[held_[0]] : nullptr;
+    if (!next) {
+        // A hole announced by a heartbeat stays open until it is reached
+        if (!snapshot_pending_ && expected_ >= hole_end_) {
+            close_gap();
+        }
+        return;
+    }
+
+    // Still a hole in front of the buffered packets
+    hole_end_ = next->sequence;
+    if (expected_ >= requested_end_) {
+        // The outstanding request (if any) is used up, start a new one
+        request_pending_ = false;
+        attempts_ = 0;
+        ahead_ = held_count_;
+        if (allow_requests && !snapshot_pending_ && ahead_ > gap_tolerance_) {
+            request_retransmit();
+        }
+    }
+}
+
+void FeedArbitrator::request_retransmit() {
+    if (!retransmit_) {
+        request_snapshot();
+        return;
+    }
+
+    uint64_t count = std::min(hole_end_ - expected_, MAX_REQUEST);
+    retransmit_(session_, expected_, static_cast<uint16_t>(count));
+
+    requested_end_ = expected_ + count;
+    request_pending_ = true;
+    request_time_ns_ = 0;
+    ++attempts_;
+    ++stats_.retransmit_requests;
+}
+
+void FeedArbitrator::request_snapshot() {
+    if (!snapshot_) {
+        skip_gap();
+        return;
+    }
+
+    uint64_t next_sequence = 0;
+    if (!snapshot_(next_sequence)) {
+        snapshot_pending_ = true;
+        return;
+    }
+
+    snapshot_pending_ = false;
+    request_pending_ = false;
+    attempts_ = 0;
+    ++stats_.snapshots;
+
+    // A hole left behind the snapshot is picked up by the next packet
+    expected_ = next_sequence;
+    drain(false);
+}
+
+void FeedArbitrator::skip_gap() {
+    LOG_WARN("Feed gap not recoverable, skipping missing messages");
+
+    if (hole_end_ > expected_) {
+        stats_.lost_messages += hole_end_ - expected_;
+        expected_ = hole_end_;
+    }
+    request_pending_ = false;
+    attempts_ = 0;
+    drain(false);
+}
+
+void FeedArbitrator::poll(uint64_t now_ns) {
+    if (snapshot_pending_) {
+        request_snapshot();
+        return;
+    }
+
+    if (!request_pending_) {
+        return;
+    }
+
+    // First tick after the request starts its timer
+    if (request_time_ns_ == 0) {
+        request_time_ns_ = now_ns;
+        return;
+    }
+
+    if (now_ns - request_time_ns_ < retransmit_timeout_ns_) {
+        return;
+    }
+
+    if (attempts_ >= max_retransmit_attempts_) {
+        request_pending_ = false;
+        request_snapshot();
+    } else {
+        request_retransmit();
+    }
+}
+
+void FeedArbitrator::close_gap() {
+    gap_open_ = false;
+    request_pending_ = false;
+    ahead_ = 0;
+    attempts_ = 0;
+}
+
+} // namespace hft
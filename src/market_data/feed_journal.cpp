@@ -0,0 +1,166 @@
+#include "market_data/feed_journal.h"
+#include "common/logger.h"
+#include "common/timestamp.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hft {
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+FeedJournalWriter::~FeedJournalWriter() {
+    close();
+}
+
+bool FeedJournalWriter::open(const std::string& path, size_t capacity) {
+    close();
+
+    capacity = (capacity + 7) & ~static_cast<size_t>(7);
+    size_t file_size = sizeof(journal::FileHeader) + capacity;
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR("Journal {}: cannot create", path.c_str());
+        return false;
+    }
+
+    // Blocks allocated up front: appends never extend the file
+    if (posix_fallocate(fd_, 0, static_cast<off_t>(file_size)) != 0 &&
+        ftruncate(fd_, static_cast<off_t>(file_size)) != 0) {
+        LOG_ERROR("Journal {}: cannot allocate {} bytes", path.c_str(), file_size);
+        close();
+        return false;
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;              // Prefault the page tables
+#endif
+    void* map = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, flags, fd_, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Journal {}: mmap of {} bytes failed", path.c_str(), file_size);
+        close();
+        return false;
+    }
+    map_ = map;
+    map_size_ = file_size;
+#ifdef MADV_SEQUENTIAL
+    madvise(map_, map_size_, MADV_SEQUENTIAL);
+#endif
+
+    header_ = static_cast<journal::FileHeader*>(map_);
+    std::memset(header_, 0, sizeof(*header_));
+    std::memcpy(header_->magic, journal::MAGIC, sizeof(header_->magic));
+    header_->version = journal::VERSION;
+    header_->header_size = sizeof(journal::FileHeader);
+    header_->capacity = capacity;
+    header_->created_ns = Timestamp::wall_clock_ns();
+
+    records_ = static_cast<char*>(map_) + sizeof(journal::FileHeader);
+
+    // MAP_POPULATE only read-faults a shared mapping: the write fault of
+    // each page would still land on the first append into it
+    std::memset(records_, 0, capacity);
+
+    capacity_ = capacity;
+    used_ = 0;
+    count_ = 0;
+    captured_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    LOG_INFO("Journal {}: capturing up to {} MB", path.c_str(), capacity >> 20);
+    return true;
+}
+
+void FeedJournalWriter::close() {
+    if (map_) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        header_ = nullptr;
+        records_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        // Keep what was written (plus the end marker, if there is room)
+        size_t end = used_ + sizeof(journal::RecordHeader) <= capacity_ ? used_ + sizeof(journal::RecordHeader)
+                                                                        : used_;
+        if (map_size_ > 0 && ftruncate(fd_, static_cast<off_t>(sizeof(journal::FileHeader) + end)) != 0) {
+            LOG_WARN("Journal: cannot trim to {} bytes", end);
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    map_size_ = 0;
+    capacity_ = 0;
+    used_ = 0;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+FeedJournalReader::~FeedJournalReader() {
+    close();
+}
+
+bool FeedJournalReader::open(const std::string& path) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        LOG_ERROR("Journal {}: cannot open", path.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(journal::FileHeader)) {
+        LOG_ERROR("Journal {}: too short", path.c_str());
+        close();
+        return false;
+    }
+
+    size_t file_size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Journal {}: mmap failed", path.c_str());
+        close();
+        return false;
+    }
+    map_ = map;
+    map_size_ = file_size;
+#ifdef MADV_SEQUENTIAL
+    madvise(map_, map_size_, MADV_SEQUENTIAL);
+#endif
+
+    journal::FileHeader header;
+    std::memcpy(&header, map_, sizeof(header));
+    if (std::memcmp(header.magic, journal::MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != journal::VERSION || header.header_size != sizeof(journal::FileHeader)) {
+        LOG_ERROR("Journal {}: not a version {} journal", path.c_str(), journal::VERSION);
+        close();
+        return false;
+    }
+
+    records_ = static_cast<const char*>(map_) + sizeof(journal::FileHeader);
+    size_ = file_size - sizeof(journal::FileHeader);
+    records_count_ = header.records;
+    return true;
+}
+
+void FeedJournalReader::close() {
+    if (map_) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        records_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    map_size_ = 0;
+    size_ = 0;
+    records_count_ = 0;
+}
+
+} // namespace hft
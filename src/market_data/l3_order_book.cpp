@@ -0,0 +1,229 @@
+#include "market_data/l3_order_book.h"
+
+namespace hft {
+
+L3OrderBook::L3OrderBook(const std::string& symbol, double tick_size, size_t max_orders,
+                         size_t max_levels, size_t depth, int numa_node)
+    : order_pool_(max_orders, numa_node)
+    , queue_pool_(max_levels ? max_levels : max_orders, numa_node)
+    , order_cache_(order_pool_)
+    , queue_cache_(queue_pool_)
+    , orders_(max_orders, numa_node)
+    , queue_index_(max_levels ? max_levels : max_orders, numa_node)
+    , levels_(symbol, tick_size, depth, TickOrderBook::DEFAULT_LADDER_TICKS,
+              max_levels ? max_levels : max_orders) {
+}
+
+bool L3OrderBook::add_order(uint64_t order_id, Side side, uint64_t price_ticks,
+                            uint32_t quantity) {
+    if (quantity == 0 || lookup(order_id)) {
+        return false;
+    }
+    
+    PriceQueue* level = get_or_create_level(side, price_ticks);
+    if (!level) {
+        return false;
+    }
+    
+    OrderNode* node = order_cache_.allocate();
+    if (!node) {
+        publish(level); // Drops the queue again if we just created it
+        return false;
+    }
+    
+    node->order_id = order_id;
+    node->price_ticks = price_ticks;
+    node->quantity = quantity;
+    node->side = side;
+    
+    if (!orders_.insert(order_id, node)) {
+        order_cache_.deallocate(node);
+        publish(level);
+        return false;
+    }
+    
+    append(level, node);
+    publish(level);
+    return true;
+}
+
+bool L3OrderBook::execute_order(uint64_t order_id, uint32_t quantity) {
+    OrderNode* node = lookup(order_id);
+    if (!node) {
+        return false;
+    }
+    reduce(node, quantity);
+    return true;
+}
+
+bool L3OrderBook::cancel_order(uint64_t order_id, uint32_t quantity) {
+    // Same book effect as an execution; kept separate for ITCH symmetry
+    return execute_order(order_id, quantity);
+}
+
+bool L3OrderBook::delete_order(uint64_t order_id) {
+    OrderNode* node = lookup(order_id);
+    if (!node) {
+        return false;
+    }
+    reduce(node, node->quantity);
+    return true;
+}
+
+bool L3OrderBook::replace_order(uint64_t order_id, uint64_t new_order_id,
+                                uint64_t price_ticks, uint32_t quantity) {
+    OrderNode* node = lookup(order_id);
+    if (!node || (new_order_id != order_id && lookup(new_order_id))) {
+        return false;
+    }
+    
+    Side side = node->side;
+    if (!delete_order(order_id)) {
+        return false;
+    }
+    return add_order(new_order_id, side, price_ticks, quantity);
+}
+
+bool L3OrderBook::modify_order(uint64_t order_id, uint64_t price_ticks, uint32_t quantity) {
+    OrderNode* node = lookup(order_id);
+    if (!node) {
+        return false;
+    }
+    
+    if (quantity == 0) {
+        reduce(node, node->quantity);
+        return true;
+    }
+    
+    // Size down at the same price: keep queue position
+    if (price_ticks == node->price_ticks && quantity <= node->quantity) {
+        reduce(node, node->quantity - quantity);
+        return true;
+    }
+    
+    // Anything else re-queues at the back of the (possibly new) level.
+    // The node is reused, so no pool traffic.
+    PriceQueue* target = get_or_create_level(node->side, price_ticks);
+    if (!target) {
+        return false;
+    }
+    
+    PriceQueue* old_level = node->level;
+    unlink(node);
+    if (old_level != target) {
+        publish(old_level);
+    }
+    
+    node->price_ticks = price_ticks;
+    node->quantity = quantity;
+    append(target, node);
+    publish(target);
+    return true;
+}
+
+const L3OrderBook::OrderNode* L3OrderBook::find_order(uint64_t order_id) const {
+    OrderNode* const* node = orders_.find(order_id);
+    return node ? *node : nullptr;
+}
+
+const L3OrderBook::PriceQueue* L3OrderBook::find_level(Side side, uint64_t price_ticks) const {
+    PriceQueue* const* level = queue_index_.find(level_key(side, price_ticks));
+    return level ? *level : nullptr;
+}
+
+void L3OrderBook::clear() {
+    orders_.for_each([this](uint64_t, OrderNode* node) {
+        order_cache_.deallocate(node);
+    });
+    queue_index_.for_each([this](uint64_t, PriceQueue* level) {
+        queue_cache_.deallocate(level);
+    });
+    orders_.clear();
+    queue_index_.clear();
+    levels_.clear();
+}
+
+L3OrderBook::PriceQueue* L3OrderBook::get_or_create_level(Side side, uint64_t price_ticks) {
+    uint64_t key = level_key(side, price_ticks);
+    PriceQueue** existing = queue_index_.find(key);
+    if (existing) {
+        return *existing;
+    }
+    
+    PriceQueue* level = queue_cache_.allocate();
+    if (!level) {
+        return nullptr;
+    }
+    
+    level->price_ticks = price_ticks;
+    level->side = side;
+    if (!queue_index_.insert(key, level)) {
+        queue_cache_.deallocate(level);
+        return nullptr;
+    }
+    return level;
+}
+
+void L3OrderBook::append(PriceQueue* level, OrderNode* node) {
+    node->level = level;
+    node->next = nullptr;
+    node->prev = level->tail;
+    
+    if (level->tail) {
+        level->tail->next = node;
+    } else {
+        level->head = node;
+    }
+    level->tail = node;
+    
+    level->total_quantity += node->quantity;
+    level->order_count++;
+}
+
+void L3OrderBook::unlink(OrderNode* node) {
+    PriceQueue* level = node->level;
+    
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        level->head = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    } else {
+        level->tail = node->prev;
+    }
+    
+    level->total_quantity -= node->quantity;
+    level->order_count--;
+    node->prev = node->next = nullptr;
+    node->level = nullptr;
+}
+
+void L3OrderBook::reduce(OrderNode* node, uint32_t quantity) {
+    PriceQueue* level = node->level;
+    
+    if (quantity >= node->quantity) {
+        unlink(node);
+        orders_.erase(node->order_id);
+        order_cache_.deallocate(node);
+    } else {
+        node->quantity -= quantity;
+        level->total_quantity -= quantity;
+    }
+    
+    publish(level);
+}
+
+void L3OrderBook::publish(PriceQueue* level) {
+    last_side_ = level->side;
+    levels_.update(level->side, level->price_ticks,
+                   static_cast<double>(level->total_quantity), level->order_count);
+    
+    if (level->order_count == 0) {
+        queue_index_.erase(level_key(level->side, level->price_ticks));
+        queue_cache_.deallocate(level);
+    }
+}
+
+} // namespace hft
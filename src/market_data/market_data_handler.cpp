@@ -1,10 +1,205 @@
 #include "market_data/market_data_handler.h"
+#include "market_data/itch_decoder.h"
 #include "common/logger.h"
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 namespace hft {
 
-MarketDataHandler::MarketDataHandler() = default;
+// ITCH 5.0 book building
+// Stock locate codes index flat tables, so after the first message of a
+// symbol no string hashing happens on the hot path
+struct MarketDataHandler::ItchState : itch::NullHandler {
+    static constexpr size_t MAX_LOCATE = 65536;
+
+    MarketDataHandler& owner;
+    std::vector<OrderBook*> books;
+    std::vector<L3OrderBook*> l3_books;
+    std::vector<uint8_t> resolved; // Locate looked up (even if unsubscribed)
+    std::vector<std::unique_ptr<L3OrderBook>> owned;
+
+    feed::FeedDecoder<feed::MoldUDP64Framing, itch::Itch50, ItchState> mold_decoder;
+    feed::FeedDecoder<feed::LengthPrefixedFraming, itch::Itch50, ItchState> framed_decoder;
+
+    explicit ItchState(MarketDataHandler& handler)
+        : owner(handler)
+        , books(MAX_LOCATE, nullptr)
+        , l3_books(MAX_LOCATE, nullptr)
+        , resolved(MAX_LOCATE, 0)
+        , mold_decoder(*this)
+        , framed_decoder(*this) {
+    }
+
+    // Map a locate code to our book the first time we see its symbol
+    void resolve(uint16_t locate, const char* stock) {
+        if (resolved[locate]) {
+            return;
+        }
+        resolved[locate] = 1;
+
+        // Stock field is space padded to 8 characters
+        char name[9];
+        std::memcpy(name, stock, 8);
+        size_t n = 8;
+        while (n > 0 && name[n - 1] == ' ') {
+            --n;
+        }
+        name[n] = '\0';
+
+        OrderBook* book = owner.get_order_book(name);
+        if (!book) {
+            return; // Not subscribed
+        }
+
+        // A symbol seen under another locate before forget_locates() keeps
+        // its L3 book
+        L3OrderBook* l3 = nullptr;
+        for (const auto& existing : owned) {
+            if (existing->symbol() == name) {
+                l3 = existing.get();
+            }
+        }
+        if (!l3) {
+            owned.push_back(std::make_unique<L3OrderBook>(
+                name, itch::PRICE_TICK, owner.l3_capacity_, 0, owner.book_depth_, owner.numa_node_));
+            l3 = owned.back().get();
+        }
+        books[locate] = book;
+        l3_books[locate] = l3;
+    }
+
+    // Copy the changed side's top levels into the OrderBook and notify
+    void publish(uint16_t locate) {
+        L3OrderBook* l3 = l3_books[locate];
+        OrderBook* book = books[locate];
+
+        PriceLevel levels[OrderBook::MAX_DEPTH];
+        auto side = l3->last_side();
+        size_t n = l3->levels().get_levels(side, levels, owner.book_depth_);
+        book->begin_update();
+        book->set_rx_timestamp(owner.rx_timestamp_ns_);
+        book->set_levels(side, levels, n);
+        book->end_update();
+        owner.notify(*book);
+    }
+
+    void on_stock_directory(const itch::StockDirectory& m) {
+        resolve(m.stock_locate, m.stock);
+    }
+
+    void on_add_order(const itch::AddOrder& m) {
+        resolve(m.stock_locate, m.stock);
+        L3OrderBook* l3 = l3_books[m.stock_locate];
+        if (!l3) {
+            return;
+        }
+        TickToTrade::mark(TickToTrade::DECODE);
+        auto side = m.side == 'B' ? OrderBook::Side::BID : OrderBook::Side::ASK;
+        if (l3->add_order(m.order_ref, side, m.price, m.shares)) {
+            publish(m.stock_locate);
+        }
+    }
+
+    // Book first, then the print: strategies see the post-trade book
+    void execute(const itch::OrderExecuted& m, const uint32_t* execution_price) {
+        L3OrderBook* l3 = l3_books[m.stock_locate];
+        if (!l3) {
+            return;
+        }
+        const L3OrderBook::OrderNode* order = l3->find_order(m.order_ref);
+        if (!order) {
+            return;
+        }
+        TickToTrade::mark(TickToTrade::DECODE);
+        uint64_t price_ticks = execution_price ? *execution_price : order->price_ticks;
+        OrderBook::Side side = order->side;
+        if (l3->execute_order(m.order_ref, m.executed_shares)) {
+            publish(m.stock_locate);
+            print(m.stock_locate, price_ticks, m.executed_shares, m.match_number, side);
+        }
+    }
+
+    void print(uint16_t locate, uint64_t price_ticks, uint32_t shares, uint64_t match_number,
+               OrderBook::Side side) {
+        TradePrint trade;
+        trade.price = static_cast<double>(price_ticks) * itch::PRICE_TICK;
+        trade.quantity = shares;
+        trade.match_number = match_number;
+        trade.rx_timestamp_ns = owner.rx_timestamp_ns_;
+        trade.resting_side = side;
+        owner.notify_trade(*books[locate], trade);
+    }
+
+    void on_order_executed(const itch::OrderExecuted& m) {
+        execute(m, nullptr);
+    }
+
+    void on_order_executed_with_price(const itch::OrderExecutedWithPrice& m) {
+        // Non-printable executions are not trades to report
+        if (m.printable == 'N') {
+            L3OrderBook* l3 = l3_books[m.stock_locate];
+            if (l3) {
+                TickToTrade::mark(TickToTrade::DECODE);
+                if (l3->execute_order(m.order_ref, m.executed_shares)) {
+                    publish(m.stock_locate);
+                }
+            }
+            return;
+        }
+        execute(m, &m.execution_price);
+    }
+
+    // Execution against a non-displayed order: no book change
+    void on_trade(const itch::Trade& m) {
+        resolve(m.stock_locate, m.stock);
+        if (l3_books[m.stock_locate]) {
+            print(m.stock_locate, m.price, m.shares, m.match_number,
+                  m.side == 'B' ? OrderBook::Side::BID : OrderBook::Side::ASK);
+        }
+    }
+
+    void on_order_cancel(const itch::OrderCancel& m) {
+        L3OrderBook* l3 = l3_books[m.stock_locate];
+        if (!l3) {
+            return;
+        }
+        TickToTrade::mark(TickToTrade::DECODE);
+        if (l3->cancel_order(m.order_ref, m.cancelled_shares)) {
+            publish(m.stock_locate);
+        }
+    }
+
+    void on_order_delete(const itch::OrderDelete& m) {
+        L3OrderBook* l3 = l3_books[m.stock_locate];
+        if (!l3) {
+            return;
+        }
+        TickToTrade::mark(TickToTrade::DECODE);
+        if (l3->delete_order(m.order_ref)) {
+            publish(m.stock_locate);
+        }
+    }
+
+    void on_order_replace(const itch::OrderReplace& m) {
+        L3OrderBook* l3 = l3_books[m.stock_locate];
+        if (!l3) {
+            return;
+        }
+        TickToTrade::mark(TickToTrade::DECODE);
+        if (l3->replace_order(m.original_order_ref, m.new_order_ref, m.price, m.shares)) {
+            publish(m.stock_locate);
+        }
+    }
+};
+
+MarketDataHandler::MarketDataHandler(size_t max_symbols, int numa_node)
+    : symbols_(max_symbols)
+    , order_book_pool_(max_symbols, numa_node)
+    , numa_node_(numa_node)
+    , itch_(std::make_unique<ItchState>(*this)) {
+    books_.reserve(max_symbols);
+}
 
 MarketDataHandler::~MarketDataHandler() = default;
 
@@ -13,55 +208,145 @@ void MarketDataHandler::register_callback(OrderBookCallback callback) {
 }
 
 OrderBook* MarketDataHandler::get_order_book(const char* symbol) {
-    // Lock-free hash map lookup - O(1), cache-friendly
-    OrderBook** book_ptr = order_book_map_.find(symbol);
-    return book_ptr ? *book_ptr : nullptr;
+    return get_order_book(symbols_.find(symbol));
 }
 
 OrderBook* MarketDataHandler::get_order_book(const std::string& symbol) {
     return get_order_book(symbol.c_str());
 }
 
-void MarketDataHandler::add_symbol(const std::string& symbol) {
-    if (!get_order_book(symbol.c_str())) {
-        // Allocate from memory pool (no heap fragmentation)
-        OrderBook* book = order_book_pool_.allocate(symbol);
-        if (book) {
-            order_book_map_.insert(symbol.c_str(), book);
+const L3OrderBook* MarketDataHandler::get_l3_book(const std::string& symbol) const {
+    for (const auto& l3 : itch_->owned) {
+        if (l3->symbol() == symbol) {
+            return l3.get();
         }
     }
+    return nullptr;
+}
+
+void MarketDataHandler::set_book_depth(size_t levels) {
+    size_t depth = std::clamp<size_t>(levels, 1, OrderBook::MAX_DEPTH);
+    if (depth != levels) {
+        LOG_WARN("Book depth {} outside 1..{}, using {}", levels, OrderBook::MAX_DEPTH, depth);
+    }
+    book_depth_ = depth;
 }
 
-void MarketDataHandler::process_message(const char* data, size_t len) {
-    // In production, this would parse binary protocols like ITCH, PITCH, etc.
-    // For now, we assume a simple binary format
+uint64_t MarketDataHandler::malformed_packets() const {
+    return itch_->mold_decoder.malformed_packets() +
+           itch_->framed_decoder.malformed_packets();
+}
+
+void MarketDataHandler::reset_books() {
+    for (size_t locate = 0; locate < ItchState::MAX_LOCATE; ++locate) {
+        if (itch_->l3_books[locate]) {
+            itch_->l3_books[locate]->clear();
+        }
+    }
     
-    if (len < sizeof(MarketDataMessage)) {
+    // OrderBooks fed by the simple protocol are reset too
+    for (OrderBook* book : books_) {
+        book->set_levels(OrderBook::Side::BID, nullptr, 0);
+        book->set_levels(OrderBook::Side::ASK, nullptr, 0);
+    }
+}
+
+void MarketDataHandler::forget_locates() {
+    reset_books();
+    std::fill(itch_->books.begin(), itch_->books.end(), nullptr);
+    std::fill(itch_->l3_books.begin(), itch_->l3_books.end(), nullptr);
+    std::fill(itch_->resolved.begin(), itch_->resolved.end(), 0);
+}
+
+void MarketDataHandler::set_publisher(ShmBookPublisher* publisher) {
+    publisher_ = publisher;
+    if (!publisher_) {
         return;
     }
+    for (uint32_t id = 0; id < books_.size(); ++id) {
+        if (!publisher_->add_symbol(id, symbols_.name(id))) {
+            LOG_WARN("Book region holds {} symbols, {} not published",
+                     publisher_->max_symbols(), symbols_.name(id));
+        }
+    }
+}
+
+uint32_t MarketDataHandler::add_symbol(const std::string& symbol) {
+    uint32_t id = symbols_.find(symbol.c_str());
+    if (id != SymbolTable::NO_SYMBOL) {
+        return id;
+    }
     
-    // Zero-copy: cast directly to message struct
-    // This avoids any memory allocation or copying
-    const auto* msg = reinterpret_cast<const MarketDataMessage*>(data);
-    
-    // Fast hash map lookup (lock-free, cache-friendly)
-    OrderBook* book = get_order_book(msg->symbol);
+    // Allocate from memory pool (no heap fragmentation)
+    OrderBook* book = order_book_pool_.allocate(symbol);
     if (!book) {
-        return; // Unknown symbol
+        LOG_ERROR("Cannot track {}: {} symbols max", symbol, symbols_.capacity());
+        return SymbolTable::NO_SYMBOL;
+    }
+    id = symbols_.intern(symbol.c_str());
+    if (id == SymbolTable::NO_SYMBOL) {
+        order_book_pool_.deallocate(book);
+        LOG_ERROR("Cannot track symbol '{}'", symbol);
+        return SymbolTable::NO_SYMBOL;
     }
+    book->set_symbol_id(id);
+    books_.push_back(book);
+    if (publisher_) {
+        publisher_->add_symbol(id, symbol.c_str());
+    }
+    return id;
+}
+
+void MarketDataHandler::process_message(const char* data, size_t len, uint64_t rx_timestamp_ns) {
+    rx_timestamp_ns_ = rx_timestamp_ns;
+    TickToTrade::Packet tick(rx_timestamp_ns);
     
+    switch (protocol_) {
+        case FeedProtocol::ITCH50_MOLDUDP64:
+            messages_decoded_ += itch_->mold_decoder.decode(data, len);
+            return;
+        case FeedProtocol::ITCH50_FRAMED:
+            messages_decoded_ += itch_->framed_decoder.decode(data, len);
+            return;
+        case FeedProtocol::SIMPLE:
+            break;
+    }
+
+    // Simple binary format: fixed-size records, walk all of them
+    for (size_t offset = 0; offset + sizeof(MarketDataMessage) <= len;
+         offset += sizeof(MarketDataMessage)) {
+        // Zero-copy: cast directly to message struct
+        // This avoids any memory allocation or copying
+        parse_and_update(reinterpret_cast<const MarketDataMessage*>(data + offset));
+        ++messages_decoded_;
+    }
+}
+
+void MarketDataHandler::parse_and_update(const MarketDataMessage* msg) {
+    // Fixed 16-byte symbol field: one SIMD compare per probe, then the
+    // book by ID
+    uint32_t id = symbols_.find_field(msg->symbol);
+    if (id == SymbolTable::NO_SYMBOL) {
+        return; // Unknown symbol
+    }
+    if (msg->level >= book_depth_) {
+        return; // Beyond order_book_depth
+    }
+    OrderBook* book = books_[id];
+
     // Update the order book
     // This is lock-free and extremely fast (< 100ns typical)
+    TickToTrade::mark(TickToTrade::DECODE);
+    book->begin_update();
+    book->set_rx_timestamp(rx_timestamp_ns_);
     if (msg->side == 0) {
         book->update_bid(msg->level, msg->price, msg->quantity);
     } else {
         book->update_ask(msg->level, msg->price, msg->quantity);
     }
-    
-    // Notify callback if registered
-    if (callback_) {
-        callback_(*book);
-    }
+    book->end_update();
+
+    notify(*book);
 }
 
 } // namespace hft
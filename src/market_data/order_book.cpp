@@ -6,64 +6,162 @@ namespace hft {
 
 OrderBook::OrderBook(const std::string& symbol) 
     : symbol_(symbol) {
-    // Initialize all levels
-    for (auto& level : bids_.levels) {
-        level.reset();
-    }
-    for (auto& level : asks_.levels) {
-        level.reset();
-    }
+    // Levels start zeroed (Book value-initializes them)
 }
 
 void OrderBook::update_bid(size_t level, double price, double quantity) {
     if (level >= MAX_DEPTH) return;
+    begin_update();
     update_level(bids_, level, price, quantity);
+    end_update();
 }
 
 void OrderBook::update_ask(size_t level, double price, double quantity) {
     if (level >= MAX_DEPTH) return;
+    begin_update();
     update_level(asks_, level, price, quantity);
+    end_update();
+}
+
+void OrderBook::set_levels(Side side, const PriceLevel* levels, size_t count) {
+    Book& book = side == Side::BID ? bids_ : asks_;
+    count = std::min(count, MAX_DEPTH);
+    
+    begin_update();
+    
+    size_t old_depth = book.depth.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        book.levels.set(i, levels[i]);
+    }
+    for (size_t i = count; i < old_depth; ++i) {
+        book.levels.reset(i);
+    }
+    book.depth.store(static_cast<uint32_t>(count), std::memory_order_relaxed);
+    book.sequence.fetch_add(1, std::memory_order_relaxed);
+    
+    end_update();
+}
+
+void OrderBook::begin_update() noexcept {
+    if (write_nesting_++ > 0) {
+        return;
+    }
+    
+    // Odd version: write in progress
+    // The release fence keeps the level stores below from being
+    // reordered before the version bump
+    uint64_t v = version_.load(std::memory_order_relaxed);
+    version_.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void OrderBook::end_update() noexcept {
+    if (--write_nesting_ > 0) {
+        return;
+    }
+    
+    // Even version: publish all level stores made since begin_update()
+    uint64_t v = version_.load(std::memory_order_relaxed);
+    version_.store(v + 1, std::memory_order_release);
 }
 
 void OrderBook::update_level(Book& book, size_t level, double price, double quantity) {
     // Update the price level
-    // Using relaxed memory ordering for maximum performance
-    // The sequence number provides ordering guarantees
-    auto& price_level = book.levels[level];
-    price_level.price = price;
-    price_level.quantity = quantity;
+    // Relaxed ordering is enough here: the enclosing seqlock write section
+    // provides the ordering guarantees for readers
+    book.levels.price[level] = price;
+    book.levels.quantity[level] = quantity;
     
     // Update depth if needed
     if (level >= book.depth.load(std::memory_order_relaxed)) {
         book.depth.store(level + 1, std::memory_order_relaxed);
     }
     
-    // Increment sequence number (acts as version counter)
-    // This uses release semantics to ensure all previous writes are visible
-    book.sequence.fetch_add(1, std::memory_order_release);
+    // Per-side update counter (lets consumers tell which side changed)
+    book.sequence.fetch_add(1, std::memory_order_relaxed);
 }
 
-OrderBook::Snapshot OrderBook::get_snapshot() const {
-    Snapshot snap;
-    
-    // Read sequence numbers first (acquire semantics)
-    snap.bid_sequence = bids_.sequence.load(std::memory_order_acquire);
-    snap.ask_sequence = asks_.sequence.load(std::memory_order_acquire);
+bool OrderBook::read_snapshot(Snapshot& snap) const noexcept {
+    uint64_t v1 = version_.load(std::memory_order_acquire);
+    if (v1 & 1) {
+        return false; // Writer is mid-update
+    }
     
-    // Copy depths
+    snap.bid_sequence = bids_.sequence.load(std::memory_order_relaxed);
+    snap.ask_sequence = asks_.sequence.load(std::memory_order_relaxed);
     snap.bid_depth = bids_.depth.load(std::memory_order_relaxed);
     snap.ask_depth = asks_.depth.load(std::memory_order_relaxed);
+    snap.rx_timestamp_ns = rx_timestamp_ns_.load(std::memory_order_relaxed);
     
-    // Copy price levels
-    // This is safe because we're reading after acquiring the sequence number
-    for (size_t i = 0; i < MAX_DEPTH; ++i) {
-        snap.bids[i] = bids_.levels[i];
-        snap.asks[i] = asks_.levels[i];
+    // Copy price levels (whole arrays, padding included)
+    // May race with the writer - the version re-check below discards
+    // the copy if it did
+    snap.bids = bids_.levels;
+    snap.asks = asks_.levels;
+    
+    // Keep the copy above from sinking below the version re-read
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t v2 = version_.load(std::memory_order_relaxed);
+    
+    snap.version = v1;
+    return v1 == v2;
+}
+
+bool OrderBook::read_top(Top& top) const noexcept {
+    uint64_t v1 = version_.load(std::memory_order_acquire);
+    if (v1 & 1) {
+        return false; // Writer is mid-update
+    }
+    
+    top.bid_depth = bids_.depth.load(std::memory_order_relaxed);
+    top.ask_depth = asks_.depth.load(std::memory_order_relaxed);
+    top.rx_timestamp_ns = rx_timestamp_ns_.load(std::memory_order_relaxed);
+    top.bid_price = bids_.levels.price[0];
+    top.bid_quantity = bids_.levels.quantity[0];
+    top.ask_price = asks_.levels.price[0];
+    top.ask_quantity = asks_.levels.quantity[0];
+    
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t v2 = version_.load(std::memory_order_relaxed);
+    
+    top.version = v1;
+    return v1 == v2;
+}
+
+OrderBook::Top OrderBook::get_top() const {
+    Top top;
+    while (!read_top(top)) {
+        cpu_relax();
+    }
+    return top;
+}
+
+OrderBook::Snapshot OrderBook::get_snapshot() const {
+    Snapshot snap;
+    uint32_t retries = 0;
+    
+    while (!read_snapshot(snap)) {
+        ++retries;
+        cpu_relax();
     }
     
+    snap.retries = retries;
     snap.timestamp = Timestamp::now();
     
     return snap;
 }
 
+bool OrderBook::try_get_snapshot(Snapshot& snap, uint32_t max_spins) const {
+    for (uint32_t attempt = 0; attempt <= max_spins; ++attempt) {
+        if (read_snapshot(snap)) {
+            snap.retries = attempt;
+            snap.timestamp = Timestamp::now();
+            return true;
+        }
+        cpu_relax();
+    }
+    
+    return false; // Stale: writer kept the book busy
+}
+
 } // namespace hft
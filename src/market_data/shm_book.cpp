@@ -0,0 +1,249 @@
+#include "market_data/shm_book.h"
+#include "common/bit_utils.h"
+#include "common/logger.h"
+#include "common/timestamp.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hft {
+
+// ============================================================================
+// Publisher
+// ============================================================================
+
+ShmBookPublisher::~ShmBookPublisher() {
+    close();
+}
+
+bool ShmBookPublisher::open(const std::string& name, size_t max_symbols, size_t ring_size) {
+    close();
+
+    ring_size = bits::next_power_of_2(ring_size < 2 ? 2 : ring_size);
+    size_t size = shm::region_size(max_symbols, ring_size);
+
+    // Always a new object: a reader of the previous run keeps its mapping
+    // instead of faulting on a region truncated underneath it
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Book region {}: cannot create", name.c_str());
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        LOG_ERROR("Book region {}: cannot size {} bytes", name.c_str(), size);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;
+#endif
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    ::close(fd);                        // The mapping keeps the object
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Book region {}: mmap of {} bytes failed", name.c_str(), size);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    name_ = name;
+    map_ = map;
+    map_size_ = size;
+
+    // Write-fault every page now rather than on the first publish into it
+    std::memset(map_, 0, map_size_);
+
+    header_ = static_cast<shm::Header*>(map_);
+    slots_ = reinterpret_cast<shm::BookSlot*>(static_cast<char*>(map_) + sizeof(shm::Header));
+    ring_ = reinterpret_cast<shm::Notice*>(slots_ + max_symbols);
+    max_symbols_ = static_cast<uint32_t>(max_symbols);
+    ring_mask_ = ring_size - 1;
+    published_ = 0;
+
+    header_->version = shm::VERSION;
+    header_->header_size = sizeof(shm::Header);
+    header_->slot_size = sizeof(shm::BookSlot);
+    header_->max_symbols = max_symbols_;
+    header_->ring_size = static_cast<uint32_t>(ring_size);
+    header_->publisher_pid = static_cast<uint32_t>(getpid());
+    header_->created_ns = Timestamp::wall_clock_ns();
+
+    // Readers check the magic first
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, shm::MAGIC, sizeof(header_->magic));
+
+    LOG_INFO("Book region {}: {} symbols, {} notices, {} KB", name.c_str(), max_symbols,
+             ring_size, size >> 10);
+    return true;
+}
+
+void ShmBookPublisher::close() {
+    if (map_) {
+        header_->closed.store(1, std::memory_order_release);
+        munmap(map_, map_size_);
+        shm_unlink(name_.c_str());
+        map_ = nullptr;
+    }
+    map_size_ = 0;
+    header_ = nullptr;
+    slots_ = nullptr;
+    ring_ = nullptr;
+    max_symbols_ = 0;
+    ring_mask_ = 0;
+    name_.clear();
+}
+
+bool ShmBookPublisher::add_symbol(uint32_t id, const char* symbol) {
+    if (id >= max_symbols_) {
+        return false;
+    }
+    shm::BookSlot& slot = slots_[id];
+    std::memset(slot.symbol, 0, sizeof(slot.symbol));
+    std::memcpy(slot.symbol, symbol, strnlen(symbol, sizeof(slot.symbol) - 1));
+
+    uint32_t count = header_->symbol_count.load(std::memory_order_relaxed);
+    if (id >= count) {
+        header_->symbol_count.store(id + 1, std::memory_order_release);
+    }
+    return true;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+ShmBookReader::~ShmBookReader() {
+    close();
+}
+
+bool ShmBookReader::open(const std::string& name) {
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false; // No publisher (yet)
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(shm::Header)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Book region {}: mmap of {} bytes failed", name.c_str(), size);
+        return false;
+    }
+
+    const shm::Header* header = static_cast<const shm::Header*>(map);
+    bool ready = std::memcmp(header->magic, shm::MAGIC, sizeof(header->magic)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!ready || header->version != shm::VERSION ||
+        header->header_size != sizeof(shm::Header) ||
+        header->slot_size != sizeof(shm::BookSlot) ||
+        header->ring_size == 0 || (header->ring_size & (header->ring_size - 1)) != 0 ||
+        shm::region_size(header->max_symbols, header->ring_size) > size) {
+        if (ready) {
+            LOG_ERROR("Book region {}: unsupported layout (version {})", name.c_str(), header->version);
+        }
+        munmap(map, size);
+        return false;
+    }
+
+    map_ = map;
+    map_size_ = size;
+    header_ = header;
+    slots_ = reinterpret_cast<const shm::BookSlot*>(static_cast<const char*>(map) + sizeof(shm::Header));
+    ring_ = reinterpret_cast<const shm::Notice*>(slots_ + header->max_symbols);
+    max_symbols_ = header->max_symbols;
+    ring_mask_ = header->ring_size - 1;
+    cursor_ = header->published.load(std::memory_order_acquire);
+    lapped_ = 0;
+    return true;
+}
+
+void ShmBookReader::close() {
+    if (map_) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    map_size_ = 0;
+    header_ = nullptr;
+    slots_ = nullptr;
+    ring_ = nullptr;
+    max_symbols_ = 0;
+    ring_mask_ = 0;
+    cursor_ = 0;
+}
+
+uint32_t ShmBookReader::find(const char* symbol) const {
+    uint32_t count = symbols();
+    for (uint32_t id = 0; id < count; ++id) {
+        if (std::strncmp(slots_[id].symbol, symbol, sizeof(slots_[id].symbol) - 1) == 0) {
+            return id;
+        }
+    }
+    return NO_SYMBOL;
+}
+
+bool ShmBookReader::read(uint32_t id, OrderBook::Snapshot& snap, uint32_t max_spins) const {
+    if (id >= symbols()) {
+        return false;
+    }
+    const shm::BookSlot& slot = slots_[id];
+    for (uint32_t attempt = 0; attempt <= max_spins; ++attempt) {
+        uint64_t v1 = slot.version.load(std::memory_order_acquire);
+        if ((v1 & 1) == 0) {
+            snap.bid_depth = slot.bid_depth;
+            snap.ask_depth = slot.ask_depth;
+            snap.rx_timestamp_ns = slot.rx_timestamp_ns;
+            snap.bids = slot.bids;
+            snap.asks = slot.asks;
+            snap.bid_sequence = slot.bid_sequence;
+            snap.ask_sequence = slot.ask_sequence;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == v1) {
+                snap.version = v1;
+                snap.retries = attempt;
+                snap.timestamp = Timestamp::now();
+                return true;
+            }
+        }
+        cpu_relax();
+    }
+    return false; // Stale: publisher kept the slot busy
+}
+
+bool ShmBookReader::read_top(uint32_t id, OrderBook::Top& top, uint32_t max_spins) const {
+    if (id >= symbols()) {
+        return false;
+    }
+    const shm::BookSlot& slot = slots_[id];
+    for (uint32_t attempt = 0; attempt <= max_spins; ++attempt) {
+        uint64_t v1 = slot.version.load(std::memory_order_acquire);
+        if ((v1 & 1) == 0) {
+            top.bid_depth = slot.bid_depth;
+            top.ask_depth = slot.ask_depth;
+            top.rx_timestamp_ns = slot.rx_timestamp_ns;
+            top.bid_price = slot.bid_price;
+            top.bid_quantity = slot.bid_quantity;
+            top.ask_price = slot.ask_price;
+            top.ask_quantity = slot.ask_quantity;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == v1) {
+                top.version = v1;
+                return true;
+            }
+        }
+        cpu_relax();
+    }
+    return false;
+}
+
+} // namespace hft
@@ -0,0 +1,251 @@
+#include "market_data/tick_order_book.h"
+#include <algorithm>
+#include <limits>
+
+namespace hft {
+
+TickOrderBook::TickOrderBook(const std::string& symbol, double tick_size,
+                             size_t depth, size_t ladder_ticks, size_t overflow_levels)
+    : symbol_(symbol)
+    , tick_size_(tick_size)
+    , depth_(depth) {
+    // Whole bitmap words only, bounded by what one summary word can cover
+    ladder_ticks_ = std::clamp<size_t>((ladder_ticks + 63) & ~size_t(63),
+                                       64, MAX_LADDER_TICKS);
+
+    for (Ladder* l : {&bids_, &asks_}) {
+        l->slots.assign(ladder_ticks_, TickLevel{});
+        l->words.assign(ladder_ticks_ / 64, 0);
+        l->overflow.reserve(overflow_levels);
+    }
+    bids_.is_bid = true;
+    asks_.is_bid = false;
+}
+
+void TickOrderBook::update(Side side, uint64_t price_ticks, double quantity,
+                           uint32_t order_count) {
+    Ladder& l = ladder(side);
+    if (quantity > 0.0) {
+        set_level(l, price_ticks, quantity, order_count);
+    } else {
+        erase_level(l, price_ticks);
+    }
+}
+
+void TickOrderBook::set_level(Ladder& l, uint64_t ticks, double quantity,
+                              uint32_t order_count) {
+    if (!l.in_window(ticks)) {
+        // New touch outside the window, or first level on an empty side:
+        // slide the window to it. Anything else is a far level.
+        bool ladder_empty = l.summary == 0;
+        bool beyond_touch = l.is_bid ? ticks >= l.base + l.slots.size()
+                                     : ticks < l.base;
+        if (!ladder_empty && !beyond_touch) {
+            auto it = l.lower_bound(ticks);
+            if (it == l.overflow.end() || it->ticks != ticks) {
+                it = l.overflow.insert(it, FarLevel{ticks, TickLevel{}});
+                ++l.count;
+            }
+            it->level.quantity = quantity;
+            it->level.order_count = order_count;
+            return;
+        }
+        l.recenter(ticks);
+    }
+
+    size_t idx = ticks - l.base;
+    if (!bits::test_bit(l.words[idx >> 6], static_cast<int>(idx & 63))) {
+        l.mark(idx);
+        ++l.count;
+    }
+    l.slots[idx].quantity = quantity;
+    l.slots[idx].order_count = order_count;
+}
+
+void TickOrderBook::erase_level(Ladder& l, uint64_t ticks) {
+    if (!l.in_window(ticks)) {
+        auto it = l.lower_bound(ticks);
+        if (it != l.overflow.end() && it->ticks == ticks) {
+            l.overflow.erase(it);
+            --l.count;
+        }
+        return;
+    }
+
+    size_t idx = ticks - l.base;
+    if (!bits::test_bit(l.words[idx >> 6], static_cast<int>(idx & 63))) {
+        return;
+    }
+
+    l.unmark(idx);
+    l.slots[idx] = TickLevel{};
+    --l.count;
+
+    // Ladder drained: pull the next far levels back in around the new touch
+    if (l.summary == 0 && !l.overflow.empty()) {
+        l.recenter(l.is_bid ? l.overflow.back().ticks : l.overflow.front().ticks);
+    }
+}
+
+const TickOrderBook::TickLevel* TickOrderBook::find(Side side, uint64_t price_ticks) const {
+    const Ladder& l = ladder(side);
+    if (l.in_window(price_ticks)) {
+        size_t idx = price_ticks - l.base;
+        return bits::test_bit(l.words[idx >> 6], static_cast<int>(idx & 63))
+            ? &l.slots[idx] : nullptr;
+    }
+    auto it = l.lower_bound(price_ticks);
+    return it != l.overflow.end() && it->ticks == price_ticks ? &it->level : nullptr;
+}
+
+double TickOrderBook::best_bid() const noexcept {
+    uint64_t ticks = bids_.best();
+    return ticks == NO_PRICE ? 0.0 : to_price(ticks);
+}
+
+double TickOrderBook::best_ask() const noexcept {
+    uint64_t ticks = asks_.best();
+    return ticks == NO_PRICE ? std::numeric_limits<double>::max() : to_price(ticks);
+}
+
+size_t TickOrderBook::get_levels(Side side, PriceLevel* out, size_t max_levels) const {
+    const Ladder& l = ladder(side);
+    size_t limit = std::min(max_levels, depth_);
+    size_t n = 0;
+
+    auto emit = [&](uint64_t ticks, const TickLevel& level) {
+        out[n].reset();
+        out[n].price = to_price(ticks);
+        out[n].quantity = level.quantity;
+        out[n].order_count = level.order_count;
+        ++n;
+    };
+
+    if (l.summary != 0) {
+        for (size_t idx = l.best_index(); idx < l.slots.size() && n < limit;
+             idx = l.next_index(idx)) {
+            emit(l.base + idx, l.slots[idx]);
+        }
+    }
+
+    // Far levels continue in price order behind the ladder
+    if (l.is_bid) {
+        for (auto it = l.overflow.rbegin(); it != l.overflow.rend() && n < limit; ++it) {
+            emit(it->ticks, it->level);
+        }
+    } else {
+        for (auto it = l.overflow.begin(); it != l.overflow.end() && n < limit; ++it) {
+            emit(it->ticks, it->level);
+        }
+    }
+
+    return n;
+}
+
+void TickOrderBook::clear() {
+    for (Ladder* l : {&bids_, &asks_}) {
+        std::fill(l->slots.begin(), l->slots.end(), TickLevel{});
+        std::fill(l->words.begin(), l->words.end(), 0);
+        l->summary = 0;
+        l->count = 0;
+        l->base = 0;
+        l->overflow.clear();
+    }
+}
+
+uint64_t TickOrderBook::Ladder::best() const noexcept {
+    if (summary != 0) {
+        return base + best_index();
+    }
+    if (overflow.empty()) {
+        return NO_PRICE;
+    }
+    return is_bid ? overflow.back().ticks : overflow.front().ticks;
+}
+
+std::vector<TickOrderBook::FarLevel>::iterator
+TickOrderBook::Ladder::lower_bound(uint64_t ticks) noexcept {
+    return std::lower_bound(overflow.begin(), overflow.end(), ticks,
+                            [](const FarLevel& far, uint64_t t) { return far.ticks < t; });
+}
+
+std::vector<TickOrderBook::FarLevel>::const_iterator
+TickOrderBook::Ladder::lower_bound(uint64_t ticks) const noexcept {
+    return std::lower_bound(overflow.begin(), overflow.end(), ticks,
+                            [](const FarLevel& far, uint64_t t) { return far.ticks < t; });
+}
+
+size_t TickOrderBook::Ladder::next_index(size_t idx) const noexcept {
+    size_t w = idx >> 6;
+    int b = static_cast<int>(idx & 63);
+
+    if (is_bid) {
+        // Next lower price
+        uint64_t below = words[w] & ((1ULL << b) - 1);
+        if (below) {
+            return (w << 6) | bits::log2_floor(below);
+        }
+        uint64_t lower_words = summary & ((1ULL << w) - 1);
+        if (!lower_words) {
+            return slots.size();
+        }
+        size_t w2 = bits::log2_floor(lower_words);
+        return (w2 << 6) | bits::log2_floor(words[w2]);
+    }
+
+    // Next higher price (2ULL << 63 wraps to 0, giving an empty mask)
+    uint64_t above = words[w] & ~((2ULL << b) - 1);
+    if (above) {
+        return (w << 6) | bits::count_trailing_zeros(above);
+    }
+    uint64_t higher_words = summary & ~((2ULL << w) - 1);
+    if (!higher_words) {
+        return slots.size();
+    }
+    size_t w2 = bits::count_trailing_zeros(higher_words);
+    return (w2 << 6) | bits::count_trailing_zeros(words[w2]);
+}
+
+void TickOrderBook::Ladder::recenter(uint64_t touch) {
+    // Leave 1/4 of the window for the touch to improve into and 3/4 for
+    // depth behind it
+    const uint64_t n = slots.size();
+    const uint64_t behind = n - n / 4;
+    const uint64_t ahead = n / 4;
+    uint64_t new_base = is_bid ? (touch > behind ? touch - behind : 0)
+                               : (touch > ahead ? touch - ahead : 0);
+
+    // Spill the current ladder into the overflow, then pull the new
+    // window's range back out. Every far level is worse than the ladder,
+    // so the ladder lands as one block in price order: behind the far bids
+    // (appended), in front of the far asks (one shift). Recentering is
+    // rare (touch moved by more than a quarter window).
+    size_t spilled = count - overflow.size();
+    size_t at = is_bid ? overflow.size() : 0;
+    if (is_bid) {
+        overflow.resize(overflow.size() + spilled);
+    } else {
+        overflow.insert(overflow.begin(), spilled, FarLevel{});
+    }
+    for (size_t w = 0; w < words.size(); ++w) {
+        for (uint64_t set = words[w]; set != 0; set &= set - 1) {
+            size_t idx = (w << 6) | bits::count_trailing_zeros(set);
+            overflow[at++] = FarLevel{base + idx, slots[idx]};
+            slots[idx] = TickLevel{};
+        }
+        words[w] = 0;
+    }
+    summary = 0;
+
+    base = new_base;
+    auto first = lower_bound(new_base);
+    auto last = lower_bound(new_base + n);
+    for (auto it = first; it != last; ++it) {
+        size_t idx = it->ticks - new_base;
+        slots[idx] = it->level;
+        mark(idx);
+    }
+    overflow.erase(first, last);
+}
+
+} // namespace hft
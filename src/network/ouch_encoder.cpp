@@ -0,0 +1,209 @@
+#include "network/ouch_encoder.h"
+#include "common/bit_utils.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace hft {
+
+namespace {
+
+// Field offsets inside the OUCH messages (after the SoupBinTCP header)
+namespace enter {
+constexpr size_t TOKEN = 1;
+constexpr size_t SIDE = 15;
+constexpr size_t SHARES = 16;
+constexpr size_t STOCK = 20;
+constexpr size_t PRICE = 28;
+constexpr size_t TIME_IN_FORCE = 32;
+constexpr size_t FIRM = 36;
+constexpr size_t DISPLAY = 40;
+constexpr size_t CAPACITY = 41;
+constexpr size_t SWEEP = 42;
+constexpr size_t MINIMUM_QUANTITY = 43;
+constexpr size_t CROSS_TYPE = 47;
+constexpr size_t CUSTOMER_TYPE = 48;
+} // namespace enter
+
+namespace replace {
+constexpr size_t EXISTING_TOKEN = 1;
+constexpr size_t REPLACEMENT_TOKEN = 15;
+constexpr size_t SHARES = 29;
+constexpr size_t PRICE = 33;
+constexpr size_t TIME_IN_FORCE = 37;
+constexpr size_t DISPLAY = 41;
+constexpr size_t SWEEP = 42;
+constexpr size_t MINIMUM_QUANTITY = 43;
+} // namespace replace
+
+namespace cancel {
+constexpr size_t TOKEN = 1;
+constexpr size_t SHARES = 15;
+} // namespace cancel
+
+constexpr size_t HEADER = OuchEncoder::SOUP_HEADER_SIZE;
+
+inline void put_u32(char* out, uint32_t value) {
+    value = bits::byte_swap_32(value);
+    std::memcpy(out, &value, sizeof(value));
+}
+
+inline void put_u16(char* out, uint16_t value) {
+    value = bits::byte_swap_16(value);
+    std::memcpy(out, &value, sizeof(value));
+}
+
+// Alpha field: left-justified, space padded
+void put_alpha(char* out, const char* value, size_t width) {
+    size_t len = std::min(std::strlen(value), width);
+    std::memset(out, ' ', width);
+    std::memcpy(out, value, len);
+}
+
+// SoupBinTCP unsequenced data packet header
+void put_header(char* frame, size_t message_size) {
+    put_u16(frame, static_cast<uint16_t>(message_size + 1));
+    frame[2] = 'U';
+}
+
+// Byte -> two uppercase hex digits
+struct HexTable {
+    char digits[256][2];
+
+    constexpr HexTable() : digits() {
+        const char* hex = "0123456789ABCDEF";
+        for (int i = 0; i < 256; ++i) {
+            digits[i][0] = hex[i >> 4];
+            digits[i][1] = hex[i & 0xF];
+        }
+    }
+};
+
+constexpr HexTable HEX;
+
+// Stock symbol as held in Order::symbol (NUL padded), first 8 bytes
+inline uint64_t stock_key(const char* symbol) {
+    uint64_t key;
+    std::memcpy(&key, symbol, sizeof(key));
+    return key;
+}
+
+} // namespace
+
+OuchEncoder::OuchEncoder(const Options& options)
+    : options_(options) {
+    symbols_.reserve(64);
+
+    // Replace and cancel carry no symbol: one template each
+    std::memset(&replace_, 0, sizeof(replace_));
+    char* msg = replace_.bytes + HEADER;
+    put_header(replace_.bytes, REPLACE_ORDER_SIZE);
+    msg[0] = 'U';
+    put_u32(msg + replace::TIME_IN_FORCE, TIF_DAY);
+    msg[replace::DISPLAY] = options_.display;
+    msg[replace::SWEEP] = options_.intermarket_sweep;
+    put_u32(msg + replace::MINIMUM_QUANTITY, options_.minimum_quantity);
+
+    std::memset(&cancel_, 0, sizeof(cancel_));
+    msg = cancel_.bytes + HEADER;
+    put_header(cancel_.bytes, CANCEL_ORDER_SIZE);
+    msg[0] = 'X';
+    put_u32(msg + cancel::SHARES, 0);   // 0 = cancel all remaining shares
+}
+
+bool OuchEncoder::add_symbol(const char* symbol) {
+    size_t len = std::strlen(symbol);
+    if (len == 0 || len > 8) {
+        LOG_ERROR("OUCH symbols are 1 to 8 characters: {}", symbol);
+        return false;
+    }
+
+    char padded[16] = {};
+    std::memcpy(padded, symbol, len);
+    uint64_t key = stock_key(padded);
+    for (const auto& entry : symbols_) {
+        if (entry.stock == key) {
+            return true;
+        }
+    }
+
+    SymbolTemplates entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.stock = key;
+    for (int side = 0; side < 2; ++side) {
+        char* frame = entry.enter[side].bytes;
+        char* msg = frame + HEADER;
+        put_header(frame, ENTER_ORDER_SIZE);
+        msg[0] = 'O';
+        msg[enter::SIDE] = side == static_cast<int>(Order::Side::BUY) ? 'B' : 'S';
+        put_alpha(msg + enter::STOCK, symbol, 8);
+        put_u32(msg + enter::TIME_IN_FORCE, TIF_DAY);
+        put_alpha(msg + enter::FIRM, options_.firm, 4);
+        msg[enter::DISPLAY] = options_.display;
+        msg[enter::CAPACITY] = options_.capacity;
+        msg[enter::SWEEP] = options_.intermarket_sweep;
+        put_u32(msg + enter::MINIMUM_QUANTITY, options_.minimum_quantity);
+        msg[enter::CROSS_TYPE] = options_.cross_type;
+        msg[enter::CUSTOMER_TYPE] = options_.customer_type;
+    }
+    symbols_.push_back(entry);
+    return true;
+}
+
+void OuchEncoder::write_token(char* out, uint64_t order_id) const {
+    out[0] = options_.token_prefix[0];
+    out[1] = options_.token_prefix[1];
+
+    // 48-bit ID, most significant byte first
+    for (int i = 0; i < 6; ++i) {
+        uint8_t byte = static_cast<uint8_t>(order_id >> (40 - 8 * i));
+        std::memcpy(out + 2 + 2 * i, HEX.digits[byte], 2);
+    }
+}
+
+uint32_t OuchEncoder::encode_price(double price) {
+    return static_cast<uint32_t>(bits::CompactPrice::from_double(price, PRICE_TICK).ticks);
+}
+
+uint32_t OuchEncoder::encode_shares(double quantity) {
+    return static_cast<uint32_t>(quantity + 0.5);
+}
+
+EncodedMessage OuchEncoder::encode_new(const Order& order) {
+    // Few symbols per session: a linear scan over 8-byte keys
+    uint64_t key = stock_key(order.symbol);
+    SymbolTemplates* entry = nullptr;
+    for (auto& candidate : symbols_) {
+        if (candidate.stock == key) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (__builtin_expect(entry == nullptr, 0)) {
+        return {nullptr, 0};
+    }
+
+    Frame& frame = entry->enter[static_cast<size_t>(order.side) & 1];
+    char* msg = frame.bytes + HEADER;
+    write_token(msg + enter::TOKEN, order.order_id);
+    put_u32(msg + enter::SHARES, encode_shares(order.quantity));
+    put_u32(msg + enter::PRICE, order.type == Order::Type::MARKET ? MARKET_PRICE : encode_price(order.price));
+    put_u32(msg + enter::TIME_IN_FORCE, order.type == Order::Type::LIMIT ? TIF_DAY : TIF_IOC);
+    return {frame.bytes, HEADER + ENTER_ORDER_SIZE};
+}
+
+EncodedMessage OuchEncoder::encode_replace(const ReplaceRequest& request) {
+    char* msg = replace_.bytes + HEADER;
+    write_token(msg + replace::EXISTING_TOKEN, request.order_id);
+    write_token(msg + replace::REPLACEMENT_TOKEN, request.new_order_id);
+    put_u32(msg + replace::SHARES, encode_shares(request.quantity));
+    put_u32(msg + replace::PRICE, encode_price(request.price));
+    return {replace_.bytes, HEADER + REPLACE_ORDER_SIZE};
+}
+
+EncodedMessage OuchEncoder::encode_cancel(const CancelRequest& request) {
+    write_token(cancel_.bytes + HEADER + cancel::TOKEN, request.order_id);
+    return {cancel_.bytes, HEADER + CANCEL_ORDER_SIZE};
+}
+
+} // namespace hft
@@ -0,0 +1,325 @@
+#include "network/socket_transport.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <linux/net_tstamp.h>
+#include <time.h>
+#endif
+
+namespace hft {
+
+#ifdef __linux__
+namespace {
+
+// Payload of an SCM_TIMESTAMPING message: [0] software, [2] raw hardware
+struct ScmTimestamping {
+    struct timespec ts[3];
+};
+
+uint64_t to_ns(const struct timespec& ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Receive timestamp carried in a message's control data (0 if none)
+uint64_t rx_timestamp(const struct msghdr& hdr) {
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+         cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&hdr), cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_TIMESTAMPING) {
+            continue;
+        }
+        ScmTimestamping stamps;
+        std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+        uint64_t hardware = to_ns(stamps.ts[2]);
+        return hardware ? hardware : to_ns(stamps.ts[0]);
+    }
+    return 0;
+}
+
+} // namespace
+#endif
+
+SocketTransport::SocketTransport() : SocketTransport(Options{}) {}
+
+SocketTransport::SocketTransport(const Options& options)
+    : options_(options) {
+    options_.batch_size = std::clamp<size_t>(options_.batch_size, 1, MAX_BATCH);
+}
+
+SocketTransport::~SocketTransport() {
+    close();
+}
+
+int SocketTransport::open_multicast(const std::string& group, uint16_t port) {
+    // Create UDP socket
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // Set socket options for low latency
+    optimize_socket(fd);
+
+    // Several channels/lines may share a port on different groups
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+#ifdef IP_MULTICAST_ALL
+    // Only the groups this socket joined, not every group joined on the host
+    int all = 0;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &all, sizeof(all));
+#endif
+
+    // Bind to the group and port: sockets sharing the port each see their
+    // own group's datagrams only
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(group.c_str());
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    // Join multicast group
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = inet_addr(group.c_str());
+    mreq.imr_interface.s_addr = INADDR_ANY;
+
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                   &mreq, sizeof(mreq)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    fds_.push_back(fd);
+    return static_cast<int>(fds_.size() - 1);
+}
+
+int SocketTransport::open_unicast(const std::string& ip, uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    optimize_socket(fd);
+
+    // Connected: send() goes to the server, recv() only sees its replies
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(ip.c_str());
+    addr.sin_port = htons(port);
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    fds_.push_back(fd);
+    return static_cast<int>(fds_.size() - 1);
+}
+
+bool SocketTransport::start() {
+    // One aligned slot per datagram of a batch, registered once
+    ring_ = HugePageBuffer(options_.batch_size * DATAGRAM_SIZE);
+    if (!ring_.data()) {
+        return false;
+    }
+
+    char* base = static_cast<char*>(ring_.data());
+    iovecs_.assign(options_.batch_size, {});
+    for (size_t i = 0; i < options_.batch_size; ++i) {
+        iovecs_[i].iov_base = base + i * DATAGRAM_SIZE;
+        iovecs_[i].iov_len = DATAGRAM_SIZE;
+    }
+
+#ifdef __linux__
+    msgs_.assign(options_.batch_size, {});
+    for (size_t i = 0; i < options_.batch_size; ++i) {
+        msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+        msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    if (options_.timestamping != RxTimestamping::NONE) {
+        control_.assign(options_.batch_size * CONTROL_SIZE, 0);
+        for (size_t i = 0; i < options_.batch_size; ++i) {
+            msgs_[i].msg_hdr.msg_control = control_.data() + i * CONTROL_SIZE;
+        }
+    }
+
+    epoll_fd_ = epoll_create1(0);
+    if (epoll_fd_ < 0) {
+        return false;
+    }
+
+    // Level triggered: a socket not fully drained by one batch reports
+    // ready again on the next wait
+    for (uint32_t i = 0; i < fds_.size(); ++i) {
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fds_[i], &ev) < 0) {
+            return false;
+        }
+    }
+#endif
+
+    return true;
+}
+
+void SocketTransport::close() {
+    for (int fd : fds_) {
+        ::close(fd);
+    }
+    fds_.clear();
+
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+int SocketTransport::fd(int source) const {
+    return source >= 0 && static_cast<size_t>(source) < fds_.size() ? fds_[source] : -1;
+}
+
+void SocketTransport::optimize_socket(int fd) {
+    // Increase receive buffer size
+    int recv_buffer_size = 2 * 1024 * 1024; // 2MB
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+               &recv_buffer_size, sizeof(recv_buffer_size));
+
+    // Non-blocking: the thread waits in epoll (or spins), never in recv
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+#ifdef __linux__
+    // SO_BUSY_POLL: Use busy polling instead of interrupts
+    // This reduces latency significantly (microseconds)
+    if (options_.busy_poll_us > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL,
+                   &options_.busy_poll_us, sizeof(options_.busy_poll_us));
+    }
+
+    // SO_INCOMING_CPU: Pin socket to specific CPU
+    if (options_.incoming_cpu >= 0) {
+        setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU,
+                   &options_.incoming_cpu, sizeof(options_.incoming_cpu));
+    }
+
+    // SO_TIMESTAMPING: stamp every datagram on arrival. Hardware stamps
+    // also need RX timestamping enabled on the interface (SIOCSHWTSTAMP).
+    if (options_.timestamping != RxTimestamping::NONE) {
+        int stamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (options_.timestamping == RxTimestamping::HARDWARE) {
+            stamping |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        }
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &stamping, sizeof(stamping)) < 0) {
+            LOG_WARN("SO_TIMESTAMPING not supported, receive timestamps disabled");
+        }
+    }
+#endif
+}
+
+int SocketTransport::drain(uint32_t source, RxPacket* packets, size_t filled, size_t capacity) {
+    ++syscalls_;
+#ifdef __linux__
+    // The kernel shrinks msg_controllen to what it wrote
+    if (!control_.empty()) {
+        for (size_t i = filled; i < capacity; ++i) {
+            msgs_[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+        }
+    }
+
+    // One syscall drains up to the free ring slots
+    int received = recvmmsg(fds_[source], msgs_.data() + filled,
+                            static_cast<unsigned int>(capacity - filled),
+                            MSG_DONTWAIT, nullptr);
+#else
+    ssize_t bytes = recv(fds_[source], iovecs_[filled].iov_base, DATAGRAM_SIZE, MSG_DONTWAIT);
+    int received = bytes < 0 ? -1 : 1;
+#endif
+
+    if (received < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+
+    for (int i = 0; i < received; ++i) {
+        RxPacket& packet = packets[filled + i];
+        packet.data = static_cast<const char*>(iovecs_[filled + i].iov_base);
+#ifdef __linux__
+        packet.len = msgs_[filled + i].msg_len;
+        packet.rx_timestamp_ns = control_.empty() ? 0 : rx_timestamp(msgs_[filled + i].msg_hdr);
+#else
+        packet.len = static_cast<uint32_t>(bytes);
+        packet.rx_timestamp_ns = 0;
+#endif
+        packet.source = source;
+    }
+
+    return received;
+}
+
+int SocketTransport::receive(RxPacket* packets, size_t max, int timeout_ms) {
+    size_t capacity = std::min(max, options_.batch_size);
+    size_t filled = 0;
+
+#ifdef __linux__
+    if (timeout_ms > 0) {
+        // Sleep until a socket is readable, then drain the ready ones
+        constexpr int MAX_EVENTS = 64;
+        struct epoll_event events[MAX_EVENTS];
+
+        ++syscalls_;
+        int ready = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+        if (ready < 0) {
+            return errno == EINTR ? 0 : -1;
+        }
+
+        for (int i = 0; i < ready && filled < capacity; ++i) {
+            int n = drain(events[i].data.u32, packets, filled, capacity);
+            if (n < 0) {
+                return -1;
+            }
+            filled += n;
+        }
+        return static_cast<int>(filled);
+    }
+#else
+    (void)timeout_ms;
+#endif
+
+    // Busy poll: one non-blocking sweep over every socket
+    for (uint32_t source = 0; source < fds_.size() && filled < capacity; ++source) {
+        int n = drain(source, packets, filled, capacity);
+        if (n < 0) {
+            return -1;
+        }
+        filled += n;
+    }
+    return static_cast<int>(filled);
+}
+
+bool SocketTransport::send(int source, const char* data, size_t len) {
+    int sock = fd(source);
+    if (sock < 0) {
+        return false;
+    }
+    ++syscalls_;
+    return ::send(sock, data, len, MSG_DONTWAIT) == static_cast<ssize_t>(len);
+}
+
+} // namespace hft
@@ -1,16 +1,38 @@
 #include "network/tcp_sender.h"
+#include "network/order_encoder.h"
 #include "common/logger.h"
+#include "common/realtime.h"
+#include "common/timestamp.h"
+#include "common/tick_to_trade.h"
 #include <cstring>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 #include <fcntl.h>
+#include <cerrno>
+#include <algorithm>
+#include <pthread.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/epoll.h>
+#endif
 
 namespace hft {
 
+namespace {
+
+constexpr size_t RX_BUFFER_SIZE = 64 * 1024;
+
+} // namespace
+
 TCPSender::TCPSender(const std::string& host, uint16_t port)
     : host_(host)
-    , port_(port) {
+    , port_(port)
+    , ring_(new char[RING_SIZE]) {
+    // Touch every page now so the first orders don't fault
+    std::memset(ring_.get(), 0, RING_SIZE);
 }
 
 TCPSender::~TCPSender() {
@@ -52,17 +74,41 @@ bool TCPSender::connect() {
         return false;
     }
     
+    // Blocking connect, non-blocking from here on
+    int flags = fcntl(socket_fd_, F_GETFL, 0);
+    fcntl(socket_fd_, F_SETFL, flags | O_NONBLOCK);
+
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(0);
+    if (epoll_fd_ >= 0) {
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket_fd_, &ev);
+    }
+#endif
+    write_armed_ = false;
+    
     connected_.store(true, std::memory_order_release);
-    LOG_INFO("Connected to order gateway");
+    LOG_INFO("Connected to order gateway {}:{}", host_.c_str(), port_);
     return true;
 }
 
 void TCPSender::disconnect() {
+    stop_reader();
+    connected_.store(false, std::memory_order_release);
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
     if (socket_fd_ >= 0) {
         close(socket_fd_);
         socket_fd_ = -1;
     }
-    connected_.store(false, std::memory_order_release);
+    
+    // Unsent orders die with the connection
+    head_.store(tail_.load(std::memory_order_relaxed), std::memory_order_release);
+    rx_length_ = 0;
 }
 
 void TCPSender::enable_tcp_optimizations() {
@@ -85,7 +131,7 @@ void TCPSender::optimize_socket() {
     flag = 1;
     setsockopt(socket_fd_, IPPROTO_TCP, TCP_QUICKACK, &flag, sizeof(flag));
 #endif
-    
+
     // Set send buffer size
     int send_buffer_size = 256 * 1024;
     setsockopt(socket_fd_, SOL_SOCKET, SO_SNDBUF, 
@@ -97,35 +143,315 @@ void TCPSender::optimize_socket() {
     setsockopt(socket_fd_, SOL_SOCKET, SO_PRIORITY, 
                &priority, sizeof(priority));
 #endif
-    
+
     // TCP_USER_TIMEOUT: Set timeout for unacknowledged data
 #ifdef __linux__
     unsigned int timeout = 5000; // 5 seconds
     setsockopt(socket_fd_, IPPROTO_TCP, TCP_USER_TIMEOUT,
                &timeout, sizeof(timeout));
 #endif
-    
+
+    // Batching is done in user space (one sendmsg per flush), which needs
+    // no TCP_CORK/TCP_UNCORK syscall pair.
     // For ultimate performance, you could use:
-    // - TCP_CORK/TCP_UNCORK for batching
     // - SO_BUSY_POLL for polling instead of interrupts
     // - DPDK or kernel bypass (XDP, AF_XDP) for sub-microsecond latency
 }
 
+void TCPSender::set_encoder(std::unique_ptr<OrderEncoder> encoder) {
+    encoder_ = std::move(encoder);
+}
+
 bool TCPSender::send_order(const Order& order) {
-    if (!connected_.load(std::memory_order_acquire)) {
+    bool queued;
+    if (encoder_) {
+        EncodedMessage message = encoder_->encode_new(order);
+        if (message.len == 0) {
+            LOG_ERROR("Order {} not sent: symbol unknown to the {} encoder", order.order_id,
+                      encoder_->name());
+            return false;
+        }
+        queued = send_bytes(message.data, message.len);
+    } else {
+        queued = send_bytes(&order, sizeof(order));
+    }
+    
+    if (!queued) {
+        return false;
+    }
+    if (loopback_) {
+        loopback_report(order.type == Order::Type::IOC ? ExecutionReport::Type::CANCELED
+                                                       : ExecutionReport::Type::ACK,
+                        order.order_id, order.quantity);
+        return true;
+    }
+    orders_sent_.store(orders_sent_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    return true;
+}
+
+bool TCPSender::send_cancel(const CancelRequest& request) {
+    bool queued;
+    if (encoder_) {
+        EncodedMessage message = encoder_->encode_cancel(request);
+        queued = send_bytes(message.data, message.len);
+    } else {
+        queued = send_bytes(&request, sizeof(request));
+    }
+    if (queued && loopback_) {
+        loopback_report(ExecutionReport::Type::CANCELED, request.order_id, 0.0);
+    }
+    return queued;
+}
+
+bool TCPSender::send_replace(const ReplaceRequest& request) {
+    bool queued;
+    if (encoder_) {
+        EncodedMessage message = encoder_->encode_replace(request);
+        queued = send_bytes(message.data, message.len);
+    } else {
+        queued = send_bytes(&request, sizeof(request));
+    }
+    if (queued && loopback_) {
+        loopback_report(ExecutionReport::Type::ACK, request.new_order_id, request.quantity);
+    }
+    return queued;
+}
+
+void TCPSender::loopback_report(ExecutionReport::Type type, uint64_t order_id, double quantity) {
+    ExecutionReport report{};
+    report.type = type;
+    report.order_id = order_id;
+    report.leaves_quantity = quantity;
+    report.timestamp = Timestamp::fast_wall_clock_ns();
+    if (execution_callback_) {
+        execution_callback_(report);
+    }
+}
+
+bool TCPSender::send_bytes(const void* data, size_t len) {
+    if (!connected_.load(std::memory_order_acquire) && !loopback_) {
         LOG_ERROR("Not connected to order gateway");
         return false;
     }
     
-    // Send the order (blocking send)
-    // In production, might use non-blocking I/O with epoll
-    ssize_t sent = send(socket_fd_, &order, sizeof(order), 0);
+    // Room check; a full ring gets one chance to drain
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail + len - head_.load(std::memory_order_acquire) > RING_SIZE) {
+        try_flush();
+        if (tail + len - head_.load(std::memory_order_acquire) > RING_SIZE) {
+            LOG_WARN("Order ring full ({} bytes pending), order refused", pending_bytes());
+            return false;
+        }
+    }
+    
+    // Copy in, wrapping at the end of the ring
+    size_t offset = static_cast<size_t>(tail & (RING_SIZE - 1));
+    size_t first = std::min(len, RING_SIZE - offset);
+    std::memcpy(ring_.get() + offset, data, first);
+    std::memcpy(ring_.get(), static_cast<const char*>(data) + first, len - first);
+    tail_.store(tail + len, std::memory_order_release);
+    TickToTrade::mark(TickToTrade::ENCODE);
     
-    if (sent != sizeof(order)) {
-        LOG_ERROR("Failed to send order");
+    if (!batching_) {
+        try_flush();
+    }
+    return true;
+}
+
+void TCPSender::flush() {
+    batching_ = false;
+    try_flush();
+}
+
+void TCPSender::try_flush() {
+    // One flusher at a time. Whoever loses the race leaves its bytes to the
+    // holder, which re-checks for late arrivals after letting go. The check
+    // is a store-load pair on both sides (producer: tail_ then flushing_,
+    // holder: flushing_ then tail_), so both need a full fence: the seq_cst
+    // exchange on one side, the fence on the other.
+    while (!flushing_.exchange(true, std::memory_order_seq_cst)) {
+        bool drained = write_pending();
+        flushing_.store(false, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (drained) {
+            TickToTrade::sent();
+        }
+        if (!drained || pending_bytes() == 0) {
+            return;
+        }
+    }
+}
+
+bool TCPSender::write_pending() {
+    // Called with flushing_ held. True when everything was written.
+    while (true) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        if (head == tail) {
+            if (write_armed_) {
+                arm_write(false);
+            }
+            return true;
+        }
+        if (loopback_) {
+            head_.store(tail, std::memory_order_release);
+            continue;
+        }
+        
+        // Up to two iovecs: the ring may wrap inside the pending range
+        size_t offset = static_cast<size_t>(head & (RING_SIZE - 1));
+        size_t len = static_cast<size_t>(tail - head);
+        size_t first = std::min(len, RING_SIZE - offset);
+        struct iovec iov[2];
+        iov[0].iov_base = ring_.get() + offset;
+        iov[0].iov_len = first;
+        iov[1].iov_base = ring_.get();
+        iov[1].iov_len = len - first;
+        
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = len > first ? 2 : 1;
+        
+        ssize_t sent = sendmsg(socket_fd_, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        send_syscalls_.store(send_syscalls_.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        
+        if (sent > 0) {
+            // Short writes just advance; the loop retries the rest
+            head_.store(head + static_cast<uint64_t>(sent), std::memory_order_release);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Send buffer full: keep the bytes, resume on EPOLLOUT
+            if (!write_armed_) {
+                arm_write(true);
+            }
+            return false;
+        }
+        
+        LOG_ERROR("Failed to send orders (errno {})", errno);
+        connected_.store(false, std::memory_order_release);
         return false;
     }
+}
+
+void TCPSender::arm_write(bool armed) {
+#ifdef __linux__
+    if (epoll_fd_ >= 0) {
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = armed ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, socket_fd_, &ev);
+    }
+#endif
+    write_armed_ = armed;
+}
+
+void TCPSender::start_reader() {
+    if (reading_.load(std::memory_order_acquire) || !connected_.load(std::memory_order_acquire)) {
+        return;
+    }
+    rx_buffer_.resize(RX_BUFFER_SIZE);
+    rx_length_ = 0;
+    reading_.store(true, std::memory_order_release);
+    reader_thread_ = std::thread(&TCPSender::reader_loop, this);
+}
+
+void TCPSender::stop_reader() {
+    reading_.store(false, std::memory_order_release);
+    if (reader_thread_.joinable()) {
+        reader_thread_.join();
+    }
+}
+
+void TCPSender::reader_loop() {
+#ifdef __linux__
+    if (cpu_affinity_ >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu_affinity_, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        LOG_INFO("Order gateway reader pinned to CPU {}", cpu_affinity_);
+    }
+#endif
+    if (realtime_priority_ > 0 && !realtime::set_thread_priority(realtime_priority_)) {
+        LOG_WARN("Order gateway reader: SCHED_FIFO {} refused", realtime_priority_);
+    }
+
+    constexpr int WAIT_TIMEOUT_MS = 10;
+    bool busy = wait_mode_ == WaitMode::BUSY_POLL || epoll_fd_ < 0;
     
+    while (reading_.load(std::memory_order_acquire)) {
+        bool readable = busy;
+        bool writable = busy && pending_bytes() > 0;
+
+#ifdef __linux__
+        if (!busy) {
+            struct epoll_event events[1];
+            int ready = epoll_wait(epoll_fd_, events, 1, WAIT_TIMEOUT_MS);
+            if (ready < 0 && errno != EINTR) {
+                LOG_ERROR("Order gateway epoll error");
+                break;
+            }
+            for (int i = 0; i < ready; ++i) {
+                readable |= (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0;
+                writable |= (events[i].events & EPOLLOUT) != 0;
+            }
+        }
+#endif
+
+        // Finish writes the producer left behind on back-pressure
+        if (writable) {
+            try_flush();
+        }
+        if (readable && !read_reports()) {
+            break;
+        }
+        if (busy) {
+            cpu_relax();
+        }
+    }
+}
+
+bool TCPSender::read_reports() {
+    ssize_t received = recv(socket_fd_, rx_buffer_.data() + rx_length_,
+                            rx_buffer_.size() - rx_length_, MSG_DONTWAIT);
+    if (received == 0) {
+        LOG_WARN("Order gateway closed the connection");
+        connected_.store(false, std::memory_order_release);
+        return false;
+    }
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return true;
+        }
+        LOG_ERROR("Order gateway receive error (errno {})", errno);
+        connected_.store(false, std::memory_order_release);
+        return false;
+    }
+    rx_length_ += static_cast<size_t>(received);
+    
+    // Decode whole reports, keep a trailing partial one for the next read
+    size_t offset = 0;
+    while (rx_length_ - offset >= sizeof(ExecutionReport)) {
+        ExecutionReport report;
+        std::memcpy(&report, rx_buffer_.data() + offset, sizeof(report));
+        offset += sizeof(report);
+        reports_received_.store(reports_received_.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+        if (execution_callback_) {
+            execution_callback_(report);
+        }
+    }
+    if (offset > 0) {
+        std::memmove(rx_buffer_.data(), rx_buffer_.data() + offset, rx_length_ - offset);
+        rx_length_ -= offset;
+    }
     return true;
 }
 
@@ -1,10 +1,10 @@
 #include "network/udp_receiver.h"
+#include "network/socket_transport.h"
 #include "common/logger.h"
+#include "common/realtime.h"
+#include "common/timestamp.h"
+#include <algorithm>
 #include <cstring>
-#include <unistd.h>
-#include <arpa/inet.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
 #include <pthread.h>
 
 #ifdef __linux__
@@ -16,15 +16,26 @@ namespace hft {
 UDPReceiver::UDPReceiver(MarketDataHandler& handler,
                          const std::string& multicast_ip,
                          uint16_t port)
-    : handler_(handler)
-    , multicast_ip_(multicast_ip)
-    , port_(port) {
+    : handler_(handler) {
+    add_channel(multicast_ip, port);
 }
 
 UDPReceiver::~UDPReceiver() {
     stop();
 }
 
+size_t UDPReceiver::add_channel(const std::string& multicast_ip, uint16_t port) {
+    Channel channel;
+    channel.multicast_ip = multicast_ip;
+    channel.port = port;
+    channel.arbitrator = std::make_unique<FeedArbitrator>(
+        [this](const char* data, size_t len) {
+            dispatch(data, len, rx_timestamp_ns_);
+        });
+    channels_.push_back(std::move(channel));
+    return channels_.size() - 1;
+}
+
 void UDPReceiver::start() {
     if (running_.load(std::memory_order_acquire)) {
         return;
@@ -46,10 +57,14 @@ void UDPReceiver::stop() {
         receiver_thread_.join();
     }
     
-    if (socket_fd_ >= 0) {
-        close(socket_fd_);
-        socket_fd_ = -1;
+    close_sockets();
+}
+
+void UDPReceiver::close_sockets() {
+    if (transport_) {
+        transport_->close();
     }
+    sources_.clear();
 }
 
 void UDPReceiver::set_cpu_affinity(int cpu) {
@@ -60,38 +75,73 @@ void UDPReceiver::enable_kernel_bypass() {
     kernel_bypass_enabled_ = true;
 }
 
+void UDPReceiver::set_batch_size(size_t datagrams) {
+    batch_size_ = std::clamp<size_t>(datagrams, 1, MAX_BATCH);
+}
+
+void UDPReceiver::set_line_b(const std::string& multicast_ip, uint16_t port, size_t channel) {
+    channels_[channel].line_b_ip = multicast_ip;
+    channels_[channel].line_b_port = port;
+}
+
+void UDPReceiver::set_recovery_server(const std::string& ip, uint16_t port, size_t channel) {
+    channels_[channel].recovery_ip = ip;
+    channels_[channel].recovery_port = port;
+}
+
 bool UDPReceiver::setup_socket() {
-    // Create UDP socket
-    socket_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
-    if (socket_fd_ < 0) {
-        return false;
+    if (!transport_) {
+        SocketTransport::Options options;
+        options.batch_size = batch_size_;
+        options.timestamping = timestamping_;
+        if (kernel_bypass_enabled_) {
+            options.busy_poll_us = 50; // microseconds
+            options.incoming_cpu = cpu_affinity_;
+        }
+        transport_ = std::make_unique<SocketTransport>(options);
     }
     
-    // Set socket options for low latency
-    optimize_socket();
+    // B lines and recovery only make sense for sequenced feeds
+    bool sequenced = handler_.feed_protocol() == FeedProtocol::ITCH50_MOLDUDP64;
     
-    // Bind to port
-    struct sockaddr_in addr;
-    std::memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port_);
-    
-    if (bind(socket_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        close(socket_fd_);
-        socket_fd_ = -1;
-        return false;
+    for (uint32_t c = 0; c < channels_.size(); ++c) {
+        Channel& channel = channels_[c];
+        
+        if (!add_source(transport_->open_multicast(channel.multicast_ip, channel.port),
+                        c, FeedArbitrator::Line::A)) {
+            close_sockets();
+            return false;
+        }
+        
+        if (!channel.line_b_ip.empty()) {
+            if (!sequenced) {
+                LOG_WARN("Line B ignored: feed protocol carries no sequence numbers");
+            } else if (!add_source(transport_->open_multicast(channel.line_b_ip, channel.line_b_port),
+                                   c, FeedArbitrator::Line::B)) {
+                LOG_ERROR("Failed to setup line B socket");
+                close_sockets();
+                return false;
+            }
+        }
+        
+        // Without a rerequest server gaps go straight to snapshot recovery
+        channel.arbitrator->set_retransmit_callback(nullptr);
+        if (sequenced && !channel.recovery_ip.empty()) {
+            int source = transport_->open_unicast(channel.recovery_ip, channel.recovery_port);
+            if (!add_source(source, c, FeedArbitrator::Line::RECOVERY)) {
+                LOG_ERROR("Failed to setup recovery socket");
+                close_sockets();
+                return false;
+            }
+            channel.arbitrator->set_retransmit_callback(
+                [this, source](const char* session, uint64_t sequence, uint16_t count) {
+                    send_retransmit_request(source, session, sequence, count);
+                });
+        }
     }
     
-    // Join multicast group
-    struct ip_mreq mreq;
-    mreq.imr_multiaddr.s_addr = inet_addr(multicast_ip_.c_str());
-    mreq.imr_interface.s_addr = INADDR_ANY;
-    
-    if (setsockopt(socket_fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, 
-                   &mreq, sizeof(mreq)) < 0) {
-        close(socket_fd_);
-        socket_fd_ = -1;
+    if (!transport_->start()) {
+        close_sockets();
         return false;
     }
     
@@ -99,30 +149,36 @@ bool UDPReceiver::setup_socket() {
     return true;
 }
 
-void UDPReceiver::optimize_socket() {
-    // Increase receive buffer size
-    int recv_buffer_size = 2 * 1024 * 1024; // 2MB
-    setsockopt(socket_fd_, SOL_SOCKET, SO_RCVBUF, 
-               &recv_buffer_size, sizeof(recv_buffer_size));
-    
-#ifdef __linux__
-    // SO_BUSY_POLL: Use busy polling instead of interrupts
-    // This reduces latency significantly (microseconds)
-    if (kernel_bypass_enabled_) {
-        int busy_poll = 50; // microseconds
-        setsockopt(socket_fd_, SOL_SOCKET, SO_BUSY_POLL, 
-                   &busy_poll, sizeof(busy_poll));
-        
-        // SO_INCOMING_CPU: Pin socket to specific CPU
-        if (cpu_affinity_ >= 0) {
-            setsockopt(socket_fd_, SOL_SOCKET, SO_INCOMING_CPU,
-                      &cpu_affinity_, sizeof(cpu_affinity_));
+bool UDPReceiver::add_source(int id, uint32_t channel, FeedArbitrator::Line line) {
+    if (id < 0) {
+        return false;
+    }
+    if (sources_.size() <= static_cast<size_t>(id)) {
+        sources_.resize(id + 1, Source{0, FeedArbitrator::Line::A});
+    }
+    sources_[id] = {channel, line};
+    return true;
+}
+
+void UDPReceiver::send_retransmit_request(int source, const char* session,
+                                          uint64_t sequence, uint16_t count) {
+    // MoldUDP64 request packet: [session 10][sequence u64][count u16]
+    char request[feed::MoldUDP64Framing::HEADER_SIZE];
+    std::memcpy(request, session, 10);
+    feed::write_be64(request + 10, sequence);
+    feed::write_be16(request + 18, count);
+    
+    if (!transport_->send(source, request, sizeof(request))) {
+        LOG_WARN("Failed to send retransmission request");
+    }
+}
+
+void UDPReceiver::poll_recovery(uint64_t now_ns) {
+    for (auto& channel : channels_) {
+        if (channel.arbitrator->in_recovery()) {
+            channel.arbitrator->poll(now_ns);
         }
     }
-#endif
-    
-    // Set socket to non-blocking for better control
-    // (though we'll use blocking recv for simplicity in this demo)
 }
 
 void UDPReceiver::receive_loop() {
@@ -133,31 +189,63 @@ void UDPReceiver::receive_loop() {
         CPU_ZERO(&cpuset);
         CPU_SET(cpu_affinity_, &cpuset);
         pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
-        LOG_INFO("Market data thread pinned to CPU");
+        LOG_INFO("Market data thread pinned to CPU {}", cpu_affinity_);
     }
 #endif
+    if (realtime_priority_ > 0 && !realtime::set_thread_priority(realtime_priority_)) {
+        LOG_WARN("Market data thread: SCHED_FIFO {} refused", realtime_priority_);
+    }
+    TickToTrade::attach(latency_stages_);
+
+    // Sequenced feeds are arbitrated, anything else goes straight through
+    bool arbitrate = handler_.feed_protocol() == FeedProtocol::ITCH50_MOLDUDP64;
+    
+    // Epoll mode: bounded wait so stop() and recovery timers are serviced.
+    // Busy poll: never sleep, check the coarse recovery timers every few
+    // thousand sweeps.
+    constexpr int WAIT_TIMEOUT_MS = 10;
+    constexpr uint32_t RECOVERY_CHECK_INTERVAL = 4096;
+    bool busy = wait_mode_ == WaitMode::BUSY_POLL;
+    int timeout_ms = busy ? 0 : WAIT_TIMEOUT_MS;
+    uint32_t sweeps = 0;
     
-    // Pre-allocate buffer (avoid allocations in hot path)
-    constexpr size_t BUFFER_SIZE = 65536;
-    alignas(64) char buffer[BUFFER_SIZE];
+    RxPacket packets[MAX_BATCH];
     
     LOG_INFO("UDP receiver started");
     
     while (running_.load(std::memory_order_acquire)) {
-        // Receive data (blocking)
-        ssize_t bytes_received = recv(socket_fd_, buffer, BUFFER_SIZE, 0);
+        int received = transport_->receive(packets, batch_size_, timeout_ms);
+        if (received < 0) {
+            LOG_ERROR("UDP receive error");
+            break;
+        }
         
-        if (bytes_received > 0) {
+        for (int i = 0; i < received; ++i) {
+            const RxPacket& packet = packets[i];
+            
             // Process message immediately (zero-copy)
             // This is the critical path - must be fast!
-            handler_.process_message(buffer, bytes_received);
-        } else if (bytes_received < 0) {
-            // Error handling
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                LOG_ERROR("UDP receive error");
-                break;
+            if (arbitrate) {
+                const Source& source = sources_[packet.source];
+                rx_timestamp_ns_ = packet.rx_timestamp_ns;
+                channels_[source.channel].arbitrator->on_packet(source.line, packet.data, packet.len);
+            } else {
+                dispatch(packet.data, packet.len, packet.rx_timestamp_ns);
             }
         }
+        
+        datagrams_.store(datagrams_.load(std::memory_order_relaxed) + received,
+                         std::memory_order_relaxed);
+        receive_calls_.store(transport_->syscalls(), std::memory_order_relaxed);
+        
+        if (busy && received == 0) {
+            cpu_relax();
+        }
+        
+        if (arbitrate && (!busy || ++sweeps == RECOVERY_CHECK_INTERVAL)) {
+            sweeps = 0;
+            poll_recovery(Timestamp::fast_wall_clock_ns());
+        }
     }
     
     LOG_INFO("UDP receiver stopped");
@@ -0,0 +1,397 @@
+#include "network/xdp_transport.h"
+#include "common/logger.h"
+#include "common/timestamp.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#if defined(__linux__) && __has_include(<linux/if_xdp.h>) && __has_include(<linux/bpf.h>)
+#define HFT_HAVE_AF_XDP 1
+#include <linux/if_xdp.h>
+#include <linux/bpf.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+#endif
+
+namespace hft {
+
+XdpTransport::XdpTransport(const Options& options)
+    : options_(options) {
+}
+
+XdpTransport::~XdpTransport() {
+    close();
+}
+
+int XdpTransport::open_multicast(const std::string& group, uint16_t port) {
+    // IGMP membership only: matching frames are redirected to the XDP
+    // socket before the kernel stack sees them
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Anything the XDP program passes up must not pile up here
+    int recv_buffer_size = 4096;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &recv_buffer_size, sizeof(recv_buffer_size));
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = inet_addr(group.c_str());
+    mreq.imr_interface.s_addr = INADDR_ANY;
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    membership_fds_.push_back(fd);
+
+    uint32_t source = static_cast<uint32_t>(sources_.size());
+    filters_.push_back({ntohl(mreq.imr_multiaddr.s_addr), port, source});
+    sources_.push_back({false, -1});
+    return static_cast<int>(source);
+}
+
+int XdpTransport::open_unicast(const std::string& ip, uint16_t port) {
+    // Control traffic is rare and not latency critical: kernel sockets
+    int inner = control_.open_unicast(ip, port);
+    if (inner < 0) {
+        return -1;
+    }
+
+    uint32_t source = static_cast<uint32_t>(sources_.size());
+    sources_.push_back({true, inner});
+    if (control_map_.size() <= static_cast<size_t>(inner)) {
+        control_map_.resize(inner + 1);
+    }
+    control_map_[inner] = source;
+    return static_cast<int>(source);
+}
+
+bool XdpTransport::send(int source, const char* data, size_t len) {
+    if (source < 0 || static_cast<size_t>(source) >= sources_.size() ||
+        !sources_[source].unicast) {
+        return false;
+    }
+    return control_.send(sources_[source].control_source, data, len);
+}
+
+#ifdef HFT_HAVE_AF_XDP
+
+bool XdpTransport::start() {
+    if (options_.interface.empty()) {
+        LOG_ERROR("AF_XDP transport needs an interface");
+        return false;
+    }
+    if ((options_.frame_count & (options_.frame_count - 1)) != 0 ||
+        (options_.frame_size & (options_.frame_size - 1)) != 0) {
+        LOG_ERROR("AF_XDP frame count and size must be powers of 2");
+        return false;
+    }
+
+    xsk_fd_ = socket(AF_XDP, SOCK_RAW, 0);
+    if (xsk_fd_ < 0) {
+        LOG_ERROR("Failed to create AF_XDP socket (needs CAP_NET_RAW/CAP_BPF)");
+        return false;
+    }
+
+    if (!setup_umem() || !setup_rings() || !bind_socket() || !register_xskmap() ||
+        !control_.start()) {
+        close();
+        return false;
+    }
+
+    held_.reserve(options_.batch_size);
+    LOG_INFO("AF_XDP transport bound to {} queue {} ({})", options_.interface.c_str(),
+             options_.queue, zero_copy_active_ ? "zero-copy" : "copy mode");
+    return true;
+}
+
+bool XdpTransport::setup_umem() {
+    size_t bytes = static_cast<size_t>(options_.frame_count) * options_.frame_size;
+    umem_ = HugePageBuffer(bytes);
+    if (!umem_.data()) {
+        LOG_ERROR("Failed to allocate AF_XDP UMEM");
+        return false;
+    }
+
+    struct xdp_umem_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.addr = reinterpret_cast<uint64_t>(umem_.data());
+    reg.len = bytes;
+    reg.chunk_size = options_.frame_size;
+    reg.headroom = 0;
+
+    if (setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+        LOG_ERROR("Failed to register AF_XDP UMEM");
+        return false;
+    }
+    return true;
+}
+
+bool XdpTransport::setup_rings() {
+    uint32_t entries = options_.frame_count;
+    if (setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_FILL_RING, &entries, sizeof(entries)) < 0 ||
+        setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_COMPLETION_RING, &entries, sizeof(entries)) < 0 ||
+        setsockopt(xsk_fd_, SOL_XDP, XDP_RX_RING, &entries, sizeof(entries)) < 0) {
+        LOG_ERROR("Failed to size AF_XDP rings");
+        return false;
+    }
+
+    struct xdp_mmap_offsets off;
+    socklen_t optlen = sizeof(off);
+    if (getsockopt(xsk_fd_, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) < 0) {
+        return false;
+    }
+
+    auto map_ring = [&](Ring& ring, const xdp_ring_offset& ro, size_t desc_size, off_t pgoff) {
+        size_t len = ro.desc + entries * desc_size;
+        void* map = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, xsk_fd_, pgoff);
+        if (map == MAP_FAILED) {
+            return false;
+        }
+        char* base = static_cast<char*>(map);
+        ring.map = map;
+        ring.map_len = len;
+        ring.producer = reinterpret_cast<uint32_t*>(base + ro.producer);
+        ring.consumer = reinterpret_cast<uint32_t*>(base + ro.consumer);
+        ring.flags = reinterpret_cast<uint32_t*>(base + ro.flags);
+        ring.descs = base + ro.desc;
+        ring.mask = entries - 1;
+        return true;
+    };
+
+    if (!map_ring(fill_, off.fr, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) ||
+        !map_ring(completion_, off.cr, sizeof(uint64_t), XDP_UMEM_PGOFF_COMPLETION_RING) ||
+        !map_ring(rx_, off.rx, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING)) {
+        LOG_ERROR("Failed to map AF_XDP rings");
+        return false;
+    }
+
+    // Every frame starts out owned by the kernel
+    std::vector<uint64_t> frames(entries);
+    for (uint32_t i = 0; i < entries; ++i) {
+        frames[i] = static_cast<uint64_t>(i) * options_.frame_size;
+    }
+    refill(frames.data(), frames.size());
+    return true;
+}
+
+bool XdpTransport::bind_socket() {
+    struct sockaddr_xdp sxdp;
+    std::memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_ifindex = if_nametoindex(options_.interface.c_str());
+    sxdp.sxdp_queue_id = options_.queue;
+    if (sxdp.sxdp_ifindex == 0) {
+        LOG_ERROR("AF_XDP interface not found");
+        return false;
+    }
+
+    // Need-wakeup: the kernel only wants a syscall when the fill ring ran dry
+    if (options_.zero_copy) {
+        sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_ZEROCOPY;
+        if (bind(xsk_fd_, (struct sockaddr*)&sxdp, sizeof(sxdp)) == 0) {
+            zero_copy_active_ = true;
+            return true;
+        }
+        LOG_WARN("AF_XDP zero-copy not supported by the driver, using copy mode");
+    }
+
+    sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_COPY;
+    if (bind(xsk_fd_, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+        LOG_ERROR("Failed to bind AF_XDP socket");
+        return false;
+    }
+    return true;
+}
+
+bool XdpTransport::register_xskmap() {
+    // Raw bpf(2): open the pinned map and point the queue's slot at us
+    union bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.pathname = reinterpret_cast<uint64_t>(options_.xskmap_path.c_str());
+    int map_fd = static_cast<int>(syscall(__NR_bpf, BPF_OBJ_GET, &attr, sizeof(attr)));
+    if (map_fd < 0) {
+        LOG_ERROR("XSKMAP not found: load the XDP redirect program first");
+        return false;
+    }
+
+    uint32_t key = options_.queue;
+    uint32_t value = static_cast<uint32_t>(xsk_fd_);
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_fd = static_cast<uint32_t>(map_fd);
+    attr.key = reinterpret_cast<uint64_t>(&key);
+    attr.value = reinterpret_cast<uint64_t>(&value);
+    attr.flags = BPF_ANY;
+    long rc = syscall(__NR_bpf, BPF_MAP_UPDATE_ELEM, &attr, sizeof(attr));
+    ::close(map_fd);
+
+    if (rc < 0) {
+        LOG_ERROR("Failed to insert AF_XDP socket into XSKMAP");
+        return false;
+    }
+    return true;
+}
+
+void XdpTransport::refill(const uint64_t* addrs, size_t count) {
+    // We are the only producer; the kernel reads up to the published index
+    uint32_t prod = *fill_.producer;
+    auto* ring = static_cast<uint64_t*>(fill_.descs);
+    for (size_t i = 0; i < count; ++i) {
+        ring[(prod + i) & fill_.mask] = addrs[i];
+    }
+    __atomic_store_n(fill_.producer, prod + static_cast<uint32_t>(count), __ATOMIC_RELEASE);
+}
+
+int XdpTransport::receive(RxPacket* packets, size_t max, int timeout_ms) {
+    // Frames handed out last time go back to the NIC
+    if (!held_.empty()) {
+        refill(held_.data(), held_.size());
+        held_.clear();
+    }
+
+    size_t capacity = std::min(max, options_.batch_size);
+    size_t filled = 0;
+
+    uint32_t cons = *rx_.consumer;
+    uint32_t prod = __atomic_load_n(rx_.producer, __ATOMIC_ACQUIRE);
+    uint32_t take = std::min<uint32_t>(prod - cons, static_cast<uint32_t>(capacity));
+
+    // No NIC metadata without a custom XDP program: software stamp at
+    // ring poll, one per batch
+    uint64_t rx_timestamp_ns = take ? Timestamp::fast_wall_clock_ns() : 0;
+
+    const char* umem = static_cast<const char*>(umem_.data());
+    const auto* descs = static_cast<const struct xdp_desc*>(rx_.descs);
+    uint64_t chunk_mask = ~static_cast<uint64_t>(options_.frame_size - 1);
+
+    for (uint32_t i = 0; i < take; ++i) {
+        const struct xdp_desc& desc = descs[(cons + i) & rx_.mask];
+        held_.push_back(desc.addr & chunk_mask);
+
+        uint32_t dst_ip;
+        uint16_t dst_port;
+        const char* payload;
+        size_t payload_len;
+        if (!parse_udp_frame(umem + desc.addr, desc.len, dst_ip, dst_port,
+                             payload, payload_len)) {
+            ++unmatched_;
+            continue;
+        }
+
+        // A handful of channels: a linear scan beats any index
+        bool matched = false;
+        for (const auto& filter : filters_) {
+            if (filter.ip == dst_ip && filter.port == dst_port) {
+                packets[filled++] = {payload, static_cast<uint32_t>(payload_len),
+                                     filter.source, rx_timestamp_ns};
+                matched = true;
+                break;
+            }
+        }
+        unmatched_ += !matched;
+    }
+    __atomic_store_n(rx_.consumer, cons + take, __ATOMIC_RELEASE);
+
+    // Retransmissions arrive through the kernel stack
+    if (filled < capacity && !control_map_.empty()) {
+        int n = control_.receive(packets + filled, capacity - filled, 0);
+        for (int i = 0; i < n; ++i) {
+            packets[filled + i].source = control_map_[packets[filled + i].source];
+        }
+        filled += std::max(n, 0);
+    }
+
+    if (filled == 0) {
+        // Fill ring ran dry at some point: the driver waits for a kick
+        if (__atomic_load_n(fill_.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP) {
+            ++syscalls_;
+            recvfrom(xsk_fd_, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+        }
+
+        if (timeout_ms > 0) {
+            struct pollfd pfd = {xsk_fd_, POLLIN, 0};
+            ++syscalls_;
+            if (poll(&pfd, 1, timeout_ms) > 0) {
+                return receive(packets, max, 0);
+            }
+        }
+    }
+
+    return static_cast<int>(filled);
+}
+
+void XdpTransport::unmap_ring(Ring& ring) {
+    if (ring.map) {
+        munmap(ring.map, ring.map_len);
+    }
+    ring = Ring{};
+}
+
+#else // !HFT_HAVE_AF_XDP
+
+bool XdpTransport::start() {
+    LOG_ERROR("AF_XDP is not available on this platform");
+    return false;
+}
+
+int XdpTransport::receive(RxPacket*, size_t, int) {
+    return -1;
+}
+
+void XdpTransport::unmap_ring(Ring& ring) {
+    ring = Ring{};
+}
+
+bool XdpTransport::setup_umem() { return false; }
+bool XdpTransport::setup_rings() { return false; }
+bool XdpTransport::bind_socket() { return false; }
+bool XdpTransport::register_xskmap() { return false; }
+void XdpTransport::refill(const uint64_t*, size_t) {}
+
+#endif // HFT_HAVE_AF_XDP
+
+void XdpTransport::close() {
+    // Closing the socket also drops it from the XSKMAP
+    unmap_ring(rx_);
+    unmap_ring(fill_);
+    unmap_ring(completion_);
+    if (xsk_fd_ >= 0) {
+        ::close(xsk_fd_);
+        xsk_fd_ = -1;
+    }
+    umem_ = HugePageBuffer();
+    held_.clear();
+
+    for (int fd : membership_fds_) {
+        ::close(fd);
+    }
+    membership_fds_.clear();
+    control_.close();
+}
+
+} // namespace hft
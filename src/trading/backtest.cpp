@@ -0,0 +1,147 @@
+#include "trading/backtest.h"
+#include "trading/strategy_router.h"
+#include "network/tcp_sender.h"
+#include "common/timestamp.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hft {
+
+namespace {
+
+constexpr uint64_t TIMER_INTERVAL_NS = 1000000;     // Strategy on_timer(), feed time
+
+// Book update: resting orders react first, then the strategies see it
+void on_book(void* context, const OrderBook& book) {
+    auto* venue = static_cast<ExchangeSimulator*>(context);
+    OrderBook::Top top = book.get_top();
+    venue->on_book(book, top);
+    StrategyRouter::dispatch(book, top);
+    venue->collect();
+    venue->advance(venue->now());
+}
+
+void on_trade(void* context, const OrderBook& book, const TradePrint& trade) {
+    auto* venue = static_cast<ExchangeSimulator*>(context);
+    venue->on_trade(book, trade);
+    StrategyRouter::dispatch_trade(book, trade);
+    venue->collect();
+    venue->advance(venue->now());
+}
+
+void pin_worker(int cpu) {
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        LOG_INFO("Backtest worker pinned to CPU {}", cpu);
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+} // namespace
+
+Backtest::Backtest(const FeedJournalReader& journal, const Setup& setup)
+    : journal_(journal)
+    , setup_(setup) {
+}
+
+Backtest::Result Backtest::run(const ParameterSet& parameters) const {
+    Result result;
+    uint64_t start = Timestamp::now();
+
+    MarketDataHandler handler(setup_.symbols.size());
+    for (const std::string& symbol : setup_.symbols) {
+        handler.add_symbol(symbol);
+    }
+    handler.set_feed_protocol(setup_.feed_protocol);
+
+    // Never connected: the venue takes orders from the command queue
+    TCPSender sender("127.0.0.1", 0);
+    OrderManager order_manager(sender);
+    OrderManager::RiskLimits limits = setup_.risk_limits;
+    limits.max_orders_per_second = 1000000000;
+    limits.max_order_burst = 1000000;
+    order_manager.set_risk_limits(limits);
+
+    std::vector<std::unique_ptr<MarketMakingStrategy>> strategies;
+    StrategyRouter router(handler);
+    for (const MarketMakingStrategy::Parameters& params : parameters) {
+        strategies.push_back(std::make_unique<MarketMakingStrategy>(order_manager, params));
+        router.subscribe(params.symbol, strategies.back().get());
+    }
+
+    ExchangeSimulator venue(handler, order_manager, setup_.venue);
+    handler.set_book_listener(&on_book, &venue);
+    handler.set_trade_listener(&on_trade, &venue);
+
+    FeedJournalReader::Record record;
+    size_t offset = 0;
+    uint64_t last_timer = 0;
+    double peak = 0;
+    while (journal_.next(offset, record)) {
+        venue.advance(record.timestamp_ns);
+        if (record.timestamp_ns - last_timer >= TIMER_INTERVAL_NS) {
+            router.on_timer();
+            last_timer = record.timestamp_ns;
+        }
+        handler.process_message(record.data, record.len, record.timestamp_ns);
+        ++result.packets;
+
+        double pnl = 0;
+        for (const auto& strategy : strategies) {
+            pnl += strategy->get_pnl();
+        }
+        peak = std::max(peak, pnl);
+        result.max_drawdown = std::max(result.max_drawdown, peak - pnl);
+    }
+
+    for (const auto& strategy : strategies) {
+        result.pnl += strategy->get_pnl();
+        result.position += strategy->get_position();
+    }
+    result.orders = venue.stats().orders;
+    result.fills = venue.stats().fills;
+    result.filled_quantity = venue.stats().filled_quantity;
+    result.elapsed_ns = Timestamp::to_nanoseconds(Timestamp::now() - start);
+    return result;
+}
+
+std::vector<Backtest::Result> Backtest::sweep(const std::vector<ParameterSet>& sets, size_t threads,
+                                              int first_cpu) const {
+    std::vector<Result> results(sets.size());
+    threads = std::max<size_t>(1, std::min(threads, sets.size()));
+
+    // Workers take the next set until none is left
+    std::atomic<size_t> next{0};
+    auto worker = [&](int cpu) {
+        pin_worker(cpu);
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < sets.size();
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            results[i] = run(sets[i]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(worker, first_cpu >= 0 ? first_cpu + static_cast<int>(t) : -1);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    return results;
+}
+
+} // namespace hft
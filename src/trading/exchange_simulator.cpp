@@ -0,0 +1,341 @@
+#include "trading/exchange_simulator.h"
+#include "trading/strategy_router.h"
+#include "trading/risk_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace hft {
+
+namespace {
+
+constexpr size_t COLLECT_BATCH = 64;
+
+} // namespace
+
+ExchangeSimulator::ExchangeSimulator(MarketDataHandler& handler, OrderManager& order_manager,
+                                     const Options& options)
+    : handler_(handler)
+    , order_manager_(order_manager)
+    , options_(options)
+    , commands_(std::make_unique<OrderManager::CommandQueue>())
+    , ids_(OrderManager::DEFAULT_MAX_ORDERS * 2) {
+    order_manager_.set_command_queue(commands_.get());
+}
+
+ExchangeSimulator::~ExchangeSimulator() {
+    order_manager_.set_command_queue(nullptr);
+}
+
+void ExchangeSimulator::collect() {
+    OrderCommand batch[COLLECT_BATCH];
+    size_t count;
+    while ((count = commands_->pop_batch(batch, COLLECT_BATCH)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            requests_.push_back({now_ns_ + options_.order_latency_ns, batch[i]});
+        }
+    }
+}
+
+void ExchangeSimulator::advance(uint64_t now_ns) {
+    now_ns_ = now_ns > now_ns_ ? now_ns : now_ns_;
+
+    // Requests match at their arrival time, against the book as it is now
+    while (!requests_.empty() && requests_.front().due_ns <= now_ns_) {
+        OrderCommand command = requests_.front().item;
+        match_ns_ = requests_.front().due_ns;
+        requests_.pop_front();
+        execute(command);
+    }
+
+    while (!reports_.empty() && reports_.front().due_ns <= now_ns_) {
+        ExecutionReport report = reports_.front().item;
+        reports_.pop_front();
+        order_manager_.on_execution_report(report);
+    }
+}
+
+void ExchangeSimulator::execute(const OrderCommand& command) {
+    switch (command.kind) {
+        case OrderCommand::Kind::NEW:
+            on_new(command.order);
+            break;
+        case OrderCommand::Kind::REPLACE:
+            on_replace(command.replace);
+            break;
+        case OrderCommand::Kind::CANCEL:
+            on_cancel(command.cancel);
+            break;
+    }
+}
+
+void ExchangeSimulator::on_new(const Order& order) {
+    char symbol[sizeof(order.symbol) + 1] = {};
+    std::memcpy(symbol, order.symbol, sizeof(order.symbol));
+    OrderBook* book = handler_.get_order_book(symbol);
+    Book* entry = book ? book_of(*book) : nullptr;
+    if (!entry) {
+        ++stats_.rejects;
+        report(ExecutionReport::Type::REJECT, order.order_id, 0, 0, 0, REJECT_UNKNOWN_SYMBOL);
+        return;
+    }
+
+    ++stats_.orders;
+    report(ExecutionReport::Type::ACK, order.order_id, order.price, 0, order.quantity);
+
+    // Market orders take whatever the touch shows
+    double price = order.price;
+    if (order.type == Order::Type::MARKET) {
+        price = order.side == Order::Side::BUY ? std::numeric_limits<double>::max() : 0.0;
+    }
+    Resting resting{order.order_id, order.side, price, order.quantity, 0, 0};
+    enter(*entry, book->subscribers()->slot, resting, order.type == Order::Type::LIMIT);
+}
+
+void ExchangeSimulator::on_replace(const ReplaceRequest& request) {
+    uint32_t slot;
+    Resting* found = find(request.order_id, slot);
+    if (!found) {
+        // Filled or canceled first: the venue answers under the new ID
+        ++stats_.rejects;
+        report(ExecutionReport::Type::REJECT, request.new_order_id, 0, 0, 0, REJECT_UNKNOWN_ORDER);
+        return;
+    }
+
+    ++stats_.replaces;
+    Resting order = *found;
+    bool keeps_priority = same_price(order.price, request.price) && request.quantity <= order.leaves;
+    remove(slot, request.order_id);
+    order.order_id = request.new_order_id;
+    order.leaves = request.quantity;
+    report(ExecutionReport::Type::ACK, order.order_id, request.price, 0, order.leaves);
+
+    Book& book = books_[slot];
+    if (keeps_priority) {
+        insert(book, slot, order);
+    } else {
+        order.price = request.price;
+        enter(book, slot, order, true);
+    }
+}
+
+void ExchangeSimulator::on_cancel(const CancelRequest& request) {
+    uint32_t slot;
+    if (!find(request.order_id, slot)) {
+        ++stats_.rejects;
+        report(ExecutionReport::Type::REJECT, request.order_id, 0, 0, 0, REJECT_UNKNOWN_ORDER);
+        return;
+    }
+    ++stats_.cancels;
+    remove(slot, request.order_id);
+    report(ExecutionReport::Type::CANCELED, request.order_id, 0, 0, 0);
+}
+
+void ExchangeSimulator::enter(Book& book, uint32_t slot, Resting order, bool rest) {
+    // Marketable: takes the displayed touch at its price
+    OrderBook::Top top = book.book->get_top();
+    bool buy = order.side == Order::Side::BUY;
+    uint32_t depth = buy ? top.ask_depth : top.bid_depth;
+    double touch = buy ? top.ask_price : top.bid_price;
+    if (depth > 0 && !better(order.side, touch, order.price)) {
+        fill(order, std::min(order.leaves, buy ? top.ask_quantity : top.bid_quantity), touch);
+    }
+    if (order.leaves <= 0) {
+        return;
+    }
+    if (!rest) {
+        report(ExecutionReport::Type::CANCELED, order.order_id, 0, 0, 0);
+        return;
+    }
+
+    order.queue_ahead = displayed_at(*book.book, order.side, order.price);
+    order.queue_before = order.queue_ahead;
+    insert(book, slot, order);
+}
+
+void ExchangeSimulator::insert(Book& book, uint32_t slot, const Resting& order) {
+    // Behind every order of the same side it does not beat
+    auto position = std::find_if(book.orders.begin(), book.orders.end(), [&order](const Resting& other) {
+        return other.side == order.side && better(order.side, order.price, other.price);
+    });
+    book.orders.insert(position, order);
+    ids_.insert(order.order_id, slot);
+}
+
+void ExchangeSimulator::on_book(const OrderBook& book, const OrderBook::Top& top) {
+    Book* entry = book_of(book);
+    if (!entry || entry->orders.empty()) {
+        return;
+    }
+    match_ns_ = now_ns_;
+
+    // Opposite quantity still available to cross our orders this update
+    double bid_left = top.bid_depth > 0 ? top.bid_quantity : 0;
+    double ask_left = top.ask_depth > 0 ? top.ask_quantity : 0;
+
+    auto& orders = entry->orders;
+    for (size_t i = 0; i < orders.size();) {
+        Resting& order = orders[i];
+        bool buy = order.side == Order::Side::BUY;
+        double& opposite_left = buy ? ask_left : bid_left;
+        double opposite = buy ? top.ask_price : top.bid_price;
+        if (opposite_left > 0 && !better(order.side, opposite, order.price)) {
+            double quantity = std::min(order.leaves, opposite_left);
+            opposite_left -= quantity;
+            fill(order, quantity, order.price);
+            if (order.leaves <= 0) {
+                ids_.erase(order.order_id);
+                orders.erase(orders.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+        }
+
+        // Queue ahead: what is left displayed at our price
+        order.queue_before = order.queue_ahead;
+        uint32_t depth = buy ? top.bid_depth : top.ask_depth;
+        double touch = buy ? top.bid_price : top.ask_price;
+        if (depth == 0 || better(order.side, order.price, touch)) {
+            order.queue_ahead = 0;
+        } else if (same_price(order.price, touch)) {
+            order.queue_ahead = std::min(order.queue_ahead, buy ? top.bid_quantity : top.ask_quantity);
+        }
+        ++i;
+    }
+}
+
+void ExchangeSimulator::on_trade(const OrderBook& book, const TradePrint& trade) {
+    Book* entry = book_of(book);
+    if (!entry || entry->orders.empty()) {
+        return;
+    }
+    match_ns_ = now_ns_;
+
+    Order::Side side = trade.resting_side == OrderBook::Side::BID ? Order::Side::BUY : Order::Side::SELL;
+    double remaining = trade.quantity;
+    auto& orders = entry->orders;
+    for (size_t i = 0; i < orders.size() && remaining > 0;) {
+        Resting& order = orders[i];
+        double ours = 0;
+        if (order.side != side) {
+            // Other side of the book
+        } else if (better(side, order.price, trade.price)) {
+            ours = remaining;                   // Traded through us
+        } else if (same_price(order.price, trade.price)) {
+            // The update that reported this execution already took it off
+            // the level: count it against the queue from before that update
+            ours = remaining - order.queue_before;
+            order.queue_ahead = std::min(order.queue_ahead, std::max(0.0, order.queue_before - remaining));
+            order.queue_before = order.queue_ahead;
+        }
+        if (ours > 0) {
+            double quantity = std::min(order.leaves, ours);
+            remaining -= quantity;
+            fill(order, quantity, order.price);
+            if (order.leaves <= 0) {
+                ids_.erase(order.order_id);
+                orders.erase(orders.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+        }
+        ++i;
+    }
+}
+
+void ExchangeSimulator::fill(Resting& order, double quantity, double price) {
+    if (quantity <= 0) {
+        return;
+    }
+    order.leaves -= quantity;
+    if (order.leaves < 1e-9) {
+        order.leaves = 0;
+    }
+    ++stats_.fills;
+    stats_.filled_quantity += quantity;
+    stats_.filled_notional += quantity * price;
+    report(ExecutionReport::Type::FILL, order.order_id, price, quantity, order.leaves);
+}
+
+void ExchangeSimulator::report(ExecutionReport::Type type, uint64_t order_id, double price,
+                               double quantity, double leaves, uint8_t reason) {
+    ExecutionReport report{};
+    report.type = type;
+    report.reason = reason;
+    report.order_id = order_id;
+    report.price = price;
+    report.quantity = quantity;
+    report.leaves_quantity = leaves;
+    report.timestamp = match_ns_;
+    reports_.push_back({match_ns_ + options_.report_latency_ns, report});
+}
+
+ExchangeSimulator::Book* ExchangeSimulator::book_of(const OrderBook& book) {
+    const BookSubscribers* subscribers = book.subscribers();
+    if (!subscribers) {
+        return nullptr;
+    }
+    if (subscribers->slot >= books_.size()) {
+        books_.resize(subscribers->slot + 1);
+    }
+    Book& entry = books_[subscribers->slot];
+    entry.book = &book;
+    return &entry;
+}
+
+ExchangeSimulator::Resting* ExchangeSimulator::find(uint64_t order_id, uint32_t& slot) {
+    const uint32_t* found = ids_.find(order_id);
+    if (!found) {
+        return nullptr;
+    }
+    slot = *found;
+    for (Resting& order : books_[slot].orders) {
+        if (order.order_id == order_id) {
+            return &order;
+        }
+    }
+    return nullptr;
+}
+
+void ExchangeSimulator::remove(uint32_t slot, uint64_t order_id) {
+    auto& orders = books_[slot].orders;
+    orders.erase(std::remove_if(orders.begin(), orders.end(),
+                                [order_id](const Resting& order) { return order.order_id == order_id; }),
+                 orders.end());
+    ids_.erase(order_id);
+}
+
+double ExchangeSimulator::displayed_at(const OrderBook& book, Order::Side side, double price) {
+    OrderBook::Top top = book.get_top();
+    bool buy = side == Order::Side::BUY;
+    uint32_t depth = buy ? top.bid_depth : top.ask_depth;
+    double touch = buy ? top.bid_price : top.ask_price;
+    if (depth == 0 || better(side, price, touch)) {
+        return 0;
+    }
+    if (same_price(price, touch)) {
+        return buy ? top.bid_quantity : top.ask_quantity;
+    }
+
+    // Behind the touch: the level's quantity, if it is displayed
+    OrderBook::Snapshot snapshot = book.get_snapshot();
+    const auto& levels = buy ? snapshot.bids : snapshot.asks;
+    uint32_t levels_shown = buy ? snapshot.bid_depth : snapshot.ask_depth;
+    for (uint32_t i = 0; i < levels_shown; ++i) {
+        if (same_price(levels[i].price, price)) {
+            return levels[i].quantity;
+        }
+    }
+    return 0;
+}
+
+bool ExchangeSimulator::better(Order::Side side, double a, double b) {
+    constexpr double HALF_TICK = 0.5 / RiskEngine::PRICE_SCALE;
+    return side == Order::Side::BUY ? a > b + HALF_TICK : a < b - HALF_TICK;
+}
+
+bool ExchangeSimulator::same_price(double a, double b) {
+    constexpr double HALF_TICK = 0.5 / RiskEngine::PRICE_SCALE;
+    return std::abs(a - b) < HALF_TICK;
+}
+
+} // namespace hft
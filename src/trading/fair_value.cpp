@@ -0,0 +1,241 @@
+#include "trading/fair_value.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace hft {
+
+#if defined(__AVX2__)
+namespace {
+
+// a * b + c
+inline __m256d multiply_add(__m256d a, __m256d b, __m256d c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+
+} // namespace
+#endif
+
+FairValueEngine::FairValueEngine(size_t max_instruments, uint32_t recompute_interval)
+    : instruments_(max_instruments)
+    , recompute_interval_(recompute_interval ? recompute_interval : 1) {
+}
+
+uint32_t FairValueEngine::intern(const std::string& symbol) {
+    uint32_t index = instruments_.intern(symbol.c_str());
+    if (index != SymbolTable::NO_SYMBOL && index >= prices_.size()) {
+        prices_.resize(index + 1, 0.0);
+        basket_of_.resize(index + 1, NO_INDEX);
+    }
+    return index == SymbolTable::NO_SYMBOL ? NO_INDEX : index;
+}
+
+uint32_t FairValueEngine::add_basket(const std::string& symbol, double threshold_bps, double cash) {
+    uint32_t instrument = intern(symbol);
+    if (instrument == NO_INDEX || basket_of_[instrument] != NO_INDEX) {
+        LOG_ERROR("Cannot add basket '{}': instruments full or already a basket", symbol);
+        return NO_INDEX;
+    }
+    uint32_t basket = static_cast<uint32_t>(baskets_.size());
+    BasketState state{};
+    state.cash = cash;
+    state.threshold = threshold_bps * 1e-4;
+    state.instrument = instrument;
+    baskets_.push_back(state);
+    basket_of_[instrument] = basket;
+    return basket;
+}
+
+bool FairValueEngine::add_component(uint32_t basket, const std::string& symbol, double weight) {
+    uint32_t instrument = basket < baskets_.size() ? intern(symbol) : NO_INDEX;
+    if (instrument == NO_INDEX) {
+        LOG_ERROR("Cannot add component '{}': no such basket or instruments full", symbol);
+        return false;
+    }
+    components_.push_back(Component{basket, instrument, weight});
+    return true;
+}
+
+bool FairValueEngine::load(const std::string& path, double threshold_bps) {
+    std::ifstream file(path);
+    if (!file) {
+        LOG_ERROR("Cannot open basket file {}", path);
+        return false;
+    }
+    std::string line;
+    size_t number = 0;
+    while (std::getline(file, line)) {
+        ++number;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) {
+            line.erase(hash);
+        }
+        std::istringstream fields(line);
+        std::string basket_symbol, component;
+        double weight;
+        if (!(fields >> basket_symbol)) {
+            continue; // Blank or comment
+        }
+        if (!(fields >> component >> weight)) {
+            LOG_ERROR("Basket file {}:{}: expected '<basket> <component> <weight>'", path, number);
+            return false;
+        }
+
+        uint32_t instrument = instruments_.find(basket_symbol.c_str());
+        uint32_t basket = instrument != SymbolTable::NO_SYMBOL ? basket_of_[instrument] : NO_INDEX;
+        if (basket == NO_INDEX) {
+            basket = add_basket(basket_symbol, threshold_bps);
+            if (basket == NO_INDEX) {
+                return false;
+            }
+        }
+        if (component == "CASH") {
+            baskets_[basket].cash += weight;
+        } else if (!add_component(basket, component, weight)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FairValueEngine::finalize() {
+    uint32_t instruments = static_cast<uint32_t>(prices_.size());
+    uint32_t baskets = static_cast<uint32_t>(baskets_.size());
+
+    // One entry per (basket, instrument), weights of repeats summed
+    std::vector<Component> merged = components_;
+    std::sort(merged.begin(), merged.end(), [](const Component& a, const Component& b) {
+        return a.basket != b.basket ? a.basket < b.basket : a.instrument < b.instrument;
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < merged.size(); ++i) {
+        if (out > 0 && merged[out - 1].basket == merged[i].basket &&
+            merged[out - 1].instrument == merged[i].instrument) {
+            merged[out - 1].weight += merged[i].weight;
+        } else {
+            merged[out++] = merged[i];
+        }
+    }
+    merged.resize(out);
+
+    // Rows, each padded to whole vectors with zero weights
+    row_begin_.assign(baskets + 1, 0);
+    row_size_.assign(baskets, 0);
+    for (const Component& c : merged) {
+        ++row_size_[c.basket];
+    }
+    for (uint32_t b = 0; b < baskets; ++b) {
+        row_begin_[b + 1] = row_begin_[b] + ((row_size_[b] + 3) & ~3u);
+    }
+    row_weight_.assign(row_begin_[baskets], 0.0);
+    row_price_.assign(row_begin_[baskets], 0.0);
+    std::vector<uint32_t> slot(merged.size());
+    std::vector<uint32_t> fill(row_begin_.begin(), row_begin_.end() - 1);
+    for (size_t k = 0; k < merged.size(); ++k) {
+        const Component& c = merged[k];
+        slot[k] = fill[c.basket]++;
+        row_weight_[slot[k]] = c.weight;
+        row_price_[slot[k]] = prices_[c.instrument];
+    }
+
+    // Columns
+    column_begin_.assign(instruments + 1, 0);
+    for (const Component& c : merged) {
+        ++column_begin_[c.instrument + 1];
+    }
+    for (uint32_t i = 0; i < instruments; ++i) {
+        column_begin_[i + 1] += column_begin_[i];
+    }
+    columns_.assign(merged.size(), Entry{});
+    fill.assign(column_begin_.begin(), column_begin_.end() - 1);
+    for (size_t k = 0; k < merged.size(); ++k) {
+        const Component& c = merged[k];
+        columns_[fill[c.instrument]++] = Entry{c.basket, slot[k], c.weight};
+    }
+
+    // Prices seen so far count
+    for (uint32_t b = 0; b < baskets; ++b) {
+        baskets_[b].unpriced = baskets_[b].market_price > 0 ? 0 : 1;
+    }
+    for (const Component& c : merged) {
+        if (prices_[c.instrument] == 0.0) {
+            ++baskets_[c.basket].unpriced;
+        }
+    }
+    finalized_ = instruments;
+    ticks_ = 0;
+    next_recompute_ = 0;
+    recompute();
+    max_drift_ = 0.0;
+}
+
+void FairValueEngine::reset_prices() {
+    std::fill(prices_.begin(), prices_.end(), 0.0);
+    std::fill(row_price_.begin(), row_price_.end(), 0.0);
+    for (uint32_t b = 0; b < baskets_.size(); ++b) {
+        BasketState& state = baskets_[b];
+        state.fair_value = state.cash;
+        state.market_price = 0.0;
+        state.side = 0;
+        state.unpriced = 1 + (b < row_size_.size() ? row_size_[b] : 0);
+    }
+    ticks_ = 0;
+    next_recompute_ = 0;
+    max_drift_ = 0.0;
+}
+
+double FairValueEngine::recompute(uint32_t basket) {
+    const double* weight = row_weight_.data() + row_begin_[basket];
+    const double* price = row_price_.data() + row_begin_[basket];
+    uint32_t n = row_begin_[basket + 1] - row_begin_[basket];
+
+#if defined(__AVX2__)
+    // Four independent sums so the multiply-adds overlap instead of
+    // waiting on each other
+    __m256d total[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        for (int k = 0; k < 4; ++k) {
+            total[k] = multiply_add(_mm256_loadu_pd(weight + i + 4 * k), _mm256_loadu_pd(price + i + 4 * k), total[k]);
+        }
+    }
+    for (; i < n; i += 4) {
+        total[0] = multiply_add(_mm256_loadu_pd(weight + i), _mm256_loadu_pd(price + i), total[0]);
+    }
+    total[0] = _mm256_add_pd(_mm256_add_pd(total[0], total[1]), _mm256_add_pd(total[2], total[3]));
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(total[0]), _mm256_extractf128_pd(total[0], 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+#else
+    double sum = 0.0;
+    for (uint32_t i = 0; i < n; ++i) {
+        sum += weight[i] * price[i];
+    }
+#endif
+
+    BasketState& state = baskets_[basket];
+    double value = state.cash + sum;
+    double drift = value != 0.0 ? std::fabs(state.fair_value - value) / std::fabs(value) : 0.0;
+    state.fair_value = value;
+    max_drift_ = std::max(max_drift_, drift);
+    return drift;
+}
+
+double FairValueEngine::recompute() {
+    double drift = 0.0;
+    for (uint32_t b = 0; b < baskets_.size(); ++b) {
+        drift = std::max(drift, recompute(b));
+    }
+    return drift;
+}
+
+} // namespace hft
@@ -1,117 +1,349 @@
 #include "trading/order_manager.h"
 #include "common/timestamp.h"
 #include "common/logger.h"
-#include <cmath>
+#include "common/tick_to_trade.h"
 
 namespace hft {
 
-OrderManager::OrderManager(TCPSender& order_sender)
-    : order_sender_(order_sender) {
+OrderManager::OrderManager(TCPSender& order_sender, size_t max_open_orders)
+    : order_sender_(order_sender)
+    , limits_(risk_.limits())
+    , limits_reader_(limits_.add_reader())
+    , applied_limits_(limits_.read(limits_reader_))
+    , pool_(max_open_orders)
+    , orders_(max_open_orders * 2)
+    , staged_(new OrderCommand[MAX_STAGED]) {
 }
 
-void OrderManager::set_risk_limits(const RiskLimits& limits) {
-    limits_ = limits;
+void OrderManager::begin_batch() {
+    if (commands_) {
+        batching_ = true;
+    } else {
+        order_sender_.begin_batch();
+    }
+}
+
+void OrderManager::flush() {
+    if (commands_) {
+        publish_staged();
+        batching_ = false;
+    } else {
+        order_sender_.flush();
+    }
+}
+
+void OrderManager::queue_command(const OrderCommand& command) {
+    if (staged_count_ == MAX_STAGED) {
+        publish_staged();
+    }
+    staged_[staged_count_++] = command;
+    if (!batching_) {
+        publish_staged();
+    }
+}
+
+void OrderManager::publish_staged() {
+    // The request is already accounted for: wait for the sender stage
+    // rather than drop it, applying its failure reports meanwhile so it
+    // never waits on us in turn
+    size_t published = 0;
+    while (published < staged_count_) {
+        published += commands_->push_batch(staged_.get() + published, staged_count_ - published);
+        if (published < staged_count_) {
+            cpu_relax();
+            while (ExecutionReport* report = send_failures_.front()) {
+                on_execution_report(*report);
+                send_failures_.pop();
+            }
+        }
+    }
+    staged_count_ = 0;
+}
+
+void OrderManager::enqueue_send_failure(const OrderCommand& command) {
+    ExecutionReport report{};
+    report.type = ExecutionReport::Type::REJECT;
+    report.reason = REJECT_NOT_SENT;
+    report.order_id = command.report_id();
+    report.timestamp = Timestamp::fast_wall_clock_ns();
+    while (!send_failures_.push(report)) {
+        cpu_relax();
+    }
 }
 
 bool OrderManager::submit_order(const Order& order) {
-    // Pre-trade risk checks (must be FAST!)
-    // These checks typically take < 100ns
+    TickToTrade::mark(TickToTrade::STRATEGY);
     
-    // 1. Check order size
-    if (!check_order_size(order.quantity)) {
-        LOG_ERROR("Order size exceeds limit");
+    // 1. Slot from the pool and symbol risk entry, no allocation
+    uint64_t order_id = order.order_id;
+    if (orders_.find(order_id)) {
+        LOG_ERROR("Order {} rejected: duplicate order ID", order_id);
         return false;
     }
-    
-    // 2. Check position limit
-    if (!check_position_limit(order.side, order.quantity)) {
-        LOG_ERROR("Order would exceed position limit");
+    uint32_t symbol = risk_.order_symbol(order.symbol);
+    if (symbol == RiskEngine::NO_SYMBOL) {
+        LOG_ERROR("Order {} rejected: no risk entry for its symbol", order_id);
         return false;
     }
-    
-    // 3. Check rate limit
-    if (!check_rate_limit()) {
-        LOG_ERROR("Rate limit exceeded");
+    OrderInfo* info = pool_.allocate();
+    if (!info) {
+        LOG_ERROR("Order {} rejected: {} orders open, order table full", order_id, open_orders());
         return false;
     }
     
-    // 4. Check notional limit
-    if (!check_notional_limit(order.price, order.quantity)) {
-        LOG_ERROR("Notional limit exceeded");
+    // 2. Pre-trade risk checks: size, position (filled plus open on the
+    // same side), notional and order rate, all evaluated together
+    int64_t lots = RiskEngine::to_lots(order.quantity);
+    int64_t ticks = RiskEngine::to_ticks(order.price);
+    uint32_t reject = risk_.check(symbol, order.side, lots, lots, lots * ticks, Timestamp::now());
+    if (reject) {
+        pool_.deallocate(info);
+        LOG_ERROR("Order {} rejected: {} limit ({} @ {})", order_id,
+                  RiskEngine::reject_reason(reject), order.quantity, order.price);
         return false;
     }
+    TickToTrade::mark(TickToTrade::RISK);
     
     // All checks passed - submit order
-    bool success = order_sender_.send_order(order);
-    
-    if (success) {
-        // Update internal state (would be more sophisticated in production)
-        // For now, assume immediate fill (unrealistic but for demo)
-        double position = position_.load(std::memory_order_relaxed);
-        if (order.side == Order::Side::BUY) {
-            position_.store(position + order.quantity, std::memory_order_relaxed);
-        } else {
-            position_.store(position - order.quantity, std::memory_order_relaxed);
-        }
+    if (commands_) {
+        queue_command(OrderCommand(order));
+    } else if (!order_sender_.send_order(order)) {
+        risk_.refund_token();
+        pool_.deallocate(info);
+        return false;
     }
     
-    return success;
+    info->order_id = order_id;
+    info->replace_id = 0;
+    info->symbol = symbol;
+    info->side = order.side;
+    info->state = OrderState::PENDING_NEW;
+    info->price = order.price;
+    info->quantity = order.quantity;
+    info->filled_quantity = 0;
+    info->leaves_quantity = order.quantity;
+    info->submit_time = Timestamp::fast_wall_clock_ns();
+    orders_.insert(order_id, info);
+    adjust_open(*info, info->leaves_quantity, info->price, 1);
+    return true;
 }
 
 bool OrderManager::cancel_order(uint64_t order_id) {
-    // Send cancel request
-    // In production, this would be a separate message type
-    (void)order_id;
+    TickToTrade::mark(TickToTrade::STRATEGY);
+    OrderInfo** found = orders_.find(order_id);
+    if (!found) {
+        return false;
+    }
+    
+    OrderInfo& order = **found;
+    if (order.state != OrderState::LIVE && order.state != OrderState::PARTIALLY_FILLED) {
+        return false;
+    }
+    
+    CancelRequest request;
+    request.order_id = order.order_id;
+    if (commands_) {
+        queue_command(OrderCommand(request));
+    } else if (!order_sender_.send_cancel(request)) {
+        return false;
+    }
+    order.state = OrderState::PENDING_CANCEL;
     return true;
 }
 
-bool OrderManager::check_order_size(double size) {
-    return size > 0 && size <= limits_.max_order_size;
+size_t OrderManager::cancel_all() {
+    // cancel_order() changes order states, not the table being walked
+    size_t sent = 0;
+    begin_batch();
+    orders_.for_each([this, &sent](uint64_t order_id, OrderInfo* order) {
+        if (order_id == order->order_id && cancel_order(order_id)) {
+            ++sent;
+        }
+    });
+    flush();
+    return sent;
 }
 
-bool OrderManager::check_position_limit(Order::Side side, double size) {
-    double current_position = position_.load(std::memory_order_relaxed);
-    double new_position = current_position;
+bool OrderManager::replace_order(uint64_t order_id, uint64_t new_order_id, double price,
+                                 double quantity, uint64_t timestamp) {
+    TickToTrade::mark(TickToTrade::STRATEGY);
+    OrderInfo** found = orders_.find(order_id);
+    if (!found) {
+        return false;
+    }
     
-    if (side == Order::Side::BUY) {
-        new_position += size;
-    } else {
-        new_position -= size;
+    OrderInfo& order = **found;
+    if (order.state != OrderState::LIVE && order.state != OrderState::PARTIALLY_FILLED) {
+        return false;
     }
     
-    return std::abs(new_position) <= limits_.max_position;
-}
-
-bool OrderManager::check_rate_limit() {
-    update_rate_limiter();
+    if (orders_.find(new_order_id)) {
+        LOG_ERROR("Replace of order {} rejected: duplicate order ID {}", order_id, new_order_id);
+        return false;
+    }
     
-    uint32_t count = orders_this_second_.load(std::memory_order_relaxed);
-    if (count >= limits_.max_orders_per_second) {
+    // Risk is checked on what the new version adds over the resting one
+    int64_t lots = RiskEngine::to_lots(quantity);
+    int64_t leaves = RiskEngine::to_lots(order.leaves_quantity);
+    int64_t added_lots = lots > leaves ? lots - leaves : 0;
+    int64_t added_notional = lots * RiskEngine::to_ticks(price) - leaves * RiskEngine::to_ticks(order.price);
+    uint32_t reject = risk_.check(order.symbol, order.side, lots, added_lots, added_notional,
+                                  Timestamp::now());
+    if (reject) {
+        LOG_ERROR("Replace of order {} rejected: {} limit ({} @ {})", order_id,
+                  RiskEngine::reject_reason(reject), quantity, price);
         return false;
     }
+    TickToTrade::mark(TickToTrade::RISK);
     
-    orders_this_second_.fetch_add(1, std::memory_order_relaxed);
+    ReplaceRequest request;
+    request.order_id = order.order_id;
+    request.new_order_id = new_order_id;
+    request.price = price;
+    request.quantity = quantity;
+    request.timestamp = timestamp;
+    if (commands_) {
+        queue_command(OrderCommand(request));
+    } else if (!order_sender_.send_replace(request)) {
+        risk_.refund_token();
+        return false;
+    }
+    
+    // Same slot, reachable under both IDs until the venue answers; both
+    // versions count against limits meanwhile
+    orders_.insert(new_order_id, &order);
+    ++pending_replaces_;
+    order.replace_id = new_order_id;
+    order.pending_price = price;
+    order.pending_quantity = quantity;
+    order.state = OrderState::PENDING_REPLACE;
+    adjust_open(order, quantity, price, 1);
     return true;
 }
 
-bool OrderManager::check_notional_limit(double price, double size) {
-    double order_notional = price * size;
-    double current_notional = notional_.load(std::memory_order_relaxed);
+const OrderManager::OrderInfo* OrderManager::find_order(uint64_t order_id) const {
+    OrderInfo* const* found = orders_.find(order_id);
+    return found ? *found : nullptr;
+}
+
+void OrderManager::on_execution_report(const ExecutionReport& report) {
+    uint64_t order_id = report.order_id;
+    OrderInfo** found = orders_.find(order_id);
+    if (!found) {
+        ++unknown_reports_;
+        return;
+    }
+    
+    OrderInfo& order = **found;
+    bool replace_answer = order.state == OrderState::PENDING_REPLACE && order_id == order.replace_id;
+    OrderState resting = order.filled_quantity > 0 ? OrderState::PARTIALLY_FILLED : OrderState::LIVE;
     
-    return (current_notional + order_notional) <= limits_.max_notional;
+    switch (report.type) {
+        case ExecutionReport::Type::ACK:
+            if (replace_answer) {
+                // New version is live: retire the old ID and its exposure
+                adjust_open(order, order.leaves_quantity, order.price, -1);
+                orders_.erase(order.order_id);
+                --pending_replaces_;
+                order.order_id = order.replace_id;
+                order.replace_id = 0;
+                order.price = order.pending_price;
+                order.quantity = order.pending_quantity;
+                order.leaves_quantity = order.pending_quantity;
+                order.state = resting;
+            } else if (order.state == OrderState::PENDING_NEW) {
+                order.state = OrderState::LIVE;
+            }
+            break;
+            
+        case ExecutionReport::Type::REJECT:
+            if (replace_answer) {
+                // Old version stays live
+                LOG_WARN("Replace of order {} rejected by venue (reason {})", order.order_id,
+                         report.reason);
+                adjust_open(order, order.pending_quantity, order.pending_price, -1);
+                if (report.reason == REJECT_NOT_SENT) {
+                    risk_.refund_token();
+                }
+                orders_.erase(order.replace_id);
+                --pending_replaces_;
+                order.replace_id = 0;
+                order.state = resting;
+            } else if (order.state == OrderState::PENDING_CANCEL) {
+                LOG_WARN("Cancel of order {} rejected by venue (reason {})", order_id, report.reason);
+                order.state = resting;
+            } else {
+                LOG_WARN("Order {} rejected by venue (reason {})", order_id, report.reason);
+                if (report.reason == REJECT_NOT_SENT) {
+                    risk_.refund_token();
+                }
+                finish(order);
+            }
+            break;
+            
+        case ExecutionReport::Type::FILL:
+            apply_fill(order, report);
+            if (order.leaves_quantity <= 0) {
+                finish(order);
+            } else if (order.state == OrderState::PENDING_NEW || order.state == OrderState::LIVE) {
+                order.state = OrderState::PARTIALLY_FILLED;
+            }
+            break;
+            
+        case ExecutionReport::Type::CANCELED:
+            finish(order);
+            break;
+    }
+}
+
+void OrderManager::enqueue_execution_report(const ExecutionReport& report) {
+    while (!reports_.push(report)) {
+        cpu_relax();
+    }
+}
+
+size_t OrderManager::process_execution_reports() {
+    refresh_risk_limits();
+    size_t count = 0;
+    while (ExecutionReport* report = reports_.front()) {
+        on_execution_report(*report);
+        reports_.pop();
+        ++count;
+    }
+    while (ExecutionReport* report = send_failures_.front()) {
+        on_execution_report(*report);
+        send_failures_.pop();
+        ++count;
+    }
+    return count;
 }
 
-void OrderManager::update_rate_limiter() {
-    uint64_t now_ns = Timestamp::wall_clock_ns();
-    uint64_t last_ns = last_second_timestamp_.load(std::memory_order_relaxed);
+void OrderManager::apply_fill(OrderInfo& order, const ExecutionReport& report) {
+    risk_.apply_fill(order.symbol, order.side, RiskEngine::to_lots(report.quantity),
+                     RiskEngine::to_ticks(report.price));
+    order.filled_quantity += report.quantity;
     
-    // Check if we've moved to a new second
-    constexpr uint64_t ONE_SECOND_NS = 1000000000ULL;
-    if (now_ns - last_ns > ONE_SECOND_NS) {
-        // Reset counter for new second
-        orders_this_second_.store(0, std::memory_order_relaxed);
-        last_second_timestamp_.store(now_ns, std::memory_order_relaxed);
+    // Open exposure follows the venue's leaves quantity
+    double leaves = report.leaves_quantity > 0 ? report.leaves_quantity : 0.0;
+    adjust_open(order, order.leaves_quantity - leaves, order.price, -1);
+    order.leaves_quantity = leaves;
+}
+
+void OrderManager::finish(OrderInfo& order) {
+    adjust_open(order, order.leaves_quantity, order.price, -1);
+    if (order.replace_id != 0) {
+        adjust_open(order, order.pending_quantity, order.pending_price, -1);
+        orders_.erase(order.replace_id);
+        --pending_replaces_;
     }
+    orders_.erase(order.order_id);
+    order.state = OrderState::DONE;
+    pool_.deallocate(&order);
+}
+
+void OrderManager::adjust_open(const OrderInfo& order, double quantity, double price, int64_t sign) {
+    risk_.adjust_open(order.symbol, order.side, RiskEngine::to_lots(quantity),
+                      RiskEngine::to_ticks(price), sign);
 }
 
 } // namespace hft
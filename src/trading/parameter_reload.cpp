@@ -0,0 +1,148 @@
+#include "trading/parameter_reload.h"
+#include "common/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <utility>
+
+namespace hft {
+
+MarketMakingStrategy::Parameters market_making_parameters(const Config& config, const std::string& symbol) {
+    MarketMakingStrategy::Parameters params;
+    params.symbol = symbol;
+    params.spread_target = config.spread_threshold;
+    params.max_position = config.max_position_size;
+    auto override_param = [&config, &symbol](const char* key, double& value) {
+        std::string name = symbol + "." + key;
+        if (config.has(name)) {
+            value = config.get<double>(name);
+        }
+    };
+    override_param("spread_target", params.spread_target);
+    override_param("quote_size", params.quote_size);
+    override_param("max_position", params.max_position);
+    override_param("skew_factor", params.skew_factor);
+    override_param("edge", params.edge);
+    override_param("tick_size", params.tick_size);
+    override_param("lot_size", params.lot_size);
+    auto override_count = [&config, &symbol](const char* key, uint32_t& value) {
+        std::string name = symbol + "." + key;
+        if (config.has(name)) {
+            value = static_cast<uint32_t>(std::max(config.get<int>(name), 0));     // Negative: rejected as 0
+        }
+    };
+    override_count("requote_ticks", params.requote_ticks);
+    override_count("requote_lots", params.requote_lots);
+    return params;
+}
+
+OrderManager::RiskLimits risk_limits(const Config& config) {
+    OrderManager::RiskLimits limits;
+    limits.max_order_size = config.max_order_size;
+    limits.max_position = config.max_position_size;
+    limits.max_orders_per_second = config.max_orders_per_second;
+    limits.max_order_burst = config.max_order_burst;
+    return limits;
+}
+
+bool validate_parameters(const MarketMakingStrategy::Parameters& params) {
+    const char* problem = nullptr;
+    if (!(params.spread_target > 0.0 && params.spread_target < 1.0)) {
+        problem = "spread_target outside (0, 1)";
+    } else if (!(params.quote_size > 0.0 && std::isfinite(params.quote_size))) {
+        problem = "quote_size not positive";
+    } else if (!(params.max_position > 0.0 && std::isfinite(params.max_position))) {
+        problem = "max_position not positive";
+    } else if (!(params.skew_factor >= 0.0 && params.skew_factor < 1.0)) {
+        problem = "skew_factor outside [0, 1)";   // 1 would skew the fair value to 0
+    } else if (!(params.edge >= 0.0 && params.edge < 1.0)) {
+        problem = "edge outside [0, 1)";
+    } else if (!(params.tick_size > 0.0 && std::isfinite(params.tick_size))) {
+        problem = "tick_size not positive";
+    } else if (!(params.lot_size > 0.0 && params.quote_size >= params.lot_size)) {
+        problem = "lot_size not positive or above quote_size";
+    } else if (params.requote_ticks == 0 || params.requote_lots == 0) {
+        problem = "requote_ticks or requote_lots is 0";
+    }
+    if (problem) {
+        LOG_ERROR("Parameters for {} rejected: {}", params.symbol, problem);
+        return false;
+    }
+    return true;
+}
+
+bool validate_risk_limits(const OrderManager::RiskLimits& limits) {
+    const char* problem = nullptr;
+    if (!(limits.max_order_size > 0.0 && std::isfinite(limits.max_order_size))) {
+        problem = "max_order_size not positive";
+    } else if (!(limits.max_position > 0.0 && std::isfinite(limits.max_position))) {
+        problem = "max_position_size not positive";
+    } else if (!(limits.max_notional > 0.0 && std::isfinite(limits.max_notional))) {
+        problem = "max_notional not positive";
+    } else if (limits.max_orders_per_second == 0 || limits.max_order_burst == 0) {
+        problem = "order rate or burst is 0";
+    }
+    if (problem) {
+        LOG_ERROR("Risk limits rejected: {}", problem);
+        return false;
+    }
+    return true;
+}
+
+ParameterReloader::ParameterReloader(OrderManager& order_manager, std::string path)
+    : order_manager_(order_manager)
+    , path_(std::move(path)) {
+}
+
+bool ParameterReloader::reload() {
+    // A fresh parse: keys removed from the file fall back to the defaults
+    Config config;
+    try {
+        if (path_.empty() || !config.load(path_)) {
+            LOG_ERROR("Parameter reload: cannot read '{}'", path_);
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Parameter reload: bad value in {} ({})", path_, e.what());
+        return false;
+    }
+
+    OrderManager::RiskLimits limits = risk_limits(config);
+    bool valid = validate_risk_limits(limits);
+    std::vector<MarketMakingStrategy::Parameters> parameters;
+    parameters.reserve(strategies_.size());
+    for (MarketMakingStrategy* strategy : strategies_) {
+        parameters.push_back(market_making_parameters(config, strategy->symbol()));
+        const MarketMakingStrategy::Parameters& params = parameters.back();
+        if (!validate_parameters(params)) {
+            valid = false;
+        } else if (params.quote_size > limits.max_order_size) {
+            LOG_ERROR("Parameters for {} rejected: quote_size {} above max_order_size {}",
+                      params.symbol, params.quote_size, limits.max_order_size);
+            valid = false;
+        }
+    }
+    if (!valid) {
+        LOG_ERROR("Parameter reload of {} rejected, still trading on the previous values", path_);
+        return false;
+    }
+
+    // Risk first: new quotes are checked against the limits they were
+    // sized for
+    order_manager_.publish_risk_limits(limits);
+    for (size_t i = 0; i < strategies_.size(); ++i) {
+        strategies_[i]->update_parameters(parameters[i]);
+    }
+    ++reloads_;
+    LOG_INFO("Reloaded strategy parameters and risk limits from {} ({} strategies)", path_, strategies_.size());
+    return true;
+}
+
+void ParameterReloader::reclaim() {
+    order_manager_.reclaim_risk_limits();
+    for (MarketMakingStrategy* strategy : strategies_) {
+        strategy->reclaim_parameters();
+    }
+}
+
+} // namespace hft
@@ -0,0 +1,292 @@
+#include "trading/pipeline.h"
+#include "common/timestamp.h"
+#include "common/bit_utils.h"
+#include "common/logger.h"
+#include "common/realtime.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hft {
+
+namespace {
+
+constexpr uint64_t TIMER_INTERVAL_NS = 1000000;     // Strategy on_timer()
+constexpr uint32_t IDLE_SPINS = 4096;               // Before yielding
+
+void pin_stage(int cpu, int priority, const char* stage) {
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        LOG_INFO("Pipeline {} thread pinned to CPU {}", stage, cpu);
+    }
+#else
+    (void)cpu;
+#endif
+    if (priority > 0 && !realtime::set_thread_priority(priority)) {
+        LOG_WARN("Pipeline {} thread: SCHED_FIFO {} refused", stage, priority);
+    }
+}
+
+} // namespace
+
+TradingPipeline::TradingPipeline(MarketDataHandler& handler, StrategyRouter& router,
+                                 OrderManager& order_manager, TCPSender& order_sender,
+                                 const Options& options)
+    : handler_(handler)
+    , router_(router)
+    , order_manager_(order_manager)
+    , order_sender_(order_sender)
+    , options_(options)
+    , events_(std::make_unique<CircularBuffer<BookEvent, EVENT_QUEUE_SIZE>>())
+    , commands_(std::make_unique<OrderManager::CommandQueue>())
+    , trades_(std::make_unique<CircularBuffer<TradeEvent, TRADE_QUEUE_SIZE>>()) {
+}
+
+TradingPipeline::~TradingPipeline() {
+    stop();
+}
+
+void TradingPipeline::start() {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    conflate_ = options_.conflate;
+    if (conflate_ && router_.books() > MAX_CONFLATED_BOOKS) {
+        LOG_ERROR("Conflation covers {} books, {} routed: queuing every update instead",
+                  MAX_CONFLATED_BOOKS, router_.books());
+        conflate_ = false;
+    }
+    dirty_words_ = (router_.books() + 63) / 64;
+    for (auto& word : dirty_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+
+    order_manager_.set_command_queue(commands_.get());
+    sender_running_.store(true, std::memory_order_release);
+    sender_thread_ = std::thread(&TradingPipeline::sender_loop, this);
+    strategy_running_.store(true, std::memory_order_release);
+    strategy_thread_ = std::thread(&TradingPipeline::strategy_loop, this);
+
+    handler_.set_book_listener(conflate_ ? &TradingPipeline::on_book_dirty : &TradingPipeline::on_book_update,
+                               this);
+    handler_.set_trade_listener(&TradingPipeline::on_trade, this);
+    LOG_INFO("Trading pipeline started ({})", conflate_ ? "conflating" : "every update");
+}
+
+void TradingPipeline::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    // Upstream first, so each stage drains what the previous one queued
+    router_.attach();
+    strategy_running_.store(false, std::memory_order_release);
+    strategy_thread_.join();
+    sender_running_.store(false, std::memory_order_release);
+    sender_thread_.join();
+    order_manager_.set_command_queue(nullptr);
+
+    LOG_INFO("Trading pipeline stopped: {} book evaluations ({} dropped, {} conflated), {} trades, "
+             "{} orders sent, {} send failures", events_processed(), events_dropped(),
+             updates_conflated(), trades_processed(), commands_sent(), send_failures());
+}
+
+void TradingPipeline::on_book_update(void* context, const OrderBook& book) {
+    static_cast<TradingPipeline*>(context)->publish(book);
+}
+
+void TradingPipeline::publish(const OrderBook& book) {
+    // Filled in place: one top-of-book read, no copy
+    BookEvent* event = events_->back_slot();
+    if (__builtin_expect(event == nullptr, 0)) {
+        events_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    event->book = &book;
+    event->top = book.get_top();
+    event->enqueue_tsc = Timestamp::now();
+    events_->commit_back();
+    events_queued_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TradingPipeline::on_book_dirty(void* context, const OrderBook& book) {
+    static_cast<TradingPipeline*>(context)->mark_dirty(book);
+}
+
+void TradingPipeline::on_trade(void* context, const OrderBook& book, const TradePrint& trade) {
+    static_cast<TradingPipeline*>(context)->publish_trade(book, trade);
+}
+
+void TradingPipeline::mark_dirty(const OrderBook& book) {
+    // Always the read-modify-write: it orders the book update before the
+    // strategy's take of the word, a plain load of a set bit would not
+    uint32_t slot = book.subscribers()->slot;
+    uint64_t bit = 1ULL << (slot & 63);
+    uint64_t previous = dirty_[slot >> 6].fetch_or(bit, std::memory_order_release);
+    if (previous & bit) {
+        updates_conflated_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        events_queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TradingPipeline::publish_trade(const OrderBook& book, const TradePrint& trade) {
+    TradeEvent* event = trades_->back_slot();
+    if (__builtin_expect(event == nullptr, 0)) {
+        trades_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    event->book = &book;
+    event->trade = trade;
+    trades_->commit_back();
+    trades_queued_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t TradingPipeline::process_events(BookEvent* batch, uint64_t& max_delay) {
+    size_t count = events_->pop_batch(batch, EVENT_BATCH);
+    uint64_t now = Timestamp::now();
+    for (size_t i = 0; i < count; ++i) {
+        StrategyRouter::dispatch(*batch[i].book, batch[i].top);
+        uint64_t delay = now - batch[i].enqueue_tsc;
+        max_delay = delay > max_delay ? delay : max_delay;
+    }
+    if (count > 0) {
+        max_queue_delay_ns_.store(Timestamp::to_nanoseconds(max_delay), std::memory_order_relaxed);
+    }
+    return count;
+}
+
+size_t TradingPipeline::process_dirty_books() {
+    size_t count = 0;
+    for (size_t w = 0; w < dirty_words_; ++w) {
+        // Skip clean words without taking the line exclusive
+        if (dirty_[w].load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        uint64_t marked = dirty_[w].exchange(0, std::memory_order_acquire);
+        while (marked) {
+            uint32_t slot = static_cast<uint32_t>(w * 64 + bits::count_trailing_zeros(marked));
+            marked &= marked - 1;
+            StrategyRouter::dispatch(*router_.book(slot));      // Reads the newest top
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t TradingPipeline::process_trades() {
+    size_t count = 0;
+    while (TradeEvent* event = trades_->front()) {
+        StrategyRouter::dispatch_trade(*event->book, event->trade);
+        trades_->pop();
+        ++count;
+    }
+    if (count > 0) {
+        trades_processed_.fetch_add(count, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+void TradingPipeline::strategy_loop() {
+    pin_stage(options_.strategy_cpu, options_.realtime_priority, "strategy");
+
+    BookEvent batch[EVENT_BATCH];
+    uint64_t last_timer = Timestamp::now();
+    uint64_t max_delay = 0;
+    uint32_t idle_spins = 0;
+
+    for (;;) {
+        bool running = strategy_running_.load(std::memory_order_acquire);
+        uint64_t now = Timestamp::now();
+
+        // Book states first, then the prints that followed them
+        size_t books = conflate_ ? process_dirty_books() : process_events(batch, max_delay);
+        if (books > 0) {
+            events_processed_.fetch_add(books, std::memory_order_relaxed);
+        }
+        size_t count = books + process_trades();
+        if (count > 0) {
+            idle_spins = 0;
+        }
+
+        if (Timestamp::to_nanoseconds(now - last_timer) >= TIMER_INTERVAL_NS) {
+            order_manager_.process_execution_reports();
+            router_.on_timer();
+            last_timer = now;
+        }
+
+        // Drained after stop(): the feed no longer queues
+        if (count == 0) {
+            if (!running) {
+                break;
+            }
+            idle(idle_spins);
+        }
+    }
+}
+
+void TradingPipeline::sender_loop() {
+    pin_stage(options_.sender_cpu, options_.realtime_priority, "order sender");
+
+    OrderCommand batch[COMMAND_BATCH];
+    uint32_t idle_spins = 0;
+
+    for (;;) {
+        bool running = sender_running_.load(std::memory_order_acquire);
+        size_t count = commands_->pop_batch(batch, COMMAND_BATCH);
+        if (count == 0) {
+            if (!running) {
+                break;
+            }
+            idle(idle_spins);
+            continue;
+        }
+        idle_spins = 0;
+
+        // One write per batch
+        order_sender_.begin_batch();
+        uint64_t failures = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const OrderCommand& command = batch[i];
+            bool sent = false;
+            switch (command.kind) {
+                case OrderCommand::Kind::NEW:
+                    sent = order_sender_.send_order(command.order);
+                    break;
+                case OrderCommand::Kind::REPLACE:
+                    sent = order_sender_.send_replace(command.replace);
+                    break;
+                case OrderCommand::Kind::CANCEL:
+                    sent = order_sender_.send_cancel(command.cancel);
+                    break;
+            }
+            if (__builtin_expect(!sent, 0)) {
+                order_manager_.enqueue_send_failure(command);
+                ++failures;
+            }
+        }
+        order_sender_.flush();
+
+        commands_sent_.fetch_add(count - failures, std::memory_order_relaxed);
+        if (failures) {
+            send_failures_.fetch_add(failures, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TradingPipeline::idle(uint32_t& idle_spins) const {
+    if (options_.busy_poll || ++idle_spins < IDLE_SPINS) {
+        cpu_relax();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace hft
@@ -0,0 +1,202 @@
+#include "trading/risk_engine.h"
+#include "common/timestamp.h"
+#include "common/logger.h"
+#include <cstring>
+
+namespace hft {
+
+RiskEngine::RiskEngine(size_t max_symbols)
+    : max_symbols_(max_symbols)
+    , table_(new SymbolRisk[max_symbols])
+    , index_(max_symbols) {
+    set_limits(limits_);
+}
+
+void RiskEngine::apply_limits(SymbolRisk& risk, const Limits& limits) {
+    risk.max_order_lots = to_lots(limits.max_order_size);
+    risk.max_position_lots = to_lots(limits.max_position);
+    risk.max_notional = to_ticks(limits.max_notional);
+}
+
+void RiskEngine::set_limits(const Limits& limits) {
+    bool same_rate = token_cost_ != 0 && limits.max_orders_per_second == limits_.max_orders_per_second &&
+                     limits.max_order_burst == limits_.max_order_burst;
+    limits_ = limits;
+    for (size_t i = 0; i < symbols(); ++i) {
+        apply_limits(table_[i], limits);
+    }
+    if (!same_rate) {
+        set_order_rate(limits.max_orders_per_second, limits.max_order_burst);
+    }
+}
+
+void RiskEngine::set_order_rate(uint32_t max_orders_per_second, uint32_t max_order_burst) {
+    limits_.max_orders_per_second = max_orders_per_second;
+    limits_.max_order_burst = max_order_burst;
+
+    // Counter ticks per token; the bucket starts full
+    uint32_t rate = max_orders_per_second ? max_orders_per_second : 1;
+    uint32_t burst = max_order_burst ? max_order_burst : 1;
+    token_cost_ = static_cast<int64_t>(Timestamp::tsc_frequency() / rate);
+    bucket_capacity_ = token_cost_ * burst;
+    bucket_level_ = bucket_capacity_;
+    bucket_last_ = Timestamp::now();
+}
+
+bool RiskEngine::set_symbol_limits(const char* symbol, const Limits& limits) {
+    uint32_t index = symbol_index(symbol);
+    if (index == NO_SYMBOL) {
+        return false;
+    }
+    apply_limits(table_[index], limits);
+    return true;
+}
+
+uint32_t RiskEngine::symbol_index(const char* symbol) {
+    uint32_t index = index_.find(symbol);
+    if (index != NO_SYMBOL) {
+        return index;
+    }
+    size_t count = symbol_count_.load(std::memory_order_relaxed);
+    index = index_.intern(symbol);
+    if (index == NO_SYMBOL) {
+        LOG_ERROR("Risk table full ({} symbols) or bad symbol, '{}' not tracked", max_symbols_, symbol);
+        return NO_SYMBOL;
+    }
+
+    // IDs are dense: a new one is the next table entry
+    SymbolRisk& risk = table_[index];
+    apply_limits(risk, limits_);
+    risk.position.store(0, std::memory_order_relaxed);
+    risk.notional.store(0, std::memory_order_relaxed);
+    risk.open_buy.store(0, std::memory_order_relaxed);
+    risk.open_sell.store(0, std::memory_order_relaxed);
+    risk.open_notional.store(0, std::memory_order_relaxed);
+    symbol_count_.store(count + 1, std::memory_order_release);
+    return index;
+}
+
+uint32_t RiskEngine::lookup_order_symbol(const char* symbol, const uint64_t key[2]) {
+    uint32_t index = symbol_index(symbol);
+    if (index != NO_SYMBOL) {
+        last_key_[0] = key[0];
+        last_key_[1] = key[1];
+        last_index_ = index;
+    }
+    return index;
+}
+
+uint32_t RiskEngine::check(uint32_t symbol, Order::Side side, int64_t order_lots, int64_t added_lots,
+                           int64_t added_notional, uint64_t now_tsc) {
+    const SymbolRisk& risk = table_[symbol];
+    bool buy = side == Order::Side::BUY;
+
+    // Worst case: every open order on this side fills
+    int64_t open_same = buy ? risk.open_buy.load(std::memory_order_relaxed)
+                            : risk.open_sell.load(std::memory_order_relaxed);
+    int64_t sign = buy ? 1 : -1;
+    int64_t worst = risk.position.load(std::memory_order_relaxed) + sign * (open_same + added_lots);
+    int64_t worst_abs = worst < 0 ? -worst : worst;
+
+    // Filled exposure plus everything still open
+    int64_t filled = risk.notional.load(std::memory_order_relaxed);
+    int64_t exposure = (filled < 0 ? -filled : filled) +
+                       risk.open_notional.load(std::memory_order_relaxed) + added_notional;
+
+    // Refill by the elapsed counter ticks, capped at the burst
+    uint64_t elapsed = now_tsc - bucket_last_;
+    uint64_t room = static_cast<uint64_t>(bucket_capacity_ - bucket_level_);
+    int64_t level = bucket_level_ + static_cast<int64_t>(elapsed < room ? elapsed : room);
+
+    uint32_t reject = (static_cast<uint32_t>((order_lots <= 0) | (order_lots > risk.max_order_lots)) * ORDER_SIZE) |
+                      (static_cast<uint32_t>(worst_abs > risk.max_position_lots) * POSITION) |
+                      (static_cast<uint32_t>(exposure > risk.max_notional) * NOTIONAL) |
+                      (static_cast<uint32_t>(level < token_cost_) * RATE);
+
+    // Take the token only if everything passed
+    bucket_level_ = level - (token_cost_ & -static_cast<int64_t>(reject == 0));
+    bucket_last_ = now_tsc;
+    return reject;
+}
+
+void RiskEngine::refund_token() {
+    int64_t level = bucket_level_ + token_cost_;
+    bucket_level_ = level < bucket_capacity_ ? level : bucket_capacity_;
+}
+
+void RiskEngine::adjust_open(uint32_t symbol, Order::Side side, int64_t lots, int64_t price_ticks,
+                             int64_t sign) {
+    SymbolRisk& risk = table_[symbol];
+    auto& open = side == Order::Side::BUY ? risk.open_buy : risk.open_sell;
+    open.store(open.load(std::memory_order_relaxed) + sign * lots, std::memory_order_relaxed);
+    risk.open_notional.store(risk.open_notional.load(std::memory_order_relaxed) + sign * lots * price_ticks,
+                             std::memory_order_relaxed);
+}
+
+void RiskEngine::apply_fill(uint32_t symbol, Order::Side side, int64_t lots, int64_t price_ticks) {
+    SymbolRisk& risk = table_[symbol];
+    int64_t signed_lots = side == Order::Side::BUY ? lots : -lots;
+    risk.position.store(risk.position.load(std::memory_order_relaxed) + signed_lots,
+                        std::memory_order_relaxed);
+    risk.notional.store(risk.notional.load(std::memory_order_relaxed) + signed_lots * price_ticks,
+                        std::memory_order_relaxed);
+}
+
+const char* RiskEngine::reject_reason(uint32_t reject) {
+    if (reject & ORDER_SIZE) return "order size";
+    if (reject & POSITION) return "position";
+    if (reject & NOTIONAL) return "notional";
+    if (reject & RATE) return "order rate";
+    return "none";
+}
+
+double RiskEngine::position(uint32_t symbol) const {
+    return static_cast<double>(table_[symbol].position.load(std::memory_order_relaxed));
+}
+
+double RiskEngine::notional(uint32_t symbol) const {
+    return static_cast<double>(table_[symbol].notional.load(std::memory_order_relaxed)) / PRICE_SCALE;
+}
+
+double RiskEngine::open_buy_quantity(uint32_t symbol) const {
+    return static_cast<double>(table_[symbol].open_buy.load(std::memory_order_relaxed));
+}
+
+double RiskEngine::open_sell_quantity(uint32_t symbol) const {
+    return static_cast<double>(table_[symbol].open_sell.load(std::memory_order_relaxed));
+}
+
+double RiskEngine::open_notional(uint32_t symbol) const {
+    return static_cast<double>(table_[symbol].open_notional.load(std::memory_order_relaxed)) / PRICE_SCALE;
+}
+
+int64_t RiskEngine::total(std::atomic<int64_t> SymbolRisk::*field) const {
+    int64_t sum = 0;
+    size_t count = symbols();
+    for (size_t i = 0; i < count; ++i) {
+        sum += (table_[i].*field).load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+double RiskEngine::total_position() const {
+    return static_cast<double>(total(&SymbolRisk::position));
+}
+
+double RiskEngine::total_notional() const {
+    return static_cast<double>(total(&SymbolRisk::notional)) / PRICE_SCALE;
+}
+
+double RiskEngine::total_open_buy_quantity() const {
+    return static_cast<double>(total(&SymbolRisk::open_buy));
+}
+
+double RiskEngine::total_open_sell_quantity() const {
+    return static_cast<double>(total(&SymbolRisk::open_sell));
+}
+
+double RiskEngine::total_open_notional() const {
+    return static_cast<double>(total(&SymbolRisk::open_notional)) / PRICE_SCALE;
+}
+
+} // namespace hft
@@ -0,0 +1,273 @@
+#include "trading/sharded_feed.h"
+#include "common/hashmap.h"
+#include "common/huge_pages.h"
+#include "common/logger.h"
+#include "common/realtime.h"
+#include "common/timestamp.h"
+#include <algorithm>
+#include <sstream>
+
+namespace hft {
+
+namespace {
+
+constexpr uint64_t TIMER_INTERVAL_NS = 1000000;     // Strategy on_timer()
+constexpr uint32_t IDLE_SPINS = 4096;               // Before yielding
+
+} // namespace
+
+size_t FeedPartition::shard_of(const std::string& symbol) const {
+    auto it = placed.find(symbol);
+    if (it != placed.end()) {
+        return it->second;
+    }
+    return shards.empty() ? 0 : detail::fnv1a(symbol.data(), symbol.size()) % shards.size();
+}
+
+FeedPartition feed_partition(const Config& config) {
+    FeedPartition partition;
+    size_t count = std::max<size_t>(config.feed_shards, 1);
+    partition.shards.resize(count);
+
+    // Every configured group, for shards that list none
+    std::vector<std::pair<std::string, uint16_t>> all_channels;
+    all_channels.emplace_back(config.market_data_multicast_ip, config.market_data_port);
+    all_channels.insert(all_channels.end(), config.market_data_channels.begin(),
+                        config.market_data_channels.end());
+
+    for (size_t i = 0; i < count; ++i) {
+        FeedPartition::Shard& shard = partition.shards[i];
+        std::string prefix = "feed_shard." + std::to_string(i) + ".";
+        shard.cpu = config.has(prefix + "cpu") ? config.get<int>(prefix + "cpu")
+                                               : config.market_data_cpu + static_cast<int>(i);
+        if (config.has(prefix + "channels")) {
+            shard.channels = Config::parse_channels(config.get<std::string>(prefix + "channels"));
+        }
+        if (shard.channels.empty()) {
+            shard.channels = all_channels;
+        }
+        if (config.has(prefix + "symbols")) {
+            std::stringstream list(config.get<std::string>(prefix + "symbols"));
+            std::string symbol;
+            while (std::getline(list, symbol, ',')) {
+                if (symbol.empty()) {
+                    continue;
+                }
+                auto [it, inserted] = partition.placed.emplace(symbol, i);
+                if (!inserted) {
+                    LOG_WARN("Feed shards: {} placed on shards {} and {}, keeping {}",
+                             symbol, it->second, i, it->second);
+                    continue;
+                }
+                shard.symbols.push_back(symbol);
+            }
+        }
+    }
+    return partition;
+}
+
+ShardedFeed::Shard::Shard(size_t max_symbols, int numa_node)
+    : handler(max_symbols, numa_node)
+    , router(handler)
+    , events(std::make_unique<CircularBuffer<BookEvent, EVENT_QUEUE_SIZE>>())
+    , trades(std::make_unique<CircularBuffer<TradeEvent, TRADE_QUEUE_SIZE>>()) {
+}
+
+ShardedFeed::ShardedFeed(FeedPartition partition, OrderManager& order_manager, const Options& options)
+    : partition_(std::move(partition))
+    , order_manager_(order_manager)
+    , options_(options) {
+    if (partition_.shards.empty()) {
+        partition_.shards.resize(1);
+    }
+    for (const FeedPartition::Shard& shard : partition_.shards) {
+        // Books and pools next to the shard's receiver core
+        shards_.push_back(std::make_unique<Shard>(options_.max_symbols,
+                                                  HugePageBuffer::numa_node_of_cpu(shard.cpu)));
+    }
+    for (size_t i = 0; i < partition_.shards.size(); ++i) {
+        for (const std::string& symbol : partition_.shards[i].symbols) {
+            shards_[i]->handler.add_symbol(symbol);
+        }
+    }
+}
+
+ShardedFeed::~ShardedFeed() {
+    stop();
+}
+
+size_t ShardedFeed::add_symbol(const std::string& symbol) {
+    size_t shard = shard_of(symbol);
+    shards_[shard]->handler.add_symbol(symbol);
+    return shard;
+}
+
+bool ShardedFeed::subscribe(const std::string& symbol, StrategyRef strategy) {
+    size_t shard = add_symbol(symbol);
+    if (!shards_[shard]->router.subscribe(symbol, strategy)) {
+        return false;
+    }
+    if (std::find(strategies_.begin(), strategies_.end(), strategy) == strategies_.end()) {
+        strategies_.push_back(strategy);
+    }
+    return true;
+}
+
+void ShardedFeed::set_feed_protocol(FeedProtocol protocol) {
+    for (auto& shard : shards_) {
+        shard->handler.set_feed_protocol(protocol);
+    }
+}
+
+void ShardedFeed::set_book_depth(size_t levels) {
+    for (auto& shard : shards_) {
+        shard->handler.set_book_depth(levels);
+    }
+}
+
+void ShardedFeed::start() {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    strategy_running_.store(true, std::memory_order_release);
+    strategy_thread_ = std::thread(&ShardedFeed::strategy_loop, this);
+    for (auto& shard : shards_) {
+        shard->handler.set_book_listener(&ShardedFeed::on_book_update, shard.get());
+        shard->handler.set_trade_listener(&ShardedFeed::on_trade, shard.get());
+    }
+    LOG_INFO("Sharded feed started: {} shards, {} strategies", shards_.size(), strategies_.size());
+}
+
+void ShardedFeed::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    for (auto& shard : shards_) {
+        shard->router.attach();
+    }
+    strategy_running_.store(false, std::memory_order_release);
+    strategy_thread_.join();
+
+    LOG_INFO("Sharded feed stopped: {} book evaluations ({} dropped), {} trades ({} dropped)",
+             events_processed(), events_dropped(), trades_processed(), trades_dropped());
+}
+
+void ShardedFeed::on_book_update(void* context, const OrderBook& book) {
+    Shard& shard = *static_cast<Shard*>(context);
+    BookEvent* event = shard.events->back_slot();
+    if (__builtin_expect(event == nullptr, 0)) {
+        shard.events_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    event->book = &book;
+    event->top = book.get_top();
+    event->enqueue_tsc = Timestamp::now();
+    shard.events->commit_back();
+    shard.events_queued.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ShardedFeed::on_trade(void* context, const OrderBook& book, const TradePrint& trade) {
+    Shard& shard = *static_cast<Shard*>(context);
+    TradeEvent* event = shard.trades->back_slot();
+    if (__builtin_expect(event == nullptr, 0)) {
+        shard.trades_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    event->book = &book;
+    event->trade = trade;
+    shard.trades->commit_back();
+    shard.trades_queued.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t ShardedFeed::process(Shard& shard, BookEvent* batch) {
+    // Book states first, then the prints that followed them
+    size_t books = shard.events->pop_batch(batch, EVENT_BATCH);
+    for (size_t i = 0; i < books; ++i) {
+        StrategyRouter::dispatch(*batch[i].book, batch[i].top);
+    }
+    if (books > 0) {
+        shard.events_processed.fetch_add(books, std::memory_order_relaxed);
+    }
+
+    size_t trades = 0;
+    while (TradeEvent* event = shard.trades->front()) {
+        StrategyRouter::dispatch_trade(*event->book, event->trade);
+        shard.trades->pop();
+        ++trades;
+    }
+    if (trades > 0) {
+        shard.trades_processed.fetch_add(trades, std::memory_order_relaxed);
+    }
+    return books + trades;
+}
+
+void ShardedFeed::strategy_loop() {
+    if (options_.strategy_cpu >= 0) {
+        if (realtime::pin_thread(options_.strategy_cpu)) {
+            LOG_INFO("Sharded feed strategy thread pinned to CPU {}", options_.strategy_cpu);
+        } else {
+            LOG_WARN("Sharded feed strategy thread: pinning to CPU {} failed", options_.strategy_cpu);
+        }
+    }
+    if (options_.realtime_priority > 0 && !realtime::set_thread_priority(options_.realtime_priority)) {
+        LOG_WARN("Sharded feed strategy thread: SCHED_FIFO {} refused", options_.realtime_priority);
+    }
+
+    BookEvent batch[EVENT_BATCH];
+    uint64_t last_timer = Timestamp::now();
+    uint32_t idle_spins = 0;
+
+    for (;;) {
+        bool running = strategy_running_.load(std::memory_order_acquire);
+        uint64_t now = Timestamp::now();
+
+        // One batch per shard per pass: a busy shard cannot starve the others
+        size_t count = 0;
+        for (auto& shard : shards_) {
+            count += process(*shard, batch);
+        }
+        if (count > 0) {
+            idle_spins = 0;
+        }
+
+        if (Timestamp::to_nanoseconds(now - last_timer) >= TIMER_INTERVAL_NS) {
+            order_manager_.process_execution_reports();
+            // Once per strategy, however many shards it is subscribed in
+            for (const StrategyRef& strategy : strategies_) {
+                std::visit([](auto* s) { s->on_timer(); }, strategy);
+            }
+            last_timer = now;
+        }
+
+        // Drained after stop(): the feeds no longer queue
+        if (count == 0) {
+            if (!running) {
+                break;
+            }
+            if (options_.busy_poll || ++idle_spins < IDLE_SPINS) {
+                cpu_relax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+uint64_t ShardedFeed::total(std::atomic<uint64_t> Shard::*counter) const {
+    uint64_t sum = 0;
+    for (const auto& shard : shards_) {
+        sum += ((*shard).*counter).load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+uint64_t ShardedFeed::events_queued() const { return total(&Shard::events_queued); }
+uint64_t ShardedFeed::events_dropped() const { return total(&Shard::events_dropped); }
+uint64_t ShardedFeed::events_processed() const { return total(&Shard::events_processed); }
+uint64_t ShardedFeed::trades_queued() const { return total(&Shard::trades_queued); }
+uint64_t ShardedFeed::trades_dropped() const { return total(&Shard::trades_dropped); }
+uint64_t ShardedFeed::trades_processed() const { return total(&Shard::trades_processed); }
+
+} // namespace hft
@@ -1,49 +1,132 @@
 #include "trading/strategy.h"
 #include "common/timestamp.h"
 #include "common/logger.h"
+#include "common/bit_utils.h"
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 
 namespace hft {
 
+namespace {
+
+// Price onto the venue's grid on the passive side: buys round down, sells
+// up; the tolerance keeps a price already on the grid where it is
+int64_t passive_ticks(double price, double ticks_per_unit, bool buy) {
+    return static_cast<int64_t>(buy ? std::floor(price * ticks_per_unit + 1e-6)
+                                    : std::ceil(price * ticks_per_unit - 1e-6));
+}
+
+} // namespace
+
 // ============================================================================
 // Market Making Strategy Implementation
 // ============================================================================
 
-MarketMakingStrategy::MarketMakingStrategy(TCPSender& order_sender, 
+MarketMakingStrategy::MarketMakingStrategy(OrderManager& order_manager, 
                                            const Parameters& params)
-    : order_sender_(order_sender)
-    , params_(params) {
+    : order_manager_(order_manager)
+    , symbol_(params.symbol)
+    , risk_symbol_(order_manager.symbol_index(params.symbol.c_str()))
+    , parameters_(params)
+    , parameters_reader_(parameters_.add_reader())
+    , params_(nullptr) {
+    // Static order fields are set once; each quote patches the rest
+    for (Order* order : {&bid_template_, &ask_template_}) {
+        std::memset(order, 0, sizeof(*order));
+        std::strncpy(order->symbol, symbol_.c_str(), sizeof(order->symbol) - 1);
+        order->type = Order::Type::LIMIT;
+    }
+    bid_template_.side = Order::Side::BUY;
+    ask_template_.side = Order::Side::SELL;
+    apply_parameters(parameters_.read(parameters_reader_));
+}
+
+bool MarketMakingStrategy::update_parameters(const Parameters& params) {
+    if (params.symbol != symbol_) {
+        LOG_ERROR("Parameters for '{}' not applied to the {} strategy", params.symbol, symbol_);
+        return false;
+    }
+    parameters_.publish(params);
+    return true;
 }
 
-void MarketMakingStrategy::on_order_book_update(const OrderBook& book) {
-    // Get snapshot of order book
-    auto snapshot = book.get_snapshot();
+void MarketMakingStrategy::apply_parameters(const Parameters* params) {
+    // New grid: the cached ticks and lots no longer compare with the
+    // targets, so each side is amended once onto the new one
+    if (params_ && (params->tick_size != params_->tick_size || params->lot_size != params_->lot_size)) {
+        bid_quote_.stale = true;
+        ask_quote_.stale = true;
+    }
+    params_ = params;
+    
+    // Requote on the next tick instead of waiting out the pacing interval
+    last_quote_time_.store(0, std::memory_order_relaxed);
+}
+
+void MarketMakingStrategy::on_top_of_book(const OrderBook& book, const OrderBook::Top& top) {
+    // Quotes only depend on the touch: no full snapshot copy
+    (void)book;
+    
+    // Newest parameters: one acquire load unless a reload was published
+    const Parameters* params = parameters_.read(parameters_reader_);
+    if (__builtin_expect(params != params_, 0)) {
+        apply_parameters(params);
+    }
+    
+    // Filled position marked to the mid, against what it cost
+    if (top.bid_depth > 0 && top.ask_depth > 0) {
+        pnl_.store(get_position() * top.mid_price() - order_manager_.get_notional(risk_symbol_),
+                   std::memory_order_relaxed);
+    }
+    
+    // Quote pacing runs on the feed's clock (the packet receive time), so a
+    // replayed session quotes the way the live one did at any replay speed
+    uint64_t now = Timestamp::now();
+    uint64_t tick_ns = top.rx_timestamp_ns ? top.rx_timestamp_ns : Timestamp::fast_wall_clock_ns();
     
     // Check if we should update our quotes
-    if (should_requote(snapshot)) {
-        update_quotes(snapshot);
+    if (should_requote(top, tick_ns)) {
+        update_quotes(top, now, tick_ns);
     }
 }
 
+void MarketMakingStrategy::on_trade(const OrderBook& book, const TradePrint& trade) {
+    // Quotes follow the book; prints are only tracked for now
+    (void)book;
+    last_trade_price_.store(trade.price, std::memory_order_relaxed);
+    trades_seen_.store(trades_seen_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
 void MarketMakingStrategy::on_timer() {
     // Periodic tasks (risk checks, position rebalancing, etc.)
     // For now, just a placeholder
 }
 
-bool MarketMakingStrategy::should_requote(const OrderBook::Snapshot& snapshot) {
+void MarketMakingStrategy::reset() {
+    bid_quote_ = Quote{};
+    ask_quote_ = Quote{};
+    pnl_.store(0.0, std::memory_order_relaxed);
+    last_quote_time_.store(0, std::memory_order_relaxed);
+    last_wire_to_order_ns_.store(0, std::memory_order_relaxed);
+    last_trade_price_.store(0.0, std::memory_order_relaxed);
+    trades_seen_.store(0, std::memory_order_relaxed);
+    quotes_sent_.store(0, std::memory_order_relaxed);
+    quotes_unchanged_.store(0, std::memory_order_relaxed);
+}
+
+bool MarketMakingStrategy::should_requote(const OrderBook::Top& top, uint64_t tick_ns) {
     // Don't quote if spread is too wide (might indicate illiquid market)
-    if (snapshot.spread_bps() > 10.0) {
+    if (top.spread_bps() > 10.0) {
         return false;
     }
     
     // Rate limiting: don't quote too frequently
-    uint64_t now = Timestamp::now();
     uint64_t last_quote = last_quote_time_.load(std::memory_order_relaxed);
     
     // Minimum 100 microseconds between quotes
     constexpr uint64_t MIN_QUOTE_INTERVAL_NS = 100000;
-    if (Timestamp::to_nanoseconds(now - last_quote) < MIN_QUOTE_INTERVAL_NS) {
+    if (tick_ns - last_quote < MIN_QUOTE_INTERVAL_NS) {
         return false;
     }
     
@@ -54,20 +137,22 @@ double MarketMakingStrategy::calculate_fair_value(double mid, double position) c
     // Adjust fair value based on inventory
     // If we're long, shade our fair value down to encourage selling
     // If we're short, shade it up to encourage buying
-    double skew = -position / params_.max_position * params_.skew_factor;
+    double skew = -position / params_->max_position * params_->skew_factor;
     return mid * (1.0 + skew);
 }
 
-void MarketMakingStrategy::update_quotes(const OrderBook::Snapshot& snapshot) {
-    double mid = snapshot.mid_price();
+void MarketMakingStrategy::update_quotes(const OrderBook::Top& top, uint64_t now, uint64_t tick_ns) {
+    double mid = top.mid_price();
     if (mid <= 0) {
         return;
     }
     
-    double position = position_.load(std::memory_order_relaxed);
+    // Fills and acks since the last tick
+    order_manager_.process_execution_reports();
+    double position = get_position();
     
     // Check position limits
-    if (std::abs(position) >= params_.max_position) {
+    if (std::abs(position) >= params_->max_position) {
         // Hit position limit - don't quote in the direction that increases position
         return;
     }
@@ -76,69 +161,238 @@ void MarketMakingStrategy::update_quotes(const OrderBook::Snapshot& snapshot) {
     double fair_value = calculate_fair_value(mid, position);
     
     // Calculate bid/ask prices with target spread
-    double half_spread = fair_value * params_.spread_target / 2.0;
-    double bid_price = fair_value - half_spread - params_.edge * fair_value;
-    double ask_price = fair_value + half_spread + params_.edge * fair_value;
-    
-    // Create orders
-    Order bid_order;
-    std::memset(&bid_order, 0, sizeof(bid_order));
-    std::strncpy(bid_order.symbol, snapshot.bids[0].price > 0 ? "SYMBOL" : "SYMBOL", 
-                 sizeof(bid_order.symbol) - 1);
-    bid_order.order_id = generate_order_id();
-    bid_order.side = Order::Side::BUY;
-    bid_order.type = Order::Type::LIMIT;
-    bid_order.price = bid_price;
-    bid_order.quantity = params_.quote_size;
-    bid_order.timestamp = Timestamp::now();
-    
-    Order ask_order;
-    std::memset(&ask_order, 0, sizeof(ask_order));
-    std::strncpy(ask_order.symbol, "SYMBOL", sizeof(ask_order.symbol) - 1);
-    ask_order.order_id = generate_order_id();
-    ask_order.side = Order::Side::SELL;
-    ask_order.type = Order::Type::LIMIT;
-    ask_order.price = ask_price;
-    ask_order.quantity = params_.quote_size;
-    ask_order.timestamp = Timestamp::now();
+    double half_spread = fair_value * params_->spread_target / 2.0;
+    double bid_price = fair_value - half_spread - params_->edge * fair_value;
+    double ask_price = fair_value + half_spread + params_->edge * fair_value;
+    
+    // Onto the venue's grid: bids down, asks up, so rounding never
+    // narrows the spread
+    double ticks_per_unit = 1.0 / params_->tick_size;
+    int64_t bid_ticks = passive_ticks(bid_price, ticks_per_unit, true);
+    int64_t ask_ticks = passive_ticks(ask_price, ticks_per_unit, false);
+    int64_t size_lots = static_cast<int64_t>(params_->quote_size / params_->lot_size + 1e-6);
+    
+    // Orders carry the feed time of the data they react to
+    uint64_t rx_timestamp_ns = top.rx_timestamp_ns;
+    bid_template_.timestamp = tick_ns;
+    ask_template_.timestamp = tick_ns;
     
     // Send orders (this is the critical path!)
-    LatencyMeasure latency;
+    // Both sides leave in one write; unchanged sides send nothing
+    order_manager_.begin_batch();
     
-    if (position < params_.max_position * 0.8) {
-        order_sender_.send_order(bid_order);
+    bool sent = false;
+    if (position < params_->max_position * 0.8) {
+        sent |= quote_side(bid_quote_, bid_template_, bid_ticks, size_lots);
     }
     
-    if (position > -params_.max_position * 0.8) {
-        order_sender_.send_order(ask_order);
+    if (position > -params_->max_position * 0.8) {
+        sent |= quote_side(ask_quote_, ask_template_, ask_ticks, size_lots);
     }
     
-    // Update timestamp
-    last_quote_time_.store(Timestamp::now(), std::memory_order_relaxed);
+    order_manager_.flush();
+    if (!sent) {
+        return;
+    }
+    
+    // Update timestamp (the tick's feed time): pacing counts from the last
+    // quote that went out
+    last_quote_time_.store(tick_ns, std::memory_order_relaxed);
+    
+    // Wire to order: includes NIC, kernel and feed thread time
+    if (rx_timestamp_ns) {
+        last_wire_to_order_ns_.store(Timestamp::fast_wall_clock_ns() - rx_timestamp_ns,
+                                     std::memory_order_relaxed);
+    }
     
     // Log latency (for monitoring)
-    uint64_t order_latency_ns = latency.elapsed_ns();
+    uint64_t order_latency_ns = Timestamp::to_nanoseconds(Timestamp::now() - now);
     if (order_latency_ns > 10000) { // More than 10 microseconds
-        LOG_WARN("High order latency detected");
+        LOG_WARN("High order latency detected: {} ns", order_latency_ns);
     }
 }
 
+bool MarketMakingStrategy::quote_side(Quote& quote, Order& order, int64_t price_ticks, int64_t size_lots) {
+    // Find the resting quote: under the new ID once a replace is taken,
+    // under the old one if the venue refused it
+    const OrderManager::OrderInfo* resting = quote.order_id ? order_manager_.find_order(quote.order_id) : nullptr;
+    if (!resting && quote.previous_id) {
+        resting = order_manager_.find_order(quote.previous_id);
+        if (resting) {
+            // Still at the price and size before the amend
+            quote.order_id = quote.previous_id;
+            quote.price_ticks = std::llround(resting->price / params_->tick_size);
+            quote.size_lots = std::llround(resting->quantity / params_->lot_size);
+        }
+    }
+    quote.previous_id = 0;
+    
+    // Per-quote fields patched into the prebuilt order
+    auto patch = [this, &order, price_ticks, size_lots]() {
+        order.order_id = generate_order_id();
+        order.price = static_cast<double>(price_ticks) * params_->tick_size;
+        order.quantity = static_cast<double>(size_lots) * params_->lot_size;
+    };
+    
+    // None (filled, canceled or never placed): place a new one
+    if (!resting) {
+        quote.order_id = 0;
+        patch();
+        if (!order_manager_.submit_order(order)) {
+            return false;
+        }
+        quote.order_id = order.order_id;
+        quote.price_ticks = price_ticks;
+        quote.size_lots = size_lots;
+        quote.stale = false;
+        quotes_sent_.store(quotes_sent_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    // Previous amend or cancel still in flight: leave this side alone
+    if (resting->state != OrderManager::OrderState::LIVE &&
+        resting->state != OrderManager::OrderState::PARTIALLY_FILLED) {
+        if (resting->state == OrderManager::OrderState::PENDING_REPLACE) {
+            quote.previous_id = resting->order_id;
+            quote.order_id = resting->replace_id;
+        }
+        return false;
+    }
+    
+    // Same quote on the grid (within the thresholds): nothing to send
+    if (!quote.stale &&
+        std::abs(price_ticks - quote.price_ticks) < static_cast<int64_t>(params_->requote_ticks) &&
+        std::abs(size_lots - quote.size_lots) < static_cast<int64_t>(params_->requote_lots)) {
+        quotes_unchanged_.store(quotes_unchanged_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    patch();
+    if (!order_manager_.replace_order(resting->order_id, order.order_id, order.price,
+                                      order.quantity, order.timestamp)) {
+        return false;
+    }
+    quote.previous_id = resting->order_id;
+    quote.order_id = order.order_id;
+    quote.price_ticks = price_ticks;
+    quote.size_lots = size_lots;
+    quote.stale = false;
+    quotes_sent_.store(quotes_sent_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
 // ============================================================================
-// Arbitrage Strategy Implementation (placeholder)
+// Arbitrage Strategy Implementation
 // ============================================================================
 
-ArbitrageStrategy::ArbitrageStrategy(TCPSender& order_sender)
-    : order_sender_(order_sender) {
+ArbitrageStrategy::ArbitrageStrategy(OrderManager& order_manager, const Parameters& params)
+    : order_manager_(order_manager)
+    , params_(params)
+    , engine_(params.max_instruments, params.recompute_interval) {
 }
 
-void ArbitrageStrategy::on_order_book_update(const OrderBook& book) {
-    // Would implement arbitrage logic here
-    // Example: ETF vs constituent stocks, futures vs spot, etc.
-    (void)book; // Suppress unused warning
+void ArbitrageStrategy::finalize() {
+    engine_.finalize();
+    
+    orders_.resize(engine_.baskets());
+    for (uint32_t b = 0; b < engine_.baskets(); ++b) {
+        Order& order = orders_[b];
+        std::memset(&order, 0, sizeof(order));
+        const char* symbol = engine_.instrument_symbol(engine_.basket_instrument(b));
+        std::strncpy(order.symbol, symbol, sizeof(order.symbol) - 1);
+        order.type = Order::Type::IOC;
+        order.quantity = params_.order_size;
+        order_manager_.symbol_index(symbol);     // Risk entry up front
+    }
+    // Room for every instrument's book at half load
+    instrument_of_book_.assign(bits::next_power_of_2(std::max<size_t>(engine_.instruments(), 8) * 2),
+                               Resolved{nullptr, FairValueEngine::NO_INDEX});
+    books_resolved_ = 0;
+    finalized_ = true;
+}
+
+uint32_t ArbitrageStrategy::resolve(const OrderBook& book) {
+    if (book.symbol_id() == UINT32_MAX) {
+        return engine_.instrument(book.symbol().c_str()); // Book outside a handler
+    }
+    size_t mask = instrument_of_book_.size() - 1;
+    uint64_t address = reinterpret_cast<uintptr_t>(&book) >> 6;
+    size_t i = static_cast<size_t>((address * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while (instrument_of_book_[i].book != &book) {
+        if (__builtin_expect(instrument_of_book_[i].book == nullptr, 0)) {
+            uint32_t instrument = engine_.instrument(book.symbol().c_str());
+            // Past half load (books outside the engine) looked up by name
+            if (books_resolved_ * 2 < instrument_of_book_.size()) {
+                instrument_of_book_[i] = Resolved{&book, instrument};
+                ++books_resolved_;
+            }
+            return instrument;
+        }
+        i = (i + 1) & mask;
+    }
+    return instrument_of_book_[i].instrument;
+}
+
+void ArbitrageStrategy::on_top_of_book(const OrderBook& book, const OrderBook::Top& top) {
+    if (!finalized_ || top.bid_depth == 0 || top.ask_depth == 0) {
+        return;
+    }
+    uint32_t instrument = resolve(book);
+    if (instrument == FairValueEngine::NO_INDEX) {
+        return;
+    }
+    
+    // Only the baskets holding this instrument are touched
+    FairValueEngine::Signal signals[MAX_SIGNALS];
+    size_t count = engine_.on_price(instrument, top.mid_price(), signals, MAX_SIGNALS);
+    if (__builtin_expect(count == 0, 1)) {
+        return;
+    }
+    
+    uint64_t tick_ns = top.rx_timestamp_ns ? top.rx_timestamp_ns : Timestamp::fast_wall_clock_ns();
+    order_manager_.process_execution_reports();
+    order_manager_.begin_batch();
+    for (size_t i = 0; i < count; ++i) {
+        on_signal(signals[i], tick_ns);
+    }
+    order_manager_.flush();
+}
+
+void ArbitrageStrategy::on_signal(const FairValueEngine::Signal& signal, uint64_t tick_ns) {
+    signals_.store(signals_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (signal.side == 0) {
+        return; // Back inside the threshold: the IOCs left nothing resting
+    }
+    
+    Order& order = orders_[signal.basket];
+    order.order_id = order_manager_.next_order_id();
+    bool buy = signal.side < 0;
+    order.side = buy ? Order::Side::BUY : Order::Side::SELL;
+    // Halfway, then onto the grid away from the market
+    double limit = (signal.market_price + signal.fair_value) / 2.0;
+    order.price = static_cast<double>(passive_ticks(limit, 1.0 / params_.tick_size, buy)) * params_.tick_size;
+    order.timestamp = tick_ns;
+    if (order_manager_.submit_order(order)) {
+        orders_sent_.store(orders_sent_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void ArbitrageStrategy::on_trade(const OrderBook& book, const TradePrint& trade) {
+    (void)book;
+    (void)trade;
 }
 
 void ArbitrageStrategy::on_timer() {
-    // Periodic checks
+    // Drift correction of every basket, off the tick path
+    if (finalized_) {
+        engine_.recompute();
+    }
+}
+
+void ArbitrageStrategy::reset() {
+    engine_.reset_prices();
+    signals_.store(0, std::memory_order_relaxed);
+    orders_sent_.store(0, std::memory_order_relaxed);
 }
 
 } // namespace hft
@@ -0,0 +1,60 @@
+#include "trading/strategy_router.h"
+#include "common/logger.h"
+#include <algorithm>
+
+namespace hft {
+
+StrategyRouter::StrategyRouter(MarketDataHandler& handler)
+    : handler_(handler) {
+    attach();
+}
+
+StrategyRouter::~StrategyRouter() {
+    // Books outlive the router: detach the subscriber lists
+    for (const auto& route : books_) {
+        route.book->set_subscribers(nullptr);
+    }
+    handler_.set_book_listener(nullptr, nullptr);
+    handler_.set_trade_listener(nullptr, nullptr);
+}
+
+bool StrategyRouter::subscribe(const std::string& symbol, StrategyRef strategy) {
+    OrderBook* book = handler_.get_order_book(symbol);
+    if (!book) {
+        LOG_ERROR("Cannot route {}: symbol not tracked by the market data handler", symbol.c_str());
+        return false;
+    }
+
+    BookSubscribers* subscribers = book->subscribers();
+    if (!subscribers) {
+        books_.push_back({book, std::make_unique<BookSubscribers>()});
+        subscribers = books_.back().subscribers.get();
+        subscribers->slot = static_cast<uint32_t>(books_.size() - 1);
+        book->set_subscribers(subscribers);
+    }
+    if (subscribers->count >= BookSubscribers::MAX_STRATEGIES) {
+        LOG_ERROR("Cannot route {}: {} strategies already subscribed", symbol.c_str(),
+                  subscribers->count);
+        return false;
+    }
+    subscribers->strategies[subscribers->count++] = strategy;
+
+    if (std::find(strategies_.begin(), strategies_.end(), strategy) == strategies_.end()) {
+        strategies_.push_back(strategy);
+    }
+    return true;
+}
+
+void StrategyRouter::on_timer() {
+    for (const StrategyRef& strategy : strategies_) {
+        std::visit([](auto* s) { s->on_timer(); }, strategy);
+    }
+}
+
+void StrategyRouter::reset() {
+    for (const StrategyRef& strategy : strategies_) {
+        std::visit([](auto* s) { s->reset(); }, strategy);
+    }
+}
+
+} // namespace hft
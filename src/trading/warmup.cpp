@@ -0,0 +1,323 @@
+#include "trading/warmup.h"
+#include "market_data/itch_decoder.h"
+#include "common/logger.h"
+#include "common/realtime.h"
+#include "common/timestamp.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hft {
+
+namespace {
+
+// Synthetic packets this far apart on the feed clock: at least the market
+// maker's minimum quote interval, so every packet can reach the sender
+constexpr uint64_t TICK_SPACING_NS = 100000;
+
+// Order rate during the traffic; the configured bucket comes back after
+constexpr uint32_t WARMUP_ORDER_RATE = 1000000000;
+constexpr uint32_t WARMUP_ORDER_BURST = 1000000;
+
+constexpr uint64_t NS_PER_DAY = 86400ULL * 1000000000ULL;
+
+// Record of the simple feed protocol (MarketDataHandler::MarketDataMessage)
+struct SimpleRecord {
+    char symbol[16];
+    uint8_t side;
+    uint8_t level;
+    double price;
+    double quantity;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+// Big-endian fields and length-prefixed ITCH messages
+class ItchWriter {
+public:
+    explicit ItchWriter(std::vector<char>& out) : out_(out) {}
+
+    void put(uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            out_.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    void stock(const std::string& symbol) {
+        for (size_t i = 0; i < 8; ++i) {
+            out_.push_back(i < symbol.size() ? symbol[i] : ' ');
+        }
+    }
+
+    // Type, locate, tracking number and timestamp, after the length prefix
+    void begin(char type, uint16_t locate, uint64_t timestamp_ns) {
+        mark_ = out_.size();
+        put(0, 2);
+        out_.push_back(type);
+        put(locate, 2);
+        put(0, 2);
+        put(timestamp_ns % NS_PER_DAY, 6);
+        ++messages_;
+    }
+
+    void end() {
+        size_t len = out_.size() - mark_ - 2;
+        out_[mark_] = static_cast<char>(len >> 8);
+        out_[mark_ + 1] = static_cast<char>(len & 0xFF);
+    }
+
+    uint16_t messages() const { return messages_; }
+
+private:
+    std::vector<char>& out_;
+    size_t mark_ = 0;
+    uint16_t messages_ = 0;
+};
+
+uint32_t itch_price(double price) {
+    return static_cast<uint32_t>(std::lround(price / itch::PRICE_TICK));
+}
+
+bool within(uint64_t value, uint64_t reference, double tolerance) {
+    double difference = std::fabs(static_cast<double>(value) - static_cast<double>(reference));
+    return difference <= tolerance * static_cast<double>(reference);
+}
+
+} // namespace
+
+Warmup::Warmup(MarketDataHandler& handler, StrategyRouter& router, OrderManager& order_manager,
+               TCPSender& order_sender, const Options& options)
+    : handler_(handler)
+    , router_(router)
+    , order_manager_(order_manager)
+    , order_sender_(order_sender)
+    , options_(options)
+    , histograms_(std::make_unique<TickToTrade::Histograms>()) {
+    if (options_.batch_ticks == 0) {
+        options_.batch_ticks = 1;
+    }
+}
+
+Warmup::Result Warmup::run(const std::atomic<bool>* running) {
+    Result result;
+    uint64_t start = Timestamp::now();
+
+    // 1. No page faults from here on
+    if (options_.lock_memory) {
+        result.memory_locked = realtime::lock_memory();
+        if (!result.memory_locked) {
+            LOG_WARN("Warm-up: mlockall refused (errno {}), prefaulting instead", errno);
+        }
+    }
+    if (!result.memory_locked) {
+        result.prefaulted_bytes = realtime::prefault_writable();
+    }
+
+    // 2. The feed core, at the feed thread's priority
+#ifdef __linux__
+    cpu_set_t saved_cpus;
+    bool restore_cpus = pthread_getaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus) == 0;
+    int saved_policy = SCHED_OTHER;
+    sched_param saved_param{};
+    bool restore_sched = pthread_getschedparam(pthread_self(), &saved_policy, &saved_param) == 0;
+#endif
+    result.pinned = options_.cpu >= 0 && realtime::pin_thread(options_.cpu);
+    result.realtime = options_.realtime_priority > 0 &&
+                      realtime::set_thread_priority(options_.realtime_priority);
+    if (options_.realtime_priority > 0 && !result.realtime) {
+        LOG_WARN("Warm-up: SCHED_FIFO {} refused", options_.realtime_priority);
+    }
+
+    // 3. Synthetic traffic: nothing published, nothing written, no rate limit
+    ShmBookPublisher* publisher = handler_.publisher();
+    handler_.set_publisher(nullptr);
+    RiskEngine::Limits limits = order_manager_.risk().limits();
+    order_manager_.set_order_rate(WARMUP_ORDER_RATE, WARMUP_ORDER_BURST);
+    bool loopback = order_sender_.loopback();
+    order_sender_.set_loopback(true);
+    router_.attach();
+
+    traffic(result, running);
+
+    // 4. Undo it: resting quotes canceled (the loopback answers at once),
+    // then every piece of state the synthetic market touched
+    order_manager_.process_execution_reports();
+    result.orders_canceled = order_manager_.cancel_all();
+    order_manager_.process_execution_reports();
+    if (order_manager_.open_orders() != 0) {
+        LOG_WARN("Warm-up: {} orders still open after the cleanup", order_manager_.open_orders());
+    }
+    order_sender_.set_loopback(loopback);
+    order_manager_.set_order_rate(limits.max_orders_per_second, limits.max_order_burst);
+    handler_.forget_locates();
+    router_.reset();
+    handler_.set_publisher(publisher);
+
+#ifdef __linux__
+    if (restore_sched) {
+        pthread_setschedparam(pthread_self(), saved_policy, &saved_param);
+    }
+    if (restore_cpus) {
+        pthread_setaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus);
+    }
+#endif
+
+    result.elapsed_ns = Timestamp::to_nanoseconds(Timestamp::now() - start);
+    LOG_INFO("Warm-up: {} ticks, first {} ns, p50 {} -> {} ns, p99 {} -> {} ns, ready in {} us",
+             result.ticks, result.first_tick_ns, result.first_p50_ns, result.last_p50_ns,
+             result.first_p99_ns, result.last_p99_ns, result.elapsed_ns / 1000);
+    return result;
+}
+
+void Warmup::traffic(Result& result, const std::atomic<bool>* running) {
+    books_.clear();
+    for (uint32_t slot = 0; slot < router_.books() && slot < UINT16_MAX; ++slot) {
+        books_.push_back(Book{router_.book(slot), static_cast<uint16_t>(slot + 1), 0, 0, 100.0});
+    }
+    if (books_.empty()) {
+        LOG_WARN("Warm-up: no routed books, no synthetic traffic");
+        return;
+    }
+
+    // Feed clock in the past: its last tick is about now
+    uint64_t base = Timestamp::fast_wall_clock_ns() - options_.max_ticks * TICK_SPACING_NS;
+
+    const LatencyHistogram& total = histograms_->stage[TickToTrade::TOTAL];
+    LatencyHistogram batch_start;
+    uint64_t previous_p50 = 0;
+    uint64_t previous_p99 = 0;
+    uint32_t stable = 0;
+
+    TickToTrade::attach(histograms_.get());
+    while (result.ticks < options_.max_ticks) {
+        if (running && !running->load(std::memory_order_relaxed)) {
+            break;
+        }
+        Book& book = books_[result.ticks % books_.size()];
+        uint64_t rx_timestamp_ns = base + result.ticks * TICK_SPACING_NS;
+        build_packet(book, result.ticks < books_.size(), rx_timestamp_ns);    // First lap: new books
+        handler_.process_message(packet_.data(), packet_.size(), rx_timestamp_ns);
+        order_manager_.process_execution_reports();
+        if (result.first_tick_ns == 0 && total.count() != 0) {
+            result.first_tick_ns = total.max();
+        }
+        if (++result.ticks % options_.batch_ticks != 0) {
+            continue;
+        }
+
+        // One batch done: its percentiles against the previous batch's
+        router_.on_timer();
+        LatencyHistogram batch = total;
+        batch.subtract(batch_start);
+        batch_start = total;
+        if (batch.count() == 0) {
+            continue;
+        }
+        uint64_t p50 = batch.value_at_percentile(50.0);
+        uint64_t p99 = batch.value_at_percentile(99.0);
+        if (result.first_p50_ns == 0) {
+            result.first_p50_ns = p50;
+            result.first_p99_ns = p99;
+        }
+        result.last_p50_ns = p50;
+        result.last_p99_ns = p99;
+
+        bool steady = previous_p50 != 0 && within(p50, previous_p50, options_.tolerance) &&
+                      within(p99, previous_p99, options_.tolerance);
+        stable = steady ? stable + 1 : 0;
+        previous_p50 = p50;
+        previous_p99 = p99;
+        if (stable >= options_.stable_batches && result.ticks >= options_.min_ticks) {
+            result.steady = true;
+            break;
+        }
+    }
+    TickToTrade::attach(nullptr);
+    result.samples = total.count();
+}
+
+void Warmup::build_packet(Book& book, bool first, uint64_t rx_timestamp_ns) {
+    // Random walk of a cent per packet, a cent either side of the mid
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 7;
+    random_ ^= random_ << 17;
+    if (!first) {
+        book.mid += (random_ & 1) ? 0.01 : -0.01;
+        book.mid = book.mid < 1.0 ? 1.0 : book.mid;
+    }
+    double bid = book.mid - 0.01;
+    double ask = book.mid + 0.01;
+    uint32_t shares = static_cast<uint32_t>(100 + (random_ >> 8) % 900);
+    packet_.clear();
+
+    FeedProtocol protocol = handler_.feed_protocol();
+    if (protocol == FeedProtocol::SIMPLE) {
+        SimpleRecord records[2];
+        std::memset(records, 0, sizeof(records));
+        for (int side = 0; side < 2; ++side) {
+            std::strncpy(records[side].symbol, book.book->symbol().c_str(), sizeof(records[side].symbol) - 1);
+            records[side].side = static_cast<uint8_t>(side);
+            records[side].price = side == 0 ? bid : ask;
+            records[side].quantity = shares;
+            records[side].timestamp = rx_timestamp_ns;
+        }
+        const char* bytes = reinterpret_cast<const char*>(records);
+        packet_.assign(bytes, bytes + sizeof(records));
+        return;
+    }
+
+    // ITCH: the book's two orders added once, then replaced every packet,
+    // with an execution now and then for the trade print path
+    ItchWriter itch(packet_);
+    size_t count_offset = 0;
+    if (protocol == FeedProtocol::ITCH50_MOLDUDP64) {
+        for (char c : {'W', 'A', 'R', 'M', 'U', 'P', ' ', ' ', ' ', ' '}) {
+            packet_.push_back(c);
+        }
+        itch.put(sequence_, 8);
+        count_offset = packet_.size();
+        itch.put(0, 2);
+    }
+    uint64_t refs[2] = {book.bid_ref, book.ask_ref};
+    for (int side = 0; side < 2; ++side) {
+        uint64_t ref = next_ref_++;
+        uint32_t price = itch_price(side == 0 ? bid : ask);
+        if (first) {
+            itch.begin('A', book.locate, rx_timestamp_ns);
+            itch.put(ref, 8);
+            itch.put(side == 0 ? 'B' : 'S', 1);
+            itch.put(shares, 4);
+            itch.stock(book.book->symbol());
+            itch.put(price, 4);
+        } else {
+            itch.begin('U', book.locate, rx_timestamp_ns);
+            itch.put(refs[side], 8);
+            itch.put(ref, 8);
+            itch.put(shares, 4);
+            itch.put(price, 4);
+        }
+        itch.end();
+        refs[side] = ref;
+    }
+    book.bid_ref = refs[0];
+    book.ask_ref = refs[1];
+    if (!first && (random_ & 0x70) == 0) {
+        itch.begin('E', book.locate, rx_timestamp_ns);
+        itch.put(book.bid_ref, 8);
+        itch.put(1, 4);
+        itch.put(next_ref_++, 8);
+        itch.end();
+    }
+
+    if (protocol == FeedProtocol::ITCH50_MOLDUDP64) {
+        packet_[count_offset] = static_cast<char>(itch.messages() >> 8);
+        packet_[count_offset + 1] = static_cast<char>(itch.messages() & 0xFF);
+        sequence_ += itch.messages();
+    }
+}
+
+} // namespace hft
@@ -1,12 +1,27 @@
 #include "common/hashmap.h"
+#include "common/symbol_table.h"
 #include "common/circular_buffer.h"
 #include "common/memory_pool.h"
 #include "common/bit_utils.h"
+#include "common/timestamp.h"
+#include "common/logger.h"
+#include "common/latency_histogram.h"
+#include "common/tick_to_trade.h"
+#include "common/rcu.h"
 #include <iostream>
 #include <thread>
 #include <vector>
+// Release (the default build) defines NDEBUG: keep the checks
+#undef NDEBUG
 #include <cassert>
 #include <string>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <unistd.h>
 
 using namespace hft;
 
@@ -65,6 +80,93 @@ void test_hashmap_strings() {
     std::cout << "✓ String hash map test passed\n";
 }
 
+// Test runtime-sized open-addressing map with erase
+void test_flat_hashmap() {
+    std::cout << "Testing flat hash map with erase...\n";
+    
+    FlatHashMap<uint64_t, uint64_t> map(1000);
+    assert(map.capacity() >= 1000);
+    
+    for (uint64_t i = 0; i < 1000; ++i) {
+        assert(map.insert(i * 7919, i));
+    }
+    assert(map.size() == 1000);
+    
+    // Erase every other key, the rest must stay reachable
+    for (uint64_t i = 0; i < 1000; i += 2) {
+        assert(map.erase(i * 7919));
+    }
+    assert(!map.erase(0));
+    for (uint64_t i = 0; i < 1000; ++i) {
+        uint64_t* val = map.find(i * 7919);
+        assert((i % 2 == 0) ? val == nullptr : (val && *val == i));
+        (void)val;
+    }
+    
+    // Heavy churn must not exhaust the table (no tombstones)
+    for (uint64_t round = 0; round < 100; ++round) {
+        for (uint64_t i = 0; i < 500; ++i) {
+            assert(map.insert((1ULL << 40) + round * 500 + i, i));
+        }
+        for (uint64_t i = 0; i < 500; ++i) {
+            assert(map.erase((1ULL << 40) + round * 500 + i));
+        }
+    }
+    assert(map.size() == 500);
+    
+    std::cout << "✓ Flat hash map test passed\n";
+}
+
+void test_symbol_table() {
+    std::cout << "Testing symbol interning...\n";
+    
+    SymbolTable symbols(20000);
+    assert(symbols.capacity() == 20000);
+    
+    // Dense IDs in intern order, interning twice returns the same ID
+    char name[16];
+    for (uint32_t i = 0; i < 20000; ++i) {
+        std::snprintf(name, sizeof(name), "S%05u", i);
+        assert(symbols.intern(name) == i);
+    }
+    assert(symbols.intern("S00042") == 42 && symbols.size() == 20000);
+    assert(std::string(symbols.name(42)) == "S00042");
+    assert(symbols.intern("FULL") == SymbolTable::NO_SYMBOL);
+    assert(symbols.intern("") == SymbolTable::NO_SYMBOL);
+    assert(symbols.find("S20000") == SymbolTable::NO_SYMBOL);
+    
+    // Message fields: 16 bytes, whatever follows the NUL is ignored
+    char field[16];
+    std::memset(field, 'x', sizeof(field));
+    std::memcpy(field, "S12345", 7);
+    assert(symbols.find_field(field) == 12345);
+    field[6] = 'x';
+    assert(symbols.find_field(field) == SymbolTable::NO_SYMBOL);
+    
+    // Names are cut to MAX_NAME characters, like Order::symbol
+    SymbolTable small(4);
+    uint32_t id = small.intern("ABCDEFGHIJKLMNOPQ");
+    assert(id == 0 && small.find("ABCDEFGHIJKLMNO") == id);
+    std::memcpy(field, "ABCDEFGHIJKLMNOP", 16);
+    assert(small.find_field(field) == id);
+    
+    // Erase keeps the rest reachable; IDs are not reused
+    for (uint32_t i = 0; i < 20000; i += 2) {
+        std::snprintf(name, sizeof(name), "S%05u", i);
+        assert(symbols.erase(name));
+    }
+    assert(!symbols.erase("S00000") && symbols.size() == 10000);
+    for (uint32_t i = 0; i < 20000; ++i) {
+        std::snprintf(name, sizeof(name), "S%05u", i);
+        assert(symbols.find(name) == (i % 2 ? i : SymbolTable::NO_SYMBOL));
+    }
+    assert(std::string(symbols.name(0)).empty());
+    assert(symbols.intern("S00000") == SymbolTable::NO_SYMBOL); // IDs used up
+    (void)id;
+    
+    std::cout << "✓ Symbol table test passed\n";
+}
+
 // Test circular buffer (SPSC)
 void test_circular_buffer() {
     std::cout << "Testing SPSC circular buffer...\n";
@@ -90,6 +192,47 @@ void test_circular_buffer() {
     std::cout << "✓ Circular buffer test passed\n";
 }
 
+// Test batch push/pop, including wrap-around and a full ring
+void test_circular_buffer_batch() {
+    std::cout << "Testing circular buffer batch push/pop...\n";
+    
+    CircularBuffer<int, 16> buffer;
+    int items[32];
+    for (int i = 0; i < 32; ++i) {
+        items[i] = i;
+    }
+    int out[32] = {};
+    
+    // 15 usable slots: a larger batch is cut short
+    assert(buffer.push_batch(items, 20) == 15);
+    assert(buffer.push_batch(items, 1) == 0);
+    assert(!buffer.push(99));
+    assert(buffer.pop_batch(out, 10) == 10);
+    for (int i = 0; i < 10; ++i) {
+        assert(out[i] == i);
+    }
+    
+    // Batch crossing the end of the array
+    assert(buffer.push_batch(items + 15, 10) == 10);
+    assert(buffer.size() == 15);
+    assert(buffer.pop_batch(out, 32) == 15);
+    for (int i = 0; i < 15; ++i) {
+        assert(out[i] == 10 + i);
+    }
+    assert(buffer.empty());
+    assert(buffer.pop_batch(out, 32) == 0);
+    
+    // Mixes with the single-item calls
+    assert(buffer.push_batch(items, 3) == 3);
+    [[maybe_unused]] int val = -1;
+    assert(buffer.pop(val) && val == 0);
+    assert(buffer.push(42));
+    assert(buffer.pop_batch(out, 8) == 3);
+    assert(out[0] == 1 && out[1] == 2 && out[2] == 42);
+    
+    std::cout << "✓ Circular buffer batch test passed\n";
+}
+
 // Test concurrent circular buffer
 void test_circular_buffer_concurrent() {
     std::cout << "Testing concurrent circular buffer...\n";
@@ -132,6 +275,47 @@ void test_circular_buffer_concurrent() {
     std::cout << "✓ Concurrent circular buffer test passed\n";
 }
 
+// Test concurrent batch producer/consumer: order and count preserved
+void test_circular_buffer_batch_concurrent() {
+    std::cout << "Testing concurrent circular buffer batches...\n";
+    
+    CircularBuffer<int, 256> buffer;
+    constexpr int ITEMS = 100000;
+    
+    std::thread producer([&]() {
+        int batch[37];
+        int next = 0;
+        while (next < ITEMS) {
+            int count = std::min(37, ITEMS - next);
+            for (int i = 0; i < count; ++i) {
+                batch[i] = next + i;
+            }
+            int pushed = 0;
+            while (pushed < count) {
+                pushed += static_cast<int>(buffer.push_batch(batch + pushed, count - pushed));
+            }
+            next += count;
+        }
+    });
+    
+    bool in_order = true;
+    int expected = 0;
+    int batch[64];
+    while (expected < ITEMS) {
+        size_t n = buffer.pop_batch(batch, 64);
+        for (size_t i = 0; i < n; ++i) {
+            in_order &= batch[i] == expected++;
+        }
+    }
+    producer.join();
+    
+    assert(in_order);
+    assert(buffer.empty());
+    (void)in_order;
+    
+    std::cout << "✓ Concurrent circular buffer batch test passed\n";
+}
+
 // Test memory pool
 void test_memory_pool() {
     std::cout << "Testing memory pool...\n";
@@ -164,9 +348,91 @@ void test_memory_pool() {
     
     assert(pool.available() == 100);
     
+    // Runtime-sized pool
+    MemoryPool<TestObj> big_pool(1 << 16);
+    assert(big_pool.capacity() == (1 << 16));
+    TestObj* obj = big_pool.allocate(7, 2.5);
+    assert(obj && big_pool.owns(obj) && !pool.owns(obj));
+    big_pool.deallocate(obj);
+    assert(big_pool.available() == big_pool.capacity());
+    
     std::cout << "✓ Memory pool test passed\n";
 }
 
+void test_memory_pool_concurrent() {
+    std::cout << "Testing memory pool under concurrent allocate/free...\n";
+    
+    struct Slot {
+        std::atomic<int> owner{-1};
+    };
+    
+    constexpr int THREADS = 4;
+    constexpr int ROUNDS = 20000;
+    MemoryPool<Slot> pool(256, HugePageBuffer::numa_node_of_cpu(0));
+    std::atomic<bool> corrupted{false};
+    
+    // Each thread holds a few objects at a time, half of them through a
+    // cache; an object owned by two threads at once shows up as a bad owner
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&pool, &corrupted, t]() {
+            MemoryPool<Slot>::Cache cache(pool);
+            Slot* held[16] = {};
+            for (int r = 0; r < ROUNDS; ++r) {
+                int i = r % 16;
+                if (held[i]) {
+                    if (held[i]->owner.exchange(-1, std::memory_order_relaxed) != t) {
+                        corrupted = true;
+                    }
+                    (i % 2 ? cache.deallocate(held[i]) : pool.deallocate(held[i]));
+                }
+                held[i] = i % 2 ? cache.allocate() : pool.allocate();
+                if (held[i] && held[i]->owner.exchange(t, std::memory_order_relaxed) != -1) {
+                    corrupted = true;
+                }
+            }
+            for (Slot*& slot : held) {
+                if (slot) {
+                    slot->owner.store(-1, std::memory_order_relaxed);
+                    pool.deallocate(slot);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(!corrupted.load());
+    assert(pool.available() == pool.capacity());
+    
+    // A cache moves objects in half magazines and returns them when done
+    {
+        MemoryPool<Slot>::Cache cache(pool);
+        Slot* slot = cache.allocate();
+        assert(slot && pool.owns(slot));
+        assert(cache.cached() == MemoryPool<Slot>::Cache::SIZE / 2 - 1);
+        assert(pool.available() == pool.capacity() - MemoryPool<Slot>::Cache::SIZE / 2);
+        cache.deallocate(slot);
+    }
+    assert(pool.available() == pool.capacity());
+    
+    // Exhaustion through a cache, then everything comes back
+    std::vector<Slot*> all;
+    {
+        MemoryPool<Slot>::Cache cache(pool);
+        while (Slot* slot = cache.allocate()) {
+            all.push_back(slot);
+        }
+        assert(all.size() == pool.capacity() && pool.available() == 0);
+        for (Slot* slot : all) {
+            cache.deallocate(slot);
+        }
+    }
+    assert(pool.available() == pool.capacity());
+    
+    std::cout << "✓ Concurrent memory pool test passed\n";
+}
+
 // Test bit manipulation
 void test_bit_manipulation() {
     std::cout << "Testing bit manipulation utilities...\n";
@@ -243,7 +509,7 @@ void benchmark_hashmap() {
     volatile uint64_t sum = 0;
     for (uint64_t i = 0; i < 1000; ++i) {
         uint64_t* val = map.find(i);
-        if (val) sum += *val;
+        if (val) sum = sum + *val;
     }
     end = std::chrono::high_resolution_clock::now();
     auto lookup_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
@@ -253,6 +519,418 @@ void benchmark_hashmap() {
               << (lookup_us * 1000.0 / 1000) << " ns/lookup)\n";
 }
 
+void test_timestamp_calibration() {
+    std::cout << "Testing TSC calibration and conversion...\n";
+    
+    // Uncalibrated: 3.0 GHz assumed
+    assert(Timestamp::to_nanoseconds(3000) == 999 || Timestamp::to_nanoseconds(3000) == 1000);
+    
+    double hz = Timestamp::calibrate_tsc_frequency();
+    assert(hz > 1e8);
+    assert(hz == Timestamp::tsc_frequency());
+    
+    // Fixed-point factor matches the measured rate, even for long spans
+    uint64_t one_second = static_cast<uint64_t>(hz);
+    int64_t error = static_cast<int64_t>(Timestamp::to_nanoseconds(one_second)) - 1000000000LL;
+    assert(error > -10 && error < 10);
+    uint64_t one_day = one_second * 86400;
+    double day_ns = static_cast<double>(Timestamp::to_nanoseconds(one_day));
+    assert(day_ns > 86399.99e9 && day_ns < 86400.01e9);
+    
+    // Counter-derived wall clock tracks the system clock
+    for (int i = 0; i < 3; ++i) {
+        int64_t skew = static_cast<int64_t>(Timestamp::fast_wall_clock_ns() - Timestamp::wall_clock_ns());
+        assert(skew > -1000000 && skew < 1000000);
+        (void)skew;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Timestamp::resync_wall_clock();
+    }
+    
+    uint64_t a = Timestamp::fast_wall_clock_ns();
+    uint64_t b = Timestamp::fast_wall_clock_ns();
+    assert(b >= a);
+    (void)hz; (void)error; (void)day_ns; (void)a; (void)b;
+    
+    std::cout << "✓ TSC calibration test passed\n";
+}
+
+void test_logger() {
+    std::cout << "Testing async logger...\n";
+    
+    FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    int fd = fileno(file);
+    auto read_all = [fd]() {
+        std::string text;
+        char chunk[4096];
+        lseek(fd, 0, SEEK_SET);
+        ssize_t n;
+        while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+            text.append(chunk, static_cast<size_t>(n));
+        }
+        return text;
+    };
+    
+    Logger& logger = Logger::instance();
+    logger.flush();
+    logger.set_output_fd(fd);
+    
+    // Deferred formatting of each argument kind
+    const char* symbol = "AAPL";
+    LOG_WARN("Order {} {} rejected: {} > {} ({}, {})", 42u, symbol, 150.5, -3, 'B', true);
+    LOG_INFO("No arguments");
+    LOG_DEBUG("Below the level, never queued {}", 1);
+    logger.flush();
+    std::string text = read_all();
+    assert(text.find(" [WARN] Order 42 AAPL rejected: 150.5 > -3 (B, true)\n") != std::string::npos);
+    assert(text.find(" [INFO] No arguments\n") != std::string::npos);
+    assert(text.find("never queued") == std::string::npos);
+    
+    // Long strings are truncated to the record, not overflowed
+    std::string long_text(500, 'x');
+    LOG_INFO("Long {} end", long_text.c_str());
+    logger.flush();
+    text = read_all();
+    assert(text.find(std::string(Logger::ARG_BYTES - 2, 'x') + " end\n") != std::string::npos);
+    
+    // Several producers, each on its own ring
+    uint64_t written_before = logger.written();
+    uint64_t dropped_before = logger.dropped();
+    constexpr int THREADS = 3;
+    constexpr int PER_THREAD = 200;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < THREADS; ++t) {
+        producers.emplace_back([t]() {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                LOG_INFO("Producer {} message {}", t, i);
+                if (i % 50 == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                }
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    logger.flush();
+    assert(logger.written() - written_before + logger.dropped() - dropped_before ==
+           static_cast<uint64_t>(THREADS * PER_THREAD));
+    
+    // Exited threads hand their rings to the next ones
+    size_t rings_before = logger.rings();
+    for (int round = 0; round < 4; ++round) {
+        std::thread([round]() { LOG_INFO("Short-lived thread {}", round); }).join();
+        logger.flush();
+    }
+    assert(logger.rings() == rings_before);
+    (void)rings_before;
+    
+    // Bursting past the ring drops and counts, never overwrites
+    written_before = logger.written();
+    dropped_before = logger.dropped();
+    constexpr int BURST = static_cast<int>(Logger::RING_SIZE) * 4;
+    for (int i = 0; i < BURST; ++i) {
+        LOG_INFO("Burst {}", i);
+    }
+    logger.flush();
+    uint64_t dropped = logger.dropped() - dropped_before;
+    assert(logger.written() - written_before + dropped == static_cast<uint64_t>(BURST));
+    text = read_all();
+    assert(text.find(" [INFO] Burst 0\n") != std::string::npos);
+    if (dropped > 0) {
+        assert(text.find("Logger dropped ") != std::string::npos);
+    }
+    
+    logger.set_output_fd(STDOUT_FILENO);
+    std::fclose(file);
+    (void)written_before; (void)dropped_before; (void)dropped;
+    
+    std::cout << "✓ Async logger test passed\n";
+}
+
+void test_latency_histogram() {
+    std::cout << "Testing log-linear latency histogram...\n";
+    
+    // Small values are exact; every bucket is within 1/32 of its values
+    for (uint64_t v = 0; v < 2 * LatencyHistogram::SUB_BUCKETS; ++v) {
+        assert(LatencyHistogram::bucket_of(v) == v);
+    }
+    size_t last_bucket = 0;
+    for (uint64_t v = 1; v < (1ULL << 62); v += v / 7 + 1) {
+        size_t bucket = LatencyHistogram::bucket_of(v);
+        assert(bucket >= last_bucket && bucket < LatencyHistogram::BUCKETS);
+        uint64_t low = LatencyHistogram::lowest_value(bucket);
+        uint64_t high = LatencyHistogram::highest_value(bucket);
+        assert(low <= v && v <= high);
+        assert(high - low <= low / LatencyHistogram::SUB_BUCKETS);
+        last_bucket = bucket;
+        (void)low; (void)high;
+    }
+    assert(LatencyHistogram::bucket_of(std::numeric_limits<uint64_t>::max()) == LatencyHistogram::BUCKETS - 1);
+    
+    // Percentiles, to bucket precision; count, min, max and mean exact
+    auto histogram = std::make_unique<LatencyHistogram>();
+    assert(histogram->count() == 0 && histogram->value_at_percentile(99) == 0 && histogram->min() == 0);
+    for (uint64_t v = 1; v <= 10000; ++v) {
+        histogram->record(v);
+    }
+    assert(histogram->count() == 10000);
+    assert(histogram->min() == 1 && histogram->max() == 10000);
+    assert(histogram->mean() == 5000.5);
+    auto near = [](uint64_t value, uint64_t exact) {
+        return value >= exact && value <= exact + exact / LatencyHistogram::SUB_BUCKETS;
+    };
+    assert(near(histogram->value_at_percentile(50), 5000));
+    assert(near(histogram->value_at_percentile(99), 9900));
+    assert(histogram->value_at_percentile(100) == 10000);
+    assert(histogram->value_at_percentile(0) == 1);
+    
+    // Two threads' halves merge into the whole
+    auto low = std::make_unique<LatencyHistogram>();
+    auto high = std::make_unique<LatencyHistogram>();
+    for (uint64_t v = 1; v <= 10000; ++v) {
+        (v <= 5000 ? *low : *high).record(v);
+    }
+    auto merged = std::make_unique<LatencyHistogram>(*low);
+    merged->merge(*high);
+    assert(merged->count() == 10000 && merged->min() == 1 && merged->max() == 10000);
+    for (double p : {10.0, 50.0, 90.0, 99.0, 99.9}) {
+        assert(merged->value_at_percentile(p) == histogram->value_at_percentile(p));
+        (void)p;
+    }
+    
+    // Difference of two reads: the samples in between
+    auto earlier = std::make_unique<LatencyHistogram>(*histogram);
+    for (int i = 0; i < 100; ++i) {
+        histogram->record(1000000);
+    }
+    auto interval = std::make_unique<LatencyHistogram>(*histogram);
+    interval->subtract(*earlier);
+    assert(interval->count() == 100 && interval->mean() == 1000000.0);
+    assert(near(interval->value_at_percentile(50), 1000000));
+    assert(interval->max() == 1000000 && interval->min() >= 1000000 - 1000000 / LatencyHistogram::SUB_BUCKETS);
+    interval->subtract(*interval);
+    assert(interval->count() == 0 && interval->max() == 0);
+    
+    histogram->reset();
+    assert(histogram->count() == 0 && histogram->max() == 0);
+    
+    // Readers on another thread see counts grow while the owner records
+    constexpr uint64_t SAMPLES = 200000;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (uint64_t i = 0; i < SAMPLES; ++i) {
+            histogram->record(i & 4095);
+        }
+        done.store(true, std::memory_order_release);
+    });
+    uint64_t seen = 0;
+    while (!done.load(std::memory_order_acquire)) {
+        uint64_t count = histogram->count();
+        assert(count >= seen);
+        seen = count;
+        LatencyHistogram copy(*histogram);
+        (void)copy.value_at_percentile(99);
+    }
+    writer.join();
+    assert(histogram->count() == SAMPLES);
+    (void)seen; (void)near;
+    
+    std::cout << "✓ Latency histogram test passed\n";
+}
+
+void test_tick_to_trade() {
+    std::cout << "Testing tick-to-trade stage stamps...\n";
+    
+    auto stages = std::make_unique<TickToTrade::Histograms>();
+    
+    // Not attached: stamping records nothing
+    {
+        TickToTrade::Packet packet(0);
+        TickToTrade::mark(TickToTrade::BOOK);
+        TickToTrade::mark(TickToTrade::ENCODE);
+        TickToTrade::sent();
+    }
+    assert(stages->stage[TickToTrade::TOTAL].count() == 0);
+    
+    // One quoting tick: a sample per stage, adding up to the total
+    TickToTrade::attach(stages.get());
+    {
+        TickToTrade::Packet packet(Timestamp::fast_wall_clock_ns() - 5000);
+        TickToTrade::mark(TickToTrade::DECODE);
+        TickToTrade::mark(TickToTrade::BOOK);
+        TickToTrade::mark(TickToTrade::STRATEGY);
+        TickToTrade::mark(TickToTrade::RISK);
+        TickToTrade::mark(TickToTrade::ENCODE);
+        TickToTrade::sent();
+        
+        // Flushing again without a new book update adds nothing
+        TickToTrade::mark(TickToTrade::ENCODE);
+        TickToTrade::sent();
+    }
+    for (int s = 0; s < TickToTrade::STAGES; ++s) {
+        assert(stages->stage[s].count() == 1);
+    }
+    uint64_t sum = 0;
+    for (int s = TickToTrade::DECODE; s <= TickToTrade::SEND; ++s) {
+        sum += stages->stage[s].max();
+    }
+    uint64_t total = stages->stage[TickToTrade::TOTAL].max();
+    assert(sum <= total + 6 && sum + 6 >= total);
+    assert(stages->stage[TickToTrade::RECV].min() >= 5000);
+    
+    // Orders outside a packet (timers) and ticks that send nothing are
+    // not samples; a cancel (no risk stage) counts risk as 0
+    TickToTrade::mark(TickToTrade::BOOK);
+    TickToTrade::mark(TickToTrade::ENCODE);
+    TickToTrade::sent();
+    {
+        TickToTrade::Packet packet(0);
+        TickToTrade::mark(TickToTrade::DECODE);
+        TickToTrade::mark(TickToTrade::BOOK);
+        TickToTrade::sent();
+    }
+    assert(stages->stage[TickToTrade::TOTAL].count() == 1);
+    {
+        TickToTrade::Packet packet(0);
+        TickToTrade::mark(TickToTrade::DECODE);
+        TickToTrade::mark(TickToTrade::BOOK);
+        TickToTrade::mark(TickToTrade::STRATEGY);
+        TickToTrade::mark(TickToTrade::ENCODE);
+        TickToTrade::sent();
+    }
+    assert(stages->stage[TickToTrade::TOTAL].count() == 2);
+    assert(stages->stage[TickToTrade::RISK].count() == 2 && stages->stage[TickToTrade::RISK].min() == 0);
+    assert(stages->stage[TickToTrade::RECV].count() == 1);    // No rx stamp
+    TickToTrade::attach(nullptr);
+    
+    std::string report = TickToTrade::report(*stages);
+    assert(report.find("tick-to-trade") != std::string::npos);
+    assert(report.find("strategy") != std::string::npos);
+    (void)sum; (void)total;
+    
+    std::cout << "✓ Tick-to-trade stage test passed\n";
+}
+
+// Parameter block for the RCU tests: counts live copies, and scribbles
+// over itself when destroyed so a reader on a freed version notices
+std::atomic<int> live_blocks{0};
+
+struct RcuBlock {
+    uint64_t version;
+    uint64_t check;
+    
+    explicit RcuBlock(uint64_t v = 0) : version(v), check(v * 7 + 1) { live_blocks.fetch_add(1); }
+    RcuBlock(const RcuBlock& other) : version(other.version), check(other.check) { live_blocks.fetch_add(1); }
+    ~RcuBlock() {
+        __atomic_store_n(&check, 0, __ATOMIC_RELAXED);
+        live_blocks.fetch_sub(1);
+    }
+    bool intact() const { return check == version * 7 + 1; }
+};
+
+void test_rcu_cell() {
+    std::cout << "Testing RCU cell...\n";
+    
+    {
+        RcuCell<RcuBlock> cell(RcuBlock(1));
+        size_t reader = cell.add_reader();
+        assert(reader == 0);
+        const RcuBlock* block = cell.read(reader);
+        assert(block->version == 1 && cell.version() == 1);
+        
+        // Retired, not freed, while the reader may still hold it
+        assert(cell.publish(RcuBlock(2)) == 2);
+        assert(block->intact() && block->version == 1);
+        assert(cell.reclaim() == 1);
+        assert(cell.snapshot().version == 2);
+        
+        // Read again: the old version is past its grace period
+        block = cell.read(reader);
+        assert(block->version == 2);
+        assert(cell.reclaim() == 0);
+        assert(live_blocks.load() == 1);
+        
+        // Nothing holds versions back once the reader leaves
+        cell.remove_reader(reader);
+        cell.publish(RcuBlock(3));
+        cell.publish(RcuBlock(4));
+        assert(cell.reclaim() == 0 && live_blocks.load() == 1);
+        
+        // A new reader counts as holding the version current when it joined
+        size_t late = cell.add_reader();
+        cell.publish(RcuBlock(5));
+        assert(cell.reclaim() == 1);
+        assert(cell.read(late)->version == 5);
+        assert(cell.reclaim() == 0);
+        
+        // Slots are bounded
+        std::vector<size_t> readers;
+        for (size_t i = 1; i < RcuCell<RcuBlock>::MAX_READERS; ++i) {
+            readers.push_back(cell.add_reader());
+        }
+        assert(cell.add_reader() == RcuCell<RcuBlock>::NO_READER);
+        for (size_t r : readers) {
+            cell.remove_reader(r);
+        }
+        cell.remove_reader(late);
+        (void)block;
+    }
+    assert(live_blocks.load() == 0);
+    
+    // A reader ticking against a writer publishing as fast as it can:
+    // every version read is intact, newer than the one before, and still
+    // intact when the reader moves on
+    {
+        constexpr uint64_t VERSIONS = 20000;
+        RcuCell<RcuBlock> cell(RcuBlock(0));
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> reads{0};
+        std::atomic<bool> ok{true};
+        
+        std::thread reader_thread([&]() {
+            size_t reader = cell.add_reader();
+            const RcuBlock* held = cell.read(reader);
+            uint64_t last = held->version;
+            uint64_t count = 0;
+            while (!done.load(std::memory_order_acquire) || last < VERSIONS) {
+                if (!held->intact()) {
+                    ok.store(false);            // Freed while still ours
+                }
+                const RcuBlock* block = cell.read(reader);
+                if (!block->intact() || block->version < last) {
+                    ok.store(false);
+                }
+                last = block->version;
+                held = block;
+                ++count;
+                if ((count & 63) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            cell.remove_reader(reader);
+            reads.store(count);
+        });
+        
+        for (uint64_t v = 1; v <= VERSIONS; ++v) {
+            cell.publish(RcuBlock(v));
+            if ((v & 255) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true, std::memory_order_release);
+        reader_thread.join();
+        
+        assert(ok.load());
+        assert(reads.load() > 0);
+        assert(cell.reclaim() == 0);
+        assert(live_blocks.load() == 1);
+    }
+    assert(live_blocks.load() == 0);
+    
+    std::cout << "✓ RCU cell test passed\n";
+}
+
 int main() {
     std::cout << "\n========================================\n";
     std::cout << "   Advanced Data Structures Tests\n";
@@ -260,10 +938,20 @@ int main() {
     
     test_hashmap();
     test_hashmap_strings();
+    test_flat_hashmap();
+    test_symbol_table();
     test_circular_buffer();
+    test_circular_buffer_batch();
     test_circular_buffer_concurrent();
+    test_circular_buffer_batch_concurrent();
     test_memory_pool();
+    test_memory_pool_concurrent();
     test_bit_manipulation();
+    test_timestamp_calibration();
+    test_logger();
+    test_latency_histogram();
+    test_tick_to_trade();
+    test_rcu_cell();
     
     benchmark_hashmap();
     
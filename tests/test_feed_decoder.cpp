@@ -0,0 +1,875 @@
+#include "market_data/itch_decoder.h"
+#include "market_data/feed_arbitrator.h"
+#include "market_data/market_data_handler.h"
+#include "market_data/feed_journal.h"
+#include "market_data/feed_replay.h"
+#include "market_data/shm_book.h"
+#include <iostream>
+// The checks drive the code under test: keep them in release builds
+#undef NDEBUG
+#include <cassert>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace hft;
+
+// Minimal big-endian packet writer for building test feeds
+class PacketWriter {
+public:
+    void u8(uint8_t v) { buf_.push_back(static_cast<char>(v)); }
+    void u16(uint16_t v) { u8(v >> 8); u8(v & 0xFF); }
+    void u32(uint32_t v) { u16(v >> 16); u16(v & 0xFFFF); }
+    void u48(uint64_t v) { u16((v >> 32) & 0xFFFF); u32(v & 0xFFFFFFFF); }
+    void u64(uint64_t v) { u32(v >> 32); u32(v & 0xFFFFFFFF); }
+    void chars(const char* s, size_t n) {
+        size_t len = std::strlen(s);
+        for (size_t i = 0; i < n; ++i) {
+            u8(i < len ? s[i] : ' ');
+        }
+    }
+
+    void mold_header(uint64_t seq, uint16_t count) {
+        chars("SESSION01", 10);
+        u64(seq);
+        u16(count);
+    }
+
+    // Length prefix placeholder, filled by end_message()
+    void begin_message() { mark_ = buf_.size(); u16(0); }
+    void end_message() {
+        uint16_t len = static_cast<uint16_t>(buf_.size() - mark_ - 2);
+        buf_[mark_] = static_cast<char>(len >> 8);
+        buf_[mark_ + 1] = static_cast<char>(len & 0xFF);
+    }
+
+    void add_order(uint16_t locate, uint64_t ref, char side, uint32_t shares,
+                   const char* stock, uint32_t price) {
+        begin_message();
+        u8('A'); u16(locate); u16(0); u48(34200000000000ULL);
+        u64(ref); u8(side); u32(shares); chars(stock, 8); u32(price);
+        end_message();
+    }
+
+    void execute(uint16_t locate, uint64_t ref, uint32_t shares) {
+        begin_message();
+        u8('E'); u16(locate); u16(0); u48(34200000000001ULL);
+        u64(ref); u32(shares); u64(777);
+        end_message();
+    }
+
+    void cancel(uint16_t locate, uint64_t ref, uint32_t shares) {
+        begin_message();
+        u8('X'); u16(locate); u16(0); u48(0);
+        u64(ref); u32(shares);
+        end_message();
+    }
+
+    void remove(uint16_t locate, uint64_t ref) {
+        begin_message();
+        u8('D'); u16(locate); u16(0); u48(0);
+        u64(ref);
+        end_message();
+    }
+
+    void replace(uint16_t locate, uint64_t ref, uint64_t new_ref, uint32_t shares, uint32_t price) {
+        begin_message();
+        u8('U'); u16(locate); u16(0); u48(0);
+        u64(ref); u64(new_ref); u32(shares); u32(price);
+        end_message();
+    }
+
+    const char* data() const { return buf_.data(); }
+    size_t size() const { return buf_.size(); }
+
+private:
+    std::vector<char> buf_;
+    size_t mark_ = 0;
+};
+
+struct RecordingHandler : itch::NullHandler {
+    std::vector<itch::AddOrder> adds;
+    std::vector<itch::OrderExecuted> executions;
+    size_t deletes = 0;
+    size_t unhandled = 0;
+
+    void on_add_order(const itch::AddOrder& m) { adds.push_back(m); }
+    void on_order_executed(const itch::OrderExecuted& m) { executions.push_back(m); }
+    void on_order_delete(const itch::OrderDelete&) { ++deletes; }
+    void on_unhandled(const char*, size_t) { ++unhandled; }
+};
+
+void test_itch_decode() {
+    std::cout << "Testing ITCH 5.0 decoding over MoldUDP64...\n";
+
+    PacketWriter pkt;
+    pkt.mold_header(1000, 4);
+    pkt.add_order(7, 123456789012ULL, 'B', 300, "AAPL", 1502500);
+    pkt.execute(7, 123456789012ULL, 100);
+    pkt.remove(7, 123456789012ULL);
+
+    // Unknown type 'Z' must be skipped without breaking the walk
+    pkt.begin_message();
+    pkt.u8('Z'); pkt.u32(0);
+    pkt.end_message();
+
+    RecordingHandler handler;
+    feed::FeedDecoder<feed::MoldUDP64Framing, itch::Itch50, RecordingHandler> decoder(handler);
+
+    size_t n = decoder.decode(pkt.data(), pkt.size());
+    assert(n == 4);
+    assert(decoder.last_header().sequence == 1000);
+    assert(decoder.last_header().message_count == 4);
+    assert(decoder.malformed_packets() == 0);
+
+    assert(handler.adds.size() == 1);
+    const auto& add = handler.adds[0];
+    assert(add.stock_locate == 7);
+    assert(add.timestamp == 34200000000000ULL);
+    assert(add.order_ref == 123456789012ULL);
+    assert(add.side == 'B');
+    assert(add.shares == 300);
+    assert(std::memcmp(add.stock, "AAPL    ", 8) == 0);
+    assert(add.price == 1502500);
+
+    assert(handler.executions.size() == 1);
+    assert(handler.executions[0].executed_shares == 100);
+    assert(handler.executions[0].match_number == 777);
+    assert(handler.deletes == 1);
+    assert(handler.unhandled == 1);
+
+    // Truncated packet: complete messages are still decoded
+    n = decoder.decode(pkt.data(), pkt.size() - 3);
+    assert(n == 3);
+    assert(decoder.malformed_packets() == 1);
+    (void)n; (void)add;
+
+    std::cout << "✓ ITCH decode test passed\n";
+}
+
+void test_itch_book_building() {
+    std::cout << "Testing ITCH book building in MarketDataHandler...\n";
+
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    handler.set_feed_protocol(FeedProtocol::ITCH50_FRAMED);
+    handler.set_l3_capacity(1024);
+
+    int callbacks = 0;
+    handler.register_callback([&callbacks](const OrderBook&) { ++callbacks; });
+
+    PacketWriter pkt;
+    pkt.add_order(3, 1, 'B', 100, "AAPL", 1500000);   // 150.0000
+    pkt.add_order(3, 2, 'B', 200, "AAPL", 1499900);   // 149.9900
+    pkt.add_order(3, 3, 'S', 300, "AAPL", 1500100);   // 150.0100
+    pkt.add_order(4, 9, 'B', 100, "MSFT", 3000000);   // Not subscribed
+    pkt.execute(3, 1, 40);
+    pkt.cancel(3, 3, 100);
+    handler.process_message(pkt.data(), pkt.size());
+
+    assert(handler.messages_decoded() == 6);
+    assert(callbacks == 5);
+
+    OrderBook* book = handler.get_order_book("AAPL");
+    auto snap = book->get_snapshot();
+    assert(snap.bid_depth == 2 && snap.ask_depth == 1);
+    assert(std::abs(snap.best_bid() - 150.0) < 1e-9);
+    assert(snap.bids[0].quantity == 60.0);
+    assert(std::abs(snap.bids[1].price - 149.99) < 1e-9);
+    assert(std::abs(snap.best_ask() - 150.01) < 1e-9);
+    assert(snap.asks[0].quantity == 200.0);
+
+    // Delete the touch and replace the ask: the book follows
+    PacketWriter pkt2;
+    pkt2.remove(3, 1);
+    pkt2.replace(3, 3, 4, 50, 1500200);
+    handler.process_message(pkt2.data(), pkt2.size());
+
+    snap = book->get_snapshot();
+    assert(snap.bid_depth == 1);
+    assert(std::abs(snap.best_bid() - 149.99) < 1e-9);
+    assert(std::abs(snap.best_ask() - 150.02) < 1e-9);
+    assert(snap.asks[0].quantity == 50.0);
+
+    const L3OrderBook* l3 = handler.get_l3_book("AAPL");
+    assert(l3 && l3->order_count() == 2);
+    assert(handler.get_l3_book("MSFT") == nullptr);
+    (void)l3; (void)snap;
+
+    std::cout << "✓ ITCH book building test passed\n";
+}
+
+// MoldUDP64 packet with count delete messages starting at sequence
+// (order refs equal the message sequence numbers)
+PacketWriter mold_packet(uint64_t sequence, uint16_t count) {
+    PacketWriter pkt;
+    pkt.mold_header(sequence, count);
+    for (uint16_t i = 0; i < count; ++i) {
+        pkt.remove(1, sequence + i);
+    }
+    return pkt;
+}
+
+using Line = FeedArbitrator::Line;
+using Result = FeedArbitrator::Result;
+
+// Arbitrator under test plus the (sequence, count) of every delivery
+struct ArbitrationFixture {
+    struct Delivery {
+        uint64_t sequence;
+        uint16_t count;
+        size_t len;
+    };
+    
+    std::vector<Delivery> delivered;
+    std::unique_ptr<FeedArbitrator> arb;
+    
+    ArbitrationFixture() {
+        arb = std::make_unique<FeedArbitrator>([this](const char* data, size_t len) {
+            delivered.push_back({feed::read_be64(data + 10), feed::read_be16(data + 18), len});
+        });
+        arb->set_expected_sequence(1);
+    }
+    
+    Result send(Line line, uint64_t sequence, uint16_t count = 1) {
+        PacketWriter pkt = mold_packet(sequence, count);
+        return arb->on_packet(line, pkt.data(), pkt.size());
+    }
+    
+    // Deliveries must be contiguous from sequence 1
+    bool contiguous_to(uint64_t end) const {
+        uint64_t next = 1;
+        for (const auto& d : delivered) {
+            if (d.sequence != next) {
+                return false;
+            }
+            next += d.count;
+        }
+        return next == end;
+    }
+};
+
+void test_ab_arbitration() {
+    std::cout << "Testing A/B line arbitration...\n";
+    
+    ArbitrationFixture f;
+    
+    // Both lines carry 1..4, either may be faster
+    assert(f.send(Line::A, 1) == Result::DELIVERED);
+    assert(f.send(Line::B, 1) == Result::DUPLICATE);
+    assert(f.send(Line::B, 2) == Result::DELIVERED);
+    assert(f.send(Line::A, 2) == Result::DUPLICATE);
+    
+    // A drops 3: its 4 waits until B's 3 arrives, nothing is requested
+    assert(f.send(Line::A, 4) == Result::BUFFERED);
+    assert(f.arb->in_recovery());
+    assert(f.send(Line::B, 3) == Result::DELIVERED);
+    assert(f.send(Line::B, 4) == Result::DUPLICATE);
+    assert(!f.arb->in_recovery());
+    
+    assert(f.contiguous_to(5));
+    const auto& stats = f.arb->stats();
+    assert(stats.first[0] == 2 && stats.first[1] == 2); // A: 1, 4  B: 2, 3
+    assert(stats.replayed == 1);
+    assert(stats.duplicates == 3);
+    assert(stats.gaps == 1);
+    assert(stats.retransmit_requests == 0);
+    (void)stats;
+    
+    std::cout << "✓ A/B arbitration test passed\n";
+}
+
+void test_gap_retransmission() {
+    std::cout << "Testing gap retransmission and replay...\n";
+    
+    ArbitrationFixture f;
+    f.arb->set_gap_tolerance(1);
+    f.arb->set_retransmit_timeout(1000, 2);
+    
+    uint64_t req_sequence = 0;
+    uint16_t req_count = 0;
+    int requests = 0;
+    f.arb->set_retransmit_callback([&](const char* session, uint64_t sequence, uint16_t count) {
+        assert(std::memcmp(session, "SESSION01 ", 10) == 0);
+        req_sequence = sequence;
+        req_count = count;
+        ++requests;
+        (void)session;
+    });
+    
+    f.send(Line::A, 1);
+    
+    // Both lines lost 2..3
+    assert(f.send(Line::A, 4) == Result::BUFFERED);
+    assert(requests == 0);
+    assert(f.send(Line::B, 4) == Result::BUFFERED);
+    assert(requests == 1 && req_sequence == 2 && req_count == 2);
+    assert(f.send(Line::A, 5, 2) == Result::BUFFERED);
+    assert(requests == 1);
+    
+    // Unanswered request is re-sent after the timeout
+    f.arb->poll(100);
+    f.arb->poll(500);
+    assert(requests == 1);
+    f.arb->poll(1100);
+    assert(requests == 2);
+    
+    // Retransmission overlaps what we have (1..3): trimmed to 2..3,
+    // then 4 and 5..6 are replayed from the buffer
+    assert(f.send(Line::RECOVERY, 1, 3) == Result::DELIVERED);
+    assert(f.delivered[1].sequence == 2 && f.delivered[1].count == 2);
+    assert(f.delivered[1].len == 20 + 2 * 21);
+    assert(f.contiguous_to(7));
+    assert(!f.arb->in_recovery());
+    assert(f.arb->buffered() == 0);
+    assert(f.arb->stats().replayed == 2);
+    (void)req_sequence; (void)req_count;
+    
+    std::cout << "✓ Gap retransmission test passed\n";
+}
+
+void test_interleaved_gap() {
+    std::cout << "Testing a gap filled across interleaved lines...\n";
+    
+    // A loses 2..3 and delivers 4, B loses 2 and delivers 3: the held
+    // packets arrive out of order and are replayed in sequence
+    ArbitrationFixture f;
+    f.arb->set_gap_tolerance(1);
+    std::vector<std::pair<uint64_t, uint16_t>> requests;
+    f.arb->set_retransmit_callback([&](const char*, uint64_t sequence, uint16_t count) {
+        requests.emplace_back(sequence, count);
+    });
+    
+    f.send(Line::A, 1);
+    assert(f.send(Line::A, 4) == Result::BUFFERED);
+    assert(f.send(Line::B, 3) == Result::BUFFERED);
+    assert(requests.size() == 1 && requests[0].first == 2 && requests[0].second == 1);
+    assert(f.send(Line::RECOVERY, 2) == Result::DELIVERED);
+    assert(f.contiguous_to(5));
+    assert(requests.size() == 1);          // 3 was already held
+    assert(!f.arb->in_recovery());
+    assert(f.arb->buffered() == 0);
+    assert(f.arb->stats().replayed == 2);
+    
+    // No recovery configured: only the truly missing message is lost
+    ArbitrationFixture g;
+    g.send(Line::A, 1);
+    g.send(Line::A, 4);
+    g.send(Line::B, 3);
+    g.send(Line::B, 5);
+    assert(g.arb->stats().lost_messages == 1);
+    assert(g.delivered.size() == 4);
+    assert(g.delivered[1].sequence == 3 && g.delivered[2].sequence == 4);
+    assert(g.arb->expected_sequence() == 6);
+    
+    std::cout << "✓ Interleaved gap test passed\n";
+}
+
+void test_snapshot_recovery() {
+    std::cout << "Testing snapshot recovery...\n";
+    
+    ArbitrationFixture f;
+    f.arb->set_gap_tolerance(0);
+    f.arb->set_retransmit_timeout(10, 1);
+    
+    int requests = 0;
+    f.arb->set_retransmit_callback([&](const char*, uint64_t, uint16_t) { ++requests; });
+    
+    // Snapshot covers everything up to and including sequence 4
+    bool snapshot_ready = false;
+    int snapshot_calls = 0;
+    f.arb->set_snapshot_callback([&](uint64_t& next_sequence) {
+        ++snapshot_calls;
+        next_sequence = 5;
+        return snapshot_ready;
+    });
+    
+    f.send(Line::A, 1);
+    for (uint64_t seq = 3; seq <= 6; ++seq) {
+        f.send(Line::A, seq);
+    }
+    assert(requests == 1);
+    
+    // Retransmission never comes: escalate to a snapshot, retried until ready
+    f.arb->poll(1);
+    f.arb->poll(20);
+    assert(snapshot_calls == 1);
+    assert(f.arb->in_recovery());
+    
+    snapshot_ready = true;
+    f.arb->poll(30);
+    assert(snapshot_calls == 2);
+    assert(!f.arb->in_recovery());
+    
+    // 3 and 4 were covered by the snapshot, 5 and 6 replayed on top
+    assert(f.delivered.size() == 3);
+    assert(f.delivered[1].sequence == 5 && f.delivered[2].sequence == 6);
+    assert(f.arb->expected_sequence() == 7);
+    assert(f.arb->stats().snapshots == 1);
+    assert(f.arb->stats().duplicates == 2);
+    
+    std::cout << "✓ Snapshot recovery test passed\n";
+}
+
+void test_unrecoverable_gap() {
+    std::cout << "Testing unrecoverable gap and buffer overflow...\n";
+    
+    // No recovery configured: the stream resumes after the hole
+    ArbitrationFixture f;
+    f.send(Line::A, 1);
+    f.send(Line::A, 3);
+    f.send(Line::A, 4);
+    assert(f.delivered.size() == 1);
+    f.send(Line::A, 5);
+    assert(f.delivered.size() == 4);
+    assert(f.arb->stats().lost_messages == 1);
+    assert(!f.arb->in_recovery());
+    
+    // Snapshot never ready while the gap outgrows the buffer: oldest
+    // packets are evicted, the newest are kept for replay
+    ArbitrationFixture g;
+    g.arb->set_gap_tolerance(1u << 20);
+    g.arb->set_snapshot_callback([](uint64_t&) { return false; });
+    g.send(Line::A, 1);
+    constexpr uint64_t LAST = 2 + FeedArbitrator::BUFFER_PACKETS + 50;
+    for (uint64_t seq = 3; seq <= LAST; ++seq) {
+        g.send(Line::A, seq);
+    }
+    assert(g.arb->buffered() == FeedArbitrator::BUFFER_PACKETS);
+    assert(g.arb->stats().dropped > 0);
+    assert(g.arb->in_recovery());
+    (void)LAST;
+    
+    std::cout << "✓ Unrecoverable gap test passed\n";
+}
+
+// Mirrors MarketDataHandler's packed record layout
+struct Record {
+    char symbol[16];
+    uint8_t side;
+    uint8_t level;
+    double price;
+    double quantity;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+void test_simple_multi_message() {
+    std::cout << "Testing multiple simple messages per datagram...\n";
+
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+
+    Record records[3] = {};
+    for (int i = 0; i < 3; ++i) {
+        std::strcpy(records[i].symbol, "AAPL");
+        records[i].side = i == 2 ? 1 : 0;
+        records[i].level = i == 2 ? 0 : i;
+        records[i].price = 100.0 - i;
+        records[i].quantity = 10.0;
+    }
+    handler.process_message(reinterpret_cast<const char*>(records), sizeof(records), 555000111ULL);
+
+    auto snap = handler.get_order_book("AAPL")->get_snapshot();
+    assert(handler.messages_decoded() == 3);
+    assert(snap.bid_depth == 2 && snap.ask_depth == 1);
+    assert(snap.bids[1].price == 99.0);
+    assert(snap.rx_timestamp_ns == 555000111ULL);
+    (void)snap;
+
+    std::cout << "✓ Simple multi-message test passed\n";
+}
+
+void test_book_depth() {
+    std::cout << "Testing configured book depth...\n";
+
+    // SIMPLE: levels past the depth are dropped
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    handler.set_book_depth(2);
+    Record records[3] = {};
+    for (int i = 0; i < 3; ++i) {
+        std::strcpy(records[i].symbol, "AAPL");
+        records[i].level = static_cast<uint8_t>(i);
+        records[i].price = 100.0 - i;
+        records[i].quantity = 10.0;
+    }
+    handler.process_message(reinterpret_cast<const char*>(records), sizeof(records));
+    auto snap = handler.get_order_book("AAPL")->get_snapshot();
+    assert(handler.messages_decoded() == 3 && snap.bid_depth == 2);
+
+    // ITCH: the L3 book keeps every level, the OrderBook gets the depth
+    MarketDataHandler itch;
+    itch.add_symbol("AAPL");
+    itch.set_feed_protocol(FeedProtocol::ITCH50_FRAMED);
+    itch.set_l3_capacity(1024);
+    itch.set_book_depth(2);
+    PacketWriter pkt;
+    pkt.add_order(3, 1, 'B', 100, "AAPL", 1500000);
+    pkt.add_order(3, 2, 'B', 100, "AAPL", 1499900);
+    pkt.add_order(3, 3, 'B', 100, "AAPL", 1499800);
+    itch.process_message(pkt.data(), pkt.size());
+    snap = itch.get_order_book("AAPL")->get_snapshot();
+    assert(snap.bid_depth == 2 && std::abs(snap.bids[1].price - 149.99) < 1e-9);
+    assert(itch.get_l3_book("AAPL")->levels().level_count(OrderBook::Side::BID) == 3);
+
+    // Clamped to what an OrderBook holds
+    itch.set_book_depth(50);
+    assert(itch.book_depth() == OrderBook::MAX_DEPTH);
+    itch.set_book_depth(0);
+    assert(itch.book_depth() == 1);
+    (void)snap;
+
+    std::cout << "✓ Book depth test passed\n";
+}
+
+void test_many_symbols() {
+    std::cout << "Testing 12k interned symbols...\n";
+
+    MarketDataHandler handler(12000);
+    char name[16];
+    for (uint32_t i = 0; i < 12000; ++i) {
+        std::snprintf(name, sizeof(name), "SYM%05u", i);
+        assert(handler.add_symbol(name) == i);
+    }
+    assert(handler.add_symbol("SYM00007") == 7);
+    assert(handler.add_symbol("EXTRA") == SymbolTable::NO_SYMBOL);
+    assert(handler.symbol_count() == 12000 && handler.max_symbols() == 12000);
+    assert(handler.symbol_id("SYM11999") == 11999);
+    assert(handler.get_order_book(11999u) == handler.get_order_book("SYM11999"));
+    assert(handler.get_order_book(12000u) == nullptr);
+
+    // Bytes after the symbol's NUL do not matter; unknown symbols are dropped
+    Record records[2] = {};
+    std::memset(records[0].symbol, '#', sizeof(records[0].symbol));
+    std::memcpy(records[0].symbol, "SYM04321", 9);
+    records[0].price = 42.0;
+    records[0].quantity = 5.0;
+    std::strcpy(records[1].symbol, "SYM12000");
+    records[1].price = 43.0;
+    records[1].quantity = 5.0;
+    handler.process_message(reinterpret_cast<const char*>(records), sizeof(records));
+
+    auto snap = handler.get_order_book(handler.symbol_id("SYM04321"))->get_snapshot();
+    assert(snap.bid_depth == 1 && snap.bids[0].price == 42.0);
+    assert(handler.get_order_book("SYM04322")->get_snapshot().bid_depth == 0);
+    (void)snap;
+
+    std::cout << "✓ Many symbols test passed\n";
+}
+
+// One ITCH session: adds, executions, cancels and replaces over a few books
+std::vector<PacketWriter> itch_session(size_t packets) {
+    std::vector<PacketWriter> session(packets);
+    const char* symbols[] = {"AAPL", "MSFT"};
+    for (size_t i = 0; i < packets; ++i) {
+        PacketWriter& pkt = session[i];
+        uint16_t locate = static_cast<uint16_t>(1 + i % 2);
+        uint64_t ref = 1000 + i;
+        uint32_t price = static_cast<uint32_t>(1500000 + (i % 7) * 100);
+        pkt.add_order(locate, ref, i % 3 == 0 ? 'S' : 'B', 100 + static_cast<uint32_t>(i), symbols[i % 2], price);
+        if (i >= 4 && i % 4 == 0) {
+            pkt.execute(locate, ref - 4, 30);
+        }
+        if (i >= 6 && i % 6 == 0) {
+            pkt.cancel(locate, ref - 6, 20);
+        }
+        if (i >= 10 && i % 10 == 0) {
+            pkt.replace(locate, ref - 2, 100000 + i, 75, price + 200);
+        }
+    }
+    return session;
+}
+
+std::unique_ptr<MarketDataHandler> itch_handler() {
+    auto handler = std::make_unique<MarketDataHandler>();
+    handler->add_symbol("AAPL");
+    handler->add_symbol("MSFT");
+    handler->set_feed_protocol(FeedProtocol::ITCH50_FRAMED);
+    handler->set_l3_capacity(1024);
+    return handler;
+}
+
+bool same_books(MarketDataHandler& a, MarketDataHandler& b) {
+    for (const char* symbol : {"AAPL", "MSFT"}) {
+        auto x = a.get_order_book(symbol)->get_snapshot();
+        auto y = b.get_order_book(symbol)->get_snapshot();
+        if (x.bid_depth != y.bid_depth || x.ask_depth != y.ask_depth) {
+            return false;
+        }
+        for (size_t i = 0; i < x.bid_depth; ++i) {
+            if (x.bids[i].price != y.bids[i].price || x.bids[i].quantity != y.bids[i].quantity) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < x.ask_depth; ++i) {
+            if (x.asks[i].price != y.asks[i].price || x.asks[i].quantity != y.asks[i].quantity) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_feed_journal() {
+    std::cout << "Testing feed capture journal...\n";
+
+    std::string path = "/tmp/test_feed_journal_" + std::to_string(getpid()) + ".jrnl";
+    std::vector<PacketWriter> session = itch_session(40);
+    const uint64_t T0 = 1700000000000000000ULL;
+
+    FeedJournalWriter writer;
+    assert(writer.open(path, 1 << 20));
+    for (size_t i = 0; i < session.size(); ++i) {
+        assert(writer.append(session[i].data(), session[i].size(), T0 + i * 1000));
+        if (i == session.size() / 2) {
+            // Empty datagram: refused, so the records after it still replay
+            assert(!writer.append(session[i].data(), 0, T0 + i * 1000));
+        }
+    }
+    assert(writer.records() == session.size() && writer.dropped() == 1);
+    writer.close();
+
+    // Records come back byte for byte, in order, with their timestamps
+    FeedJournalReader reader;
+    assert(reader.open(path));
+    assert(reader.records() == session.size());
+    FeedJournalReader::Record record;
+    size_t offset = 0;
+    size_t count = 0;
+    size_t last_offset = 0;
+    while (reader.next(offset, record)) {
+        assert(record.len == session[count].size());
+        assert(std::memcmp(record.data, session[count].data(), record.len) == 0);
+        assert(record.timestamp_ns == T0 + count * 1000);
+        assert(offset % 8 == 0);
+        last_offset = offset - journal::record_size(record.len);
+        ++count;
+    }
+    assert(count == session.size());
+    reader.close();
+
+    // Cut inside the last record (a crash mid-write): everything before it
+    // still reads
+    assert(truncate(path.c_str(), static_cast<off_t>(sizeof(journal::FileHeader) + last_offset + 20)) == 0);
+    assert(reader.open(path));
+    offset = 0;
+    count = 0;
+    while (reader.next(offset, record)) {
+        ++count;
+    }
+    assert(count == session.size() - 1);
+    reader.close();
+
+    // Full journal: packets are refused and counted, nothing is overwritten
+    size_t first = journal::record_size(session[0].size());
+    assert(writer.open(path, first + journal::record_size(session[1].size())));
+    assert(writer.append(session[0].data(), session[0].size(), T0));
+    assert(writer.append(session[1].data(), session[1].size(), T0 + 1));
+    assert(!writer.append(session[2].data(), session[2].size(), T0 + 2));
+    assert(writer.records() == 2 && writer.dropped() == 1);
+    writer.close();
+    assert(reader.open(path));
+    offset = 0;
+    count = 0;
+    while (reader.next(offset, record)) {
+        ++count;
+    }
+    assert(count == 2);
+    reader.close();
+
+    // Not a journal
+    FILE* f = std::fopen(path.c_str(), "w");
+    std::fputs("definitely not a journal, but long enough to hold a header.......", f);
+    std::fclose(f);
+    assert(!reader.open(path));
+    assert(!reader.is_open());
+
+    unlink(path.c_str());
+    (void)record; (void)last_offset; (void)first;
+
+    std::cout << "✓ Feed journal test passed\n";
+}
+
+void test_feed_replay() {
+    std::cout << "Testing deterministic feed replay...\n";
+
+    std::string path = "/tmp/test_feed_replay_" + std::to_string(getpid()) + ".jrnl";
+    std::vector<PacketWriter> session = itch_session(200);
+    const uint64_t T0 = 1700000000000000000ULL;
+    const uint64_t SPACING_NS = 100000;                 // 20 ms session
+
+    // Live run, captured as it goes
+    std::unique_ptr<MarketDataHandler> live = itch_handler();
+    FeedJournalWriter writer;
+    assert(writer.open(path, 1 << 20));
+    for (size_t i = 0; i < session.size(); ++i) {
+        writer.append(session[i].data(), session[i].size(), T0 + i * SPACING_NS);
+        live->process_message(session[i].data(), session[i].size(), T0 + i * SPACING_NS);
+    }
+    writer.close();
+
+    FeedJournalReader reader;
+    assert(reader.open(path));
+
+    // As fast as possible: same books, same message count
+    std::unique_ptr<MarketDataHandler> replayed = itch_handler();
+    FeedReplayer fast(*replayed);
+    fast.set_speed(0);
+    FeedReplayer::Stats stats = fast.replay(reader);
+    assert(stats.packets == session.size());
+    assert(replayed->messages_decoded() == live->messages_decoded());
+    assert(same_books(*live, *replayed));
+
+    // Twice the original pacing: roughly half the session length
+    std::unique_ptr<MarketDataHandler> paced = itch_handler();
+    FeedReplayer replayer(*paced);
+    replayer.set_speed(2.0);
+    stats = replayer.replay(reader);
+    uint64_t span_ns = (session.size() - 1) * SPACING_NS / 2;
+    assert(stats.packets == session.size());
+    assert(stats.elapsed_ns >= span_ns);
+    assert(same_books(*live, *paced));
+    std::cout << "  paced replay: " << stats.elapsed_ns / 1000 << " us for a " << span_ns / 1000
+              << " us schedule, at most " << stats.max_lateness_ns / 1000 << " us late\n";
+
+    // A cleared run flag stops it before the first packet
+    std::atomic<bool> running{false};
+    stats = replayer.replay(reader, &running);
+    assert(stats.packets == 0);
+
+    reader.close();
+    unlink(path.c_str());
+    (void)stats; (void)span_ns;
+
+    std::cout << "✓ Feed replay test passed\n";
+}
+
+Record simple_record(const char* symbol, uint8_t side, double price, double quantity) {
+    Record record = {};
+    std::strcpy(record.symbol, symbol);
+    record.side = side;
+    record.price = price;
+    record.quantity = quantity;
+    return record;
+}
+
+void test_shm_books() {
+    std::cout << "Testing shared memory book publication...\n";
+
+    std::string name = "/hft_test_books_" + std::to_string(getpid());
+    ShmBookReader reader;
+    assert(!reader.open(name));
+
+    ShmBookPublisher publisher;
+    assert(publisher.open(name, 8, 8));
+    MarketDataHandler handler(8);
+    handler.add_symbol("AAPL");
+    handler.add_symbol("MSFT");
+    handler.set_publisher(&publisher);
+    handler.add_symbol("GOOG");            // Named as it is added
+
+    assert(reader.open(name));
+    assert(reader.symbols() == 3 && reader.max_symbols() == 8);
+    assert(reader.find("GOOG") == 2 && reader.find("NOPE") == ShmBookReader::NO_SYMBOL);
+    uint32_t id;
+    assert(!reader.poll(id));
+
+    Record records[3] = {simple_record("AAPL", 0, 150.0, 100.0),
+                         simple_record("MSFT", 1, 300.0, 50.0),
+                         simple_record("GOOG", 0, 140.0, 10.0)};
+    handler.process_message(reinterpret_cast<const char*>(records), sizeof(records), 1234);
+    assert(publisher.published() == 3 && reader.pending() == 3);
+
+    // Notices in publish order, then the books as the handler has them
+    for (uint32_t expected = 0; expected < 3; ++expected) {
+        assert(reader.poll(id) && id == expected);
+    }
+    assert(!reader.poll(id));
+    OrderBook::Snapshot snap;
+    assert(reader.read(0, snap));
+    assert(snap.bid_depth == 1 && snap.bids[0].price == 150.0 && snap.bids[0].quantity == 100.0);
+    assert(snap.ask_depth == 0 && snap.rx_timestamp_ns == 1234 && (snap.version & 1) == 0);
+    OrderBook::Top top;
+    assert(reader.read_top(1, top));
+    assert(top.ask_depth == 1 && top.best_ask() == 300.0 && top.ask_quantity == 50.0 && top.bid_depth == 0);
+    assert(!reader.read(3, snap));
+
+    // Another process maps the region, sees the books and follows notices
+    int ready[2];
+    int piped = pipe(ready);
+    assert(piped == 0);
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        ShmBookReader remote;
+        bool ok = remote.open(name) && remote.read_top(remote.find("AAPL"), top) && top.best_bid() == 150.0;
+        char byte = 1;
+        ok = ok && write(ready[1], &byte, 1) == 1;
+        uint64_t deadline = Timestamp::wall_clock_ns() + 5000000000ULL;
+        while (ok && !remote.poll(id)) {
+            ok = Timestamp::wall_clock_ns() < deadline;
+        }
+        ok = ok && id == 1 && remote.read(1, snap) && snap.asks[0].price == 299.5;
+        _exit(ok ? 0 : 1);
+    }
+    char byte;
+    ssize_t signaled = read(ready[0], &byte, 1);
+    assert(signaled == 1);
+    Record update = simple_record("MSFT", 1, 299.5, 20.0);
+    handler.process_message(reinterpret_cast<const char*>(&update), sizeof(update));
+    int status = 0;
+    pid_t waited = waitpid(child, &status, 0);
+    assert(waited == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    close(ready[0]);
+    close(ready[1]);
+    assert(reader.poll(id) && id == 1);
+
+    // A reader lapped by the 8-notice ring is told to resync, once
+    for (int i = 0; i < 20; ++i) {
+        handler.process_message(reinterpret_cast<const char*>(&records[i % 3]), sizeof(Record));
+    }
+    assert(reader.poll(id) && id == ShmBookReader::RESYNC && reader.lapped() == 1);
+    assert(!reader.poll(id) && reader.pending() == 0);
+
+    // Shutdown: mapped readers see it, new ones find nothing
+    handler.set_publisher(nullptr);
+    publisher.close();
+    assert(reader.publisher_closed());
+    ShmBookReader late;
+    assert(!late.open(name));
+    (void)piped; (void)signaled; (void)byte; (void)waited; (void)status;
+
+    std::cout << "✓ Shared memory books test passed\n";
+}
+
+int main() {
+    std::cout << "\n========================================\n";
+    std::cout << "   Feed Decoder Tests\n";
+    std::cout << "========================================\n\n";
+
+    test_itch_decode();
+    test_itch_book_building();
+    test_simple_multi_message();
+    test_book_depth();
+    test_many_symbols();
+    test_ab_arbitration();
+    test_gap_retransmission();
+    test_interleaved_gap();
+    test_snapshot_recovery();
+    test_unrecoverable_gap();
+    test_feed_journal();
+    test_feed_replay();
+    test_shm_books();
+
+    std::cout << "\n✓ All feed decoder tests passed!\n\n";
+
+    return 0;
+}
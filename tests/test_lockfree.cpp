@@ -1,8 +1,12 @@
+#include "common/circular_buffer.h"
 #include <atomic>
 #include <thread>
 #include <vector>
 #include <iostream>
+// Release (the default build) defines NDEBUG: keep the checks
+#undef NDEBUG
 #include <cassert>
+#include <memory>
 
 // Test lock-free queue (SPSC - Single Producer Single Consumer)
 template<typename T, size_t Size>
@@ -81,6 +85,57 @@ void test_spsc_queue() {
     std::cout << "✓ SPSC queue test passed\n";
 }
 
+// The MPSC ring from common/circular_buffer.h: several producers, every
+// item delivered once, and the ring reusable after filling up
+void test_mpsc_queue() {
+    std::cout << "Testing MPSC lock-free queue...\n";
+    
+    auto queue = std::make_unique<hft::MPSCCircularBuffer<int, 64>>();
+    
+    // Fills to capacity, then refuses
+    for (int i = 0; i < 64; ++i) {
+        assert(queue->push(i));
+    }
+    assert(!queue->push(64));
+    int item;
+    for (int i = 0; i < 64; ++i) {
+        assert(queue->pop(item) && item == i);
+    }
+    assert(!queue->pop(item));
+    
+    constexpr int PRODUCERS = 3;
+    constexpr int ITEMS = 100000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < ITEMS; ++i) {
+                while (!queue->push(p * ITEMS + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    
+    // Per producer, items arrive in push order
+    std::vector<int> next(PRODUCERS, 0);
+    for (int count = 0; count < PRODUCERS * ITEMS;) {
+        if (queue->pop(item)) {
+            int p = item / ITEMS;
+            assert(item % ITEMS == next[p]);
+            ++next[p];
+            ++count;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    assert(!queue->pop(item));
+    
+    std::cout << "✓ MPSC queue test passed\n";
+}
+
 void test_atomic_operations() {
     std::cout << "Testing atomic operations and memory ordering...\n";
     
@@ -137,6 +192,7 @@ int main() {
     std::cout << "========================================\n\n";
     
     test_spsc_queue();
+    test_mpsc_queue();
     test_atomic_operations();
     test_memory_ordering();
     
@@ -0,0 +1,735 @@
+#include "network/udp_receiver.h"
+#include "network/socket_transport.h"
+#include "network/xdp_transport.h"
+#include "network/tcp_sender.h"
+#include "network/ouch_encoder.h"
+#include "common/timestamp.h"
+#include <iostream>
+// The checks drive the code under test: keep them in release builds
+#undef NDEBUG
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace hft;
+
+// Ethernet/IPv4/UDP frame around a payload
+std::vector<char> udp_frame(const std::string& payload, uint32_t dst_ip, uint16_t dst_port,
+                            bool vlan = false, size_t ip_options = 0) {
+    std::vector<char> f;
+    auto u8 = [&](uint8_t v) { f.push_back(static_cast<char>(v)); };
+    auto u16 = [&](uint16_t v) { u8(v >> 8); u8(v & 0xFF); };
+    auto u32 = [&](uint32_t v) { u16(v >> 16); u16(v & 0xFFFF); };
+
+    for (int i = 0; i < 12; ++i) u8(0xAA);               // MACs
+    if (vlan) { u16(0x8100); u16(42); }
+    u16(0x0800);
+
+    size_t ihl = (20 + ip_options) / 4;
+    u8(static_cast<uint8_t>(0x40 | ihl)); u8(0);
+    u16(static_cast<uint16_t>(ihl * 4 + 8 + payload.size()));
+    u16(0); u16(0x4000);                                  // Don't fragment
+    u8(64); u8(17); u16(0);
+    u32(0x0A000001); u32(dst_ip);
+    for (size_t i = 0; i < ip_options; ++i) u8(1);        // NOP options
+
+    u16(40000); u16(dst_port);
+    u16(static_cast<uint16_t>(8 + payload.size())); u16(0);
+    f.insert(f.end(), payload.begin(), payload.end());
+    return f;
+}
+
+void test_parse_udp_frame() {
+    std::cout << "Testing raw frame parsing...\n";
+
+    uint32_t ip = 0;
+    uint16_t port = 0;
+    const char* payload = nullptr;
+    size_t len = 0;
+
+    auto plain = udp_frame("HELLO", 0xEF010101, 9000);
+    assert(parse_udp_frame(plain.data(), plain.size(), ip, port, payload, len));
+    assert(ip == 0xEF010101 && port == 9000);
+    assert(len == 5 && std::memcmp(payload, "HELLO", 5) == 0);
+
+    auto tagged = udp_frame("VLAN", 0xEF010102, 9001, true, 8);
+    assert(parse_udp_frame(tagged.data(), tagged.size(), ip, port, payload, len));
+    assert(ip == 0xEF010102 && port == 9001);
+    assert(len == 4 && std::memcmp(payload, "VLAN", 4) == 0);
+
+    // Trailing Ethernet padding is not payload
+    auto padded = udp_frame("X", 0xEF010101, 9000);
+    padded.resize(60, 0);
+    assert(parse_udp_frame(padded.data(), padded.size(), ip, port, payload, len));
+    assert(len == 1);
+
+    // Fragments, non-UDP and truncated frames are rejected
+    auto fragment = udp_frame("FRAG", 0xEF010101, 9000);
+    fragment[20] = 0x20;                                  // More fragments
+    assert(!parse_udp_frame(fragment.data(), fragment.size(), ip, port, payload, len));
+
+    auto tcp = udp_frame("TCP", 0xEF010101, 9000);
+    tcp[23] = 6;
+    assert(!parse_udp_frame(tcp.data(), tcp.size(), ip, port, payload, len));
+
+    auto truncated = udp_frame("TRUNCATED", 0xEF010101, 9000);
+    assert(!parse_udp_frame(truncated.data(), truncated.size() - 3, ip, port, payload, len));
+
+    auto arp = udp_frame("ARP", 0xEF010101, 9000);
+    arp[12] = 0x08; arp[13] = 0x06;
+    assert(!parse_udp_frame(arp.data(), arp.size(), ip, port, payload, len));
+
+    std::cout << "✓ Raw frame parsing test passed\n";
+}
+
+void test_socket_transport_loopback() {
+    std::cout << "Testing socket transport over loopback...\n";
+
+    // Stand-in rerequest server on an ephemeral port
+    int server = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(server >= 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    int rc = bind(server, (struct sockaddr*)&addr, sizeof(addr));
+    assert(rc == 0);
+    socklen_t addr_len = sizeof(addr);
+    getsockname(server, (struct sockaddr*)&addr, &addr_len);
+
+    SocketTransport::Options options;
+    options.batch_size = 4;
+    options.timestamping = RxTimestamping::SOFTWARE;
+    SocketTransport transport(options);
+    int source = transport.open_unicast("127.0.0.1", ntohs(addr.sin_port));
+    assert(source == 0);
+    assert(transport.start());
+
+    // Nothing pending: a sweep returns at once
+    RxPacket packets[8];
+    assert(transport.receive(packets, 8, 0) == 0);
+
+    assert(transport.send(source, "REQ", 3));
+    char buffer[64];
+    struct sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+    ssize_t n = recvfrom(server, buffer, sizeof(buffer), 0, (struct sockaddr*)&peer, &peer_len);
+    assert(n == 3 && std::memcmp(buffer, "REQ", 3) == 0);
+
+    // Six replies: drained in batches of at most four
+    uint64_t sent_ns = Timestamp::wall_clock_ns();
+    for (int i = 0; i < 6; ++i) {
+        char reply = static_cast<char>('0' + i);
+        sendto(server, &reply, 1, 0, (struct sockaddr*)&peer, peer_len);
+    }
+
+    std::string received;
+    for (int attempt = 0; attempt < 100 && received.size() < 6; ++attempt) {
+        int count = transport.receive(packets, 8, 10);
+        assert(count >= 0 && count <= 4);
+        for (int i = 0; i < count; ++i) {
+            assert(packets[i].source == static_cast<uint32_t>(source));
+            assert(packets[i].len == 1);
+            // Kernel stamp taken on arrival, before we looked. The kernel
+            // may not have switched receive stamping on yet: 0, not captured.
+            uint64_t stamp = packets[i].rx_timestamp_ns;
+            assert(stamp == 0 || (stamp >= sent_ns && stamp <= Timestamp::wall_clock_ns()));
+            received.push_back(packets[i].data[0]);
+        }
+    }
+    assert(received == "012345");
+    assert(transport.syscalls() > 0);
+
+    transport.close();
+    ::close(server);
+    (void)rc;
+    (void)n;
+    (void)sent_ns;
+
+    std::cout << "✓ Socket transport loopback test passed\n";
+}
+
+void test_socket_transport_shared_port() {
+    std::cout << "Testing multicast channels sharing a port...\n";
+
+    // Two channels on one port, different groups
+    SocketTransport transport;
+    int port = 0;
+    {
+        // Free port for the channels
+        int probe = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        bind(probe, (struct sockaddr*)&addr, sizeof(addr));
+        socklen_t addr_len = sizeof(addr);
+        getsockname(probe, (struct sockaddr*)&addr, &addr_len);
+        port = ntohs(addr.sin_port);
+        ::close(probe);
+    }
+    int x = transport.open_multicast("239.255.42.1", static_cast<uint16_t>(port));
+    int y = transport.open_multicast("239.255.42.2", static_cast<uint16_t>(port));
+    if (x < 0 || y < 0 || !transport.start()) {
+        std::cout << "  (no multicast route, skipped)\n";
+        return;
+    }
+
+    // One datagram per group, looped back to this host
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    auto send_to = [&](const char* group, char payload) {
+        struct sockaddr_in dst;
+        std::memset(&dst, 0, sizeof(dst));
+        dst.sin_family = AF_INET;
+        dst.sin_addr.s_addr = inet_addr(group);
+        dst.sin_port = htons(static_cast<uint16_t>(port));
+        return sendto(sender, &payload, 1, 0, (struct sockaddr*)&dst, sizeof(dst)) == 1;
+    };
+    if (!send_to("239.255.42.1", 'X') || !send_to("239.255.42.2", 'Y')) {
+        std::cout << "  (no multicast route, skipped)\n";
+        ::close(sender);
+        return;
+    }
+
+    // Each channel sees its own group once, never the other's
+    RxPacket packets[8];
+    std::string seen[2];
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        int count = transport.receive(packets, 8, 10);
+        for (int i = 0; i < count; ++i) {
+            assert(packets[i].source < 2 && packets[i].len == 1);
+            seen[packets[i].source].push_back(packets[i].data[0]);
+        }
+    }
+    if (seen[x].empty() && seen[y].empty()) {
+        std::cout << "  (multicast not looped back, skipped)\n";
+    } else {
+        assert(seen[x] == "X");
+        assert(seen[y] == "Y");
+    }
+
+    ::close(sender);
+    transport.close();
+
+    std::cout << "✓ Shared port multicast test passed\n";
+}
+
+// Scripted transport driving UDPReceiver without a network
+class ScriptedTransport : public Transport {
+public:
+    const char* name() const noexcept override { return "scripted"; }
+
+    int open_multicast(const std::string&, uint16_t) override { return next_source_++; }
+    int open_unicast(const std::string&, uint16_t) override {
+        recovery_source_ = next_source_++;
+        return recovery_source_;
+    }
+
+    void push(uint32_t source, std::vector<char> payload, uint64_t rx_timestamp_ns = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({source, std::move(payload), rx_timestamp_ns});
+    }
+
+    int receive(RxPacket* packets, size_t max, int) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_.clear();
+        while (!queue_.empty() && current_.size() < max) {
+            current_.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+        for (size_t i = 0; i < current_.size(); ++i) {
+            packets[i] = {current_[i].payload.data(),
+                          static_cast<uint32_t>(current_[i].payload.size()),
+                          current_[i].source,
+                          current_[i].rx_timestamp_ns};
+        }
+        if (current_.empty()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return static_cast<int>(current_.size());
+    }
+
+    // Answer a rerequest with the queued retransmission
+    bool send(int source, const char* data, size_t len) override {
+        assert(source == recovery_source_ && len == 20);
+        last_request_sequence_.store(feed::read_be64(data + 10));
+        requests_.fetch_add(1);
+        if (on_request_) {
+            on_request_();
+        }
+        return true;
+    }
+
+    void close() override {}
+
+    std::function<void()> on_request_;
+    std::atomic<uint64_t> last_request_sequence_{0};
+    std::atomic<int> requests_{0};
+
+    bool idle() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.empty();
+    }
+
+private:
+    struct Pending {
+        uint32_t source;
+        std::vector<char> payload;
+        uint64_t rx_timestamp_ns;
+    };
+
+    std::mutex mutex_;
+    std::deque<Pending> queue_;
+    std::vector<Pending> current_;
+    int next_source_ = 0;
+    int recovery_source_ = -1;
+};
+
+// MoldUDP64 packet with one ITCH add order for AAPL
+std::vector<char> mold_add(uint64_t sequence, uint64_t ref, uint32_t price) {
+    std::vector<char> p(20 + 2 + 36, 0);
+    std::memcpy(p.data(), "SESSION01 ", 10);
+    feed::write_be64(p.data() + 10, sequence);
+    feed::write_be16(p.data() + 18, 1);
+    feed::write_be16(p.data() + 20, 36);
+    char* m = p.data() + 22;
+    m[0] = 'A';
+    feed::write_be16(m + 1, 1);
+    feed::write_be64(m + 11, ref);
+    m[19] = 'B';
+    feed::write_be16(m + 22, 100);
+    std::memcpy(m + 24, "AAPL    ", 8);
+    feed::write_be16(m + 32, static_cast<uint16_t>(price >> 16));
+    feed::write_be16(m + 34, static_cast<uint16_t>(price & 0xFFFF));
+    return p;
+}
+
+// MoldUDP64 packet with one ITCH system event message
+std::vector<char> mold_event(uint64_t sequence) {
+    std::vector<char> p(20 + 2 + 12, 0);
+    std::memcpy(p.data(), "SESSION01 ", 10);
+    feed::write_be64(p.data() + 10, sequence);
+    feed::write_be16(p.data() + 18, 1);
+    feed::write_be16(p.data() + 20, 12);
+    p[22] = 'S';
+    p[33] = 'O';
+    return p;
+}
+
+void test_receiver_custom_transport() {
+    std::cout << "Testing UDP receiver on a custom transport...\n";
+
+    MarketDataHandler handler;
+    handler.set_feed_protocol(FeedProtocol::ITCH50_MOLDUDP64);
+    handler.add_symbol("AAPL");
+
+    UDPReceiver receiver(handler, "239.1.1.1", 9000);
+    receiver.set_line_b("239.1.1.2", 9001);
+    receiver.set_recovery_server("127.0.0.1", 9100);
+    receiver.arbitrator().set_gap_tolerance(1);
+
+    auto owned = std::make_unique<ScriptedTransport>();
+    ScriptedTransport* transport = owned.get();
+    receiver.set_transport(std::move(owned));
+
+    // Sources in open order: A line 0, B line 1, recovery 2
+    transport->on_request_ = [transport] { transport->push(2, mold_event(2)); };
+    transport->push(0, mold_event(1));
+    transport->push(1, mold_event(1));
+    transport->push(0, mold_event(3));
+    transport->push(1, mold_event(3));
+    transport->push(0, mold_event(4));
+
+    // Counters are published after each batch is dispatched
+    auto drain = [&receiver](uint64_t datagrams) {
+        for (int i = 0; i < 5000 && receiver.datagrams_received() < datagrams; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    receiver.start();
+    drain(6);
+
+    // In sequence again: delivered at once with its own receive stamp
+    transport->push(0, mold_add(5, 77, 1500000), 1234567890123ULL);
+    drain(7);
+    receiver.stop();
+
+    assert(std::string(receiver.transport()->name()) == "scripted");
+    assert(transport->requests_.load() == 1);
+    assert(transport->last_request_sequence_.load() == 2);
+
+    const auto& stats = receiver.arbitrator().stats();
+    assert(stats.duplicates == 2);
+    assert(stats.replayed == 2);
+    assert(handler.messages_decoded() == 5);
+    assert(receiver.datagrams_received() == 7);
+
+    // The packet's receive stamp reaches the book snapshot
+    auto snapshot = handler.get_order_book("AAPL")->get_snapshot();
+    assert(snapshot.bid_depth == 1);
+    assert(snapshot.rx_timestamp_ns == 1234567890123ULL);
+    (void)snapshot;
+    (void)stats;
+
+    std::cout << "✓ Custom transport test passed\n";
+}
+
+// Read exactly len bytes from a blocking socket
+bool read_exact(int fd, char* out, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = recv(fd, out + got, len - got, 0);
+        if (n <= 0) {
+            return false;
+        }
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+template<typename Pred>
+bool wait_for(Pred pred, int timeout_ms = 5000) {
+    for (int i = 0; i < timeout_ms && !pred(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return pred();
+}
+
+void test_tcp_sender_gateway() {
+    std::cout << "Testing non-blocking order gateway...\n";
+
+    // Stand-in gateway with a tiny receive buffer, so back-pressure is easy
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int small = 4096;
+    setsockopt(listener, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int rc = bind(listener, (struct sockaddr*)&addr, sizeof(addr));
+    assert(rc == 0);
+    rc = listen(listener, 1);
+    assert(rc == 0);
+    socklen_t addr_len = sizeof(addr);
+    getsockname(listener, (struct sockaddr*)&addr, &addr_len);
+
+    TCPSender sender("127.0.0.1", ntohs(addr.sin_port));
+    Order order;
+    std::memset(&order, 0, sizeof(order));
+    assert(!sender.send_order(order));        // Not connected
+    assert(sender.connect());
+    int gateway = accept(listener, nullptr, nullptr);
+    assert(gateway >= 0);
+
+    std::mutex reports_mutex;
+    std::vector<ExecutionReport> reports;
+    sender.set_execution_callback([&](const ExecutionReport& report) {
+        std::lock_guard<std::mutex> lock(reports_mutex);
+        reports.push_back(report);
+    });
+    sender.start_reader();
+
+    // A batch of two orders is one syscall
+    uint64_t syscalls = sender.send_syscalls();
+    sender.begin_batch();
+    order.order_id = 1;
+    assert(sender.send_order(order));
+    order.order_id = 2;
+    assert(sender.send_order(order));
+    assert(sender.send_syscalls() == syscalls);
+    sender.flush();
+    assert(sender.send_syscalls() == syscalls + 1);
+    assert(sender.pending_bytes() == 0);
+
+    Order received[2];
+    assert(read_exact(gateway, reinterpret_cast<char*>(received), sizeof(received)));
+    assert(received[0].order_id == 1 && received[1].order_id == 2);
+
+    // Reports split across TCP segments are reassembled
+    ExecutionReport out[3];
+    std::memset(out, 0, sizeof(out));
+    out[0].type = ExecutionReport::Type::ACK;
+    out[0].order_id = 1;
+    out[1].type = ExecutionReport::Type::FILL;
+    out[1].order_id = 1;
+    out[1].price = 100.25;
+    out[1].quantity = 40;
+    out[1].leaves_quantity = 60;
+    out[2].type = ExecutionReport::Type::REJECT;
+    out[2].order_id = 2;
+    out[2].reason = 7;
+    const char* bytes = reinterpret_cast<const char*>(out);
+    send(gateway, bytes, 10, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    send(gateway, bytes + 10, sizeof(out) - 10, 0);
+    assert(wait_for([&]() { return sender.reports_received() == 3; }));
+    {
+        std::lock_guard<std::mutex> lock(reports_mutex);
+        assert(reports.size() == 3);
+        assert(reports[0].type == ExecutionReport::Type::ACK);
+        assert(reports[1].type == ExecutionReport::Type::FILL && reports[1].price == 100.25 &&
+               reports[1].leaves_quantity == 60);
+        assert(reports[2].type == ExecutionReport::Type::REJECT && reports[2].reason == 7);
+    }
+
+    // Gateway stops reading: orders queue up, then the ring refuses more.
+    // Nothing accepted is lost or reordered once the gateway catches up.
+    std::vector<uint64_t> accepted;
+    bool refused = false;
+    for (uint64_t id = 100; id < 100 + 3 * TCPSender::RING_SIZE / sizeof(Order); ++id) {
+        order.order_id = id;
+        if (!sender.send_order(order)) {
+            refused = true;
+            break;
+        }
+        accepted.push_back(id);
+    }
+    assert(refused);
+    assert(sender.pending_bytes() > 0);
+
+    std::vector<Order> stream(accepted.size());
+    assert(read_exact(gateway, reinterpret_cast<char*>(stream.data()), stream.size() * sizeof(Order)));
+    for (size_t i = 0; i < accepted.size(); ++i) {
+        assert(stream[i].order_id == accepted[i]);
+    }
+    assert(wait_for([&]() { return sender.pending_bytes() == 0; }));
+    assert(sender.orders_sent() == 2 + accepted.size());
+
+    sender.disconnect();
+    char byte;
+    assert(recv(gateway, &byte, 1, 0) == 0);
+    close(gateway);
+    close(listener);
+    (void)rc;
+    (void)syscalls;
+    (void)refused;
+    (void)byte;
+
+    std::cout << "✓ Order gateway test passed\n";
+}
+
+void test_tcp_sender_concurrent_flush() {
+    std::cout << "Testing concurrent order flushes...\n";
+
+    // Slow gateway: the socket keeps backing up, so the reader thread
+    // flushes on EPOLLOUT while the strategy thread queues more orders
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int small = 4096;
+    setsockopt(listener, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int rc = bind(listener, (struct sockaddr*)&addr, sizeof(addr));
+    assert(rc == 0);
+    rc = listen(listener, 1);
+    assert(rc == 0);
+    socklen_t addr_len = sizeof(addr);
+    getsockname(listener, (struct sockaddr*)&addr, &addr_len);
+
+    TCPSender sender("127.0.0.1", ntohs(addr.sin_port));
+    assert(sender.connect());
+    int gateway = accept(listener, nullptr, nullptr);
+    assert(gateway >= 0);
+    sender.start_reader();
+
+    std::atomic<size_t> received_bytes{0};
+    std::thread reader([&]() {
+        char buffer[256];
+        ssize_t n;
+        while ((n = recv(gateway, buffer, sizeof(buffer), 0)) > 0) {
+            received_bytes.fetch_add(static_cast<size_t>(n), std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    // Every burst drains on its own: no order waits for the next one
+    constexpr int BURSTS = 40;
+    constexpr int PER_BURST = 512;
+    Order order;
+    std::memset(&order, 0, sizeof(order));
+    uint64_t id = 0;
+    for (int burst = 0; burst < BURSTS; ++burst) {
+        for (int i = 0; i < PER_BURST; ++i) {
+            order.order_id = ++id;
+            while (!sender.send_order(order)) {
+                std::this_thread::yield();
+            }
+        }
+        assert(wait_for([&]() { return sender.pending_bytes() == 0; }, 2000));
+    }
+    assert(wait_for([&]() {
+        return received_bytes.load(std::memory_order_relaxed) == id * sizeof(Order);
+    }));
+    assert(sender.orders_sent() == id);
+
+    sender.disconnect();
+    reader.join();
+    close(gateway);
+    close(listener);
+    (void)rc;
+
+    std::cout << "✓ Concurrent flush test passed\n";
+}
+
+uint32_t be32(const char* p) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(p[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(p[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(p[2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(p[3]));
+}
+
+void test_ouch_encoder() {
+    std::cout << "Testing OUCH 4.2 order encoding...\n";
+
+    OuchEncoder::Options options;
+    std::memcpy(options.firm, "ABCD", sizeof(options.firm));
+    OuchEncoder encoder(options);
+    assert(encoder.add_symbol("AAPL"));
+    assert(encoder.add_symbol("AAPL"));           // Already there
+    assert(!encoder.add_symbol("TOOLONGSYM"));
+    assert(encoder.symbols() == 1);
+
+    Order order;
+    std::memset(&order, 0, sizeof(order));
+    std::strncpy(order.symbol, "AAPL", sizeof(order.symbol) - 1);
+    order.order_id = 0x1234ABCDULL;
+    order.side = Order::Side::SELL;
+    order.type = Order::Type::LIMIT;
+    order.price = 187.4321;
+    order.quantity = 300;
+
+    // SoupBinTCP unsequenced packet around an Enter Order
+    EncodedMessage message = encoder.encode_new(order);
+    assert(message.len == 3 + OuchEncoder::ENTER_ORDER_SIZE);
+    const char* m = message.data;
+    assert(static_cast<uint8_t>(m[0]) == 0 && static_cast<uint8_t>(m[1]) == 50 && m[2] == 'U');
+    m += 3;
+    assert(m[0] == 'O');
+    assert(std::memcmp(m + 1, "HF00001234ABCD", 14) == 0);
+    assert(m[15] == 'S');
+    assert(be32(m + 16) == 300);
+    assert(std::memcmp(m + 20, "AAPL    ", 8) == 0);
+    assert(be32(m + 28) == 1874321);
+    assert(be32(m + 32) == OuchEncoder::TIF_DAY);
+    assert(std::memcmp(m + 36, "ABCD", 4) == 0);
+    assert(m[40] == 'Y' && m[41] == 'P' && m[42] == 'N' && m[47] == 'N');
+
+    // Only the per-order fields change between orders
+    std::vector<char> first(message.data, message.data + message.len);
+    order.order_id = 0x1234ABCEULL;
+    order.type = Order::Type::IOC;
+    message = encoder.encode_new(order);
+    m = message.data + 3;
+    assert(std::memcmp(m + 1, "HF00001234ABCE", 14) == 0);
+    assert(be32(m + 32) == OuchEncoder::TIF_IOC);
+    assert(std::memcmp(first.data() + 3 + 20, m + 20, 12) == 0);
+
+    ReplaceRequest replace;
+    replace.order_id = 1;
+    replace.new_order_id = 2;
+    replace.price = 10.5;
+    replace.quantity = 200;
+    replace.timestamp = 0;
+    message = encoder.encode_replace(replace);
+    assert(message.len == 3 + OuchEncoder::REPLACE_ORDER_SIZE);
+    m = message.data + 3;
+    assert(m[0] == 'U');
+    assert(std::memcmp(m + 1, "HF000000000001", 14) == 0);
+    assert(std::memcmp(m + 15, "HF000000000002", 14) == 0);
+    assert(be32(m + 29) == 200 && be32(m + 33) == 105000);
+
+    CancelRequest cancel;
+    cancel.order_id = 0xFF;
+    message = encoder.encode_cancel(cancel);
+    assert(message.len == 3 + OuchEncoder::CANCEL_ORDER_SIZE);
+    m = message.data + 3;
+    assert(m[0] == 'X' && std::memcmp(m + 1, "HF0000000000FF", 14) == 0 && be32(m + 15) == 0);
+
+    // Unknown symbol: nothing to send
+    std::strncpy(order.symbol, "MSFT", sizeof(order.symbol) - 1);
+    assert(encoder.encode_new(order).len == 0);
+    (void)m;
+
+    std::cout << "✓ OUCH encoder test passed\n";
+}
+
+void test_tcp_sender_ouch() {
+    std::cout << "Testing order gateway with the OUCH encoder...\n";
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listener, (struct sockaddr*)&addr, sizeof(addr));
+    listen(listener, 1);
+    socklen_t addr_len = sizeof(addr);
+    getsockname(listener, (struct sockaddr*)&addr, &addr_len);
+
+    TCPSender sender("127.0.0.1", ntohs(addr.sin_port));
+    auto encoder = std::make_unique<OuchEncoder>();
+    encoder->add_symbol("MSFT");
+    sender.set_encoder(std::move(encoder));
+    assert(sender.connect());
+    int gateway = accept(listener, nullptr, nullptr);
+
+    Order order;
+    std::memset(&order, 0, sizeof(order));
+    std::strncpy(order.symbol, "MSFT", sizeof(order.symbol) - 1);
+    order.order_id = 7;
+    order.price = 400.0;
+    order.quantity = 10;
+    CancelRequest cancel;
+    cancel.order_id = 7;
+
+    sender.begin_batch();
+    assert(sender.send_order(order));
+    assert(sender.send_cancel(cancel));
+    std::strncpy(order.symbol, "AAPL", sizeof(order.symbol) - 1);
+    assert(!sender.send_order(order));             // No template
+    sender.flush();
+
+    char wire[3 + OuchEncoder::ENTER_ORDER_SIZE + 3 + OuchEncoder::CANCEL_ORDER_SIZE];
+    assert(read_exact(gateway, wire, sizeof(wire)));
+    assert(wire[3] == 'O' && std::memcmp(wire + 4, "HF000000000007", 14) == 0);
+    assert(wire[3 + OuchEncoder::ENTER_ORDER_SIZE + 3] == 'X');
+    assert(sender.orders_sent() == 1);
+
+    sender.disconnect();
+    close(gateway);
+    close(listener);
+
+    std::cout << "✓ OUCH order gateway test passed\n";
+}
+
+int main() {
+    std::cout << "\n========================================\n";
+    std::cout << "   Network Tests\n";
+    std::cout << "========================================\n\n";
+
+    test_parse_udp_frame();
+    test_socket_transport_loopback();
+    test_socket_transport_shared_port();
+    test_receiver_custom_transport();
+    test_tcp_sender_gateway();
+    test_tcp_sender_concurrent_flush();
+    test_ouch_encoder();
+    test_tcp_sender_ouch();
+
+    std::cout << "\n✓ All network tests passed!\n\n";
+
+    return 0;
+}
@@ -1,8 +1,15 @@
 #include "market_data/order_book.h"
+#include "market_data/tick_order_book.h"
+#include "market_data/l3_order_book.h"
 #include <iostream>
+// Release (the default build) defines NDEBUG: keep the checks
+#undef NDEBUG
 #include <cassert>
 #include <thread>
 #include <vector>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
 
 using namespace hft;
 
@@ -25,12 +32,80 @@ void test_order_book_basic() {
     auto snapshot = book.get_snapshot();
     assert(snapshot.bid_depth == 2);
     assert(snapshot.ask_depth == 2);
-    assert(snapshot.spread() == 0.01);
+    assert(std::abs(snapshot.spread() - 0.01) < 1e-9);
     (void)snapshot; // Suppress unused warning
     
     std::cout << "✓ Basic order book test passed\n";
 }
 
+void test_depth_analytics() {
+    std::cout << "Testing depth analytics...\n";
+    
+    // Checked against plain loops over every depth, level count and size
+    for (size_t depth = 0; depth <= OrderBook::MAX_DEPTH; ++depth) {
+        OrderBook book("TEST");
+        for (size_t i = 0; i < depth; ++i) {
+            book.update_bid(i, 100.00 - i * 0.01, 100.0 + 37.0 * i);
+            book.update_ask(i, 100.01 + i * 0.01, 250.0 - 11.0 * i);
+        }
+        auto snap = book.get_snapshot();
+        
+        for (size_t levels = 1; levels <= OrderBook::MAX_DEPTH + 2; ++levels) {
+            size_t n = std::min(levels, depth);
+            double bid_qty = 0, ask_qty = 0, bid_notional = 0, ask_notional = 0;
+            for (size_t i = 0; i < n; ++i) {
+                bid_qty += snap.bids[i].quantity;
+                ask_qty += snap.asks[i].quantity;
+                bid_notional += snap.bids[i].price * snap.bids[i].quantity;
+                ask_notional += snap.asks[i].price * snap.asks[i].quantity;
+            }
+            assert(std::abs(snap.depth_quantity(OrderBook::Side::BID, levels) - bid_qty) < 1e-9);
+            assert(std::abs(snap.depth_quantity(OrderBook::Side::ASK, levels) - ask_qty) < 1e-9);
+            double imbalance = bid_qty + ask_qty > 0 ? (bid_qty - ask_qty) / (bid_qty + ask_qty) : 0.0;
+            assert(std::abs(snap.imbalance(levels) - imbalance) < 1e-12);
+            if (n > 0) {
+                double micro = (bid_notional / bid_qty * ask_qty + ask_notional / ask_qty * bid_qty) /
+                               (bid_qty + ask_qty);
+                assert(std::abs(snap.microprice(levels) - micro) < 1e-9);
+            } else {
+                assert(snap.microprice(levels) == snap.mid_price());
+            }
+            auto features = snap.depth_features(levels);
+            assert(std::abs(features.bid_quantity - bid_qty) < 1e-9);
+            assert(std::abs(features.imbalance - snap.imbalance(levels)) < 1e-12);
+            assert(std::abs(features.microprice - snap.microprice(levels)) < 1e-9);
+            (void)imbalance; (void)features;
+        }
+        
+        for (double size : {0.0, 50.0, 100.0, 180.0, 555.5, 1e6}) {
+            double left = size, taken = 0, notional = 0;
+            for (size_t i = 0; i < depth && left > 0; ++i) {
+                double take = std::min(left, snap.asks[i].quantity);
+                taken += take;
+                notional += take * snap.asks[i].price;
+                left -= take;
+            }
+            double filled = -1;
+            double vwap = snap.vwap_to_size(OrderBook::Side::ASK, size, &filled);
+            assert(std::abs(filled - taken) < 1e-9);
+            assert(std::abs(vwap - (taken > 0 ? notional / taken : 0.0)) < 1e-9);
+            (void)vwap;
+        }
+    }
+    
+    // Top of book versions
+    OrderBook book("TEST");
+    book.update_bid(0, 100.00, 300.0);
+    book.update_ask(0, 100.10, 100.0);
+    auto top = book.get_top();
+    assert(std::abs(top.imbalance() - 0.5) < 1e-12);
+    assert(std::abs(top.microprice() - 100.075) < 1e-9);
+    assert(std::abs(book.get_snapshot().microprice() - top.microprice()) < 1e-9);
+    (void)top;
+    
+    std::cout << "✓ Depth analytics test passed\n";
+}
+
 void test_order_book_concurrent() {
     std::cout << "Testing concurrent order book access...\n";
     
@@ -81,14 +156,248 @@ void test_order_book_sequence() {
     std::cout << "✓ Sequence number test passed\n";
 }
 
+void test_order_book_seqlock() {
+    std::cout << "Testing seqlock snapshot consistency...\n";
+    
+    OrderBook book("TEST");
+    std::atomic<bool> done{false};
+    
+    // Writer: every update rewrites all levels of both sides with the same
+    // generation number, so any mix of generations in a copy is a torn read
+    std::thread writer([&book, &done]() {
+        for (int gen = 1; gen <= 20000; ++gen) {
+            book.begin_update();
+            for (size_t lvl = 0; lvl < OrderBook::MAX_DEPTH; ++lvl) {
+                book.update_bid(lvl, gen, gen);
+                book.update_ask(lvl, gen, gen);
+            }
+            book.end_update();
+        }
+        done.store(true, std::memory_order_release);
+    });
+    
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&book, &done]() {
+            while (!done.load(std::memory_order_acquire)) {
+                auto snap = book.get_snapshot();
+                assert((snap.version & 1) == 0);
+                double gen = snap.bids[0].price;
+                for (size_t lvl = 0; lvl < OrderBook::MAX_DEPTH; ++lvl) {
+                    assert(snap.bids[lvl].price == gen);
+                    assert(snap.bids[lvl].quantity == gen);
+                    assert(snap.asks[lvl].price == gen);
+                    assert(snap.asks[lvl].quantity == gen);
+                }
+                (void)gen;
+            }
+        });
+    }
+    
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    
+    // A batch counts as one version step
+    uint64_t v = book.version();
+    book.begin_update();
+    book.update_bid(0, 1.0, 1.0);
+    book.update_ask(0, 2.0, 1.0);
+    
+    // Writer still mid-update: bounded read must report stale
+    OrderBook::Snapshot snap;
+    assert(!book.try_get_snapshot(snap, 4));
+    
+    book.end_update();
+    assert(book.version() == v + 2);
+    assert(book.try_get_snapshot(snap, 4));
+    assert(snap.retries == 0);
+    assert(snap.best_bid() == 1.0 && snap.best_ask() == 2.0);
+    (void)snap; (void)v;
+    
+    std::cout << "✓ Seqlock snapshot test passed\n";
+}
+
+void test_tick_order_book() {
+    std::cout << "Testing tick-keyed full-depth order book...\n";
+    
+    using Side = TickOrderBook::Side;
+    TickOrderBook book("TEST", 0.01, 500, 256);
+    
+    assert(book.best_bid_ticks() == TickOrderBook::NO_PRICE);
+    assert(book.best_ask() == std::numeric_limits<double>::max());
+    
+    // Insert 300 levels per side - well beyond OrderBook::MAX_DEPTH
+    for (uint64_t i = 0; i < 300; ++i) {
+        book.update(Side::BID, 10000 - i, 100.0 + i, 1);
+        book.update(Side::ASK, 10001 + i, 200.0 + i, 2);
+    }
+    assert(book.level_count(Side::BID) == 300);
+    assert(book.level_count(Side::ASK) == 300);
+    assert(book.best_bid_ticks() == 10000);
+    assert(book.best_ask_ticks() == 10001);
+    assert(std::abs(book.best_bid() - 100.00) < 1e-9);
+    
+    // Levels come back in price order across ladder and overflow
+    std::vector<PriceLevel> levels(500);
+    size_t n = book.get_levels(Side::BID, levels.data(), levels.size());
+    assert(n == 300);
+    for (size_t i = 0; i < n; ++i) {
+        assert(book.to_ticks(levels[i].price) == 10000 - i);
+        assert(levels[i].quantity == 100.0 + i);
+    }
+    n = book.get_levels(Side::ASK, levels.data(), levels.size());
+    assert(n == 300);
+    for (size_t i = 0; i < n; ++i) {
+        assert(book.to_ticks(levels[i].price) == 10001 + i);
+        assert(levels[i].order_count == 2);
+    }
+    
+    // Modify and delete by price
+    book.update(Side::BID, 9990, 5.0, 3);
+    assert(book.find(Side::BID, 9990)->quantity == 5.0);
+    book.update(Side::BID, 9990, 0.0);
+    assert(book.find(Side::BID, 9990) == nullptr);
+    assert(book.level_count(Side::BID) == 299);
+    
+    // Far deletes hit the overflow
+    book.update(Side::ASK, 10300, 0.0);
+    assert(book.find(Side::ASK, 10300) == nullptr);
+    assert(book.level_count(Side::ASK) == 299);
+    
+    // Touch jumping far outside the window re-centres the ladder
+    book.update(Side::BID, 20000, 1.0);
+    assert(book.best_bid_ticks() == 20000);
+    assert(book.find(Side::BID, 10000)->quantity == 100.0);
+    
+    // Draining the touch pulls the next levels back from the overflow
+    book.update(Side::BID, 20000, 0.0);
+    assert(book.best_bid_ticks() == 10000);
+    for (uint64_t i = 0; i < 200; ++i) {
+        book.update(Side::BID, 10000 - i, 0.0);
+    }
+    assert(book.best_bid_ticks() == 9800);
+    
+    // Same on the ask side: the old ladder lands in front of the far asks
+    book.update(Side::ASK, 5000, 7.0);
+    assert(book.best_ask_ticks() == 5000 && book.level_count(Side::ASK) == 300);
+    n = book.get_levels(Side::ASK, levels.data(), levels.size());
+    assert(n == 300 && book.to_ticks(levels[0].price) == 5000);
+    for (size_t i = 1; i < n; ++i) {
+        assert(book.to_ticks(levels[i].price) > book.to_ticks(levels[i - 1].price));
+    }
+    book.update(Side::ASK, 5000, 0.0);
+    assert(book.best_ask_ticks() == 10001 && book.find(Side::ASK, 10299)->order_count == 2);
+    
+    // Runtime depth limits what get_levels reports
+    book.set_depth(10);
+    assert(book.get_levels(Side::ASK, levels.data(), levels.size()) == 10);
+    
+    book.clear();
+    assert(book.level_count(Side::BID) == 0);
+    assert(book.best_ask_ticks() == TickOrderBook::NO_PRICE);
+    (void)n;
+    
+    std::cout << "✓ Tick order book test passed\n";
+}
+
+void test_l3_order_book() {
+    std::cout << "Testing L3 order-by-order book...\n";
+    
+    using Side = L3OrderBook::Side;
+    L3OrderBook book("TEST", 0.01, 1024);
+    
+    // Three orders at the touch, one behind, one ask
+    assert(book.add_order(1, Side::BID, 10000, 100));
+    assert(book.add_order(2, Side::BID, 10000, 200));
+    assert(book.add_order(3, Side::BID, 10000, 300));
+    assert(book.add_order(4, Side::BID, 9999, 50));
+    assert(book.add_order(5, Side::ASK, 10001, 70));
+    assert(!book.add_order(1, Side::BID, 10000, 10)); // Duplicate ID
+    
+    assert(book.order_count() == 5);
+    assert(book.level_count() == 3);
+    assert(book.levels().best_bid_ticks() == 10000);
+    assert(book.levels().best_ask_ticks() == 10001);
+    
+    // Aggregates are maintained incrementally
+    const auto* touch = book.levels().find(Side::BID, 10000);
+    assert(touch->quantity == 600.0 && touch->order_count == 3);
+    
+    // FIFO: head is the oldest order
+    const auto* queue = book.find_level(Side::BID, 10000);
+    assert(queue->head->order_id == 1 && queue->tail->order_id == 3);
+    
+    // Partial execution keeps position
+    assert(book.execute_order(1, 40));
+    assert(book.find_order(1)->quantity == 60);
+    assert(queue->head->order_id == 1);
+    assert(book.levels().find(Side::BID, 10000)->quantity == 560.0);
+    
+    // Full execution removes it
+    assert(book.execute_order(1, 60));
+    assert(book.find_order(1) == nullptr);
+    assert(queue->head->order_id == 2);
+    assert(book.levels().find(Side::BID, 10000)->order_count == 2);
+    
+    // Size-down modify keeps priority, size-up goes to the back
+    assert(book.modify_order(2, 10000, 150));
+    assert(queue->head->order_id == 2);
+    assert(book.modify_order(2, 10000, 400));
+    assert(queue->head->order_id == 3 && queue->tail->order_id == 2);
+    assert(book.levels().find(Side::BID, 10000)->quantity == 700.0);
+    
+    // Replace moves to a new price under a new ID
+    assert(book.replace_order(3, 30, 10002, 300));
+    assert(book.find_order(3) == nullptr);
+    assert(book.find_order(30)->price_ticks == 10002);
+    assert(book.levels().best_bid_ticks() == 10002);
+    
+    // Cancel and delete drain levels and return nodes to the pools
+    assert(book.cancel_order(30, 100));
+    assert(book.find_order(30)->quantity == 200);
+    assert(book.delete_order(30));
+    assert(book.delete_order(2));
+    assert(book.find_level(Side::BID, 10000) == nullptr);
+    assert(book.levels().best_bid_ticks() == 9999);
+    assert(!book.delete_order(999));
+    
+    assert(book.order_count() == 2);
+    assert(book.level_count() == 2);
+    
+    // Churn far beyond capacity: pools and index must recycle
+    for (uint64_t round = 0; round < 16; ++round) {
+        for (uint64_t i = 0; i < 1000; ++i) {
+            assert(book.add_order(100000 + i, Side::ASK, 10010 + (i % 37), 10));
+        }
+        for (uint64_t i = 0; i < 1000; ++i) {
+            assert(book.delete_order(100000 + i));
+        }
+    }
+    assert(book.order_count() == 2);
+    assert(book.levels().best_ask_ticks() == 10001);
+    
+    book.clear();
+    assert(book.order_count() == 0);
+    assert(book.levels().best_bid_ticks() == TickOrderBook::NO_PRICE);
+    (void)touch; (void)queue;
+    
+    std::cout << "✓ L3 order book test passed\n";
+}
+
 int main() {
     std::cout << "\n========================================\n";
     std::cout << "   Order Book Unit Tests\n";
     std::cout << "========================================\n\n";
     
     test_order_book_basic();
+    test_depth_analytics();
     test_order_book_concurrent();
     test_order_book_sequence();
+    test_order_book_seqlock();
+    test_tick_order_book();
+    test_l3_order_book();
     
     std::cout << "\n✓ All tests passed!\n\n";
     
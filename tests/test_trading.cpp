@@ -0,0 +1,1561 @@
+#include "trading/order_manager.h"
+#include "trading/risk_engine.h"
+#include "trading/strategy.h"
+#include "trading/strategy_router.h"
+#include "trading/pipeline.h"
+#include "trading/sharded_feed.h"
+#include "trading/exchange_simulator.h"
+#include "trading/backtest.h"
+#include "trading/warmup.h"
+#include "trading/parameter_reload.h"
+#include "common/config.h"
+#include "market_data/market_data_handler.h"
+#include "market_data/feed_journal.h"
+#include "network/tcp_sender.h"
+#include "common/timestamp.h"
+#include "common/tick_to_trade.h"
+#include <iostream>
+// The checks drive the code under test: keep them in release builds
+#undef NDEBUG
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace hft;
+
+using State = OrderManager::OrderState;
+
+// Loopback stand-in for the order gateway: accepts one connection and
+// hands back what the sender wrote
+struct Gateway {
+    int listener = -1;
+    int connection = -1;
+
+    uint16_t listen() {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listener, (struct sockaddr*)&addr, sizeof(addr));
+        ::listen(listener, 1);
+        socklen_t len = sizeof(addr);
+        getsockname(listener, (struct sockaddr*)&addr, &len);
+        return ntohs(addr.sin_port);
+    }
+
+    void accept() { connection = ::accept(listener, nullptr, nullptr); }
+
+    template<typename T>
+    T read() {
+        T message;
+        char* out = reinterpret_cast<char*>(&message);
+        size_t got = 0;
+        while (got < sizeof(T)) {
+            ssize_t n = recv(connection, out + got, sizeof(T) - got, 0);
+            assert(n > 0);
+            got += static_cast<size_t>(n);
+        }
+        return message;
+    }
+
+    ~Gateway() {
+        if (connection >= 0) close(connection);
+        if (listener >= 0) close(listener);
+    }
+};
+
+Order make_order(uint64_t id, Order::Side side, double price, double quantity) {
+    Order order;
+    std::memset(&order, 0, sizeof(order));
+    std::strncpy(order.symbol, "AAPL", sizeof(order.symbol) - 1);
+    order.order_id = id;
+    order.side = side;
+    order.type = Order::Type::LIMIT;
+    order.price = price;
+    order.quantity = quantity;
+    return order;
+}
+
+ExecutionReport make_report(ExecutionReport::Type type, uint64_t id, double price = 0,
+                            double quantity = 0, double leaves = 0) {
+    ExecutionReport report;
+    std::memset(&report, 0, sizeof(report));
+    report.type = type;
+    report.order_id = id;
+    report.price = price;
+    report.quantity = quantity;
+    report.leaves_quantity = leaves;
+    return report;
+}
+
+void test_order_lifecycle() {
+    std::cout << "Testing order state machine...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+
+    OrderManager manager(sender, 8);
+    using Type = ExecutionReport::Type;
+
+    // New order: pending until acknowledged, exposure reserved, no position
+    assert(manager.submit_order(make_order(1, Order::Side::BUY, 100.0, 10)));
+    assert(gateway.read<Order>().order_id == 1);
+    const OrderManager::OrderInfo* info = manager.find_order(1);
+    assert(info && info->state == State::PENDING_NEW);
+    assert(manager.open_buy_quantity() == 10 && manager.open_notional() == 1000.0);
+    assert(manager.get_position() == 0 && manager.open_orders() == 1);
+
+    manager.on_execution_report(make_report(Type::ACK, 1));
+    assert(info->state == State::LIVE);
+
+    // Partial fill moves position and notional
+    manager.on_execution_report(make_report(Type::FILL, 1, 100.0, 4, 6));
+    assert(info->state == State::PARTIALLY_FILLED);
+    assert(manager.get_position() == 4 && manager.get_notional() == 400.0);
+    assert(manager.open_buy_quantity() == 6 && manager.open_notional() == 600.0);
+
+    // Replace: same slot, reachable under both IDs, both versions reserved
+    assert(manager.replace_order(1, 2, 101.0, 5, 0));
+    ReplaceRequest replace = gateway.read<ReplaceRequest>();
+    assert(replace.type == 'U' && replace.order_id == 1 && replace.new_order_id == 2);
+    assert(replace.price == 101.0 && replace.quantity == 5);
+    assert(manager.find_order(2) == info && manager.find_order(1) == info);
+    assert(info->state == State::PENDING_REPLACE && manager.open_orders() == 1);
+    assert(manager.open_buy_quantity() == 11);
+    assert(!manager.replace_order(1, 3, 102.0, 5, 0));     // One amend at a time
+
+    // A fill on the old version still counts
+    manager.on_execution_report(make_report(Type::FILL, 1, 100.0, 1, 5));
+    assert(manager.get_position() == 5 && info->filled_quantity == 5);
+
+    manager.on_execution_report(make_report(Type::ACK, 2));
+    assert(manager.find_order(1) == nullptr && manager.find_order(2) == info);
+    assert(info->order_id == 2 && info->price == 101.0 && info->leaves_quantity == 5);
+    assert(info->state == State::PARTIALLY_FILLED);
+    assert(manager.open_buy_quantity() == 5 && manager.open_notional() == 505.0);
+
+    // Refused replace: the old version stays live
+    assert(manager.replace_order(2, 3, 99.0, 8, 0));
+    gateway.read<ReplaceRequest>();
+    manager.on_execution_report(make_report(Type::REJECT, 3));
+    assert(manager.find_order(3) == nullptr && manager.find_order(2) == info);
+    assert(info->state == State::PARTIALLY_FILLED && info->price == 101.0);
+    assert(manager.open_buy_quantity() == 5);
+
+    // Cancel: pending until confirmed, then the slot goes back to the pool
+    assert(manager.cancel_order(2));
+    CancelRequest cancel = gateway.read<CancelRequest>();
+    assert(cancel.type == 'X' && cancel.order_id == 2);
+    assert(info->state == State::PENDING_CANCEL);
+    assert(!manager.cancel_order(2));
+    manager.on_execution_report(make_report(Type::CANCELED, 2));
+    assert(manager.find_order(2) == nullptr && manager.open_orders() == 0);
+    assert(manager.open_buy_quantity() == 0 && manager.open_notional() == 0);
+    assert(manager.get_position() == 5);
+
+    // Venue reject and full fill both end the order
+    assert(manager.submit_order(make_order(10, Order::Side::SELL, 100.0, 3)));
+    assert(manager.submit_order(make_order(11, Order::Side::SELL, 100.0, 2)));
+    assert(!manager.submit_order(make_order(11, Order::Side::SELL, 100.0, 2)));   // Duplicate ID
+    manager.on_execution_report(make_report(Type::REJECT, 10));
+    manager.on_execution_report(make_report(Type::FILL, 11, 100.5, 2, 0));
+    assert(manager.open_orders() == 0 && manager.open_sell_quantity() == 0);
+    assert(manager.get_position() == 3);
+
+    // Late reports for finished orders are counted, not applied
+    manager.on_execution_report(make_report(Type::FILL, 11, 100.5, 2, 0));
+    assert(manager.unknown_reports() == 1 && manager.get_position() == 3);
+    (void)info;
+    (void)replace;
+    (void)cancel;
+
+    std::cout << "✓ Order state machine test passed\n";
+}
+
+void test_order_risk_and_pool() {
+    std::cout << "Testing open exposure limits and order slots...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+
+    OrderManager manager(sender, 4);
+    OrderManager::RiskLimits limits;
+    limits.max_order_size = 100;
+    limits.max_position = 150;
+    limits.max_notional = 1000000;
+    limits.max_orders_per_second = 1000;
+    manager.set_risk_limits(limits);
+
+    // Unacknowledged orders count against the position limit
+    assert(manager.submit_order(make_order(1, Order::Side::BUY, 10.0, 100)));
+    assert(!manager.submit_order(make_order(2, Order::Side::BUY, 10.0, 100)));
+    assert(manager.submit_order(make_order(3, Order::Side::SELL, 10.0, 100)));
+
+    // Pool capacity bounds the open orders, slots are reused once done
+    assert(manager.submit_order(make_order(4, Order::Side::BUY, 10.0, 10)));
+    assert(manager.submit_order(make_order(5, Order::Side::BUY, 10.0, 10)));
+    assert(!manager.submit_order(make_order(6, Order::Side::BUY, 10.0, 10)));
+    const OrderManager::OrderInfo* freed = manager.find_order(5);
+    manager.on_execution_report(make_report(ExecutionReport::Type::CANCELED, 5));
+    assert(manager.submit_order(make_order(6, Order::Side::BUY, 10.0, 10)));
+    assert(manager.find_order(6) == freed);
+
+    // Reports from the reader thread are applied on the owner thread
+    std::thread reader([&manager]() {
+        for (uint64_t id : {1, 3, 4, 6}) {
+            manager.enqueue_execution_report(make_report(ExecutionReport::Type::CANCELED, id));
+        }
+    });
+    reader.join();
+    assert(manager.open_orders() == 4);
+    assert(manager.process_execution_reports() == 4);
+    assert(manager.open_orders() == 0 && manager.open_notional() == 0);
+
+    // Orders that never went out give their rate token back: failed
+    // inline sends, and sender stage failures reported as REJECT_NOT_SENT
+    TCPSender offline("127.0.0.1", 1);
+    OrderManager unsent(offline, 8);
+    limits.max_orders_per_second = 1;
+    limits.max_order_burst = 2;
+    unsent.set_risk_limits(limits);
+    for (uint64_t id = 10; id < 15; ++id) {
+        assert(!unsent.submit_order(make_order(id, Order::Side::BUY, 10.0, 10)));
+    }
+    offline.set_loopback(true);
+    assert(unsent.submit_order(make_order(20, Order::Side::BUY, 10.0, 10)));
+    assert(unsent.submit_order(make_order(21, Order::Side::BUY, 10.0, 10)));
+    assert(!unsent.submit_order(make_order(22, Order::Side::BUY, 10.0, 10)));      // Burst spent
+    ExecutionReport not_sent = make_report(ExecutionReport::Type::REJECT, 21);
+    not_sent.reason = OrderManager::REJECT_NOT_SENT;
+    unsent.on_execution_report(not_sent);
+    assert(unsent.submit_order(make_order(23, Order::Side::BUY, 10.0, 10)));
+    unsent.on_execution_report(make_report(ExecutionReport::Type::REJECT, 23));    // Venue reject
+    assert(!unsent.submit_order(make_order(24, Order::Side::BUY, 10.0, 10)));
+    (void)freed;
+
+    std::cout << "✓ Open exposure and order slot test passed\n";
+}
+
+void test_strategy_amends_quotes() {
+    std::cout << "Testing quote amendment...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+
+    OrderManager manager(sender, 16);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 1000;
+    manager.set_risk_limits(limits);
+    MarketMakingStrategy::Parameters params;
+    params.symbol = "AAPL";
+    MarketMakingStrategy strategy(manager, params);
+
+    OrderBook book("AAPL");
+    book.update_bid(0, 100.00, 500);
+    book.update_ask(0, 100.02, 500);
+
+    // First tick places both sides
+    strategy.on_order_book_update(book);
+    Order bid = gateway.read<Order>();
+    Order ask = gateway.read<Order>();
+    assert(bid.side == Order::Side::BUY && ask.side == Order::Side::SELL);
+    assert(manager.open_orders() == 2);
+
+    // Next tick, once live, amends them instead of adding orders
+    manager.on_execution_report(make_report(ExecutionReport::Type::ACK, bid.order_id));
+    manager.on_execution_report(make_report(ExecutionReport::Type::ACK, ask.order_id));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    book.update_bid(0, 100.01, 500);
+    book.update_ask(0, 100.03, 500);
+    strategy.on_order_book_update(book);
+    ReplaceRequest bid_replace = gateway.read<ReplaceRequest>();
+    ReplaceRequest ask_replace = gateway.read<ReplaceRequest>();
+    assert(bid_replace.type == 'U' && bid_replace.order_id == bid.order_id);
+    assert(ask_replace.type == 'U' && ask_replace.order_id == ask.order_id);
+    assert(manager.open_orders() == 2);
+
+    // Refused amend: the quote falls back to the order still resting, at
+    // its old price, and is amended again; the ask rests at its target
+    manager.on_execution_report(make_report(ExecutionReport::Type::REJECT, bid_replace.new_order_id));
+    manager.on_execution_report(make_report(ExecutionReport::Type::ACK, ask_replace.new_order_id));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    strategy.on_order_book_update(book);
+    ReplaceRequest again = gateway.read<ReplaceRequest>();
+    assert(again.order_id == bid.order_id && again.price == bid_replace.price);
+    assert(strategy.quotes_sent() == 5 && strategy.quotes_unchanged() == 1);
+    assert(manager.open_orders() == 2);
+    (void)bid_replace;
+    (void)ask_replace;
+    (void)again;
+
+    std::cout << "✓ Quote amendment test passed\n";
+}
+
+void test_strategy_quote_cache() {
+    std::cout << "Testing quote state cache...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+
+    OrderManager manager(sender, 16);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 1000;
+    manager.set_risk_limits(limits);
+    MarketMakingStrategy::Parameters params;
+    params.symbol = "AAPL";
+    params.spread_target = 0.0010;          // 5 cents either side of 100
+    params.edge = 0;
+    params.quote_size = 105;
+    params.lot_size = 10;
+    MarketMakingStrategy strategy(manager, params);
+
+    OrderBook book("AAPL");
+    auto tick = [&book, &strategy](double mid) {
+        book.update_bid(0, mid - 0.01, 500);
+        book.update_ask(0, mid + 0.01, 500);
+        strategy.on_order_book_update(book);
+    };
+    auto ack = [&manager](uint64_t id) {
+        manager.on_execution_report(make_report(ExecutionReport::Type::ACK, id));
+    };
+    auto pause = [] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); };
+
+    // On the grid: bid rounded down, ask up, whole lots
+    tick(100.003);
+    Order bid = gateway.read<Order>();
+    Order ask = gateway.read<Order>();
+    assert(std::fabs(bid.price - 99.95) < 1e-9 && std::fabs(ask.price - 100.06) < 1e-9);
+    assert(bid.quantity == 100 && ask.quantity == 100);
+    ack(bid.order_id);
+    ack(ask.order_id);
+
+    // Sub-tick move: both targets unchanged, nothing sent
+    pause();
+    tick(100.005);
+    assert(strategy.quotes_sent() == 2 && strategy.quotes_unchanged() == 2);
+
+    // A tick away: amended at once (no message went out, no pacing wait)
+    tick(100.020);
+    ReplaceRequest bid_replace = gateway.read<ReplaceRequest>();
+    ReplaceRequest ask_replace = gateway.read<ReplaceRequest>();
+    assert(bid_replace.order_id == bid.order_id && std::fabs(bid_replace.price - 99.96) < 1e-9);
+    assert(ask_replace.order_id == ask.order_id && std::fabs(ask_replace.price - 100.08) < 1e-9);
+    ack(bid_replace.new_order_id);
+    ack(ask_replace.new_order_id);
+
+    // Wider threshold: one tick is not enough, three are
+    params.requote_ticks = 3;
+    assert(strategy.update_parameters(params));
+    tick(100.030);
+    assert(strategy.quotes_sent() == 4 && strategy.quotes_unchanged() == 4);
+    tick(100.050);
+    ReplaceRequest bid_far = gateway.read<ReplaceRequest>();
+    ReplaceRequest ask_far = gateway.read<ReplaceRequest>();
+    assert(std::fabs(bid_far.price - 99.99) < 1e-9 && std::fabs(ask_far.price - 100.11) < 1e-9);
+    assert(strategy.quotes_sent() == 6 && manager.open_orders() == 2);
+
+    // A size below a lot changes nothing either
+    ack(bid_far.new_order_id);
+    ack(ask_far.new_order_id);
+    params.quote_size = 109;
+    assert(strategy.update_parameters(params));
+    tick(100.050);
+    assert(strategy.quotes_sent() == 6 && strategy.quotes_unchanged() == 6);
+
+    // A reloaded grid: both sides amended onto it once, then compared on it
+    params.tick_size = 0.05;
+    assert(strategy.update_parameters(params));
+    tick(100.050);
+    ReplaceRequest bid_grid = gateway.read<ReplaceRequest>();
+    ReplaceRequest ask_grid = gateway.read<ReplaceRequest>();
+    assert(std::fabs(bid_grid.price - 99.95) < 1e-9 && std::fabs(ask_grid.price - 100.15) < 1e-9);
+    assert(strategy.quotes_sent() == 8);
+    ack(bid_grid.new_order_id);
+    ack(ask_grid.new_order_id);
+    pause();
+    tick(100.060);
+    assert(strategy.quotes_sent() == 8 && strategy.quotes_unchanged() == 8);
+
+    MarketMakingStrategy::Parameters bad = params;
+    bad.tick_size = 0;
+    assert(!validate_parameters(bad));
+    bad = params;
+    bad.quote_size = 5;                     // Below one lot
+    assert(!validate_parameters(bad));
+    (void)bid_replace; (void)ask_replace; (void)bid_far; (void)ask_far; (void)bid_grid; (void)ask_grid;
+
+    std::cout << "✓ Quote state cache test passed\n";
+}
+
+void test_risk_engine() {
+    std::cout << "Testing per-symbol risk table...\n";
+
+    RiskEngine risk(4);
+    RiskEngine::Limits limits;
+    limits.max_order_size = 100;
+    limits.max_position = 150;
+    limits.max_notional = 15000;
+    limits.max_orders_per_second = 1000;
+    limits.max_order_burst = 3;
+    risk.set_limits(limits);
+
+    uint32_t aapl = risk.symbol_index("AAPL");
+    uint32_t msft = risk.symbol_index("MSFT");
+    assert(aapl != msft && risk.symbol_index("AAPL") == aapl && risk.symbols() == 2);
+    assert(RiskEngine::to_ticks(100.25) == 1002500 && RiskEngine::to_lots(99.6) == 100);
+    char field[16] = "MSFT";
+    assert(risk.order_symbol(field) == msft && risk.order_symbol(field) == msft);
+
+    // Every failed check is reported, a reject takes no token
+    uint64_t now = Timestamp::now();
+    int64_t ticks = RiskEngine::to_ticks(100.0);
+    uint32_t reject = risk.check(aapl, Order::Side::BUY, 200, 200, 200 * ticks, now);
+    assert(reject == (RiskEngine::ORDER_SIZE | RiskEngine::POSITION | RiskEngine::NOTIONAL));
+    assert(risk.check(aapl, Order::Side::BUY, 0, 0, 0, now) == RiskEngine::ORDER_SIZE);
+
+    // Exposure is per symbol: open AAPL buys do not restrict MSFT
+    risk.adjust_open(aapl, Order::Side::BUY, 100, ticks, 1);
+    assert(risk.check(aapl, Order::Side::BUY, 60, 60, 60 * ticks, now) ==
+           (RiskEngine::POSITION | RiskEngine::NOTIONAL));
+    assert(risk.check(aapl, Order::Side::SELL, 60, 60, 60 * ticks, now) == RiskEngine::NOTIONAL);
+    assert(risk.check(msft, Order::Side::BUY, 60, 60, 60 * ticks, now) == 0);
+    risk.apply_fill(aapl, Order::Side::BUY, 100, ticks);
+    risk.adjust_open(aapl, Order::Side::BUY, 100, ticks, -1);
+    assert(risk.position(aapl) == 100 && risk.notional(aapl) == 10000.0);
+    assert(risk.position(msft) == 0 && risk.total_position() == 100);
+
+    // Token bucket: burst of 3 (one taken above), then one per 1/1000 s
+    assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == 0);
+    assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == 0);
+    assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == RiskEngine::RATE);
+    uint64_t token = static_cast<uint64_t>(Timestamp::tsc_frequency() / 1000);
+    now += token;
+    assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == 0);
+    assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == RiskEngine::RATE);
+
+    // A long pause refills only up to the burst
+    now += 1000 * token;
+    for (int i = 0; i < 3; ++i) {
+        assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == 0);
+    }
+    assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == RiskEngine::RATE);
+
+    // Per-symbol override and a full table
+    RiskEngine::Limits small = limits;
+    small.max_order_size = 5;
+    assert(risk.set_symbol_limits("MSFT", small));
+    now += 10 * token;
+    assert(risk.check(msft, Order::Side::BUY, 10, 10, 10 * ticks, now) == RiskEngine::ORDER_SIZE);
+    assert(risk.check(aapl, Order::Side::SELL, 10, 10, 10 * ticks, now) == 0);
+    risk.symbol_index("GOOG");
+    risk.symbol_index("AMZN");
+    assert(risk.symbol_index("TSLA") == RiskEngine::NO_SYMBOL);
+    (void)aapl;
+    (void)msft;
+    (void)reject;
+    (void)token;
+
+    std::cout << "✓ Per-symbol risk table test passed\n";
+}
+
+// Record of the simple feed protocol (MarketDataHandler::MarketDataMessage)
+struct SimpleRecord {
+    char symbol[16];
+    uint8_t side;
+    uint8_t level;
+    double price;
+    double quantity;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+std::vector<SimpleRecord> touch(const char* symbol, double bid, double ask) {
+    std::vector<SimpleRecord> records(2);
+    for (size_t i = 0; i < 2; ++i) {
+        std::memset(&records[i], 0, sizeof(SimpleRecord));
+        std::strncpy(records[i].symbol, symbol, sizeof(records[i].symbol) - 1);
+        records[i].side = static_cast<uint8_t>(i);
+        records[i].price = i == 0 ? bid : ask;
+        records[i].quantity = 500;
+    }
+    return records;
+}
+
+void test_strategy_routing() {
+    std::cout << "Testing per-symbol strategy routing...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+
+    OrderManager manager(sender, 16);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 1000;
+    manager.set_risk_limits(limits);
+
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    handler.add_symbol("MSFT");
+    handler.add_symbol("GOOGL");
+    int updates = 0;
+    handler.register_callback([&updates](const OrderBook&) { ++updates; });
+
+    // Same strategy type, different parameters per instrument
+    MarketMakingStrategy::Parameters aapl_params;
+    aapl_params.symbol = "AAPL";
+    aapl_params.quote_size = 100;
+    MarketMakingStrategy::Parameters msft_params;
+    msft_params.symbol = "MSFT";
+    msft_params.quote_size = 30;
+    MarketMakingStrategy aapl(manager, aapl_params);
+    MarketMakingStrategy msft(manager, msft_params);
+    ArbitrageStrategy arbitrage(manager, ArbitrageStrategy::Parameters{});
+
+    {
+        StrategyRouter router(handler);
+        assert(router.subscribe("AAPL", &aapl));
+        assert(router.subscribe("MSFT", &msft));
+        assert(router.subscribe("MSFT", &arbitrage));
+        assert(!router.subscribe("TSLA", &aapl));       // Not tracked
+        assert(router.strategies() == 3);
+        assert(handler.get_order_book("GOOGL")->subscribers() == nullptr);
+
+        // Each book reaches only its own strategies
+        for (const char* symbol : {"GOOGL", "AAPL", "MSFT"}) {
+            auto records = touch(symbol, 100.00, 100.02);
+            handler.process_message(reinterpret_cast<const char*>(records.data()),
+                                    records.size() * sizeof(SimpleRecord));
+        }
+        assert(updates == 6);
+        for (const char* symbol : {"AAPL", "MSFT"}) {
+            for (Order::Side side : {Order::Side::BUY, Order::Side::SELL}) {
+                Order order = gateway.read<Order>();
+                assert(std::strcmp(order.symbol, symbol) == 0 && order.side == side);
+                assert(order.quantity == (symbol[0] == 'A' ? 100 : 30));
+                (void)side;
+            }
+        }
+        assert(manager.open_orders() == 4);
+        router.on_timer();
+    }
+
+    // The router detaches from the books it routed
+    assert(handler.get_order_book("AAPL")->subscribers() == nullptr);
+    auto records = touch("AAPL", 100.01, 100.03);
+    handler.process_message(reinterpret_cast<const char*>(records.data()),
+                            records.size() * sizeof(SimpleRecord));
+    assert(updates == 8 && manager.open_orders() == 4);
+
+    std::cout << "✓ Per-symbol strategy routing test passed\n";
+}
+
+template<typename Predicate>
+bool wait_for(Predicate done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void test_fair_value_engine() {
+    std::cout << "Testing incremental basket fair values...\n";
+
+    // A 500-name ETF, and a future on one of its names
+    FairValueEngine engine(1024, 64);
+    uint32_t etf = engine.add_basket("ETF", 10.0, 1.0);
+    uint32_t future = engine.add_basket("FUT", 10.0);
+    char name[16];
+    std::vector<double> weights(500), prices(500);
+    for (uint32_t i = 0; i < 500; ++i) {
+        std::snprintf(name, sizeof(name), "C%03u", i);
+        weights[i] = 0.01 * (1 + i % 5);
+        assert(engine.add_component(etf, name, weights[i]));
+    }
+    assert(engine.add_component(future, "C000", 1.0));
+    assert(engine.add_basket("ETF", 5.0) == FairValueEngine::NO_INDEX);
+    engine.finalize();
+    assert(engine.baskets() == 2 && engine.instruments() == 502);
+    assert(engine.basket_size(etf) == 500 && engine.basket_size(future) == 1);
+    assert(!engine.priced(etf));
+
+    // No signal until the basket and every component have a price
+    FairValueEngine::Signal signals[4];
+    for (uint32_t i = 0; i < 500; ++i) {
+        std::snprintf(name, sizeof(name), "C%03u", i);
+        prices[i] = 10.0 + i * 0.01;
+        assert(engine.on_price(engine.instrument(name), prices[i], signals, 4) == 0);
+    }
+    auto reference = [&]() {
+        double value = 1.0;
+        for (uint32_t i = 0; i < 500; ++i) {
+            value += weights[i] * prices[i];
+        }
+        return value;
+    };
+    assert(!engine.priced(etf));
+    assert(std::fabs(engine.fair_value(etf) - reference()) < 1e-9);
+    uint32_t etf_instrument = engine.instrument("ETF");
+    assert(engine.on_price(etf_instrument, engine.fair_value(etf), signals, 4) == 0);
+    assert(engine.priced(etf) && engine.spread_bps(etf) == 0.0);
+
+    // Beyond the threshold: one signal, not repeated while it stays there
+    double fair = engine.fair_value(etf);
+    assert(engine.on_price(etf_instrument, fair * 1.002, signals, 4) == 1);
+    assert(signals[0].basket == etf && signals[0].side == 1);
+    assert(std::fabs(signals[0].spread_bps - 20.0) < 1e-6);
+    assert(engine.on_price(etf_instrument, fair * 1.0021, signals, 4) == 0);
+
+    // A component tick moves the fair value up to the market: back inside
+    uint32_t c499 = engine.instrument("C499");
+    prices[499] += fair * 0.002 / weights[499];
+    assert(engine.on_price(c499, prices[499], signals, 4) == 1);
+    assert(signals[0].side == 0 && std::fabs(engine.spread_bps(etf)) < 1.0);
+
+    // One instrument in two baskets updates both
+    double future_fair = engine.fair_value(future);
+    engine.on_price(engine.instrument("FUT"), future_fair, signals, 4);
+    prices[0] *= 0.99;
+    assert(engine.on_price(engine.instrument("C000"), prices[0], signals, 4) == 1);
+    assert(signals[0].basket == future && signals[0].side == 1);
+    assert(std::fabs(engine.fair_value(future) - prices[0]) < 1e-12);
+
+    // A long random walk stays on the recomputed value (drift corrected
+    // one basket every 64 ticks)
+    uint64_t state = 12345;
+    for (int tick = 0; tick < 200000; ++tick) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t i = static_cast<uint32_t>(state >> 33) % 500;
+        prices[i] = std::max(1.0, prices[i] + (static_cast<double>(state >> 40 & 0xFF) - 127.5) * 0.0001);
+        std::snprintf(name, sizeof(name), "C%03u", i);
+        engine.on_price(engine.instrument(name), prices[i], signals, 4);
+    }
+    assert(std::fabs(engine.fair_value(etf) - reference()) / reference() < 1e-12);
+    engine.recompute();
+    assert(std::fabs(engine.fair_value(etf) - reference()) / reference() < 1e-14);
+    assert(engine.max_drift() < 1e-9);
+
+    // Basket files: repeated components add up, CASH sets the cash part
+    std::string path = "/tmp/test_baskets_" + std::to_string(getpid()) + ".txt";
+    FILE* f = std::fopen(path.c_str(), "w");
+    std::fputs("# Index\nIDX A 2\nIDX B 3   # trailing comment\n\nIDX CASH 5\nIDX A 1\n", f);
+    std::fclose(f);
+    FairValueEngine loaded;
+    assert(loaded.load(path, 10.0));
+    loaded.finalize();
+    assert(loaded.baskets() == 1 && loaded.basket_size(0) == 2);
+    loaded.on_price(loaded.instrument("A"), 10.0, signals, 4);
+    loaded.on_price(loaded.instrument("B"), 20.0, signals, 4);
+    assert(std::fabs(loaded.fair_value(0) - (5.0 + 3 * 10.0 + 3 * 20.0)) < 1e-12);
+    f = std::fopen(path.c_str(), "w");
+    std::fputs("IDX A\n", f);
+    std::fclose(f);
+    FairValueEngine bad;
+    assert(!bad.load(path, 10.0));
+    unlink(path.c_str());
+    (void)future_fair; (void)c499;
+
+    std::cout << "✓ Fair value engine test passed\n";
+}
+
+void test_arbitrage_strategy() {
+    std::cout << "Testing basket arbitrage strategy...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+    OrderManager manager(sender, 16);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 1000;
+    manager.set_risk_limits(limits);
+
+    ArbitrageStrategy::Parameters params;
+    params.order_size = 10;
+    params.tick_size = 0.05;
+    ArbitrageStrategy arbitrage(manager, params);
+    uint32_t etf = arbitrage.fair_value().add_basket("ETF", 10.0);
+    arbitrage.fair_value().add_component(etf, "AAA", 2.0);
+    arbitrage.fair_value().add_component(etf, "BBB", 1.0);
+    arbitrage.finalize();
+
+    MarketDataHandler handler;
+    StrategyRouter router(handler);
+    for (const char* symbol : {"ETF", "AAA", "BBB"}) {
+        handler.add_symbol(symbol);
+        assert(router.subscribe(symbol, &arbitrage));
+    }
+    auto feed = [&handler](const char* symbol, double bid, double ask) {
+        auto records = touch(symbol, bid, ask);
+        handler.process_message(reinterpret_cast<const char*>(records.data()),
+                                records.size() * sizeof(SimpleRecord));
+    };
+
+    // Fair value 2 x 50.01 + 100.01 = 200.03; the ETF trades at it
+    feed("AAA", 50.00, 50.02);
+    feed("BBB", 100.00, 100.02);
+    feed("ETF", 200.02, 200.04);
+    assert(arbitrage.fair_value().priced(etf) && arbitrage.signals() == 0);
+    assert(std::fabs(arbitrage.fair_value().fair_value(etf) - 200.03) < 1e-9);
+
+    // ETF rich by ~25 bps: sell it with an IOC limited above fair value
+    feed("ETF", 200.52, 200.54);
+    Order order = gateway.read<Order>();
+    assert(std::strcmp(order.symbol, "ETF") == 0);
+    assert(order.type == Order::Type::IOC && order.side == Order::Side::SELL);
+    assert(order.quantity == 10 && order.price > 200.03 && order.price < 200.53);
+    assert(std::fabs(order.price - 200.20) < 1e-9);         // 200.155 up to the grid
+    assert(arbitrage.signals() == 1 && arbitrage.orders_sent() == 1);
+
+    // The components catch up: back inside, no order
+    feed("AAA", 50.25, 50.27);
+    assert(arbitrage.signals() == 2 && arbitrage.orders_sent() == 1);
+
+    // ETF cheap: buy
+    feed("ETF", 199.90, 199.92);
+    order = gateway.read<Order>();
+    assert(order.side == Order::Side::BUY && order.price < arbitrage.fair_value().fair_value(etf));
+    assert(std::fabs(order.price - 200.35) < 1e-9);         // 200.375 down to the grid
+    assert(arbitrage.orders_sent() == 2);
+    arbitrage.on_timer();
+    (void)order;
+
+    std::cout << "✓ Basket arbitrage strategy test passed\n";
+}
+
+void test_pipeline() {
+    std::cout << "Testing staged feed -> strategy -> sender pipeline...\n";
+
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    handler.add_symbol("MSFT");
+    MarketMakingStrategy::Parameters params;
+    params.symbol = "AAPL";
+    params.quote_size = 40;
+
+    {
+        // Orders leave from the sender thread
+        Gateway gateway;
+        TCPSender sender("127.0.0.1", gateway.listen());
+        assert(sender.connect());
+        gateway.accept();
+        OrderManager manager(sender, 16);
+        MarketMakingStrategy strategy(manager, params);
+        StrategyRouter router(handler);
+        assert(router.subscribe("AAPL", &strategy));
+
+        TradingPipeline pipeline(handler, router, manager, sender, TradingPipeline::Options{});
+        pipeline.start();
+        assert(pipeline.is_running());
+        for (const char* symbol : {"MSFT", "AAPL"}) {
+            auto records = touch(symbol, 100.00, 100.02);
+            handler.process_message(reinterpret_cast<const char*>(records.data()),
+                                    records.size() * sizeof(SimpleRecord));
+        }
+        for (Order::Side side : {Order::Side::BUY, Order::Side::SELL}) {
+            Order order = gateway.read<Order>();
+            assert(std::strcmp(order.symbol, "AAPL") == 0 && order.side == side);
+            assert(order.quantity == 40);
+            (void)order;
+            (void)side;
+        }
+        pipeline.stop();
+        assert(!pipeline.is_running());
+
+        // Only the subscribed book is queued, one event per update
+        assert(pipeline.events_queued() == 2 && pipeline.events_processed() == 2);
+        assert(pipeline.events_dropped() == 0);
+        assert(pipeline.commands_sent() == 2 && pipeline.send_failures() == 0);
+        assert(manager.open_orders() == 2);
+        assert(sender.orders_sent() == 2);
+
+        // Inline again after stop()
+        auto records = touch("AAPL", 100.01, 100.03);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        handler.process_message(reinterpret_cast<const char*>(records.data()),
+                                records.size() * sizeof(SimpleRecord));
+        assert(pipeline.events_queued() == 2);
+    }
+
+    {
+        // Sender refuses (not connected): the orders come back as rejects
+        TCPSender sender("127.0.0.1", 1);
+        OrderManager manager(sender, 16);
+        MarketMakingStrategy strategy(manager, params);
+        StrategyRouter router(handler);
+        assert(router.subscribe("AAPL", &strategy));
+
+        TradingPipeline pipeline(handler, router, manager, sender, TradingPipeline::Options{});
+        pipeline.start();
+        auto records = touch("AAPL", 100.00, 100.02);
+        handler.process_message(reinterpret_cast<const char*>(records.data()),
+                                records.size() * sizeof(SimpleRecord));
+        assert(wait_for([&pipeline] { return pipeline.send_failures() == 2; }));
+        pipeline.stop();
+
+        assert(pipeline.commands_sent() == 0);
+        // Applied here unless a timer tick already did
+        manager.process_execution_reports();
+        assert(manager.open_orders() == 0);
+        assert(manager.open_buy_quantity() == 0 && manager.open_notional() == 0);
+    }
+
+    std::cout << "✓ Pipeline test passed\n";
+}
+
+// Length-prefixed ITCH 5.0 messages (FeedProtocol::ITCH50_FRAMED)
+struct ItchFrames {
+    std::vector<char> buf;
+
+    void u8(uint8_t v) { buf.push_back(static_cast<char>(v)); }
+    void u16(uint16_t v) { u8(v >> 8); u8(v & 0xFF); }
+    void u32(uint32_t v) { u16(v >> 16); u16(v & 0xFFFF); }
+    void u64(uint64_t v) { u32(v >> 32); u32(v & 0xFFFFFFFF); }
+    void stock(const char* s) {
+        for (size_t i = 0; i < 8; ++i) {
+            u8(i < std::strlen(s) ? s[i] : ' ');
+        }
+    }
+    void header(uint16_t length, char type, uint16_t locate) {
+        u16(length);
+        u8(type); u16(locate); u16(0); u16(0); u32(0);      // 48-bit timestamp
+    }
+
+    void add_order(uint16_t locate, uint64_t ref, char side, uint32_t shares, const char* symbol,
+                   uint32_t price) {
+        header(36, 'A', locate);
+        u64(ref); u8(side); u32(shares); stock(symbol); u32(price);
+    }
+    void execute(uint16_t locate, uint64_t ref, uint32_t shares, uint64_t match) {
+        header(31, 'E', locate);
+        u64(ref); u32(shares); u64(match);
+    }
+    void execute_with_price(uint16_t locate, uint64_t ref, uint32_t shares, uint64_t match,
+                            char printable, uint32_t price) {
+        header(36, 'C', locate);
+        u64(ref); u32(shares); u64(match); u8(printable); u32(price);
+    }
+    void trade(uint16_t locate, char side, uint32_t shares, const char* symbol, uint32_t price,
+               uint64_t match) {
+        header(44, 'P', locate);
+        u64(0); u8(side); u32(shares); stock(symbol); u32(price); u64(match);
+    }
+    void remove(uint16_t locate, uint64_t ref) {
+        header(19, 'D', locate);
+        u64(ref);
+    }
+};
+
+void test_trade_prints() {
+    std::cout << "Testing trade print delivery...\n";
+
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    handler.set_feed_protocol(FeedProtocol::ITCH50_FRAMED);
+    handler.set_l3_capacity(1024);
+
+    TCPSender sender("127.0.0.1", 1);
+    OrderManager manager(sender, 16);
+    MarketMakingStrategy::Parameters params;
+    params.symbol = "AAPL";
+    MarketMakingStrategy strategy(manager, params);
+    StrategyRouter router(handler);
+    assert(router.subscribe("AAPL", &strategy));
+
+    ItchFrames feed;
+    feed.add_order(7, 1, 'B', 100, "AAPL", 1500000);          // 150.0000
+    feed.add_order(7, 2, 'S', 100, "AAPL", 1500100);          // 150.0100
+    feed.execute(7, 1, 40, 901);                              // At the resting price
+    feed.execute_with_price(7, 2, 10, 902, 'Y', 1500200);     // Price from the message
+    feed.execute_with_price(7, 2, 10, 903, 'N', 1500300);     // Not printable
+    feed.trade(7, 'S', 25, "AAPL", 1500050, 904);             // Hidden order
+    handler.process_message(feed.buf.data(), feed.buf.size());
+    assert(handler.messages_decoded() == 6);
+
+    assert(strategy.trades_seen() == 3);
+    assert(std::abs(strategy.last_trade_price() - 150.005) < 1e-9);
+
+    // Every execution still moved the book
+    const L3OrderBook* l3 = handler.get_l3_book("AAPL");
+    assert(l3 && l3->find_order(1)->quantity == 60 && l3->find_order(2)->quantity == 80);
+    (void)l3;
+
+    std::cout << "✓ Trade print test passed\n";
+}
+
+void test_pipeline_conflation() {
+    std::cout << "Testing conflated pipeline dispatch...\n";
+
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    handler.add_symbol("MSFT");
+    handler.set_feed_protocol(FeedProtocol::ITCH50_FRAMED);
+    handler.set_l3_capacity(4096);
+
+    TCPSender sender("127.0.0.1", 1);
+    OrderManager manager(sender, 64);
+    MarketMakingStrategy::Parameters aapl_params;
+    aapl_params.symbol = "AAPL";
+    MarketMakingStrategy::Parameters msft_params;
+    msft_params.symbol = "MSFT";
+    MarketMakingStrategy aapl(manager, aapl_params);
+    MarketMakingStrategy msft(manager, msft_params);
+    StrategyRouter router(handler);
+    assert(router.subscribe("AAPL", &aapl));
+    assert(router.subscribe("MSFT", &msft));
+
+    TradingPipeline::Options options;
+    options.conflate = true;
+    TradingPipeline pipeline(handler, router, manager, sender, options);
+    pipeline.start();
+    assert(pipeline.conflating());
+
+    // Bursts of book updates on both symbols, with prints in between
+    constexpr int UPDATES = 2000;
+    constexpr int TRADES = 200;
+    uint64_t ref = 1;
+    for (int burst = 0; burst < TRADES; ++burst) {
+        ItchFrames feed;
+        for (int i = 0; i < UPDATES / TRADES / 2; ++i) {
+            feed.add_order(1, ref++, 'B', 100, "AAPL", 1500000 - i * 100);
+            feed.add_order(2, ref++, 'S', 100, "MSFT", 3000000 + i * 100);
+        }
+        feed.execute(1, ref - 2, 1, 1000 + burst);             // One print per burst
+        handler.process_message(feed.buf.data(), feed.buf.size());
+    }
+    pipeline.stop();
+
+    // Each evaluation took at least one update, nothing was lost or repeated
+    uint64_t updates = UPDATES + TRADES;                       // Executions move the book too
+    assert(pipeline.events_dropped() == 0);
+    assert(pipeline.events_processed() == pipeline.events_queued());
+    assert(pipeline.events_processed() + pipeline.updates_conflated() == updates);
+    assert(pipeline.events_processed() >= 2 && pipeline.events_processed() <= updates);
+
+    // Prints are never conflated: every one arrives, once
+    assert(pipeline.trades_queued() == TRADES && pipeline.trades_dropped() == 0);
+    assert(pipeline.trades_processed() == TRADES);
+    assert(aapl.trades_seen() == TRADES && msft.trades_seen() == 0);
+    (void)updates;
+
+    std::cout << "✓ Conflated pipeline test passed (" << pipeline.events_processed()
+              << " evaluations for " << updates << " updates)\n";
+}
+
+// OrderManager on an ExchangeSimulator, fed frame by frame
+struct SimulatedVenue {
+    MarketDataHandler handler;
+    TCPSender sender{"127.0.0.1", 1};
+    OrderManager manager{sender, 64};
+    ArbitrageStrategy idle{manager, {}};                       // Routes the book, never trades
+    std::unique_ptr<StrategyRouter> router;
+    std::unique_ptr<ExchangeSimulator> venue;
+    uint64_t now = 1000000000;
+
+    explicit SimulatedVenue(const ExchangeSimulator::Options& options) {
+        handler.add_symbol("AAPL");
+        handler.set_feed_protocol(FeedProtocol::ITCH50_FRAMED);
+        handler.set_l3_capacity(1024);
+        router = std::make_unique<StrategyRouter>(handler);
+        router->subscribe("AAPL", &idle);
+        venue = std::make_unique<ExchangeSimulator>(handler, manager, options);
+        handler.set_book_listener([](void* venue, const OrderBook& book) {
+            static_cast<ExchangeSimulator*>(venue)->on_book(book, book.get_top());
+        }, venue.get());
+        handler.set_trade_listener([](void* venue, const OrderBook& book, const TradePrint& trade) {
+            static_cast<ExchangeSimulator*>(venue)->on_trade(book, trade);
+        }, venue.get());
+        at(now);
+    }
+
+    void feed(const ItchFrames& frames) {
+        handler.process_message(frames.buf.data(), frames.buf.size(), now);
+    }
+
+    void at(uint64_t t) {
+        now = t;
+        venue->advance(t);
+    }
+
+    void later(uint64_t ns) { at(now + ns); }
+
+    uint64_t submit(Order::Side side, double price, double quantity) {
+        uint64_t id = manager.next_order_id();
+        bool submitted = manager.submit_order(make_order(id, side, price, quantity));
+        assert(submitted);
+        (void)submitted;
+        venue->collect();
+        return id;
+    }
+
+    OrderManager::OrderState state(uint64_t id) const {
+        const OrderManager::OrderInfo* order = manager.find_order(id);
+        return order ? order->state : OrderManager::OrderState::DONE;
+    }
+};
+
+void test_exchange_simulator() {
+    std::cout << "Testing simulated venue matching...\n";
+
+    ExchangeSimulator::Options options;
+    options.order_latency_ns = 10000;
+    options.report_latency_ns = 10000;
+    SimulatedVenue sim(options);
+
+    ItchFrames book;
+    book.add_order(7, 1, 'B', 300, "AAPL", 1500000);           // 150.0000 x 300
+    book.add_order(7, 2, 'S', 200, "AAPL", 1500500);           // 150.0500 x 200
+    sim.feed(book);
+
+    // Order latency, then report latency
+    uint64_t bid = sim.submit(Order::Side::BUY, 150.00, 100);
+    sim.later(5000);
+    assert(sim.venue->resting_orders() == 0 && sim.state(bid) == State::PENDING_NEW);
+    sim.later(5000);
+    assert(sim.venue->resting_orders() == 1 && sim.state(bid) == State::PENDING_NEW);
+    sim.later(10000);
+    assert(sim.state(bid) == State::LIVE);
+
+    // Joined behind 300: executions of the orders ahead do not fill us,
+    // even the one that empties the level
+    ItchFrames ahead;
+    ahead.execute(7, 1, 50, 901);
+    ahead.execute(7, 1, 250, 902);
+    sim.feed(ahead);
+    sim.later(20000);
+    assert(sim.manager.get_position() == 0 && sim.state(bid) == State::LIVE);
+
+    // Now first in line: a print at our price fills us
+    ItchFrames hidden;
+    hidden.trade(7, 'B', 60, "AAPL", 1500000, 903);
+    sim.feed(hidden);
+    sim.later(5000);
+    assert(sim.manager.get_position() == 0);                   // Report in flight
+    sim.later(5000);
+    assert(sim.manager.get_position() == 60 && sim.state(bid) == State::PARTIALLY_FILLED);
+
+    // An offer through our bid crosses the rest, at our price
+    ItchFrames cross;
+    cross.add_order(7, 3, 'S', 100, "AAPL", 1499900);          // 149.9900 x 100
+    sim.feed(cross);
+    sim.later(10000);
+    assert(sim.manager.get_position() == 100 && sim.state(bid) == State::DONE);
+    assert(std::abs(sim.manager.get_notional() - 100 * 150.00) < 1e-6);
+
+    // Marketable on arrival: takes the displayed offer at its price
+    uint64_t take = sim.submit(Order::Side::BUY, 150.00, 30);
+    sim.later(20000);
+    assert(sim.state(take) == State::DONE && sim.manager.get_position() == 130);
+    assert(std::abs(sim.manager.get_notional() - (100 * 150.00 + 30 * 149.99)) < 1e-6);
+
+    // Replace answers under the new ID, cancel removes it
+    uint64_t ask = sim.submit(Order::Side::SELL, 151.00, 50);
+    sim.later(20000);
+    assert(sim.state(ask) == State::LIVE);
+    uint64_t amended = sim.manager.next_order_id();
+    assert(sim.manager.replace_order(ask, amended, 151.10, 50, sim.now));
+    sim.venue->collect();
+    sim.later(20000);
+    assert(sim.state(amended) == State::LIVE && sim.manager.find_order(ask) == nullptr);
+    assert(sim.manager.cancel_order(amended));
+    sim.venue->collect();
+    sim.later(20000);
+    assert(sim.state(amended) == State::DONE);
+    assert(sim.manager.open_orders() == 0 && sim.venue->resting_orders() == 0);
+    assert(sim.venue->in_flight() == 0);
+
+    const ExchangeSimulator::Stats& stats = sim.venue->stats();
+    assert(stats.orders == 3 && stats.replaces == 1 && stats.cancels == 1);
+    assert(stats.fills == 3 && stats.rejects == 0);
+    assert(stats.filled_quantity == 130);
+    (void)stats; (void)take; (void)ask;
+
+    std::cout << "✓ Simulated venue test passed\n";
+}
+
+// One symbol, a random walk quoted 1 tick wide, with sweeps through the
+// quotes every few packets; one packet per millisecond
+void write_session(const std::string& path, int packets) {
+    FeedJournalWriter journal;
+    bool opened = journal.open(path, 1 << 20);
+    assert(opened);
+    (void)opened;
+
+    uint64_t t = 1700000000000000000ULL;
+    uint32_t mid = 1500000;
+    uint64_t seed = 12345;
+    uint64_t ref = 1;
+    uint64_t match = 1;
+    for (int i = 0; i < packets; ++i) {
+        ItchFrames frames;
+        if (i > 0) {
+            frames.remove(7, ref - 2);
+            frames.remove(7, ref - 1);
+        }
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        mid = static_cast<uint32_t>(mid + static_cast<int>((seed >> 33) % 161) - 80);
+        frames.add_order(7, ref++, 'B', 500, "AAPL", mid - 50);
+        frames.add_order(7, ref++, 'S', 500, "AAPL", mid + 50);
+        if (i % 5 == 4) {
+            bool sell_sweep = (seed >> 20) & 1;
+            frames.trade(7, sell_sweep ? 'B' : 'S', 100, "AAPL", sell_sweep ? mid - 400 : mid + 400, match++);
+        }
+        journal.append(frames.buf.data(), frames.buf.size(), t);
+        t += 1000000;
+    }
+}
+
+void test_backtest() {
+    std::cout << "Testing backtest runs and sweeps...\n";
+
+    std::string path = "/tmp/test_backtest_" + std::to_string(getpid()) + ".jrnl";
+    constexpr int PACKETS = 3000;
+    write_session(path, PACKETS);
+    FeedJournalReader journal;
+    bool opened = journal.open(path);
+    assert(opened);
+    (void)opened;
+
+    Backtest::Setup setup;
+    setup.symbols = {"AAPL"};
+    setup.feed_protocol = FeedProtocol::ITCH50_FRAMED;
+    Backtest backtest(journal, setup);
+
+    std::vector<Backtest::ParameterSet> sets;
+    for (double spread : {0.0001, 0.0002, 0.0004}) {
+        MarketMakingStrategy::Parameters params;
+        params.symbol = "AAPL";
+        params.spread_target = spread;
+        sets.push_back({params});
+    }
+
+    // Quotes fill on the sweeps, P&L follows the fills
+    Backtest::Result first = backtest.run(sets[0]);
+    assert(first.packets == PACKETS);
+    assert(first.orders > 0 && first.fills > 0 && first.filled_quantity > 0);
+    assert(first.pnl != 0 && first.max_drawdown >= 0);
+
+    // Same journal and parameters, same result; parallel runs match
+    // serial ones exactly
+    Backtest::Result again = backtest.run(sets[0]);
+    assert(again.pnl == first.pnl && again.fills == first.fills && again.position == first.position);
+    std::vector<Backtest::Result> results = backtest.sweep(sets, 2);
+    assert(results.size() == sets.size());
+    for (size_t i = 0; i < sets.size(); ++i) {
+        Backtest::Result serial = i == 0 ? first : backtest.run(sets[i]);
+        assert(results[i].pnl == serial.pnl && results[i].fills == serial.fills);
+        assert(results[i].max_drawdown == serial.max_drawdown && results[i].position == serial.position);
+        (void)serial;
+    }
+
+    // Wider quotes: fewer sweeps reach them
+    assert(results[2].fills < results[0].fills);
+    (void)again;
+
+    journal.close();
+    unlink(path.c_str());
+
+    std::cout << "✓ Backtest test passed (";
+    for (const auto& r : results) {
+        std::cout << r.fills << " fills, P&L " << r.pnl << "; ";
+    }
+    std::cout << first.elapsed_ns / 1000 << " us per run)\n";
+}
+
+// The inline path stamps every stage of a quoting tick
+void test_tick_to_trade_stages() {
+    std::cout << "Testing tick-to-trade stages of the inline path...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+
+    OrderManager manager(sender, 16);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 1000;
+    manager.set_risk_limits(limits);
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    MarketMakingStrategy::Parameters params;
+    params.symbol = "AAPL";
+    MarketMakingStrategy strategy(manager, params);
+    StrategyRouter router(handler);
+    router.subscribe("AAPL", &strategy);
+
+    auto stages = std::make_unique<TickToTrade::Histograms>();
+    TickToTrade::attach(stages.get());
+
+    // Packet off the wire 3 us ago, quoted on both sides in one write
+    auto records = touch("AAPL", 100.00, 100.02);
+    handler.process_message(reinterpret_cast<const char*>(records.data()),
+                            records.size() * sizeof(SimpleRecord), Timestamp::fast_wall_clock_ns() - 3000);
+    gateway.read<Order>();
+    gateway.read<Order>();
+    const LatencyHistogram& total = stages->stage[TickToTrade::TOTAL];
+    assert(total.count() == 1);
+    uint64_t sum = 0;
+    for (int s = TickToTrade::DECODE; s <= TickToTrade::SEND; ++s) {
+        assert(stages->stage[s].count() == 1);
+        sum += stages->stage[s].max();
+    }
+    assert(stages->stage[TickToTrade::STRATEGY].max() > 0 && stages->stage[TickToTrade::SEND].max() > 0);
+    assert(sum <= total.max() + 6 && sum + 6 >= total.max());
+    assert(stages->stage[TickToTrade::RECV].min() >= 3000);
+
+    // Updates that send nothing, and sends outside a packet, are not ticks
+    handler.process_message(reinterpret_cast<const char*>(records.data()),
+                            records.size() * sizeof(SimpleRecord));
+    manager.flush();
+    assert(total.count() == 1);
+    TickToTrade::attach(nullptr);
+    (void)sum;
+
+    std::cout << "✓ Tick-to-trade stage test passed\n";
+}
+
+// ITCH 5.0 add order, length prefixed (ITCH50_FRAMED)
+std::vector<char> itch_add(uint16_t locate, uint64_t ref, char side, uint32_t shares,
+                           const char* stock, uint32_t price) {
+    std::vector<char> out;
+    auto put = [&out](uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    };
+    put(36, 2);
+    out.push_back('A');
+    put(locate, 2);
+    put(0, 2);
+    put(0, 6);
+    put(ref, 8);
+    out.push_back(side);
+    put(shares, 4);
+    for (size_t i = 0; i < 8; ++i) {
+        out.push_back(i < std::strlen(stock) ? stock[i] : ' ');
+    }
+    put(price, 4);
+    return out;
+}
+
+void test_warmup() {
+    std::cout << "Testing pre-open warm-up...\n";
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    OrderManager manager(sender, 64);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 10;
+    limits.max_order_burst = 4;
+    manager.set_risk_limits(limits);
+    sender.set_execution_callback([&manager](const ExecutionReport& report) {
+        manager.enqueue_execution_report(report);
+    });
+
+    MarketDataHandler handler;
+    handler.add_symbol("AAPL");
+    handler.add_symbol("MSFT");
+    MarketMakingStrategy::Parameters params;
+    params.symbol = "AAPL";
+    MarketMakingStrategy aapl(manager, params);
+    params.symbol = "MSFT";
+    MarketMakingStrategy msft(manager, params);
+    StrategyRouter router(handler);
+    router.subscribe("AAPL", &aapl);
+    router.subscribe("MSFT", &msft);
+
+    // Not connected: the loopback stands in for the gateway
+    Warmup::Options options;
+    options.lock_memory = false;
+    options.min_ticks = 2000;
+    options.max_ticks = 20000;
+    options.batch_ticks = 500;
+    options.tolerance = 1e9;                        // Any batch is steady: stop at min_ticks
+    Warmup warmup(handler, router, manager, sender, options);
+    Warmup::Result result = warmup.run();
+    assert(result.steady && result.ticks == options.min_ticks);
+    assert(result.prefaulted_bytes > 0);
+    assert(result.samples > result.ticks / 2);      // Quoted well past the rate limit
+    assert(result.first_tick_ns > 0 && result.last_p50_ns > 0);
+    assert(result.orders_canceled == 4);            // Both sides of both books
+    assert(warmup.histograms().stage[TickToTrade::ENCODE].count() == result.samples);
+
+    // Nothing left behind: no orders, no exposure, empty books, nothing sent
+    assert(manager.open_orders() == 0);
+    assert(manager.open_notional() == 0 && manager.get_position() == 0);
+    assert(sender.orders_sent() == 0 && !sender.loopback() && sender.pending_bytes() == 0);
+    assert(handler.get_order_book("AAPL")->get_top().bid_depth == 0);
+    assert(aapl.get_pnl() == 0 && aapl.last_wire_to_order_ns() == 0);
+
+    // Live: first tick quotes both sides with new orders, within the
+    // configured burst
+    assert(sender.connect());
+    gateway.accept();
+    auto records = touch("AAPL", 100.00, 100.02);
+    handler.process_message(reinterpret_cast<const char*>(records.data()),
+                            records.size() * sizeof(SimpleRecord), Timestamp::fast_wall_clock_ns());
+    Order bid = gateway.read<Order>();
+    Order ask = gateway.read<Order>();
+    assert(bid.side == Order::Side::BUY && ask.side == Order::Side::SELL);
+    assert(std::strcmp(bid.symbol, "AAPL") == 0);
+    assert(manager.open_orders() == 2);
+    for (int i = 0; i < 4; ++i) {
+        bid.order_id = 1000 + i;
+        assert(manager.submit_order(bid) == (i < 2));   // 4 tokens, 2 taken
+    }
+
+    // ITCH: synthetic locate codes are forgotten, the L3 book is reused
+    MarketDataHandler itch_handler;
+    itch_handler.set_feed_protocol(FeedProtocol::ITCH50_FRAMED);
+    itch_handler.add_symbol("AAPL");
+    OrderManager itch_manager(sender, 64);
+    params.symbol = "AAPL";
+    MarketMakingStrategy itch_aapl(itch_manager, params);
+    StrategyRouter itch_router(itch_handler);
+    itch_router.subscribe("AAPL", &itch_aapl);
+    sender.disconnect();
+    sender.set_execution_callback([&itch_manager](const ExecutionReport& report) {
+        itch_manager.enqueue_execution_report(report);
+    });
+    Warmup itch_warmup(itch_handler, itch_router, itch_manager, sender, options);
+    result = itch_warmup.run();
+    assert(result.samples > 0 && itch_manager.open_orders() == 0);
+    const L3OrderBook* l3 = itch_handler.get_l3_book("AAPL");
+    assert(l3 != nullptr && itch_handler.get_order_book("AAPL")->get_top().bid_depth == 0);
+
+    // The session's locate 1 is another stock: not AAPL's book any more
+    auto msft_add = itch_add(1, 1, 'B', 100, "MSFT", 1000000);
+    itch_handler.process_message(msft_add.data(), msft_add.size());
+    assert(itch_handler.get_order_book("AAPL")->get_top().bid_depth == 0);
+    auto aapl_add = itch_add(9, 2, 'B', 100, "AAPL", 1500000);
+    itch_handler.process_message(aapl_add.data(), aapl_add.size());
+    assert(itch_handler.get_order_book("AAPL")->get_top().bid_price == 150.0);
+    assert(itch_handler.get_l3_book("AAPL") == l3);
+    (void)l3;
+    (void)result;
+
+    std::cout << "✓ Warm-up test passed\n";
+}
+
+void write_file(const std::string& path, const char* text) {
+    FILE* f = std::fopen(path.c_str(), "w");
+    std::fputs(text, f);
+    std::fclose(f);
+}
+
+void test_parameter_reload() {
+    std::cout << "Testing parameter hot reload...\n";
+
+    std::string path = "/tmp/test_reload_" + std::to_string(getpid()) + ".conf";
+    write_file(path, "symbols=AAPL\nspread_threshold=0.0002\nmax_order_size=100\nmax_orders_per_second=1000\n");
+    Config config;
+    assert(config.load(path));
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+    OrderManager manager(sender, 16);
+    manager.set_risk_limits(risk_limits(config));
+    MarketMakingStrategy strategy(manager, market_making_parameters(config, "AAPL"));
+    ParameterReloader reloader(manager, path);
+    reloader.add_strategy(&strategy);
+
+    OrderBook book("AAPL");
+    book.update_bid(0, 100.00, 500);
+    book.update_ask(0, 100.02, 500);
+    strategy.on_order_book_update(book);
+    Order bid = gateway.read<Order>();
+    Order ask = gateway.read<Order>();
+    double width = ask.price - bid.price;
+    assert(bid.quantity == 100 && ask.quantity == 100);
+    manager.on_execution_report(make_report(ExecutionReport::Type::ACK, bid.order_id));
+    manager.on_execution_report(make_report(ExecutionReport::Type::ACK, ask.order_id));
+
+    // Wider, smaller quotes and a larger order size limit
+    write_file(path, "symbols=AAPL\nspread_threshold=0.0002\nAAPL.spread_target=0.0010\n"
+                     "AAPL.quote_size=50\nmax_order_size=200\nmax_orders_per_second=1000\n");
+    assert(reloader.reload() && reloader.reloads() == 1);
+    assert(strategy.parameters().spread_target == 0.0010 && strategy.parameters().quote_size == 50);
+    assert(manager.published_risk_limits().max_order_size == 200);
+    assert(manager.risk().limits().max_order_size == 100);      // Owner thread not there yet
+
+    // The next tick trades on them: requoted at once (no pacing wait),
+    // amending the resting orders
+    strategy.on_order_book_update(book);
+    ReplaceRequest bid_replace = gateway.read<ReplaceRequest>();
+    ReplaceRequest ask_replace = gateway.read<ReplaceRequest>();
+    assert(bid_replace.order_id == bid.order_id && ask_replace.order_id == ask.order_id);
+    assert(bid_replace.quantity == 50 && ask_replace.quantity == 50);
+    assert(ask_replace.price - bid_replace.price > width * 2);
+    assert(manager.risk().limits().max_order_size == 200);
+    assert(manager.open_orders() == 2);
+    reloader.reclaim();
+
+    // Rejected: nothing is published, trading goes on with the last set
+    const char* bad[] = {
+        "AAPL.skew_factor=2\n",                                // Out of range
+        "max_order_size=abc\n",                                // Not a number
+        "AAPL.quote_size=500\nmax_order_size=100\n",           // Quote above the order size limit
+        "max_orders_per_second=0\n",
+    };
+    for (const char* text : bad) {
+        write_file(path, text);
+        assert(!reloader.reload());
+    }
+    unlink(path.c_str());
+    assert(!reloader.reload());                                 // File gone
+    assert(reloader.reloads() == 1);
+    assert(strategy.parameters().quote_size == 50 && manager.published_risk_limits().max_order_size == 200);
+
+    // A strategy keeps its symbol
+    MarketMakingStrategy::Parameters other = strategy.parameters();
+    other.symbol = "MSFT";
+    assert(!strategy.update_parameters(other));
+    (void)width; (void)bid_replace; (void)ask_replace;
+
+    std::cout << "✓ Parameter hot reload test passed\n";
+}
+
+void test_sharded_feed() {
+    std::cout << "Testing sharded feed handling...\n";
+
+    // Partition map from the config
+    std::string path = "/tmp/test_shards_" + std::to_string(getpid()) + ".conf";
+    write_file(path, "market_data_multicast_ip=239.1.1.1\nmarket_data_port=9000\n"
+                     "market_data_channels=239.1.1.3:9002\nmarket_data_cpu=5\nfeed_shards=2\n"
+                     "feed_shard.0.symbols=ETF,AAA\n"
+                     "feed_shard.1.cpu=9\nfeed_shard.1.channels=239.1.1.4:9003\nfeed_shard.1.symbols=BBB,AAA\n");
+    Config config;
+    assert(config.load(path));
+    unlink(path.c_str());
+    FeedPartition partition = feed_partition(config);
+    assert(partition.shards.size() == 2);
+    assert(partition.shards[0].cpu == 5 && partition.shards[1].cpu == 9);
+    assert(partition.shards[0].channels.size() == 2);              // Every group
+    assert(partition.shards[1].channels.size() == 1 && partition.shards[1].channels[0].second == 9003);
+    assert(partition.shard_of("ETF") == 0 && partition.shard_of("BBB") == 1);
+    assert(partition.shard_of("AAA") == 0);                         // First placement kept
+    assert(partition.shard_of("CCC") < 2 && partition.shard_of("CCC") == partition.shard_of("CCC"));
+    config.feed_shards = 0;
+    assert(feed_partition(config).shards.size() == 1);
+
+    Gateway gateway;
+    TCPSender sender("127.0.0.1", gateway.listen());
+    assert(sender.connect());
+    gateway.accept();
+    OrderManager manager(sender, 16);
+    OrderManager::RiskLimits limits;
+    limits.max_orders_per_second = 1000;
+    manager.set_risk_limits(limits);
+
+    // A basket over both shards
+    ArbitrageStrategy::Parameters params;
+    params.order_size = 10;
+    ArbitrageStrategy arbitrage(manager, params);
+    uint32_t etf = arbitrage.fair_value().add_basket("ETF", 10.0);
+    arbitrage.fair_value().add_component(etf, "AAA", 2.0);
+    arbitrage.fair_value().add_component(etf, "BBB", 1.0);
+    arbitrage.finalize();
+
+    for (auto& shard : partition.shards) {
+        shard.cpu = -1;
+    }
+    ShardedFeed feed(partition, manager, ShardedFeed::Options{});
+    for (const char* symbol : {"ETF", "AAA", "BBB"}) {
+        assert(feed.subscribe(symbol, &arbitrage));
+    }
+    // Each shard holds its own books only
+    assert(feed.handler(0).get_order_book("ETF") && feed.handler(0).get_order_book("AAA"));
+    assert(!feed.handler(0).get_order_book("BBB"));
+    assert(feed.handler(1).get_order_book("BBB") && !feed.handler(1).get_order_book("AAA"));
+
+    auto send = [&feed](size_t shard, const char* symbol, double bid, double ask) {
+        auto records = touch(symbol, bid, ask);
+        feed.handler(shard).process_message(reinterpret_cast<const char*>(records.data()),
+                                            records.size() * sizeof(SimpleRecord));
+    };
+
+    feed.start();
+    assert(feed.is_running());
+    // One feed thread per shard; each skips the other's symbols
+    std::thread first([&send] { send(0, "AAA", 50.00, 50.02); send(0, "BBB", 1.00, 1.02); });
+    std::thread second([&send] { send(1, "BBB", 100.00, 100.02); send(1, "AAA", 1.00, 1.02); });
+    first.join();
+    second.join();
+    assert(wait_for([&feed] { return feed.events_processed() == 4; }));     // Bid and ask each
+
+    // Fair value 2 x 50.01 + 100.01 = 200.03 from both shards: the ETF
+    // rich by ~25 bps is sold
+    send(0, "ETF", 200.02, 200.04);
+    assert(wait_for([&feed] { return feed.events_processed() == 6; }));
+    assert(std::fabs(arbitrage.fair_value().fair_value(etf) - 200.03) < 1e-9);
+    assert(arbitrage.signals() == 0);
+    send(0, "ETF", 200.52, 200.54);
+    Order order = gateway.read<Order>();
+    assert(std::strcmp(order.symbol, "ETF") == 0 && order.side == Order::Side::SELL);
+    (void)order;
+    feed.stop();
+    assert(!feed.is_running());
+
+    assert(feed.events_queued() == 8 && feed.events_processed() == 8 && feed.events_dropped() == 0);
+    assert(arbitrage.signals() == 1);
+
+    // Inline again after stop()
+    send(1, "BBB", 100.01, 100.03);
+    assert(feed.events_queued() == 8);
+    assert(std::fabs(arbitrage.fair_value().fair_value(etf) - 200.04) < 1e-9);
+
+    std::cout << "✓ Sharded feed test passed\n";
+}
+
+int main() {
+    std::cout << "\n========================================\n";
+    std::cout << "   Trading Tests\n";
+    std::cout << "========================================\n\n";
+
+    test_risk_engine();
+    test_order_lifecycle();
+    test_order_risk_and_pool();
+    test_strategy_amends_quotes();
+    test_strategy_quote_cache();
+    test_strategy_routing();
+    test_fair_value_engine();
+    test_arbitrage_strategy();
+    test_tick_to_trade_stages();
+    test_warmup();
+    test_parameter_reload();
+    test_pipeline();
+    test_trade_prints();
+    test_pipeline_conflation();
+    test_sharded_feed();
+    test_exchange_simulator();
+    test_backtest();
+
+    std::cout << "\n✓ All trading tests passed!\n\n";
+
+    return 0;
+}